@@ -329,6 +329,15 @@ static int loom_asset_binaryRecognizer(const char *extension)
     {
         return LATBinary;
     }
+    // style sheets and LML compiled by StyleIndex.compile and LMLTree.compile
+    if (!stricmp(extension, "cssb"))
+    {
+        return LATBinary;
+    }
+    if (!stricmp(extension, "lmlb"))
+    {
+        return LATBinary;
+    }
     return 0;
 }
 
@@ -0,0 +1,762 @@
+/*
+ * ===========================================================================
+ * Loom SDK
+ * Copyright 2011, 2012, 2013
+ * The Game Engine Company, LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ * ===========================================================================
+ */
+
+#include <string.h>
+#include "loom/common/core/allocator.h"
+#include "loom/common/core/log.h"
+#include "loom/common/assets/assetsCompressedImage.h"
+
+static loom_logGroup_t gCompressedImageGroup = { "asset.img", 1 };
+
+static const unsigned char ktxIdentifier[12] = { 0xAB, 'K', 'T', 'X', ' ', '1', '1', 0xBB, '\r', '\n', 0x1A, '\n' };
+
+// ETC1 intensity modifiers, ETC2 T and H mode distances and EAC alpha
+// modifiers, from the Khronos data format specification.
+static const int etc1Modifiers[8][2] =
+{
+    {  2,   8 }, {  5,  17 }, {  9,  29 }, { 13,  42 },
+    { 18,  60 }, { 24,  80 }, { 33, 106 }, { 47, 183 }
+};
+
+static const int etc2Distances[8] = { 3, 6, 11, 16, 23, 32, 41, 64 };
+
+static const int eacModifiers[16][8] =
+{
+    { -3, -6,  -9, -15, 2, 5, 8, 14 },
+    { -3, -7, -10, -13, 2, 6, 9, 12 },
+    { -2, -5,  -8, -13, 1, 4, 7, 12 },
+    { -2, -4,  -6, -13, 1, 3, 5, 12 },
+    { -3, -6,  -8, -12, 2, 5, 7, 11 },
+    { -3, -7,  -9, -11, 2, 6, 8, 10 },
+    { -4, -7,  -8, -11, 3, 6, 7, 10 },
+    { -3, -5,  -8, -11, 2, 4, 7, 10 },
+    { -2, -6,  -8, -10, 1, 5, 7,  9 },
+    { -2, -5,  -8, -10, 1, 4, 7,  9 },
+    { -2, -4,  -8, -10, 1, 3, 7,  9 },
+    { -2, -5,  -7, -10, 1, 4, 6,  9 },
+    { -3, -4,  -7, -10, 2, 3, 6,  9 },
+    { -1, -2,  -3, -10, 0, 1, 2,  9 },
+    { -4, -6,  -8,  -9, 3, 5, 7,  8 },
+    { -3, -5,  -7,  -9, 2, 4, 6,  8 }
+};
+
+static unsigned int readU32(const unsigned char *p)
+{
+    return (unsigned int)p[0] | ((unsigned int)p[1] << 8) | ((unsigned int)p[2] << 16) | ((unsigned int)p[3] << 24);
+}
+
+
+static unsigned int readBE32(const unsigned char *p)
+{
+    return ((unsigned int)p[0] << 24) | ((unsigned int)p[1] << 16) | ((unsigned int)p[2] << 8) | (unsigned int)p[3];
+}
+
+
+static unsigned char clamp255(int v)
+{
+    return (unsigned char)(v < 0 ? 0 : (v > 255 ? 255 : v));
+}
+
+
+static int blockBytes(int format)
+{
+    switch (format)
+    {
+    case LOOM_IMAGE_FORMAT_ETC1:
+    case LOOM_IMAGE_FORMAT_ETC2_RGB:
+    case LOOM_IMAGE_FORMAT_DXT1:
+        return 8;
+
+    case LOOM_IMAGE_FORMAT_ETC2_RGBA:
+    case LOOM_IMAGE_FORMAT_DXT3:
+    case LOOM_IMAGE_FORMAT_DXT5:
+        return 16;
+    }
+
+    return 0;
+}
+
+
+size_t loom_image_compressedLevelSize(int format, int width, int height)
+{
+    size_t blocksWide, blocksHigh;
+
+    if ((width <= 0) || (height <= 0) || (width > LOOM_IMAGE_MAXDIMENSION) || (height > LOOM_IMAGE_MAXDIMENSION))
+    {
+        return 0;
+    }
+
+    blocksWide = ((size_t)width + 3) / 4;
+    blocksHigh = ((size_t)height + 3) / 4;
+
+    return blocksWide * blocksHigh * (size_t)blockBytes(format);
+}
+
+
+// Checks the container's dimensions before any size is derived from them.
+static int checkDimensions(const loom_compressed_image_t *image)
+{
+    if ((image->width <= 0) || (image->height <= 0) || (image->width > LOOM_IMAGE_MAXDIMENSION) || (image->height > LOOM_IMAGE_MAXDIMENSION))
+    {
+        lmLogError(gCompressedImageGroup, "Compressed image size %dx%d is out of range, the maximum is %d", image->width, image->height, LOOM_IMAGE_MAXDIMENSION);
+        return 0;
+    }
+
+    return 1;
+}
+
+
+int loom_image_isCompressedContainer(const void *buffer, size_t bufferLen)
+{
+    if ((bufferLen >= sizeof(ktxIdentifier)) && (memcmp(buffer, ktxIdentifier, sizeof(ktxIdentifier)) == 0))
+    {
+        return 1;
+    }
+
+    return (bufferLen >= 4) && (memcmp(buffer, "DDS ", 4) == 0);
+}
+
+
+// Fill in one level, checking it fits in the buffer. Levels point into the
+// container until they are copied out by loom_image_loadCompressed.
+static int setLevel(loom_compressed_image_t *image, const unsigned char *buffer, size_t bufferLen, size_t offset, size_t available)
+{
+    loom_image_level_t *level = &image->levels[image->levelCount];
+    int                shift  = image->levelCount;
+
+    level->width  = image->width >> shift;
+    level->height = image->height >> shift;
+    level->width  = level->width < 1 ? 1 : level->width;
+    level->height = level->height < 1 ? 1 : level->height;
+    level->size   = loom_image_compressedLevelSize(image->format, level->width, level->height);
+    level->data   = buffer + offset;
+
+    if ((level->size == 0) || (offset > bufferLen) || (level->size > available) || (level->size > bufferLen - offset))
+    {
+        return 0;
+    }
+
+    image->levelCount++;
+    return 1;
+}
+
+
+static int parseKTX(const unsigned char *p, size_t len, loom_compressed_image_t *image)
+{
+    unsigned int levels, keyValueBytes, i;
+    size_t       offset;
+
+    if (len < 64)
+    {
+        return 0;
+    }
+
+    if (readU32(p + 12) != 0x04030201)
+    {
+        lmLogError(gCompressedImageGroup, "Big endian KTX files are not supported");
+        return 0;
+    }
+
+    // glType and glFormat are zero for compressed data.
+    if ((readU32(p + 16) != 0) || (readU32(p + 24) != 0))
+    {
+        lmLogError(gCompressedImageGroup, "KTX file holds uncompressed data, use a PNG instead");
+        return 0;
+    }
+
+    // Only 2D textures, no arrays or cube maps.
+    if ((readU32(p + 44) > 1) || (readU32(p + 48) != 0) || (readU32(p + 52) != 1))
+    {
+        lmLogError(gCompressedImageGroup, "Only 2D KTX textures are supported");
+        return 0;
+    }
+
+    image->format = (int)readU32(p + 28);
+    image->width  = (int)readU32(p + 36);
+    image->height = (int)readU32(p + 40);
+
+    if (!checkDimensions(image))
+    {
+        return 0;
+    }
+
+    // RGB DXT1 decodes the same as the RGBA variant.
+    if (image->format == 0x83F0)
+    {
+        image->format = LOOM_IMAGE_FORMAT_DXT1;
+    }
+
+    levels        = readU32(p + 56);
+    keyValueBytes = readU32(p + 60);
+    levels        = levels ? levels : 1;
+
+    if (keyValueBytes > len - 64)
+    {
+        return 0;
+    }
+
+    offset = 64 + keyValueBytes;
+
+    for (i = 0; i < levels && i < LOOM_IMAGE_MAXLEVELS; i++)
+    {
+        unsigned int imageSize;
+
+        if (offset + 4 > len)
+        {
+            return 0;
+        }
+
+        imageSize = readU32(p + offset);
+        offset   += 4;
+
+        if (!setLevel(image, p, len, offset, imageSize))
+        {
+            return 0;
+        }
+
+        // Each level is padded to 4 bytes.
+        offset += ((size_t)imageSize + 3) & ~(size_t)3;
+    }
+
+    return 1;
+}
+
+
+static int parseDDS(const unsigned char *p, size_t len, loom_compressed_image_t *image)
+{
+    unsigned int levels, i;
+    size_t       offset;
+
+    if ((len < 128) || (readU32(p + 4) != 124))
+    {
+        return 0;
+    }
+
+    // Cube maps and volumes aren't supported.
+    if (readU32(p + 112) & (0x200 | 0x200000))
+    {
+        lmLogError(gCompressedImageGroup, "Only 2D DDS textures are supported");
+        return 0;
+    }
+
+    // DDPF_FOURCC
+    if (!(readU32(p + 80) & 0x4))
+    {
+        lmLogError(gCompressedImageGroup, "DDS file holds uncompressed data, use a PNG instead");
+        return 0;
+    }
+
+    if (memcmp(p + 84, "DXT1", 4) == 0)
+    {
+        image->format = LOOM_IMAGE_FORMAT_DXT1;
+    }
+    else if (memcmp(p + 84, "DXT3", 4) == 0)
+    {
+        image->format = LOOM_IMAGE_FORMAT_DXT3;
+    }
+    else if (memcmp(p + 84, "DXT5", 4) == 0)
+    {
+        image->format = LOOM_IMAGE_FORMAT_DXT5;
+    }
+    else
+    {
+        lmLogError(gCompressedImageGroup, "Unsupported DDS format '%.4s'", p + 84);
+        return 0;
+    }
+
+    image->height = (int)readU32(p + 12);
+    image->width  = (int)readU32(p + 16);
+
+    if (!checkDimensions(image))
+    {
+        return 0;
+    }
+
+    // DDSD_MIPMAPCOUNT
+    levels = (readU32(p + 8) & 0x20000) ? readU32(p + 28) : 1;
+    levels = levels ? levels : 1;
+
+    // The levels follow the header back to back.
+    offset = 128;
+    for (i = 0; i < levels && i < LOOM_IMAGE_MAXLEVELS; i++)
+    {
+        if (!setLevel(image, p, len, offset, len - offset))
+        {
+            return 0;
+        }
+
+        offset += image->levels[i].size;
+    }
+
+    return 1;
+}
+
+
+loom_compressed_image_t *loom_image_loadCompressed(const void *buffer, size_t bufferLen)
+{
+    const unsigned char     *p = (const unsigned char *)buffer;
+    loom_compressed_image_t parsed;
+    loom_compressed_image_t *image;
+    unsigned char           *levelData;
+    size_t                  total = 0;
+    int                     success, i;
+
+    memset(&parsed, 0, sizeof(parsed));
+
+    if ((bufferLen >= sizeof(ktxIdentifier)) && (memcmp(p, ktxIdentifier, sizeof(ktxIdentifier)) == 0))
+    {
+        success = parseKTX(p, bufferLen, &parsed);
+    }
+    else
+    {
+        success = (bufferLen >= 4) && (memcmp(p, "DDS ", 4) == 0) && parseDDS(p, bufferLen, &parsed);
+    }
+
+    if (!success || (blockBytes(parsed.format) == 0) || (parsed.width <= 0) || (parsed.height <= 0))
+    {
+        lmLogError(gCompressedImageGroup, "Unable to load compressed image, format 0x%x", parsed.format);
+        return NULL;
+    }
+
+    // Copy the levels out, they are the only part of the container we keep.
+    for (i = 0; i < parsed.levelCount; i++)
+    {
+        total += parsed.levels[i].size;
+    }
+
+    image     = (loom_compressed_image_t *)lmAlloc(NULL, sizeof(loom_compressed_image_t) + total);
+    *image    = parsed;
+    levelData = (unsigned char *)(image + 1);
+
+    for (i = 0; i < image->levelCount; i++)
+    {
+        memcpy(levelData, parsed.levels[i].data, parsed.levels[i].size);
+        image->levels[i].data = levelData;
+        levelData            += parsed.levels[i].size;
+    }
+
+    return image;
+}
+
+
+static void setPixel(unsigned char *block, int x, int y, int r, int g, int b)
+{
+    unsigned char *pixel = block + (y * 4 + x) * 4;
+
+    pixel[0] = clamp255(r);
+    pixel[1] = clamp255(g);
+    pixel[2] = clamp255(b);
+    pixel[3] = 255;
+}
+
+
+// ETC pixels are stored in columns, with the high bit of each 2 bit index in
+// the upper half of the low word.
+static int etcPixelIndex(unsigned int low, int x, int y)
+{
+    int i = x * 4 + y;
+
+    return (((low >> (16 + i)) & 1) << 1) | ((low >> i) & 1);
+}
+
+
+static int signed3(unsigned int v)
+{
+    return (v & 4) ? (int)v - 8 : (int)v;
+}
+
+
+static int extend4(int v)
+{
+    return (v << 4) | v;
+}
+
+
+static int extend5(int v)
+{
+    return (v << 3) | (v >> 2);
+}
+
+
+static int extend6(int v)
+{
+    return (v << 2) | (v >> 4);
+}
+
+
+static int extend7(int v)
+{
+    return (v << 1) | (v >> 6);
+}
+
+
+static void decodeETCPaint(unsigned int low, unsigned char *block, const int paint[4][3])
+{
+    int x, y;
+
+    for (y = 0; y < 4; y++)
+    {
+        for (x = 0; x < 4; x++)
+        {
+            const int *c = paint[etcPixelIndex(low, x, y)];
+            setPixel(block, x, y, c[0], c[1], c[2]);
+        }
+    }
+}
+
+
+static void decodeETCT(unsigned int high, unsigned int low, unsigned char *block)
+{
+    int r1 = extend4((((high >> 27) & 3) << 2) | ((high >> 24) & 3));
+    int g1 = extend4((high >> 20) & 0xF);
+    int b1 = extend4((high >> 16) & 0xF);
+    int r2 = extend4((high >> 12) & 0xF);
+    int g2 = extend4((high >> 8) & 0xF);
+    int b2 = extend4((high >> 4) & 0xF);
+    int d  = etc2Distances[(((high >> 2) & 3) << 1) | (high & 1)];
+
+    int paint[4][3] =
+    {
+        { r1,     g1,     b1     },
+        { r2 + d, g2 + d, b2 + d },
+        { r2,     g2,     b2     },
+        { r2 - d, g2 - d, b2 - d }
+    };
+
+    decodeETCPaint(low, block, paint);
+}
+
+
+static void decodeETCH(unsigned int high, unsigned int low, unsigned char *block)
+{
+    int r1 = (high >> 27) & 0xF;
+    int g1 = (((high >> 24) & 7) << 1) | ((high >> 20) & 1);
+    int b1 = (((high >> 19) & 1) << 3) | ((high >> 15) & 7);
+    int r2 = (high >> 11) & 0xF;
+    int g2 = (high >> 7) & 0xF;
+    int b2 = (high >> 3) & 0xF;
+
+    // The lowest bit of the distance index is the ordering of the colors.
+    int order = ((r1 << 8) | (g1 << 4) | b1) >= ((r2 << 8) | (g2 << 4) | b2);
+    int d     = etc2Distances[(((high >> 2) & 1) << 2) | ((high & 1) << 1) | order];
+
+    int paint[4][3];
+
+    r1 = extend4(r1); g1 = extend4(g1); b1 = extend4(b1);
+    r2 = extend4(r2); g2 = extend4(g2); b2 = extend4(b2);
+
+    paint[0][0] = r1 + d; paint[0][1] = g1 + d; paint[0][2] = b1 + d;
+    paint[1][0] = r1 - d; paint[1][1] = g1 - d; paint[1][2] = b1 - d;
+    paint[2][0] = r2 + d; paint[2][1] = g2 + d; paint[2][2] = b2 + d;
+    paint[3][0] = r2 - d; paint[3][1] = g2 - d; paint[3][2] = b2 - d;
+
+    decodeETCPaint(low, block, paint);
+}
+
+
+static void decodeETCPlanar(unsigned int high, unsigned int low, unsigned char *block)
+{
+    int ro = extend6((high >> 25) & 0x3F);
+    int go = extend7((((high >> 24) & 1) << 6) | ((high >> 17) & 0x3F));
+    int bo = extend6((((high >> 16) & 1) << 5) | (((high >> 11) & 3) << 3) | ((high >> 7) & 7));
+    int rh = extend6((((high >> 2) & 0x1F) << 1) | (high & 1));
+    int gh = extend7((low >> 25) & 0x7F);
+    int bh = extend6((low >> 19) & 0x3F);
+    int rv = extend6((low >> 13) & 0x3F);
+    int gv = extend7((low >> 6) & 0x7F);
+    int bv = extend6(low & 0x3F);
+    int x, y;
+
+    for (y = 0; y < 4; y++)
+    {
+        for (x = 0; x < 4; x++)
+        {
+            setPixel(block, x, y,
+                     (x * (rh - ro) + y * (rv - ro) + 4 * ro + 2) >> 2,
+                     (x * (gh - go) + y * (gv - go) + 4 * go + 2) >> 2,
+                     (x * (bh - bo) + y * (bv - bo) + 4 * bo + 2) >> 2);
+        }
+    }
+}
+
+
+static void decodeETCBlock(const unsigned char *src, unsigned char *block, int etc2)
+{
+    unsigned int high = readBE32(src);
+    unsigned int low  = readBE32(src + 4);
+    int          flip = high & 1;
+    int          base[2][3];
+    int          table[2];
+    int          x, y;
+
+    if ((high >> 1) & 1)
+    {
+        // Differential mode, ETC2 uses overflowing deltas to signal its
+        // additional modes.
+        int r  = (high >> 27) & 0x1F;
+        int g  = (high >> 19) & 0x1F;
+        int b  = (high >> 11) & 0x1F;
+        int dr = r + signed3((high >> 24) & 7);
+        int dg = g + signed3((high >> 16) & 7);
+        int db = b + signed3((high >> 8) & 7);
+
+        if (etc2 && ((dr < 0) || (dr > 31)))
+        {
+            decodeETCT(high, low, block);
+            return;
+        }
+
+        if (etc2 && ((dg < 0) || (dg > 31)))
+        {
+            decodeETCH(high, low, block);
+            return;
+        }
+
+        if (etc2 && ((db < 0) || (db > 31)))
+        {
+            decodeETCPlanar(high, low, block);
+            return;
+        }
+
+        base[0][0] = extend5(r);  base[0][1] = extend5(g);  base[0][2] = extend5(b);
+        base[1][0] = extend5(dr & 0x1F); base[1][1] = extend5(dg & 0x1F); base[1][2] = extend5(db & 0x1F);
+    }
+    else
+    {
+        base[0][0] = extend4((high >> 28) & 0xF);
+        base[1][0] = extend4((high >> 24) & 0xF);
+        base[0][1] = extend4((high >> 20) & 0xF);
+        base[1][1] = extend4((high >> 16) & 0xF);
+        base[0][2] = extend4((high >> 12) & 0xF);
+        base[1][2] = extend4((high >> 8) & 0xF);
+    }
+
+    table[0] = (high >> 5) & 7;
+    table[1] = (high >> 2) & 7;
+
+    for (y = 0; y < 4; y++)
+    {
+        for (x = 0; x < 4; x++)
+        {
+            // The flip bit selects between 2x4 and 4x2 subblocks.
+            int sub      = flip ? (y >= 2) : (x >= 2);
+            int index    = etcPixelIndex(low, x, y);
+            int modifier = etc1Modifiers[table[sub]][index & 1];
+
+            if (index & 2)
+            {
+                modifier = -modifier;
+            }
+
+            setPixel(block, x, y, base[sub][0] + modifier, base[sub][1] + modifier, base[sub][2] + modifier);
+        }
+    }
+}
+
+
+static void decodeEACAlpha(const unsigned char *src, unsigned char *block)
+{
+    int                base       = src[0];
+    int                multiplier = src[1] >> 4;
+    const int          *modifiers = eacModifiers[src[1] & 0xF];
+    unsigned long long indices    = 0;
+    int                i;
+
+    for (i = 2; i < 8; i++)
+    {
+        indices = (indices << 8) | src[i];
+    }
+
+    // 3 bit indices, most significant first, in columns.
+    for (i = 0; i < 16; i++)
+    {
+        int index = (int)((indices >> (45 - 3 * i)) & 7);
+        int x     = i / 4;
+        int y     = i % 4;
+
+        block[(y * 4 + x) * 4 + 3] = clamp255(base + modifiers[index] * multiplier);
+    }
+}
+
+
+static void decode565(unsigned int c, int *rgb)
+{
+    rgb[0] = extend5((c >> 11) & 0x1F);
+    rgb[1] = extend6((c >> 5) & 0x3F);
+    rgb[2] = extend5(c & 0x1F);
+}
+
+
+static void decodeDXTColorBlock(const unsigned char *src, unsigned char *block, int punchThrough)
+{
+    unsigned int c0      = src[0] | (src[1] << 8);
+    unsigned int c1      = src[2] | (src[3] << 8);
+    unsigned int indices = readU32(src + 4);
+    int          colors[4][4];
+    int          i, j;
+
+    decode565(c0, colors[0]);
+    decode565(c1, colors[1]);
+    colors[0][3] = colors[1][3] = colors[2][3] = colors[3][3] = 255;
+
+    // Only DXT1 uses the three color mode with transparent black.
+    if ((c0 > c1) || !punchThrough)
+    {
+        for (j = 0; j < 3; j++)
+        {
+            colors[2][j] = (2 * colors[0][j] + colors[1][j]) / 3;
+            colors[3][j] = (colors[0][j] + 2 * colors[1][j]) / 3;
+        }
+    }
+    else
+    {
+        for (j = 0; j < 3; j++)
+        {
+            colors[2][j] = (colors[0][j] + colors[1][j]) / 2;
+            colors[3][j] = 0;
+        }
+        colors[3][3] = 0;
+    }
+
+    // 2 bit indices, least significant first, in rows.
+    for (i = 0; i < 16; i++)
+    {
+        const int     *c    = colors[(indices >> (2 * i)) & 3];
+        unsigned char *dest = block + i * 4;
+
+        dest[0] = (unsigned char)c[0];
+        dest[1] = (unsigned char)c[1];
+        dest[2] = (unsigned char)c[2];
+        dest[3] = (unsigned char)c[3];
+    }
+}
+
+
+static void decodeDXT3Alpha(const unsigned char *src, unsigned char *block)
+{
+    int i;
+
+    for (i = 0; i < 16; i++)
+    {
+        int alpha = (src[i / 2] >> (4 * (i & 1))) & 0xF;
+        block[i * 4 + 3] = (unsigned char)(alpha * 17);
+    }
+}
+
+
+static void decodeDXT5Alpha(const unsigned char *src, unsigned char *block)
+{
+    int                alphas[8];
+    unsigned long long indices = 0;
+    int                i;
+
+    alphas[0] = src[0];
+    alphas[1] = src[1];
+
+    if (alphas[0] > alphas[1])
+    {
+        for (i = 1; i < 7; i++)
+        {
+            alphas[i + 1] = ((7 - i) * alphas[0] + i * alphas[1]) / 7;
+        }
+    }
+    else
+    {
+        for (i = 1; i < 5; i++)
+        {
+            alphas[i + 1] = ((5 - i) * alphas[0] + i * alphas[1]) / 5;
+        }
+        alphas[6] = 0;
+        alphas[7] = 255;
+    }
+
+    for (i = 7; i >= 2; i--)
+    {
+        indices = (indices << 8) | src[i];
+    }
+
+    // 3 bit indices, least significant first, in rows.
+    for (i = 0; i < 16; i++)
+    {
+        block[i * 4 + 3] = (unsigned char)alphas[(indices >> (3 * i)) & 7];
+    }
+}
+
+
+int loom_image_decodeCompressed(int format, const void *data, int width, int height, void *rgba)
+{
+    const unsigned char *src  = (const unsigned char *)data;
+    unsigned char       *dest = (unsigned char *)rgba;
+    int                 bytes = blockBytes(format);
+    unsigned char       block[4 * 4 * 4];
+    int                 bx, by, y;
+
+    if (bytes == 0)
+    {
+        return 0;
+    }
+
+    for (by = 0; by < height; by += 4)
+    {
+        for (bx = 0; bx < width; bx += 4)
+        {
+            switch (format)
+            {
+            case LOOM_IMAGE_FORMAT_ETC1:
+                decodeETCBlock(src, block, 0);
+                break;
+
+            case LOOM_IMAGE_FORMAT_ETC2_RGB:
+                decodeETCBlock(src, block, 1);
+                break;
+
+            case LOOM_IMAGE_FORMAT_ETC2_RGBA:
+                decodeETCBlock(src + 8, block, 1);
+                decodeEACAlpha(src, block);
+                break;
+
+            case LOOM_IMAGE_FORMAT_DXT1:
+                decodeDXTColorBlock(src, block, 1);
+                break;
+
+            case LOOM_IMAGE_FORMAT_DXT3:
+                decodeDXTColorBlock(src + 8, block, 0);
+                decodeDXT3Alpha(src, block);
+                break;
+
+            case LOOM_IMAGE_FORMAT_DXT5:
+                decodeDXTColorBlock(src + 8, block, 0);
+                decodeDXT5Alpha(src, block);
+                break;
+            }
+
+            // Copy the block out, clipped to the image.
+            for (y = 0; y < 4 && by + y < height; y++)
+            {
+                int columns = width - bx < 4 ? width - bx : 4;
+                memcpy(dest + ((size_t)(by + y) * width + bx) * 4, block + y * 16, columns * 4);
+            }
+
+            src += bytes;
+        }
+    }
+
+    return 1;
+}
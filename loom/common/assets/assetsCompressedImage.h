@@ -0,0 +1,81 @@
+/*
+ * ===========================================================================
+ * Loom SDK
+ * Copyright 2011, 2012, 2013
+ * The Game Engine Company, LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ * ===========================================================================
+ */
+
+#ifndef _ASSETS_ASSETSCOMPRESSEDIMAGE_H_
+#define _ASSETS_ASSETSCOMPRESSEDIMAGE_H_
+
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Block compressed pixel formats, the values match the GL internal formats
+// so they can be handed straight to glCompressedTexImage2D.
+#define LOOM_IMAGE_FORMAT_ETC1          0x8D64 // GL_ETC1_RGB8_OES
+#define LOOM_IMAGE_FORMAT_ETC2_RGB      0x9274 // GL_COMPRESSED_RGB8_ETC2
+#define LOOM_IMAGE_FORMAT_ETC2_RGBA     0x9278 // GL_COMPRESSED_RGBA8_ETC2_EAC
+#define LOOM_IMAGE_FORMAT_DXT1          0x83F1 // GL_COMPRESSED_RGBA_S3TC_DXT1_EXT
+#define LOOM_IMAGE_FORMAT_DXT3          0x83F2 // GL_COMPRESSED_RGBA_S3TC_DXT3_EXT
+#define LOOM_IMAGE_FORMAT_DXT5          0x83F3 // GL_COMPRESSED_RGBA_S3TC_DXT5_EXT
+
+#define LOOM_IMAGE_MAXLEVELS            16
+
+// Containers with a larger width or height are refused, which also keeps
+// level and decoded RGBA sizes well inside a size_t.
+#define LOOM_IMAGE_MAXDIMENSION         16384
+
+typedef struct loom_image_level
+{
+    int        width, height;
+    size_t     size;
+    const void *data;
+} loom_image_level_t;
+
+// A block compressed image with its mip chain, as stored in a KTX or DDS
+// container. The level data lives in the same allocation as the struct.
+typedef struct loom_compressed_image
+{
+    int                format;
+    int                width, height;
+    int                levelCount;
+    loom_image_level_t levels[LOOM_IMAGE_MAXLEVELS];
+} loom_compressed_image_t;
+
+// Returns 1 if buffer starts with a KTX or DDS header.
+int loom_image_isCompressedContainer(const void *buffer, size_t bufferLen);
+
+// Parse a KTX or DDS container and copy its levels out of buffer. Returns
+// NULL if the container is malformed or holds an unsupported format. Free
+// the result with lmFree.
+loom_compressed_image_t *loom_image_loadCompressed(const void *buffer, size_t bufferLen);
+
+// Size in bytes of one level of the given format and dimensions, or 0 if
+// the format isn't supported or the dimensions are out of range.
+size_t loom_image_compressedLevelSize(int format, int width, int height);
+
+// Software decode one level into width * height RGBA8 pixels, for when the
+// GPU can't sample the format directly. Returns 0 for unsupported formats.
+int loom_image_decodeCompressed(int format, const void *data, int width, int height, void *rgba);
+
+#ifdef __cplusplus
+};
+#endif
+#endif
@@ -0,0 +1,316 @@
+/*
+ * ===========================================================================
+ * Loom SDK
+ * Copyright 2011, 2012, 2013
+ * The Game Engine Company, LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ * ===========================================================================
+ */
+
+#include <string.h>
+#include "seatest.h"
+#include "loom/common/core/allocator.h"
+#include "loom/common/assets/assetsCompressedImage.h"
+
+SEATEST_FIXTURE(assetsCompressedImage)
+{
+    SEATEST_FIXTURE_ENTRY(compressedImage_etc1);
+    SEATEST_FIXTURE_ENTRY(compressedImage_etc2);
+    SEATEST_FIXTURE_ENTRY(compressedImage_dxt);
+    SEATEST_FIXTURE_ENTRY(compressedImage_ktx);
+    SEATEST_FIXTURE_ENTRY(compressedImage_dds);
+    SEATEST_FIXTURE_ENTRY(compressedImage_badDimensions);
+}
+
+static void writeU32(unsigned char *p, unsigned int v)
+{
+    p[0] = v & 0xFF;
+    p[1] = (v >> 8) & 0xFF;
+    p[2] = (v >> 16) & 0xFF;
+    p[3] = (v >> 24) & 0xFF;
+}
+
+
+static int pixelEquals(const unsigned char *rgba, int width, int x, int y, int r, int g, int b, int a)
+{
+    const unsigned char *p = rgba + (y * width + x) * 4;
+
+    return p[0] == r && p[1] == g && p[2] == b && p[3] == a;
+}
+
+
+SEATEST_TEST(compressedImage_etc1)
+{
+    unsigned char rgba[4 * 4 * 4];
+
+    // Individual mode, red and black subblocks side by side, pixel (1, 2)
+    // uses the -8 modifier and the rest +2.
+    unsigned char individual[8] = { 0xF0, 0x00, 0x00, 0x00, 0x00, 0x40, 0x00, 0x40 };
+
+    assert_true(loom_image_decodeCompressed(LOOM_IMAGE_FORMAT_ETC1, individual, 4, 4, rgba));
+    assert_true(pixelEquals(rgba, 4, 0, 0, 255, 2, 2, 255));
+    assert_true(pixelEquals(rgba, 4, 1, 2, 247, 0, 0, 255));
+    assert_true(pixelEquals(rgba, 4, 2, 0, 2, 2, 2, 255));
+    assert_true(pixelEquals(rgba, 4, 3, 3, 2, 2, 2, 255));
+
+    // Differential mode, flipped so the subblocks are stacked.
+    unsigned char differential[8] = { 0x81, 0x00, 0x00, 0x03, 0x00, 0x00, 0x00, 0x00 };
+
+    assert_true(loom_image_decodeCompressed(LOOM_IMAGE_FORMAT_ETC1, differential, 4, 4, rgba));
+    assert_true(pixelEquals(rgba, 4, 3, 1, 134, 2, 2, 255));
+    assert_true(pixelEquals(rgba, 4, 0, 3, 142, 2, 2, 255));
+
+    // Partial blocks are clipped to the image.
+    unsigned char small[2 * 2 * 4 + 4];
+    memset(small, 0xAB, sizeof(small));
+    assert_true(loom_image_decodeCompressed(LOOM_IMAGE_FORMAT_ETC1, individual, 2, 2, small));
+    assert_true(pixelEquals(small, 2, 1, 1, 255, 2, 2, 255));
+    assert_int_equal(0xAB, small[16]);
+
+    assert_false(loom_image_decodeCompressed(0x1234, individual, 4, 4, rgba));
+}
+
+
+SEATEST_TEST(compressedImage_etc2)
+{
+    unsigned char rgba[4 * 4 * 4];
+
+    // Planar mode, signalled by an overflowing blue delta. Red is constant
+    // and green ramps up horizontally.
+    unsigned char planar[8] = { 0x7E, 0x00, 0x04, 0x7F, 0xFE, 0x07, 0xE0, 0x00 };
+
+    assert_true(loom_image_decodeCompressed(LOOM_IMAGE_FORMAT_ETC2_RGB, planar, 4, 4, rgba));
+    assert_true(pixelEquals(rgba, 4, 0, 0, 255, 0, 0, 255));
+    assert_true(pixelEquals(rgba, 4, 1, 0, 255, 64, 0, 255));
+    assert_true(pixelEquals(rgba, 4, 3, 2, 255, 191, 0, 255));
+
+    // ETC1 blocks are valid ETC2.
+    unsigned char differential[8] = { 0x81, 0x00, 0x00, 0x03, 0x00, 0x00, 0x00, 0x00 };
+
+    assert_true(loom_image_decodeCompressed(LOOM_IMAGE_FORMAT_ETC2_RGB, differential, 4, 4, rgba));
+    assert_true(pixelEquals(rgba, 4, 0, 3, 142, 2, 2, 255));
+
+    // EAC alpha ahead of the color, base 128 with the first two pixels of
+    // the first column using +14 and +2, the rest -3.
+    unsigned char withAlpha[16] =
+    {
+        0x80, 0x10, 0xF0, 0x00, 0x00, 0x00, 0x00, 0x00,
+        0x81, 0x00, 0x00, 0x03, 0x00, 0x00, 0x00, 0x00
+    };
+
+    assert_true(loom_image_decodeCompressed(LOOM_IMAGE_FORMAT_ETC2_RGBA, withAlpha, 4, 4, rgba));
+    assert_true(pixelEquals(rgba, 4, 0, 0, 134, 2, 2, 142));
+    assert_true(pixelEquals(rgba, 4, 0, 1, 134, 2, 2, 130));
+    assert_true(pixelEquals(rgba, 4, 1, 0, 134, 2, 2, 125));
+    assert_true(pixelEquals(rgba, 4, 3, 3, 142, 2, 2, 125));
+}
+
+
+SEATEST_TEST(compressedImage_dxt)
+{
+    unsigned char rgba[4 * 4 * 4];
+
+    // Red to blue, four color mode.
+    unsigned char fourColor[8] = { 0x00, 0xF8, 0x1F, 0x00, 0xE4, 0x00, 0x00, 0x00 };
+
+    assert_true(loom_image_decodeCompressed(LOOM_IMAGE_FORMAT_DXT1, fourColor, 4, 4, rgba));
+    assert_true(pixelEquals(rgba, 4, 0, 0, 255, 0, 0, 255));
+    assert_true(pixelEquals(rgba, 4, 1, 0, 0, 0, 255, 255));
+    assert_true(pixelEquals(rgba, 4, 2, 0, 170, 0, 85, 255));
+    assert_true(pixelEquals(rgba, 4, 3, 0, 85, 0, 170, 255));
+    assert_true(pixelEquals(rgba, 4, 0, 1, 255, 0, 0, 255));
+
+    // Swapped endpoints select three colors plus transparent black.
+    unsigned char threeColor[8] = { 0x1F, 0x00, 0x00, 0xF8, 0xE4, 0x00, 0x00, 0x00 };
+
+    assert_true(loom_image_decodeCompressed(LOOM_IMAGE_FORMAT_DXT1, threeColor, 4, 4, rgba));
+    assert_true(pixelEquals(rgba, 4, 0, 0, 0, 0, 255, 255));
+    assert_true(pixelEquals(rgba, 4, 2, 0, 127, 0, 127, 255));
+    assert_true(pixelEquals(rgba, 4, 3, 0, 0, 0, 0, 0));
+
+    // DXT5 interpolated alpha, always four color.
+    unsigned char dxt5[16] =
+    {
+        0xFF, 0x00, 0x88, 0x0E, 0x00, 0x00, 0x00, 0x00,
+        0x1F, 0x00, 0x00, 0xF8, 0xE4, 0x00, 0x00, 0x00
+    };
+
+    assert_true(loom_image_decodeCompressed(LOOM_IMAGE_FORMAT_DXT5, dxt5, 4, 4, rgba));
+    assert_true(pixelEquals(rgba, 4, 0, 0, 0, 0, 255, 255));
+    assert_true(pixelEquals(rgba, 4, 1, 0, 255, 0, 0, 0));
+    assert_true(pixelEquals(rgba, 4, 2, 0, 85, 0, 170, 218));
+    assert_true(pixelEquals(rgba, 4, 3, 0, 170, 0, 85, 36));
+
+    // DXT3 explicit alpha.
+    unsigned char dxt3[16] =
+    {
+        0x0F, 0xA0, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+        0x00, 0xF8, 0x1F, 0x00, 0x00, 0x00, 0x00, 0x00
+    };
+
+    assert_true(loom_image_decodeCompressed(LOOM_IMAGE_FORMAT_DXT3, dxt3, 4, 4, rgba));
+    assert_true(pixelEquals(rgba, 4, 0, 0, 255, 0, 0, 255));
+    assert_true(pixelEquals(rgba, 4, 1, 0, 255, 0, 0, 0));
+    assert_true(pixelEquals(rgba, 4, 3, 0, 255, 0, 0, 170));
+    assert_true(pixelEquals(rgba, 4, 0, 1, 255, 0, 0, 0));
+
+    assert_int_equal(8, loom_image_compressedLevelSize(LOOM_IMAGE_FORMAT_DXT1, 1, 1));
+    assert_int_equal(64, loom_image_compressedLevelSize(LOOM_IMAGE_FORMAT_DXT5, 5, 5));
+    assert_int_equal(0, loom_image_compressedLevelSize(0x1234, 4, 4));
+
+    // Out of range dimensions have no size rather than a wrapped one.
+    assert_int_equal(0, loom_image_compressedLevelSize(LOOM_IMAGE_FORMAT_DXT5, 65536, 65536));
+    assert_int_equal(0, loom_image_compressedLevelSize(LOOM_IMAGE_FORMAT_DXT5, 0, 4));
+    assert_int_equal(0, loom_image_compressedLevelSize(LOOM_IMAGE_FORMAT_DXT5, 4, -4));
+    assert_true(loom_image_compressedLevelSize(LOOM_IMAGE_FORMAT_DXT5, LOOM_IMAGE_MAXDIMENSION, LOOM_IMAGE_MAXDIMENSION) == (size_t)LOOM_IMAGE_MAXDIMENSION * LOOM_IMAGE_MAXDIMENSION);
+}
+
+
+SEATEST_TEST(compressedImage_ktx)
+{
+    static const unsigned char identifier[12] = { 0xAB, 'K', 'T', 'X', ' ', '1', '1', 0xBB, '\r', '\n', 0x1A, '\n' };
+
+    // 4x4 ETC1 with a full mip chain and some key/value data.
+    unsigned char ktx[64 + 8 + 3 * (4 + 8)];
+    memset(ktx, 0, sizeof(ktx));
+    memcpy(ktx, identifier, sizeof(identifier));
+    writeU32(ktx + 12, 0x04030201);
+    writeU32(ktx + 28, LOOM_IMAGE_FORMAT_ETC1);
+    writeU32(ktx + 36, 4);
+    writeU32(ktx + 40, 4);
+    writeU32(ktx + 52, 1);
+    writeU32(ktx + 56, 3);
+    writeU32(ktx + 60, 8);
+
+    for (int i = 0; i < 3; i++)
+    {
+        unsigned char *level = ktx + 72 + i * 12;
+        writeU32(level, 8);
+        memset(level + 4, i + 1, 8);
+    }
+
+    assert_true(loom_image_isCompressedContainer(ktx, sizeof(ktx)));
+
+    loom_compressed_image_t *image = loom_image_loadCompressed(ktx, sizeof(ktx));
+    assert_true(image != NULL);
+    assert_int_equal(LOOM_IMAGE_FORMAT_ETC1, image->format);
+    assert_int_equal(4, image->width);
+    assert_int_equal(4, image->height);
+    assert_int_equal(3, image->levelCount);
+    assert_int_equal(2, image->levels[1].width);
+    assert_int_equal(1, image->levels[2].height);
+    assert_int_equal(8, image->levels[2].size);
+    assert_int_equal(3, ((const unsigned char *)image->levels[2].data)[7]);
+    lmFree(NULL, image);
+
+    // Truncated files and uncompressed data are refused.
+    assert_true(loom_image_loadCompressed(ktx, sizeof(ktx) - 1) == NULL);
+    writeU32(ktx + 16, 0x1401);
+    assert_true(loom_image_loadCompressed(ktx, sizeof(ktx)) == NULL);
+}
+
+
+SEATEST_TEST(compressedImage_badDimensions)
+{
+    static const unsigned char identifier[12] = { 0xAB, 'K', 'T', 'X', ' ', '1', '1', 0xBB, '\r', '\n', 0x1A, '\n' };
+
+    // A 65536x65536 DXT5 KTX whose level size claims to be 0, the block
+    // count times 16 wraps to 0 in 32 bits.
+    unsigned char ktx[64 + 4 + 16];
+    memset(ktx, 0, sizeof(ktx));
+    memcpy(ktx, identifier, sizeof(identifier));
+    writeU32(ktx + 12, 0x04030201);
+    writeU32(ktx + 28, LOOM_IMAGE_FORMAT_DXT5);
+    writeU32(ktx + 36, 65536);
+    writeU32(ktx + 40, 65536);
+    writeU32(ktx + 52, 1);
+    writeU32(ktx + 56, 1);
+    writeU32(ktx + 64, 0);
+
+    assert_true(loom_image_loadCompressed(ktx, sizeof(ktx)) == NULL);
+
+    // Just over the limit, zero and negative sizes.
+    writeU32(ktx + 36, LOOM_IMAGE_MAXDIMENSION + 1);
+    writeU32(ktx + 40, 4);
+    writeU32(ktx + 64, 16);
+    assert_true(loom_image_loadCompressed(ktx, sizeof(ktx)) == NULL);
+
+    writeU32(ktx + 36, 0);
+    assert_true(loom_image_loadCompressed(ktx, sizeof(ktx)) == NULL);
+
+    writeU32(ktx + 36, 0x80000000);
+    assert_true(loom_image_loadCompressed(ktx, sizeof(ktx)) == NULL);
+
+    // The same header at 4x4 loads.
+    writeU32(ktx + 36, 4);
+    loom_compressed_image_t *image = loom_image_loadCompressed(ktx, sizeof(ktx));
+    assert_true(image != NULL);
+    lmFree(NULL, image);
+
+    unsigned char dds[128 + 16];
+    memset(dds, 0, sizeof(dds));
+    memcpy(dds, "DDS ", 4);
+    writeU32(dds + 4, 124);
+    writeU32(dds + 8, 0x1007);
+    writeU32(dds + 12, 65536);
+    writeU32(dds + 16, 65536);
+    writeU32(dds + 80, 0x4);
+    memcpy(dds + 84, "DXT5", 4);
+
+    assert_true(loom_image_loadCompressed(dds, sizeof(dds)) == NULL);
+
+    writeU32(dds + 12, 0xFFFFFFFF);
+    writeU32(dds + 16, 4);
+    assert_true(loom_image_loadCompressed(dds, sizeof(dds)) == NULL);
+
+    writeU32(dds + 12, 4);
+    image = loom_image_loadCompressed(dds, sizeof(dds));
+    assert_true(image != NULL);
+    lmFree(NULL, image);
+}
+
+
+SEATEST_TEST(compressedImage_dds)
+{
+    // 8x8 DXT5 with two levels.
+    unsigned char dds[128 + 64 + 16];
+    memset(dds, 0, sizeof(dds));
+    memcpy(dds, "DDS ", 4);
+    writeU32(dds + 4, 124);
+    writeU32(dds + 8, 0x1007 | 0x20000);
+    writeU32(dds + 12, 8);
+    writeU32(dds + 16, 8);
+    writeU32(dds + 28, 2);
+    writeU32(dds + 80, 0x4);
+    memcpy(dds + 84, "DXT5", 4);
+    dds[128 + 64] = 0x55;
+
+    assert_true(loom_image_isCompressedContainer(dds, sizeof(dds)));
+
+    loom_compressed_image_t *image = loom_image_loadCompressed(dds, sizeof(dds));
+    assert_true(image != NULL);
+    assert_int_equal(LOOM_IMAGE_FORMAT_DXT5, image->format);
+    assert_int_equal(2, image->levelCount);
+    assert_int_equal(64, image->levels[0].size);
+    assert_int_equal(4, image->levels[1].width);
+    assert_int_equal(0x55, ((const unsigned char *)image->levels[1].data)[0]);
+    lmFree(NULL, image);
+
+    // Unsupported formats and other images are refused.
+    memcpy(dds + 84, "DX10", 4);
+    assert_true(loom_image_loadCompressed(dds, sizeof(dds)) == NULL);
+
+    unsigned char png[8] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+    assert_false(loom_image_isCompressedContainer(png, sizeof(png)));
+}
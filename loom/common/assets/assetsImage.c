@@ -79,16 +79,55 @@ int loom_asset_identifyImage(const char *extension)
     {
         return LATImage;
     }
+    if (!stricmp(extension, "ktx"))
+    {
+        return LATImage;
+    }
+    if (!stricmp(extension, "dds"))
+    {
+        return LATImage;
+    }
     return 0;
 }
 
 void loom_asset_imageDtor(void *bits)
 {
     loom_asset_image_t *img = (loom_asset_image_t*)bits;
-    stbi_image_free(img->bits);
+    if (img->bits)
+    {
+        stbi_image_free(img->bits);
+    }
+    if (img->compressed)
+    {
+        lmFree(NULL, img->compressed);
+    }
     lmFree(gAssetAllocator, bits);
 }
 
+void *loom_asset_imageDecode(loom_asset_image_t *img)
+{
+    loom_compressed_image_t *compressed = img->compressed;
+
+    if (img->bits || !compressed)
+    {
+        return img->bits;
+    }
+
+    if ((img->width <= 0) || (img->height <= 0) || ((size_t)img->width > ((size_t)-1 / 4) / (size_t)img->height))
+    {
+        lmLogError(gImageAssetGroup, "Compressed image size %dx%d is too big to decode", img->width, img->height);
+        return NULL;
+    }
+
+    // Allocated like stb's pixels so the dtor can free either.
+    img->bits = lmAlloc(NULL, (size_t)img->width * (size_t)img->height * 4);
+    loom_image_decodeCompressed(compressed->format, compressed->levels[0].data, img->width, img->height, img->bits);
+
+    lmLogDebug(gImageAssetGroup, "Decoded compressed image format 0x%x, %dx%d", compressed->format, img->width, img->height);
+
+    return img->bits;
+}
+
 void *loom_asset_imageDeserializer( void *buffer, size_t bufferLen, LoomAssetCleanupCallback *dtor )
 {
    loom_asset_image_t *img;
@@ -96,6 +135,31 @@ void *loom_asset_imageDeserializer( void *buffer, size_t bufferLen, LoomAssetCle
    lmAssert(buffer != NULL, "buffer should not be null");
 
    img = (loom_asset_image_t*)lmAlloc(gAssetAllocator, sizeof(loom_asset_image_t));
+   img->compressed = NULL;
+
+   // Block compressed containers skip stb entirely, the levels go straight
+   // to the GPU.
+   if (loom_image_isCompressedContainer(buffer, bufferLen))
+   {
+      img->compressed = loom_image_loadCompressed(buffer, bufferLen);
+      if (!img->compressed)
+      {
+         lmFree(gAssetAllocator, img);
+         return 0;
+      }
+
+      img->width       = img->compressed->width;
+      img->height      = img->compressed->height;
+      img->bpp         = 4;
+      img->orientation = IMAGE_ORIENTATION_UNSPECIFIED;
+      img->bits        = NULL;
+
+      *dtor = loom_asset_imageDtor;
+
+      lmLogDebug(gImageAssetGroup, "Compressed image allocation: %d levels, format 0x%x", img->compressed->levelCount, img->compressed->format);
+
+      return img;
+   }
 
     // parse any orientation info from exif format
    img->orientation = exifinfo_parse_orientation(buffer, (unsigned int)bufferLen);
@@ -22,6 +22,8 @@
 #ifndef _ASSETS_ASSETSIMAGE_H_
 #define _ASSETS_ASSETSIMAGE_H_
 
+#include "loom/common/assets/assetsCompressedImage.h"
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -42,14 +44,23 @@ typedef struct loom_asset_image
     // see IMAGE_ORIENTATION values above
     int orientation;
 
+    // RGBA8 pixels, NULL for block compressed images until they are
+    // decoded with loom_asset_imageDecode.
     void *bits;
 
+    // Set for KTX and DDS images, which keep their GPU ready mip chain.
+    loom_compressed_image_t *compressed;
+
 } loom_asset_image_t;
 
 void loom_asset_registerImageAsset();
 int loom_asset_identifyImage(const char *path);
 void *loom_asset_imageDeserializer(void *buffer, size_t bufferLen, LoomAssetCleanupCallback *dtor);
 
+// Returns the RGBA8 pixels of the image, software decoding the top level of
+// compressed images on first use. Returns NULL if it's too big to decode.
+void *loom_asset_imageDecode(loom_asset_image_t *img);
+
 #ifdef __cplusplus
 };
 #endif
@@ -37,6 +37,9 @@ int      LoomApplicationConfig::_waitForAssetAgent = false;
 utString LoomApplicationConfig::assetHost;
 int      LoomApplicationConfig::assetPort;
 bool     LoomApplicationConfig::_wants51Audio   = false;
+bool     LoomApplicationConfig::_jitEnabled     = true;
+utArray<utString> LoomApplicationConfig::_jitDisabledAssemblies;
+utArray<utString> LoomApplicationConfig::_assetArchives;
 utString LoomApplicationConfig::_version       = "0.0.0";
 utString LoomApplicationConfig::_applicationId = "unknown_app_id";
 
@@ -279,6 +282,31 @@ void LoomApplicationConfig::parseApplicationConfig(const utString& jsonString)
     _jsonReadStr(json, "debuggerHost", _debuggerHost);
     _jsonReadInt(json, "debuggerPort", _debuggerPort);
 
+    if (json_t *jitBlock = json_object_get(json, "jit"))
+    {
+        _jsonReadBool(jitBlock, "enabled", _jitEnabled);
+
+        json_t *disabled = json_object_get(jitBlock, "disabledAssemblies");
+        for (size_t i = 0; disabled && i < json_array_size(disabled); i++)
+        {
+            const char *assemblyName = json_string_value(json_array_get(disabled, i));
+            if (assemblyName)
+            {
+                _jitDisabledAssemblies.push_back(assemblyName);
+            }
+        }
+    }
+
+    json_t *archives = json_object_get(json, "assetArchives");
+    for (size_t i = 0; archives && i < json_array_size(archives); i++)
+    {
+        const char *archivePath = json_string_value(json_array_get(archives, i));
+        if (archivePath)
+        {
+            _assetArchives.push_back(archivePath);
+        }
+    }
+
     if (json_t *displayBlock = json_object_get(json, "display"))
     {
         _jsonReadStr(displayBlock, "title", _displayTitle);
@@ -22,6 +22,7 @@
 #define _lmapplicationconfig_h
 
 #include "loom/common/utils/utString.h"
+#include "loom/common/utils/utTypes.h"
 
 /**
  * C++ access to assorted configuration parameters from the application assembly.
@@ -46,6 +47,11 @@ class LoomApplicationConfig
 
     static bool     _wants51Audio;
 
+    static bool              _jitEnabled;
+    static utArray<utString> _jitDisabledAssemblies;
+
+    static utArray<utString> _assetArchives;
+
     static utString _displayTitle;
     static int      _displayX;
     static int      _displayY;
@@ -126,6 +132,24 @@ public:
         return _wants51Audio;
     }
 
+    /// True if the LuaJIT trace compiler should be enabled.
+    static bool jitEnabled()
+    {
+        return _jitEnabled;
+    }
+
+    /// Assemblies whose methods are always interpreted.
+    static const utArray<utString>& jitDisabledAssemblies()
+    {
+        return _jitDisabledAssemblies;
+    }
+
+    /// Packed asset archives to mount at startup, in mount order.
+    static const utArray<utString>& assetArchives()
+    {
+        return _assetArchives;
+    }
+
     static const utString& displayTitle()
     {
         return _displayTitle;
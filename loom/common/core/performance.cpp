@@ -120,10 +120,28 @@ void finishProfilerBlock(profilerBlock_t *block)
 #include <string.h>
 #include "loom/common/core/assert.h"
 #include "loom/common/core/stringTable.h"
+#include "loom/common/platform/platformThread.h"
 #include "loom/common/utils/utTypes.h"
 
 typedef utHashTable<utHashedString, LoomProfilerRoot*> LookupType;
 
+// Roots are created lazily by static locals on any thread, guard the shared
+// root list and lookup. Registration is rare so a spin lock is enough.
+static volatile atomic_int_t sRootLock = 0;
+
+static void lockRoots()
+{
+    while (atomic_compareAndExchange(&sRootLock, 0, 1) != 0)
+    {
+        loom_thread_yield();
+    }
+}
+
+static void unlockRoots()
+{
+    atomic_store32(&sRootLock, 0);
+}
+
 LoomProfilerRoot    *LoomProfilerRoot::sRootList = NULL;
 void*                LoomProfilerRoot::sRootLookup = (void*) (lmNew(NULL) LookupType());
 LoomProfiler        *gLoomProfiler = NULL;
@@ -176,6 +194,7 @@ LoomProfiler::LoomProfiler()
    mStackDepth = 0;
    gLoomProfiler = this;
    mDumpToConsole   = false;
+   mThreadId        = platform_getCurrentThreadId();
 
    mTimer = loom_startTimer();
 }
@@ -239,6 +258,8 @@ void LoomProfiler::reset()
 
 LoomProfilerRoot::LoomProfilerRoot(const char *name)
 {
+    lockRoots();
+
     LookupType* lookup = static_cast<LookupType*>(sRootLookup);
     utHashedString key(name);
     bool inserted = lookup->insert(key, this);
@@ -248,6 +269,9 @@ LoomProfilerRoot::LoomProfilerRoot(const char *name)
     mNameHash               = (int)(long long)stringtable_insert(name); // Poor man's hash
     mNextRoot               = sRootList;
     sRootList               = this;
+
+    unlockRoots();
+
     mTotalTime              = 0;
     mSubTime                = 0;
     mMaxTime                = 0;
@@ -263,7 +287,9 @@ LoomProfilerRoot* LoomProfilerRoot::fromName(const char *name)
     LookupType* lookup = static_cast<LookupType*>(sRootLookup);
     utHashedString key(name);
     LoomProfilerRoot* root;
+    lockRoots();
     LoomProfilerRoot** rootp = lookup->get(key);
+    unlockRoots();
     if (rootp == NULL)
     {
         root = lmNew(NULL) LoomProfilerRoot(name);
@@ -314,6 +340,9 @@ void LoomProfiler::hashPush(LoomProfilerRoot *root)
 {
    Telemetry::beginTickTimer(root);
 
+   if (platform_getCurrentThreadId() != mThreadId)
+      return;
+
    mStackDepth++;
    lmAssert(mStackDepth <= (S32) mMaxStackDepth,
                   "Stack overflow in profiler.  You may have mismatched PROFILE_START and PROFILE_ENDs");
@@ -391,10 +420,22 @@ void LoomProfiler::enable(bool enabled)
 }
 
 
+void LoomProfiler::setThread(int threadId)
+{
+    if (mStackDepth == 0)
+    {
+        mThreadId = threadId;
+    }
+}
+
+
 void LoomProfiler::hashPop(LoomProfilerRoot *expected)
 {
     Telemetry::endTickTimer(expected);
 
+    if (platform_getCurrentThreadId() != mThreadId)
+        return;
+
     mStackDepth--;
 
     lmAssert(mStackDepth >= 0, "Stack underflow in profiler.  You may have mismatched PROFILE_START and PROFILE_ENDs");
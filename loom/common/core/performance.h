@@ -147,6 +147,11 @@ class LoomProfiler
     bool mNextEnable;
     U32  mMaxStackDepth;
     bool mDumpToConsole;
+
+    // Thread keeping the call tree, the one the profiler is constructed on
+    // until the tick thread takes it over. Ranges on other threads are only
+    // recorded by Telemetry.
+    volatile int mThreadId;
     void dump();
     void validate();
 
@@ -165,6 +170,9 @@ public:
 
     inline bool isEnabled() { return mEnabled; }
 
+    /// Keep the call tree on threadId, ignored while ranges are open
+    void setThread(int threadId);
+
     /// Helper function for macro definition PROFILE_START
     void hashPush(LoomProfilerRoot *data);
 
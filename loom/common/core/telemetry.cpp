@@ -1,3 +1,6 @@
+#include <stdio.h>
+#include <string.h>
+
 #include "loom/common/core/telemetry.h"
 
 #include "loom/common/assets/assets.h"
@@ -23,6 +26,7 @@ int Telemetry::tickProfilerRootsVisited;
 size_t Telemetry::eventsStartPos;
 bool Telemetry::tickProfilerActive = false;
 int Telemetry::tickThreadId = -1;
+volatile bool Telemetry::tracing = false;
 
 // Initialize specialized constants for every type used
 // TickMetricValue
@@ -32,6 +36,51 @@ template<> const int TableValues<TickMetricValue>::packedItemSize = 4 + 8;
 static const int EVENT_BYTE_SIZE = 16;
 static const size_t EVENTS_MIN_SIZE = EVENT_BYTE_SIZE*128;
 
+// Trace events are buffered per thread so that recording never takes a lock.
+// The owning thread is the only writer of `head` and the tick thread, which
+// drains [tail, head) into the trace file, is the only writer of `tail`.
+static const int TRACE_MAX_THREADS = 32;
+static const int TRACE_BUFFER_EVENTS = 16384; // Must be a power of two
+static const int TRACE_BUFFER_MASK = TRACE_BUFFER_EVENTS - 1;
+static const int TRACE_NAME_SIZE = 32;
+
+enum TraceThreadState
+{
+    TRACE_THREAD_FREE,
+    TRACE_THREAD_CLAIMING,
+    TRACE_THREAD_ACTIVE,
+    TRACE_THREAD_RETIRED
+};
+
+struct TraceThreadBuffer
+{
+    volatile atomic_int_t state;
+    int threadId;
+
+    // Thread id written to the trace, unique even if the slot gets reused
+    int traceId;
+
+    // `true` once the thread name metadata was written, only used while draining
+    bool named;
+    char name[TRACE_NAME_SIZE];
+
+    volatile atomic_int_t head;
+    volatile atomic_int_t tail;
+    volatile atomic_int_t dropped;
+
+    // Pairs of root address with event type and nano time, as in the tick stream
+    UTuint64 *events;
+};
+
+static TraceThreadBuffer traceThreads[TRACE_MAX_THREADS];
+static volatile atomic_int_t traceThreadSerial = 0;
+static volatile atomic_int_t traceLostEvents = 0;
+
+static loom_precision_timer_t traceTimer = NULL;
+static FILE *traceFile = NULL;
+static bool traceFirstEvent = true;
+static int traceMainThreadId = -1;
+
 void Telemetry::enable()
 {
     pendingEnabled = true;
@@ -42,8 +91,258 @@ void Telemetry::disable()
     pendingEnabled = false;
 }
 
+static TraceThreadBuffer* findTraceThread(int threadId)
+{
+    for (int i = 0; i < TRACE_MAX_THREADS; i++)
+    {
+        TraceThreadBuffer *thread = &traceThreads[i];
+        if (thread->threadId == threadId && thread->state == TRACE_THREAD_ACTIVE) return thread;
+    }
+    return NULL;
+}
+
+static TraceThreadBuffer* claimTraceThread(int threadId, const char *name)
+{
+    for (int i = 0; i < TRACE_MAX_THREADS; i++)
+    {
+        TraceThreadBuffer *thread = &traceThreads[i];
+        if (atomic_compareAndExchange(&thread->state, TRACE_THREAD_FREE, TRACE_THREAD_CLAIMING) != TRACE_THREAD_FREE) continue;
+
+        thread->threadId = threadId;
+        thread->traceId = atomic_increment(&traceThreadSerial) + 1;
+        thread->named = false;
+        thread->head = 0;
+        thread->tail = 0;
+        thread->dropped = 0;
+
+        if (name)
+        {
+            strncpy(thread->name, name, TRACE_NAME_SIZE - 1);
+            thread->name[TRACE_NAME_SIZE - 1] = 0;
+        }
+        else if (threadId == traceMainThreadId)
+        {
+            strcpy(thread->name, "main");
+        }
+        else
+        {
+            snprintf(thread->name, TRACE_NAME_SIZE, "thread %d", thread->traceId);
+        }
+
+        atomic_store32(&thread->state, TRACE_THREAD_ACTIVE);
+        return thread;
+    }
+    return NULL;
+}
+
+// Write str as a JSON string, profiler root names are mostly identifiers
+// but script method names are not guaranteed to be.
+static void writeTraceString(FILE *file, const char *str)
+{
+    fputc('"', file);
+    for (const char *c = str; *c; c++)
+    {
+        if (*c == '"' || *c == '\\')
+        {
+            fputc('\\', file);
+            fputc(*c, file);
+        }
+        else if ((unsigned char)*c < 0x20)
+        {
+            fprintf(file, "\\u%04x", *c);
+        }
+        else
+        {
+            fputc(*c, file);
+        }
+    }
+    fputc('"', file);
+}
+
+static void beginTraceRecord()
+{
+    fputs(traceFirstEvent ? "\n" : ",\n", traceFile);
+    traceFirstEvent = false;
+}
+
+void Telemetry::beginThread(const char *name)
+{
+    int threadId = platform_getCurrentThreadId();
+    TraceThreadBuffer *thread = findTraceThread(threadId);
+    if (thread)
+    {
+        // Renaming is only picked up by traces started later
+        strncpy(thread->name, name, TRACE_NAME_SIZE - 1);
+        thread->name[TRACE_NAME_SIZE - 1] = 0;
+        return;
+    }
+
+    if (!claimTraceThread(threadId, name))
+    {
+        lmLogWarn(gTelemetryLogGroup, "Unable to trace thread %s, all %d thread buffers are in use", name, TRACE_MAX_THREADS);
+    }
+}
+
+void Telemetry::endThread()
+{
+    TraceThreadBuffer *thread = findTraceThread(platform_getCurrentThreadId());
+    if (!thread) return;
+
+    // While tracing the slot is freed by the drain once the events are written out
+    atomic_store32(&thread->state, tracing ? TRACE_THREAD_RETIRED : TRACE_THREAD_FREE);
+}
+
+void Telemetry::traceEvent(LoomProfilerRoot* root, int type)
+{
+    int threadId = platform_getCurrentThreadId();
+    TraceThreadBuffer *thread = findTraceThread(threadId);
+    if (!thread) thread = claimTraceThread(threadId, NULL);
+    if (!thread)
+    {
+        atomic_increment(&traceLostEvents);
+        return;
+    }
+
+    if (!thread->events)
+    {
+        thread->events = static_cast<UTuint64*>(lmAlloc(NULL, TRACE_BUFFER_EVENTS*EVENT_BYTE_SIZE));
+    }
+
+    unsigned int head = thread->head;
+    if (head - (unsigned int)atomic_load32(&thread->tail) >= (unsigned int)TRACE_BUFFER_EVENTS)
+    {
+        // The thread writing the file can make room right away, others have
+        // to wait for the end of the tick
+        if (threadId != traceMainThreadId)
+        {
+            atomic_increment(&thread->dropped);
+            return;
+        }
+        drainTrace();
+    }
+
+    UTuint64 *event = thread->events + (head & TRACE_BUFFER_MASK)*2;
+    event[0] = reinterpret_cast<UTuint64>(root) | type;
+    event[1] = loom_readTimerNano(traceTimer);
+    atomic_store32(&thread->head, (int)(head + 1));
+}
+
+void Telemetry::drainTrace()
+{
+    for (int i = 0; i < TRACE_MAX_THREADS; i++)
+    {
+        TraceThreadBuffer *thread = &traceThreads[i];
+
+        // Read the state before head so a retired thread has no events left after this
+        int state = atomic_load32(&thread->state);
+        if (state != TRACE_THREAD_ACTIVE && state != TRACE_THREAD_RETIRED) continue;
+
+        unsigned int head = atomic_load32(&thread->head);
+        unsigned int tail = thread->tail;
+
+        if (!thread->named)
+        {
+            beginTraceRecord();
+            fprintf(traceFile, "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"args\":{\"name\":", thread->traceId);
+            writeTraceString(traceFile, thread->name);
+            fputs("}}", traceFile);
+            thread->named = true;
+        }
+
+        for (; tail != head; tail++)
+        {
+            UTuint64 *event = thread->events + (tail & TRACE_BUFFER_MASK)*2;
+            LoomProfilerRoot *root = reinterpret_cast<LoomProfilerRoot*>(event[0] & ~(UTuint64)TICK_EVENT_ALIGN_MASK);
+            char phase = (event[0] & TICK_EVENT_ALIGN_MASK) == TICK_EVENT_BEGIN ? 'B' : 'E';
+
+            beginTraceRecord();
+            fputs("{\"name\":", traceFile);
+            writeTraceString(traceFile, root->mName);
+            fprintf(traceFile, ",\"cat\":\"loom\",\"ph\":\"%c\",\"ts\":%.3f,\"pid\":1,\"tid\":%d}", phase, event[1]*1e-3, thread->traceId);
+        }
+
+        atomic_store32(&thread->tail, (int)head);
+
+        int dropped = atomic_load32(&thread->dropped);
+        if (dropped)
+        {
+            atomic_compareAndExchange(&thread->dropped, dropped, 0);
+            lmLogWarn(gTelemetryLogGroup, "Trace dropped %d events on thread %s, buffer full", dropped, thread->name);
+        }
+
+        if (state == TRACE_THREAD_RETIRED) atomic_store32(&thread->state, TRACE_THREAD_FREE);
+    }
+
+    int lost = atomic_load32(&traceLostEvents);
+    if (lost)
+    {
+        atomic_compareAndExchange(&traceLostEvents, lost, 0);
+        lmLogWarn(gTelemetryLogGroup, "Trace dropped %d events, all %d thread buffers are in use", lost, TRACE_MAX_THREADS);
+    }
+}
+
+bool Telemetry::startTrace(const char *path)
+{
+    if (tracing) stopTrace();
+
+    traceFile = fopen(path, "wb");
+    if (!traceFile)
+    {
+        lmLogError(gTelemetryLogGroup, "Unable to open trace file %s", path);
+        return false;
+    }
+
+    if (!traceTimer)
+    {
+        traceTimer = loom_startTimer();
+    }
+    else
+    {
+        loom_resetTimer(traceTimer);
+    }
+
+    traceMainThreadId = platform_getCurrentThreadId();
+    traceFirstEvent = true;
+    fputs("[", traceFile);
+
+    // Skip whatever was recorded after the previous trace stopped
+    for (int i = 0; i < TRACE_MAX_THREADS; i++)
+    {
+        TraceThreadBuffer *thread = &traceThreads[i];
+        int state = atomic_load32(&thread->state);
+        if (state != TRACE_THREAD_ACTIVE && state != TRACE_THREAD_RETIRED) continue;
+
+        atomic_store32(&thread->tail, atomic_load32(&thread->head));
+        thread->named = false;
+        if (state == TRACE_THREAD_RETIRED) atomic_store32(&thread->state, TRACE_THREAD_FREE);
+    }
+
+    tracing = true;
+
+    lmLog(gTelemetryLogGroup, "Tracing to %s", path);
+    return true;
+}
+
+void Telemetry::stopTrace()
+{
+    if (!tracing) return;
+
+    tracing = false;
+    drainTrace();
+
+    fputs("\n]\n", traceFile);
+    fclose(traceFile);
+    traceFile = NULL;
+
+    lmLog(gTelemetryLogGroup, "Tracing stopped");
+}
+
 void Telemetry::beginTick()
 {
+    // The tick thread keeps the profiler call tree, whichever thread the
+    // profiler was constructed on
+    if (gLoomProfiler) gLoomProfiler->setThread(platform_getCurrentThreadId());
+
     if (enabled != pendingEnabled) {
         if (pendingEnabled) tickThreadId = platform_getCurrentThreadId();
         enabled = pendingEnabled;
@@ -222,6 +521,8 @@ bool Telemetry::readTickProfiler(utByteArray& buffer, JSON& ranges, JSON& meta)
 
 void Telemetry::endTick()
 {
+    if (tracing) drainTrace();
+
     if (!enabled) return;
 
     tickProfilerActive = false;
@@ -298,6 +599,8 @@ static void ensureEventBuffer(utByteArray &buffer, size_t startPos)
 // Begins the profiling range of the provided root.
 void Telemetry::beginTickTimer(LoomProfilerRoot* root)
 {
+    if (tracing) traceEvent(root, TICK_EVENT_BEGIN);
+
     if (!enabled) return;
     
     // Ignore all events that are not on the main thread for now
@@ -324,6 +627,8 @@ void Telemetry::beginTickTimer(LoomProfilerRoot* root)
 // Ends the timing range of the provided root. See `beginTickTimer`.
 void Telemetry::endTickTimer(LoomProfilerRoot* root)
 {
+    if (tracing) traceEvent(root, TICK_EVENT_END);
+
     if (!enabled) return;
     if (platform_getCurrentThreadId() != tickThreadId) return;
     if (!tickProfilerActive) return;
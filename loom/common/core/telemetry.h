@@ -245,6 +245,15 @@ protected:
     // Current tick ID
     static int tickId;
 
+    // `true` while a trace file is being written, read by every thread
+    static volatile bool tracing;
+
+    // Record a trace event for root into the calling thread's buffer
+    static void traceEvent(LoomProfilerRoot* root, int type);
+
+    // Write out all the events buffered by the threads since the last drain
+    static void drainTrace();
+
 public:
 
     // Enable telemetry functionality
@@ -284,6 +293,44 @@ public:
     // ranges and additional metadata into the provided objects.
     static bool readTickProfiler(utByteArray& buffer, JSON& tickRange, JSON& meta);
 
+    // Start writing profiler ranges of all threads to a Chrome Trace Event
+    // JSON file at path (viewable in chrome://tracing or Perfetto). This
+    // works without an asset agent connected. Returns false if the file
+    // can't be opened.
+    static bool startTrace(const char *path);
+
+    // Flush the remaining events and close the trace file
+    static void stopTrace();
+
+    inline static bool isTracing()
+    {
+        return tracing;
+    }
+
+    // Name the calling thread in traces and give it an event buffer. Threads
+    // that never call this still get a buffer on their first event.
+    static void beginThread(const char *name);
+
+    // Release the calling thread's event buffer once it has been written out,
+    // call before a thread that called `beginThread` exits.
+    static void endThread();
+
+};
+
+// Names a worker thread in traces for the lifetime of the scope, declare it
+// before any profiler scopes in the thread body.
+class TelemetryThreadScope
+{
+public:
+    TelemetryThreadScope(const char *name)
+    {
+        Telemetry::beginThread(name);
+    }
+
+    ~TelemetryThreadScope()
+    {
+        Telemetry::endThread();
+    }
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,160 @@
+/*
+ * ===========================================================================
+ * Loom SDK
+ * Copyright 2011, 2012, 2013
+ * The Game Engine Company, LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ * ===========================================================================
+ */
+
+#include <string.h>
+#include "seatest.h"
+#include "loom/common/core/allocator.h"
+#include "loom/common/core/performance.h"
+#include "loom/common/core/telemetry.h"
+#include "loom/common/platform/platformFile.h"
+#include "loom/common/platform/platformIO.h"
+#include "loom/common/platform/platformThread.h"
+#include "loom/common/utils/json.h"
+
+SEATEST_FIXTURE(telemetry)
+{
+    SEATEST_FIXTURE_ENTRY(telemetry_profilerThread);
+    SEATEST_FIXTURE_ENTRY(telemetry_trace);
+}
+
+static const int WORKER_RANGES = 100;
+
+static int __stdcall traceWorkerFunc(void *param)
+{
+    TelemetryThreadScope traceThread("trace worker");
+
+    for (int i = 0; i < WORKER_RANGES; i++)
+    {
+        LOOM_PROFILE_SCOPE(traceWorkerRange);
+    }
+
+    return 0;
+}
+
+
+static int __stdcall profilerWorkerFunc(void *param)
+{
+    for (int i = 0; i < WORKER_RANGES; i++)
+    {
+        LOOM_PROFILE_SCOPE(profilerWorkerRange);
+    }
+
+    return 0;
+}
+
+
+SEATEST_TEST(telemetry_profilerThread)
+{
+    // A worker pushing ranges before the main thread does must not take the
+    // call tree over
+    ThreadHandle worker = loom_thread_start(profilerWorkerFunc, NULL);
+    loom_thread_join(worker);
+
+    bool wasEnabled = gLoomProfiler->isEnabled();
+    gLoomProfiler->enable(true);
+    {
+        LOOM_PROFILE_SCOPE(profilerEnable);
+    }
+
+    for (int i = 0; i < 10; i++)
+    {
+        LOOM_PROFILE_SCOPE(profilerMainRange);
+    }
+
+    gLoomProfiler->enable(wasEnabled);
+
+    assert_int_equal(0, LoomProfilerRoot::fromName("profilerWorkerRange")->mTotalInvokeCount);
+    assert_int_equal(10, LoomProfilerRoot::fromName("profilerMainRange")->mTotalInvokeCount);
+}
+
+
+// Counts the events of a parsed trace by phase, and checks that the thread
+// names were written.
+static void countTraceEvents(JSON& trace, const char *name, int& begins, int& ends, bool& named)
+{
+    begins = ends = 0;
+    named  = false;
+
+    for (int i = 0; i < trace.getArrayCount(); i++)
+    {
+        JSON event = trace.getArrayObject(i);
+        const char *phase = event.getString("ph");
+
+        if (!strcmp(phase, "M"))
+        {
+            JSON args = event.getObject("args");
+            named |= !strcmp(args.getString("name"), "trace worker");
+            continue;
+        }
+
+        if (strcmp(event.getString("name"), name)) continue;
+
+        if (!strcmp(phase, "B")) begins++;
+        if (!strcmp(phase, "E")) ends++;
+    }
+}
+
+
+SEATEST_TEST(telemetry_trace)
+{
+    assert_true(Telemetry::startTrace("traceTest.json"));
+    assert_true(Telemetry::isTracing());
+
+    for (int i = 0; i < 10; i++)
+    {
+        LOOM_PROFILE_SCOPE(traceMainRange);
+    }
+
+    // The worker records into its own buffer while the main thread keeps
+    // the profiler call tree
+    ThreadHandle worker = loom_thread_start(traceWorkerFunc, NULL);
+    loom_thread_join(worker);
+
+    Telemetry::stopTrace();
+    assert_false(Telemetry::isTracing());
+
+    void *data;
+    long size;
+    assert_true(platform_mapFile("traceTest.json", &data, &size));
+
+    char *text = (char *)lmAlloc(NULL, size + 1);
+    memcpy(text, data, size);
+    text[size] = 0;
+    platform_unmapFile(data);
+
+    JSON trace;
+    assert_true(trace.loadString(text));
+    assert_true(trace.isArray());
+    lmFree(NULL, text);
+
+    int begins, ends;
+    bool named;
+
+    countTraceEvents(trace, "traceMainRange", begins, ends, named);
+    assert_int_equal(10, begins);
+    assert_int_equal(10, ends);
+
+    countTraceEvents(trace, "traceWorkerRange", begins, ends, named);
+    assert_int_equal(WORKER_RANGES, begins);
+    assert_int_equal(WORKER_RANGES, ends);
+    assert_true(named);
+
+    platform_removeFile("traceTest.json");
+}
@@ -32,6 +32,7 @@
 #include "loom/common/core/allocator.h"
 #include "loom/common/core/assert.h"
 #include "loom/common/core/log.h"
+#include "loom/common/core/performance.h"
 #include "loom/common/platform/platformFile.h"
 #include "loom/common/utils/utBase64.h"
 
@@ -182,7 +183,11 @@ void platform_HTTPUpdate()
 {
     assert(gHTTPInitialized);
 
+    // curl runs its transfers from here on the main thread, time them so
+    // network stalls show up in traces
+    LOOM_PROFILE_START(httpPerform);
     CURLMcode ret = curl_multi_perform(gMultiHandle, &gHandleCount);
+    LOOM_PROFILE_END(httpPerform);
 
 
     // loop over all of our infos and cleanup handles that are done
@@ -19,6 +19,8 @@
  */
 
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 #include "loom/common/core/assert.h"
 #include "loom/common/core/allocator.h"
 #include "loom/common/core/log.h"
@@ -55,6 +57,10 @@ AAssetManager *gAssetManager = NULL;
 #define STRSAFE_NO_DEPRECATE    // We still want to use strcpy and others.
 #include <strsafe.h>
 #include <sys/stat.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
 #endif
 
 // A low but arbitrary number of concurrent file mappings is allowed.
@@ -155,10 +161,170 @@ static void androidCleaner_free(loom_filemapping_t *mapping)
 }
 #endif
 
-int platform_mapFileExists(const char *path)
+#if LOOM_PLATFORM != LOOM_PLATFORM_WIN32
+static void mappingCleaner_munmap(loom_filemapping_t *mapping)
+{
+    // The payload holds the length of the mapping.
+    munmap(mapping->mapping, (size_t)mapping->payload);
+}
+
+
+static int readFully(int fd, void *buffer, long size)
+{
+    unsigned char *cursor = (unsigned char *)buffer;
+
+    while (size > 0)
+    {
+        ssize_t bytesRead = read(fd, cursor, (size_t)size);
+        if (bytesRead <= 0)
+        {
+            return 0;
+        }
+
+        cursor += bytesRead;
+        size   -= (long)bytesRead;
+    }
+
+    return 1;
+}
+#endif
+
+// Packed archives bundle many small files into one blob, which is mapped
+// once when mounted. The layout is a header, an index of entries sorted by
+// the hash of their path, the null terminated paths, and finally the file
+// data, each file aligned to LOOM_ARCHIVE_ALIGN bytes. All offsets are from
+// the start of the archive and all fields are little endian.
+#define LOOM_ARCHIVE_MAGIC      0x4B41504C // "LPAK"
+#define LOOM_ARCHIVE_VERSION    1
+#define LOOM_ARCHIVE_ALIGN      16
+#define LOOM_MAX_ARCHIVES       8
+
+typedef struct loom_archive_header
+{
+    unsigned int magic;
+    unsigned int version;
+    unsigned int entryCount;
+    unsigned int reserved;
+} loom_archive_header_t;
+
+typedef struct loom_archive_entry
+{
+    unsigned int hash;
+    unsigned int pathOffset;
+    unsigned int dataOffset;
+    unsigned int size;
+} loom_archive_entry_t;
+
+struct loom_archive
 {
-    FILE *f;
+    StringTableEntry           path;
+    const unsigned char        *base;
+    const loom_archive_entry_t *entries;
+    unsigned int               entryCount;
+}
+gArchives[LOOM_MAX_ARCHIVES];
+
+static int gArchiveCount = 0;
+
+// Paths are compared with both slash directions treated alike, so lookups
+// behave the same whichever way the caller built the path.
+static unsigned int archive_hashPath(const char *path)
+{
+    // FNV-1a
+    unsigned int hash = 2166136261u;
+
+    for ( ; *path; path++)
+    {
+        hash ^= (unsigned char)(*path == '\\' ? '/' : *path);
+        hash *= 16777619u;
+    }
+
+    return hash;
+}
+
+
+static int archive_pathEquals(const char *a, const char *b)
+{
+    for ( ; *a && *b; a++, b++)
+    {
+        char ca = *a == '\\' ? '/' : *a;
+        char cb = *b == '\\' ? '/' : *b;
+        if (ca != cb)
+        {
+            return 0;
+        }
+    }
+
+    return *a == *b;
+}
+
+
+static const loom_archive_entry_t *archive_findEntry(struct loom_archive *archive, const char *path, unsigned int hash)
+{
+    unsigned int low  = 0;
+    unsigned int high = archive->entryCount;
+
+    // Binary search for the first entry with a matching hash, then check
+    // the paths of all the entries that share it.
+    while (low < high)
+    {
+        unsigned int mid = low + (high - low) / 2;
+        if (archive->entries[mid].hash < hash)
+        {
+            low = mid + 1;
+        }
+        else
+        {
+            high = mid;
+        }
+    }
+
+    for ( ; low < archive->entryCount && archive->entries[low].hash == hash; low++)
+    {
+        const loom_archive_entry_t *entry = &archive->entries[low];
+        if (archive_pathEquals((const char *)archive->base + entry->pathOffset, path))
+        {
+            return entry;
+        }
+    }
+
+    return NULL;
+}
 
+
+// Look a path up in the mounted archives, the most recently mounted first
+// so later archives can patch earlier ones.
+static int archive_lookup(const char *path, void **outPointer, long *outSize)
+{
+    unsigned int hash;
+    int          i;
+
+    if (gArchiveCount == 0)
+    {
+        return 0;
+    }
+
+    hash = archive_hashPath(path);
+
+    for (i = gArchiveCount - 1; i >= 0; i--)
+    {
+        const loom_archive_entry_t *entry = archive_findEntry(&gArchives[i], path, hash);
+        if (entry)
+        {
+            if (outPointer)
+            {
+                *outPointer = (void *)(gArchives[i].base + entry->dataOffset);
+                *outSize    = (long)entry->size;
+            }
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+int platform_mapFileExists(const char *path)
+{
 #if LOOM_PLATFORM == LOOM_PLATFORM_ANDROID
     // Variables for the android path.
     AAsset     *asset    = NULL;
@@ -179,19 +345,22 @@ int platform_mapFileExists(const char *path)
     // Verify our dependents are good.
     ensureStartedUp();
 
+    // Mounted archives take precedence over loose files.
+    if (archive_lookup(path, NULL, NULL))
+    {
+        return 1;
+    }
+
 #if LOOM_PLATFORM == LOOM_PLATFORM_WIN32
     return GetFileAttributes(path) != 0xFFFFFFFF;
-#endif
-
-    // Try opening it with fopen.
-    f = fopen(path, "rb");
-    if (f)
+#else
+    // Checking access is cheaper than opening and closing the file.
+    if (access(path, R_OK) == 0)
     {
-        fclose(f);
-
         // Great, all done!
         return 1;
     }
+#endif
 
 #if LOOM_PLATFORM_IS_APPLE == 1
     // If we're not looking in the app bundle already, try looking in there.
@@ -225,7 +394,9 @@ int platform_mapFile(const char *path, void **outPointer, long *outSize)
 #if LOOM_PLATFORM == LOOM_PLATFORM_WIN32
     HANDLE f;
 #else
-    FILE *f;
+    int         f;
+    int         success;
+    struct stat fileStat;
 #endif
     long size;
 
@@ -253,6 +424,15 @@ int platform_mapFile(const char *path, void **outPointer, long *outSize)
     *outPointer = NULL;
     *outSize    = 0;
 
+    // Files in mounted archives are served straight out of the archive's
+    // mapping, there is nothing to release when they are unmapped.
+    if (archive_lookup(path, outPointer, outSize))
+    {
+        lmLogDebug(ioLogGroup, "Mapped via archive (%x, len=%d): '%s'", *outPointer, *outSize, path);
+        registerMapping(path, *outPointer, NULL, NULL);
+        return 1;
+    }
+
     // Open file
 #if LOOM_PLATFORM == LOOM_PLATFORM_WIN32
     lmLogDebug(ioLogGroup, "Using CreateFile to open file: '%s'", path);
@@ -335,13 +515,31 @@ int platform_mapFile(const char *path, void **outPointer, long *outSize)
         if (normPath != normPathStack) lmFree(NULL, normPath);
 
 #else
-    lmLogDebug(ioLogGroup, "Using fopen to open file: %path", path);
-    f = fopen(path, "rb");
-    if (f)
+    lmLogDebug(ioLogGroup, "Using open to map file: '%s'", path);
+    f = open(path, O_RDONLY);
+    if (f >= 0)
     {
+        void *mapped;
+
         // Get length.
-        fseek(f, 0, SEEK_END);
-        size = ftell(f);
+        size = fstat(f, &fileStat) == 0 ? (long)fileStat.st_size : 0;
+
+        // Map it read only, so the pages come straight from the page cache
+        // rather than being copied to the heap. Empty files can't be mapped
+        // and not every file system supports it, so fall back to reading.
+        mapped = size > 0 ? mmap(NULL, (size_t)size, PROT_READ, MAP_PRIVATE, f, 0) : MAP_FAILED;
+        if (mapped != MAP_FAILED)
+        {
+            close(f);
+
+            *outPointer = mapped;
+            *outSize    = size;
+
+            lmLogDebug(ioLogGroup, "Mapped via mmap (%x, len=%d): '%s'", *outPointer, *outSize, path);
+
+            registerMapping(path, mapped, mappingCleaner_munmap, (void *)(size_t)size);
+            return 1;
+        }
 #endif
 
         // Get some memory and set return values!
@@ -362,11 +560,11 @@ int platform_mapFile(const char *path, void **outPointer, long *outSize)
         lmAssert(success, "Unable to read file: '%s'", path);
         CloseHandle(f);
 #else
-        lmLogDebug(ioLogGroup, "Mapped via fopen (%x, len=%d): '%s'", *outPointer, *outSize, path);
+        lmLogDebug(ioLogGroup, "Mapped via read (%x, len=%d): '%s'", *outPointer, *outSize, path);
 
-        fseek(f, 0, SEEK_SET);
-        lmAssert(fread(*outPointer, 1, size, f), "Unable to read file: '%s'", path);
-        fclose(f);
+        success = readFully(f, *outPointer, size);
+        lmAssert(success, "Unable to read file: '%s'", path);
+        close(f);
 #endif
 
         // Register the mapping.
@@ -457,6 +655,288 @@ void platform_unmapFile(void *ptr)
 }
 
 
+int platform_mountArchive(const char *archivePath)
+{
+    void                        *ptr;
+    long                        size;
+    const loom_archive_header_t *header;
+    const loom_archive_entry_t  *entries;
+    unsigned int                i;
+
+    ensureStartedUp();
+
+    if (gArchiveCount == LOOM_MAX_ARCHIVES)
+    {
+        lmLogError(ioLogGroup, "Unable to mount '%s', too many archives mounted", archivePath);
+        return 0;
+    }
+
+    // The archive stays mapped for as long as it is mounted.
+    if (!platform_mapFile(archivePath, &ptr, &size))
+    {
+        lmLogError(ioLogGroup, "Unable to open archive '%s'", archivePath);
+        return 0;
+    }
+
+    header  = (const loom_archive_header_t *)ptr;
+    entries = (const loom_archive_entry_t *)(header + 1);
+
+    if ((size < (long)sizeof(loom_archive_header_t)) ||
+        (header->magic != LOOM_ARCHIVE_MAGIC) || (header->version != LOOM_ARCHIVE_VERSION) ||
+        (header->entryCount > (size - sizeof(loom_archive_header_t)) / sizeof(loom_archive_entry_t)))
+    {
+        lmLogError(ioLogGroup, "Unable to mount '%s', not a valid archive", archivePath);
+        platform_unmapFile(ptr);
+        return 0;
+    }
+
+    // Validate the index up front so lookups never have to.
+    for (i = 0; i < header->entryCount; i++)
+    {
+        if ((entries[i].pathOffset >= (unsigned long)size) ||
+            (entries[i].dataOffset > (unsigned long)size) ||
+            (entries[i].size > (unsigned long)size - entries[i].dataOffset) ||
+            (memchr((const char *)ptr + entries[i].pathOffset, 0, size - entries[i].pathOffset) == NULL) ||
+            ((i > 0) && (entries[i].hash < entries[i - 1].hash)))
+        {
+            lmLogError(ioLogGroup, "Unable to mount '%s', archive index is corrupt", archivePath);
+            platform_unmapFile(ptr);
+            return 0;
+        }
+    }
+
+    gArchives[gArchiveCount].path       = stringtable_insert(archivePath);
+    gArchives[gArchiveCount].base       = (const unsigned char *)ptr;
+    gArchives[gArchiveCount].entries    = entries;
+    gArchives[gArchiveCount].entryCount = header->entryCount;
+    gArchiveCount++;
+
+    lmLogDebug(ioLogGroup, "Mounted archive '%s' with %d files", archivePath, header->entryCount);
+
+    return 1;
+}
+
+
+void platform_unmountArchive(const char *archivePath)
+{
+    StringTableEntry path = stringtable_insert(archivePath);
+    int              i;
+
+    for (i = 0; i < gArchiveCount; i++)
+    {
+        if (gArchives[i].path != path)
+        {
+            continue;
+        }
+
+        platform_unmapFile((void *)gArchives[i].base);
+
+        // Keep the remaining archives in mount order.
+        memmove(&gArchives[i], &gArchives[i + 1], (gArchiveCount - i - 1) * sizeof(gArchives[0]));
+        gArchiveCount--;
+        return;
+    }
+
+    lmLogWarn(ioLogGroup, "Archive '%s' is not mounted", archivePath);
+}
+
+
+typedef struct loom_archive_source
+{
+    char         *path;
+    unsigned int hash;
+} loom_archive_source_t;
+
+typedef struct loom_archive_sources
+{
+    loom_archive_source_t *items;
+    int                   count;
+    int                   capacity;
+    const char            *skipPath;
+} loom_archive_sources_t;
+
+static void archive_collectFile(const char *filePath, void *payload)
+{
+    loom_archive_sources_t *sources = (loom_archive_sources_t *)payload;
+    loom_archive_source_t  *source;
+    char                   *c;
+
+    // remove any local path qualifier "./"
+    if ((filePath[0] == '.') && (filePath[1] == '/'))
+    {
+        filePath += 2;
+    }
+
+    // Don't pack the archive into itself.
+    if (archive_pathEquals(filePath, sources->skipPath))
+    {
+        return;
+    }
+
+    if (sources->count == sources->capacity)
+    {
+        sources->capacity = sources->capacity ? sources->capacity * 2 : 64;
+        sources->items    = (loom_archive_source_t *)lmRealloc(NULL, sources->items, sources->capacity * sizeof(loom_archive_source_t));
+    }
+
+    source       = &sources->items[sources->count++];
+    source->path = (char *)lmAlloc(NULL, strlen(filePath) + 1);
+    strcpy(source->path, filePath);
+
+    for (c = source->path; *c; c++)
+    {
+        if (*c == '\\')
+        {
+            *c = '/';
+        }
+    }
+
+    source->hash = archive_hashPath(source->path);
+}
+
+
+static int archive_compareSources(const void *a, const void *b)
+{
+    const loom_archive_source_t *sa = (const loom_archive_source_t *)a;
+    const loom_archive_source_t *sb = (const loom_archive_source_t *)b;
+
+    if (sa->hash != sb->hash)
+    {
+        return sa->hash < sb->hash ? -1 : 1;
+    }
+
+    return strcmp(sa->path, sb->path);
+}
+
+
+static int archive_pad(FILE *f, long *offset)
+{
+    static const char zeros[LOOM_ARCHIVE_ALIGN] = { 0 };
+    long padding = (LOOM_ARCHIVE_ALIGN - (*offset % LOOM_ARCHIVE_ALIGN)) % LOOM_ARCHIVE_ALIGN;
+
+    *offset += padding;
+    return fwrite(zeros, 1, padding, f) == (size_t)padding;
+}
+
+
+int platform_writeArchive(const char *archivePath, const char *rootPath)
+{
+    loom_archive_sources_t sources;
+    loom_archive_header_t  header;
+    loom_archive_entry_t   *entries;
+    FILE                   *f;
+    long                   offset;
+    int                    i;
+    int                    success = 1;
+
+    memset(&sources, 0, sizeof(sources));
+    sources.skipPath = archivePath;
+    if ((sources.skipPath[0] == '.') && (sources.skipPath[1] == '/'))
+    {
+        sources.skipPath += 2;
+    }
+
+    platform_walkFiles(rootPath, archive_collectFile, &sources);
+
+    // The index is sorted by hash so it can be binary searched.
+    qsort(sources.items, sources.count, sizeof(loom_archive_source_t), archive_compareSources);
+
+    f = fopen(archivePath, "wb");
+    if (!f)
+    {
+        lmLogError(ioLogGroup, "Unable to write archive '%s'", archivePath);
+        success = 0;
+    }
+
+    entries = (loom_archive_entry_t *)lmAlloc(NULL, (sources.count ? sources.count : 1) * sizeof(loom_archive_entry_t));
+
+    header.magic      = LOOM_ARCHIVE_MAGIC;
+    header.version    = LOOM_ARCHIVE_VERSION;
+    header.entryCount = sources.count;
+    header.reserved   = 0;
+
+    // The index is written once the data offsets and sizes are known, leave
+    // room for it and write the paths.
+    offset = sizeof(header) + sources.count * sizeof(loom_archive_entry_t);
+    if (success && (fseek(f, offset, SEEK_SET) != 0))
+    {
+        success = 0;
+    }
+
+    for (i = 0; success && i < sources.count; i++)
+    {
+        size_t length = strlen(sources.items[i].path) + 1;
+
+        entries[i].hash       = sources.items[i].hash;
+        entries[i].pathOffset = (unsigned int)offset;
+
+        success = fwrite(sources.items[i].path, 1, length, f) == length;
+        offset += (long)length;
+    }
+
+    for (i = 0; success && i < sources.count; i++)
+    {
+        void *ptr;
+        long size;
+
+        success = archive_pad(f, &offset);
+        if (!success)
+        {
+            break;
+        }
+
+        if (!platform_mapFile(sources.items[i].path, &ptr, &size))
+        {
+            lmLogError(ioLogGroup, "Unable to read '%s' into archive '%s'", sources.items[i].path, archivePath);
+            success = 0;
+            break;
+        }
+
+        entries[i].dataOffset = (unsigned int)offset;
+        entries[i].size       = (unsigned int)size;
+
+        success = fwrite(ptr, 1, size, f) == (size_t)size;
+        offset += size;
+
+        platform_unmapFile(ptr);
+
+        lmAssert(offset >= 0 && (unsigned long)offset <= 0xFFFFFFFFul, "Archive '%s' is too large", archivePath);
+    }
+
+    if (success)
+    {
+        success = (fseek(f, 0, SEEK_SET) == 0) &&
+                  (fwrite(&header, sizeof(header), 1, f) == 1) &&
+                  (fwrite(entries, sizeof(loom_archive_entry_t), sources.count, f) == (size_t)sources.count);
+    }
+
+    if (f)
+    {
+        success = (fclose(f) == 0) && success;
+
+        if (!success)
+        {
+            lmLogError(ioLogGroup, "Failed writing archive '%s'", archivePath);
+            remove(archivePath);
+        }
+    }
+
+    if (success)
+    {
+        lmLogDebug(ioLogGroup, "Wrote archive '%s' with %d files", archivePath, sources.count);
+    }
+
+    for (i = 0; i < sources.count; i++)
+    {
+        lmFree(NULL, sources.items[i].path);
+    }
+    lmSafeFree(NULL, sources.items);
+    lmFree(NULL, entries);
+
+    return success;
+}
+
+
 #if LOOM_PLATFORM == LOOM_PLATFORM_OSX || LOOM_PLATFORM == LOOM_PLATFORM_LINUX
 static platform_subdirectoryWalkerCallback gCurrentWalkCallback = NULL;
 static void *gCurrentWalkPayload = NULL;
@@ -37,6 +37,19 @@ void platform_unmapFile(void *ptr);
 // If file can be opened, returns 1, otherwise returns 0
 int platform_mapFileExists(const char *path);
 
+// Pack every file under rootPath into a single archive at archivePath. Files
+// are indexed by the path they were found at, so packing "assets" makes
+// "assets/logo.png" resolvable once mounted. Returns 1 on success.
+int platform_writeArchive(const char *archivePath, const char *rootPath);
+
+// Mount an archive written by platform_writeArchive. While mounted, its files
+// are served by platform_mapFile and platform_mapFileExists directly out of
+// the archive's mapping, ahead of loose files. Returns 1 on success.
+int platform_mountArchive(const char *archivePath);
+
+// Unmount an archive. Files mapped out of it must be unmapped first.
+void platform_unmountArchive(const char *archivePath);
+
 // Walk a directory and callback for each subdirectory.
 // Note that this is not possible within the 'assets' directory on Android.
 typedef void (*platform_subdirectoryWalkerCallback)(const char *subdirectoryPath, void *payload);
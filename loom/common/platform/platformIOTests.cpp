@@ -0,0 +1,107 @@
+/*
+ * ===========================================================================
+ * Loom SDK
+ * Copyright 2011, 2012, 2013
+ * The Game Engine Company, LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ * ===========================================================================
+ */
+
+#include <string.h>
+#include "seatest.h"
+#include "loom/common/platform/platformIO.h"
+#include "loom/common/platform/platformFile.h"
+
+SEATEST_FIXTURE(platformIO)
+{
+    SEATEST_FIXTURE_ENTRY(platformIO_mapFile);
+    SEATEST_FIXTURE_ENTRY(platformIO_archive);
+}
+
+static int mappedEquals(const char *path, const char *expected)
+{
+    void *ptr;
+    long size;
+
+    if (!platform_mapFile(path, &ptr, &size))
+    {
+        return 0;
+    }
+
+    int equal = (size == (long)strlen(expected)) && (memcmp(ptr, expected, size) == 0);
+
+    platform_unmapFile(ptr);
+
+    return equal;
+}
+
+
+SEATEST_TEST(platformIO_mapFile)
+{
+    char text[] = "Loom Map Test.";
+
+    assert_int_equal(0, platform_writeFile("mapTest.txt", text, (int)strlen(text)));
+
+    assert_true(platform_mapFileExists("mapTest.txt"));
+    assert_true(mappedEquals("mapTest.txt", text));
+    assert_true(mappedEquals("./mapTest.txt", text));
+
+    platform_removeFile("mapTest.txt");
+
+    assert_false(platform_mapFileExists("mapTest.txt"));
+}
+
+
+SEATEST_TEST(platformIO_archive)
+{
+    char first[]  = "First archived file.";
+    char second[] = "Second archived file, in a subfolder.";
+
+    platform_makeDir("archiveTest/sub");
+    assert_int_equal(0, platform_writeFile("archiveTest/first.txt", first, (int)strlen(first)));
+    assert_int_equal(0, platform_writeFile("archiveTest/sub/second.txt", second, (int)strlen(second)));
+    assert_int_equal(0, platform_writeFile("archiveTest/empty.txt", first, 0));
+
+    assert_true(platform_writeArchive("archiveTest.lpk", "archiveTest"));
+
+    // Remove the loose files so everything has to come from the archive.
+    platform_removeFile("archiveTest/first.txt");
+    platform_removeFile("archiveTest/sub/second.txt");
+    platform_removeFile("archiveTest/empty.txt");
+    platform_removeDir("archiveTest/sub");
+    platform_removeDir("archiveTest");
+
+    assert_false(platform_mapFileExists("archiveTest/first.txt"));
+
+    assert_true(platform_mountArchive("archiveTest.lpk"));
+
+    assert_true(platform_mapFileExists("archiveTest/first.txt"));
+    assert_true(platform_mapFileExists("./archiveTest/sub/second.txt"));
+    assert_false(platform_mapFileExists("archiveTest/missing.txt"));
+
+    assert_true(mappedEquals("archiveTest/first.txt", first));
+    assert_true(mappedEquals("archiveTest\\sub\\second.txt", second));
+    assert_true(mappedEquals("archiveTest/empty.txt", ""));
+
+    platform_unmountArchive("archiveTest.lpk");
+
+    assert_false(platform_mapFileExists("archiveTest/first.txt"));
+
+    // Archives that aren't archives are refused.
+    assert_false(platform_mountArchive("archiveTest/missing.lpk"));
+    assert_int_equal(0, platform_writeFile("archiveTest.lpk", first, (int)strlen(first)));
+    assert_false(platform_mountArchive("archiveTest.lpk"));
+
+    platform_removeFile("archiveTest.lpk");
+}
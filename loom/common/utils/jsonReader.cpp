@@ -0,0 +1,546 @@
+/*
+ * ===========================================================================
+ * Loom SDK
+ * Copyright 2011, 2012, 2013
+ * The Game Engine Company, LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ * ===========================================================================
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "loom/common/core/allocator.h"
+#include "loom/common/platform/platformIO.h"
+#include "loom/common/utils/jsonReader.h"
+
+JSONReader::JSONReader() : text(NULL), cursor(NULL), end(NULL), ownedText(NULL), mappedText(NULL)
+{
+    reset();
+}
+
+
+JSONReader::~JSONReader()
+{
+    loadBuffer(NULL, 0);
+}
+
+
+void JSONReader::reset()
+{
+    cursor  = text;
+    token   = JSON_TOKEN_NONE;
+    number  = 0;
+    boolean = false;
+    started = false;
+    stack.clear();
+    value.clear();
+    error = "";
+}
+
+
+void JSONReader::loadBuffer(const char *json, int length)
+{
+    if (ownedText)
+    {
+        lmFree(NULL, ownedText);
+        ownedText = NULL;
+    }
+
+    if (mappedText)
+    {
+        platform_unmapFile(mappedText);
+        mappedText = NULL;
+    }
+
+    text = json;
+    end  = json ? json + length : NULL;
+
+    reset();
+}
+
+
+bool JSONReader::loadString(const char *json)
+{
+    int length = json ? (int)strlen(json) : 0;
+
+    char *copy = (char *)lmAlloc(NULL, length + 1);
+    memcpy(copy, json ? json : "", length);
+    copy[length] = 0;
+
+    loadBuffer(copy, length);
+    ownedText = copy;
+
+    return true;
+}
+
+
+bool JSONReader::loadFile(const char *path)
+{
+    void *mapped = NULL;
+    long size    = 0;
+
+    loadBuffer(NULL, 0);
+
+    if (!path || !platform_mapFile(path, &mapped, &size))
+    {
+        fail("unable to open file");
+        return false;
+    }
+
+    loadBuffer((const char *)mapped, (int)size);
+    mappedText = mapped;
+
+    return true;
+}
+
+
+int JSONReader::fail(const char *message)
+{
+    error = message;
+
+    if (text)
+    {
+        char position[64];
+        snprintf(position, sizeof(position), " at offset %d", (int)(cursor - text));
+        error += position;
+    }
+
+    token = JSON_TOKEN_ERROR;
+    return token;
+}
+
+
+void JSONReader::skipWhitespace()
+{
+    while (cursor < end && (*cursor == ' ' || *cursor == '\t' || *cursor == '\n' || *cursor == '\r'))
+    {
+        cursor++;
+    }
+}
+
+
+int JSONReader::next()
+{
+    if ((token == JSON_TOKEN_ERROR) || (token == JSON_TOKEN_END))
+    {
+        return token;
+    }
+
+    if (!text)
+    {
+        return fail("no document loaded");
+    }
+
+    skipWhitespace();
+
+    if (!stack.size())
+    {
+        if (started)
+        {
+            if (cursor != end)
+            {
+                return fail("unexpected text after document");
+            }
+
+            token = JSON_TOKEN_END;
+            return token;
+        }
+
+        started = true;
+        return scanValue();
+    }
+
+    Level& level = stack.back();
+
+    if (cursor == end)
+    {
+        return fail("unexpected end of document");
+    }
+
+    char c = *cursor;
+
+    if (level.container == '{')
+    {
+        switch (level.state)
+        {
+        case STATE_FIRST:
+        case STATE_KEY:
+            if ((c == '}') && (level.state == STATE_FIRST))
+            {
+                cursor++;
+                stack.pop_back();
+                token = JSON_TOKEN_END_OBJECT;
+                break;
+            }
+
+            if (c != '"')
+            {
+                return fail("expected a key");
+            }
+
+            level.state = STATE_VALUE;
+            return scanString(JSON_TOKEN_KEY);
+
+        case STATE_VALUE:
+            if (c != ':')
+            {
+                return fail("expected ':'");
+            }
+
+            cursor++;
+            skipWhitespace();
+            level.state = STATE_NEXT;
+            return scanValue();
+
+        case STATE_NEXT:
+            if (c == ',')
+            {
+                cursor++;
+                skipWhitespace();
+                level.state = STATE_KEY;
+                return next();
+            }
+
+            if (c != '}')
+            {
+                return fail("expected ',' or '}'");
+            }
+
+            cursor++;
+            stack.pop_back();
+            token = JSON_TOKEN_END_OBJECT;
+            break;
+        }
+    }
+    else
+    {
+        if (c == ']')
+        {
+            cursor++;
+            stack.pop_back();
+            token = JSON_TOKEN_END_ARRAY;
+            return token;
+        }
+
+        if (level.state == STATE_NEXT)
+        {
+            if (c != ',')
+            {
+                return fail("expected ',' or ']'");
+            }
+
+            cursor++;
+            skipWhitespace();
+        }
+
+        level.state = STATE_NEXT;
+        return scanValue();
+    }
+
+    return token;
+}
+
+
+void JSONReader::skip()
+{
+    if ((token != JSON_TOKEN_BEGIN_OBJECT) && (token != JSON_TOKEN_BEGIN_ARRAY) && (token != JSON_TOKEN_KEY))
+    {
+        return;
+    }
+
+    int depth = (int)stack.size();
+
+    if (token == JSON_TOKEN_KEY)
+    {
+        // skip the value of the key
+        int t = next();
+        if ((t != JSON_TOKEN_BEGIN_OBJECT) && (t != JSON_TOKEN_BEGIN_ARRAY))
+        {
+            return;
+        }
+
+        depth = (int)stack.size();
+    }
+
+    while ((int)stack.size() >= depth)
+    {
+        int t = next();
+        if ((t == JSON_TOKEN_ERROR) || (t == JSON_TOKEN_END))
+        {
+            return;
+        }
+    }
+}
+
+
+int JSONReader::scanValue()
+{
+    if (cursor == end)
+    {
+        return fail("expected a value");
+    }
+
+    switch (*cursor)
+    {
+    case '{':
+    case '[':
+        {
+            Level level;
+            level.container = *cursor;
+            level.state     = STATE_FIRST;
+            stack.push_back(level);
+            token = *cursor == '{' ? JSON_TOKEN_BEGIN_OBJECT : JSON_TOKEN_BEGIN_ARRAY;
+            cursor++;
+            return token;
+        }
+
+    case '"':
+        return scanString(JSON_TOKEN_STRING);
+
+    case 't':
+        return scanLiteral("true", JSON_TOKEN_BOOLEAN, true);
+
+    case 'f':
+        return scanLiteral("false", JSON_TOKEN_BOOLEAN, false);
+
+    case 'n':
+        return scanLiteral("null", JSON_TOKEN_NULL, false);
+    }
+
+    if ((*cursor == '-') || ((*cursor >= '0') && (*cursor <= '9')))
+    {
+        return scanNumber();
+    }
+
+    return fail("unexpected character");
+}
+
+
+int JSONReader::scanLiteral(const char *literal, int resultToken, bool booleanValue)
+{
+    int length = (int)strlen(literal);
+
+    if ((end - cursor < length) || strncmp(cursor, literal, length))
+    {
+        return fail("invalid literal");
+    }
+
+    cursor += length;
+    boolean = booleanValue;
+    token   = resultToken;
+    return token;
+}
+
+
+int JSONReader::scanNumber()
+{
+    const char *start = cursor;
+
+    if (*cursor == '-')
+    {
+        cursor++;
+    }
+
+    if ((cursor == end) || (*cursor < '0') || (*cursor > '9'))
+    {
+        return fail("invalid number");
+    }
+
+    while (cursor < end && ((*cursor >= '0' && *cursor <= '9') || *cursor == '.' || *cursor == 'e' ||
+                            *cursor == 'E' || *cursor == '+' || *cursor == '-'))
+    {
+        cursor++;
+    }
+
+    // strtod needs a terminated copy, the text may be a mapped file
+    char buffer[64];
+    int  length = (int)(cursor - start);
+
+    if (length >= (int)sizeof(buffer))
+    {
+        return fail("number too long");
+    }
+
+    memcpy(buffer, start, length);
+    buffer[length] = 0;
+
+    char *parsedEnd;
+    number = strtod(buffer, &parsedEnd);
+
+    if (parsedEnd != buffer + length)
+    {
+        cursor = start;
+        return fail("invalid number");
+    }
+
+    token = JSON_TOKEN_NUMBER;
+    return token;
+}
+
+
+static int hexValue(const char *p)
+{
+    int result = 0;
+
+    for (int i = 0; i < 4; i++)
+    {
+        char c = p[i];
+        result <<= 4;
+
+        if ((c >= '0') && (c <= '9'))
+        {
+            result |= c - '0';
+        }
+        else if ((c >= 'a') && (c <= 'f'))
+        {
+            result |= c - 'a' + 10;
+        }
+        else if ((c >= 'A') && (c <= 'F'))
+        {
+            result |= c - 'A' + 10;
+        }
+        else
+        {
+            return -1;
+        }
+    }
+
+    return result;
+}
+
+
+void JSONReader::appendUTF8(unsigned int codepoint)
+{
+    if (codepoint < 0x80)
+    {
+        value.push_back((char)codepoint);
+    }
+    else if (codepoint < 0x800)
+    {
+        value.push_back((char)(0xC0 | (codepoint >> 6)));
+        value.push_back((char)(0x80 | (codepoint & 0x3F)));
+    }
+    else if (codepoint < 0x10000)
+    {
+        value.push_back((char)(0xE0 | (codepoint >> 12)));
+        value.push_back((char)(0x80 | ((codepoint >> 6) & 0x3F)));
+        value.push_back((char)(0x80 | (codepoint & 0x3F)));
+    }
+    else
+    {
+        value.push_back((char)(0xF0 | (codepoint >> 18)));
+        value.push_back((char)(0x80 | ((codepoint >> 12) & 0x3F)));
+        value.push_back((char)(0x80 | ((codepoint >> 6) & 0x3F)));
+        value.push_back((char)(0x80 | (codepoint & 0x3F)));
+    }
+}
+
+
+int JSONReader::scanString(int resultToken)
+{
+    // skip the opening quote
+    cursor++;
+
+    value.clear();
+
+    for ( ; ; )
+    {
+        // copy the run up to the next quote or escape in one go
+        const char *run = cursor;
+        while (cursor < end && *cursor != '"' && *cursor != '\\')
+        {
+            if ((unsigned char)*cursor < 0x20)
+            {
+                return fail("control character in string");
+            }
+
+            cursor++;
+        }
+
+        if (cursor > run)
+        {
+            UTsize offset = value.size();
+            value.resize(offset + (UTsize)(cursor - run));
+            memcpy(value.ptr() + offset, run, cursor - run);
+        }
+
+        if (cursor == end)
+        {
+            return fail("unterminated string");
+        }
+
+        if (*cursor == '"')
+        {
+            cursor++;
+            break;
+        }
+
+        // escape sequence
+        if (end - cursor < 2)
+        {
+            return fail("unterminated string");
+        }
+
+        char escaped = cursor[1];
+        cursor += 2;
+
+        switch (escaped)
+        {
+        case '"': value.push_back('"'); break;
+        case '\\': value.push_back('\\'); break;
+        case '/': value.push_back('/'); break;
+        case 'b': value.push_back('\b'); break;
+        case 'f': value.push_back('\f'); break;
+        case 'n': value.push_back('\n'); break;
+        case 'r': value.push_back('\r'); break;
+        case 't': value.push_back('\t'); break;
+
+        case 'u':
+            {
+                int codepoint = end - cursor >= 4 ? hexValue(cursor) : -1;
+                if (codepoint < 0)
+                {
+                    return fail("invalid unicode escape");
+                }
+
+                cursor += 4;
+
+                // combine a surrogate pair
+                if ((codepoint >= 0xD800) && (codepoint < 0xDC00) && (end - cursor >= 6) &&
+                    (cursor[0] == '\\') && (cursor[1] == 'u'))
+                {
+                    int low = hexValue(cursor + 2);
+                    if ((low >= 0xDC00) && (low < 0xE000))
+                    {
+                        codepoint = 0x10000 + ((codepoint - 0xD800) << 10) + (low - 0xDC00);
+                        cursor   += 6;
+                    }
+                }
+
+                appendUTF8((unsigned int)codepoint);
+                break;
+            }
+
+        default:
+            return fail("invalid escape");
+        }
+    }
+
+    value.push_back(0);
+
+    token = resultToken;
+    return token;
+}
@@ -0,0 +1,130 @@
+/*
+ * ===========================================================================
+ * Loom SDK
+ * Copyright 2011, 2012, 2013
+ * The Game Engine Company, LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ * ===========================================================================
+ */
+
+#ifndef _UTILS_JSONREADER_H
+#define _UTILS_JSONREADER_H
+
+#include "loom/common/utils/utString.h"
+#include "loom/common/utils/utTypes.h"
+
+// Tokens returned by JSONReader::next(), mirrored by the script JSONToken enum.
+enum JSONReaderToken
+{
+    JSON_TOKEN_NONE,
+    JSON_TOKEN_BEGIN_OBJECT,
+    JSON_TOKEN_END_OBJECT,
+    JSON_TOKEN_BEGIN_ARRAY,
+    JSON_TOKEN_END_ARRAY,
+    JSON_TOKEN_KEY,
+    JSON_TOKEN_STRING,
+    JSON_TOKEN_NUMBER,
+    JSON_TOKEN_BOOLEAN,
+    JSON_TOKEN_NULL,
+    JSON_TOKEN_END,
+    JSON_TOKEN_ERROR
+};
+
+/*
+ * Pull parser over a JSON text. Each call to next() scans one token, so a
+ * document can be walked without building a DOM; the only state kept is
+ * the stack of open containers and the value of the current token.
+ *
+ * The text is either copied, borrowed from the caller or mapped from disk.
+ */
+class JSONReader
+{
+public:
+
+    JSONReader();
+    ~JSONReader();
+
+    // copies the text
+    bool loadString(const char *json);
+
+    // reads text that must outlive the reader, or until the next load
+    void loadBuffer(const char *json, int length);
+
+    // maps the file at path
+    bool loadFile(const char *path);
+
+    // scans the next token, returns a JSONReaderToken
+    int next();
+
+    // skips over the value of the current token, so that after skipping a
+    // BEGIN_OBJECT or BEGIN_ARRAY the next token follows its matching end
+    void skip();
+
+    int getToken() const { return token; }
+
+    // number of containers enclosing the current position
+    int getDepth() const { return (int)stack.size(); }
+
+    // text of the current KEY or STRING token, NUL terminated
+    const char *getString() const { return value.ptr() ? value.ptr() : ""; }
+    int getStringLength() const { return value.size() ? (int)value.size() - 1 : 0; }
+
+    double getNumber() const { return number; }
+    bool getBoolean() const { return boolean; }
+
+    const char *getError() const { return error.c_str(); }
+
+private:
+
+    enum State
+    {
+        STATE_FIRST,    // container just opened
+        STATE_KEY,      // object expects a key after a comma
+        STATE_VALUE,    // object expects a value after a key
+        STATE_NEXT      // a value was read, expects a comma or close
+    };
+
+    struct Level
+    {
+        char container;
+        char state;
+    };
+
+    const char *text;
+    const char *cursor;
+    const char *end;
+
+    char *ownedText;
+    void *mappedText;
+
+    utArray<Level> stack;
+    utArray<char>  value;
+
+    int    token;
+    double number;
+    bool   boolean;
+    bool   started;
+
+    utString error;
+
+    void reset();
+    int fail(const char *message);
+    void skipWhitespace();
+    int scanValue();
+    int scanString(int resultToken);
+    int scanNumber();
+    int scanLiteral(const char *literal, int resultToken, bool booleanValue);
+    void appendUTF8(unsigned int codepoint);
+};
+#endif
@@ -1459,6 +1459,28 @@ public:
         }
 
 
+        UTsize fh = findUncached(key);
+
+        if (fh != UT_NPOS)
+        {
+            m_lastKey = hk;
+            m_lastPos = fh;
+
+            UT_ASSERT(fh >= 0 && fh < m_size);
+        }
+        return fh;
+    }
+
+    // Find without reading or updating the last lookup cache, so a table
+    // nothing writes to any more may be searched from several threads
+    UTsize findUncached(const Key& key) const
+    {
+        if ((m_capacity == 0) || (m_capacity == UT_NPOS) || (m_size == 0))
+        {
+            return UT_NPOS;
+        }
+
+        UTsize hk = key.hash();
         UThash hr = _UT_UTHASHTABLE_HKHASH(hk);
 
         UT_ASSERT(m_bptr && m_iptr && m_nptr);
@@ -1469,15 +1491,14 @@ public:
             fh = m_nptr[fh];
         }
 
+        return fh;
+    }
 
-        if (fh != UT_NPOS)
-        {
-            m_lastKey = hk;
-            m_lastPos = fh;
+    const Value *getUncached(const Key& key) const
+    {
+        UTsize i = findUncached(key);
 
-            UT_ASSERT(fh >= 0 && fh < m_size);
-        }
-        return fh;
+        return i == UT_NPOS ? (const Value *)0 : &m_bptr[i].second;
     }
 
     void erase(const Key& key) { remove(key); }
@@ -26,6 +26,7 @@ SEATEST_SUITE(allTests)
     SEATEST_SUITE_ENTRY(allocatorSystem);
     SEATEST_SUITE_ENTRY(platformThread);
     SEATEST_SUITE_ENTRY(platformNetwork);
+    SEATEST_SUITE_ENTRY(platformIO);
     SEATEST_SUITE_ENTRY(stringTable);
     //SEATEST_SUITE_ENTRY(typeRegistry);
     //SEATEST_SUITE_ENTRY(handles);
@@ -34,6 +35,13 @@ SEATEST_SUITE(allTests)
     //SEATEST_SUITE_ENTRY(eventQueue);
     //SEATEST_SUITE_ENTRY(matrix);
     SEATEST_SUITE_ENTRY(logging);
+    SEATEST_SUITE_ENTRY(telemetry);
     SEATEST_SUITE_ENTRY(assets);
+    SEATEST_SUITE_ENTRY(assetsCompressedImage);
+    SEATEST_SUITE_ENTRY(gfxBitmapData);
+    SEATEST_SUITE_ENTRY(gfxImageScale);
+    SEATEST_SUITE_ENTRY(l2dEventDispatcher);
+    SEATEST_SUITE_ENTRY(l2dLayoutSolver);
+    SEATEST_SUITE_ENTRY(l2dTMXMap);
     SEATEST_SUITE_ENTRY(lmAutoPtr);
 }
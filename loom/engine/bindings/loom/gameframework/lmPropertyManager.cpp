@@ -19,10 +19,293 @@
  */
 
 #include "loom/script/loomscript.h"
+#include "loom/script/reflection/lsFieldInfo.h"
+#include "loom/script/reflection/lsMethodInfo.h"
 
 using namespace LS;
 
 namespace Loom {
+/*
+ * A binding list compiled once per component.  Each member lookup is resolved
+ * to the cheapest way of reaching it: script fields are raw table reads,
+ * native getters with a fast call are invoked directly on the native
+ * instance and script getters and setters are called from the class table
+ * without going through a bound method.  Anything else takes the same
+ * generic path applyBindings does.
+ */
+class PropertyBindingProgram {
+public:
+
+    enum StepKind
+    {
+        // script field, read and written raw on the instance table
+        STEP_FIELD,
+        // script getter or setter, called with the instance as "this"
+        STEP_SCRIPTCALL,
+        // native property with a fast call
+        STEP_FASTCALL,
+        // anything else, looked up through the instance metamethods
+        STEP_INDEX
+    };
+
+    struct Step
+    {
+        int                 kind;
+        int                 ordinal;
+        bool                method;
+        CallFastMemberBase *fastCall;
+    };
+
+    struct Binding
+    {
+        int  firstStep;
+        int  numSteps;
+        Step set;
+    };
+
+    utArray<Step>    steps;
+    utArray<Binding> bindings;
+
+    void clear()
+    {
+        steps.clear();
+        bindings.clear();
+    }
+
+    int getNumBindings() const
+    {
+        return (int)bindings.size();
+    }
+
+    void beginBinding()
+    {
+        Binding binding;
+
+        binding.firstStep = (int)steps.size();
+        binding.numSteps  = 0;
+        bindings.push_back(binding);
+    }
+
+    // the field or getter method read next in the chain of the current binding
+    int addGet(lua_State *L)
+    {
+        lmAssert(bindings.size(), "PropertyBindingProgram.addGet called before beginBinding");
+
+        steps.push_back(compileStep((MemberInfo *)lualoom_getnativepointer(L, 2)));
+        bindings.back().numSteps++;
+        return 0;
+    }
+
+    // the field or setter method on the component which ends the current binding
+    int endBinding(lua_State *L)
+    {
+        lmAssert(bindings.size(), "PropertyBindingProgram.endBinding called before beginBinding");
+
+        Step set = compileStep((MemberInfo *)lualoom_getnativepointer(L, 2));
+
+        // components are script instances, a native setter on one is
+        // reached through the instance metamethods like applyBindings does
+        if (set.kind == STEP_FASTCALL)
+        {
+            set.kind     = STEP_INDEX;
+            set.fastCall = NULL;
+        }
+
+        bindings.back().set = set;
+        return 0;
+    }
+
+    // component at stack 1, program at stack 2 and the vector of the source
+    // component of each binding at stack 3, see PropertyManager.applyBindingProgram
+    int apply(lua_State *L)
+    {
+        if (!bindings.size())
+        {
+            return 0;
+        }
+
+        lmAssert(lsr_vector_get_length(L, 3) >= (int)bindings.size(), "PropertyBindingProgram.apply is missing source components");
+
+        lua_settop(L, 3);
+
+        lua_rawgeti(L, 3, LSINDEXVECTOR);
+        lua_replace(L, 3);
+
+        // the component's class table is looked up once for all of its setters
+        int componentIdx = 1;
+        int classIdx     = 4;
+
+        lua_rawgeti(L, componentIdx, LSINDEXCLASS);
+
+        for (UTsize i = 0; i < bindings.size(); i++)
+        {
+            const Binding& binding = bindings[i];
+
+            // the component we are getting from
+            lua_rawgeti(L, 3, (int)i);
+
+            const Step *step = binding.numSteps ? &steps[binding.firstStep] : NULL;
+            for (int j = 0; j < binding.numSteps; j++, step++)
+            {
+                // we have a null in the property chain, exit
+                if (lua_isnil(L, -1))
+                {
+                    return 0;
+                }
+
+                get(L, *step);
+            }
+
+            set(L, binding.set, componentIdx, classIdx);
+
+            lua_settop(L, classIdx);
+        }
+
+        return 0;
+    }
+
+private:
+
+    static Step compileStep(MemberInfo *member)
+    {
+        lmAssert(member, "PropertyBindingProgram was given a null member");
+
+        Step step;
+
+        step.kind     = STEP_INDEX;
+        step.ordinal  = member->getOrdinal();
+        step.method   = member->isMethod();
+        step.fastCall = NULL;
+
+        if (member->isStatic())
+        {
+            return step;
+        }
+
+        if (member->isField())
+        {
+            if (!((FieldInfo *)member)->isNative())
+            {
+                step.kind = STEP_FIELD;
+            }
+        }
+        else if (member->isMethod())
+        {
+            MethodBase *method = (MethodBase *)member;
+
+            if (method->isFastCall())
+            {
+                step.kind     = STEP_FASTCALL;
+                step.fastCall = (CallFastMemberBase *)method->getFastCall();
+            }
+            else if (!method->isNative())
+            {
+                step.kind = STEP_SCRIPTCALL;
+            }
+        }
+
+        return step;
+    }
+
+    static void *toNativeThis(lua_State *L, int index)
+    {
+        if (lua_type(L, index) == LUA_TTABLE)
+        {
+            lua_rawgeti(L, index, LSINDEXNATIVE);
+            void *p = lua_isuserdata(L, -1) ? ((Detail::UserdataPtr *)lua_topointer(L, -1))->getPointer() : NULL;
+            lua_pop(L, 1);
+            return p;
+        }
+
+        return lua_isuserdata(L, index) ? ((Detail::UserdataPtr *)lua_topointer(L, index))->getPointer() : NULL;
+    }
+
+    // replaces the instance at the top of the stack with the member's value
+    static void get(lua_State *L, const Step& step)
+    {
+        int kind = step.kind;
+
+        if ((kind != STEP_FASTCALL) && (lua_type(L, -1) != LUA_TTABLE))
+        {
+            kind = STEP_INDEX;
+        }
+
+        switch (kind)
+        {
+        case STEP_FIELD:
+            lua_rawgeti(L, -1, step.ordinal);
+            break;
+
+        case STEP_SCRIPTCALL:
+            lua_rawgeti(L, -1, LSINDEXCLASS);
+            lua_pushnumber(L, step.ordinal);
+            lua_gettable(L, -2);
+            lua_replace(L, -2);
+            lua_pushvalue(L, -2);
+            lua_call(L, 1, 1);
+            break;
+
+        case STEP_FASTCALL:
+        {
+            void *p = toNativeThis(L, -1);
+            if (!p)
+            {
+                lua_pushnil(L);
+                break;
+            }
+            step.fastCall->call(L, p, step.fastCall);
+            break;
+        }
+
+        default:
+            lua_pushnumber(L, step.ordinal);
+            lua_gettable(L, -2);
+            if (step.method)
+            {
+                lua_call(L, 0, 1);
+            }
+            break;
+        }
+
+        lua_replace(L, -2);
+    }
+
+    // assigns the value at the top of the stack to the component
+    static void set(lua_State *L, const Step& step, int componentIdx, int classIdx)
+    {
+        switch (step.kind)
+        {
+        case STEP_FIELD:
+            lua_rawseti(L, componentIdx, step.ordinal);
+            break;
+
+        case STEP_SCRIPTCALL:
+            lua_pushnumber(L, step.ordinal);
+            lua_gettable(L, classIdx);
+            lua_pushvalue(L, componentIdx);
+            lua_pushvalue(L, -3);
+            lua_call(L, 2, 0);
+            break;
+
+        default:
+            if (step.method)
+            {
+                lua_pushnumber(L, step.ordinal);
+                lua_gettable(L, componentIdx);
+                lua_pushvalue(L, -2);
+                lua_call(L, 1, 0);
+            }
+            else
+            {
+                lua_pushnumber(L, step.ordinal);
+                lua_insert(L, -2);
+                lua_settable(L, componentIdx);
+            }
+            break;
+        }
+    }
+};
+
 class PropertyManager {
 public:
 
@@ -120,6 +403,18 @@ public:
 
         return 0;
     }
+
+    static int applyBindingProgram(lua_State *L)
+    {
+        // Component "this" at stack 1
+        // compiled program at stack 2
+        // source components at stack 3
+        PropertyBindingProgram *program = (PropertyBindingProgram *)lualoom_getnativepointer(L, 2);
+
+        lmAssert(program, "PropertyManager.applyBindingProgram was given a null program");
+
+        return program->apply(L);
+    }
 };
 
 static int registerLoomPropertyManager(lua_State *L)
@@ -129,6 +424,20 @@ static int registerLoomPropertyManager(lua_State *L)
        .beginClass<PropertyManager>("PropertyManager")
 
        .addStaticLuaFunction("applyBindings", &PropertyManager::applyBindings)
+       .addStaticLuaFunction("applyBindingProgram", &PropertyManager::applyBindingProgram)
+
+       .endClass()
+
+       .beginClass<PropertyBindingProgram>("PropertyBindingProgram")
+
+       .addConstructor<void (*)(void)>()
+
+       .addProperty("numBindings", &PropertyBindingProgram::getNumBindings)
+
+       .addMethod("clear", &PropertyBindingProgram::clear)
+       .addMethod("beginBinding", &PropertyBindingProgram::beginBinding)
+       .addLuaFunction("addGet", &PropertyBindingProgram::addGet)
+       .addLuaFunction("endBinding", &PropertyBindingProgram::endBinding)
 
        .endClass()
 
@@ -141,4 +450,5 @@ static int registerLoomPropertyManager(lua_State *L)
 void installLoomPropertyManager()
 {
     LOOM_DECLARE_NATIVETYPE(Loom::PropertyManager, Loom::registerLoomPropertyManager);
+    LOOM_DECLARE_NATIVETYPE(Loom::PropertyBindingProgram, Loom::registerLoomPropertyManager);
 }
@@ -0,0 +1,937 @@
+/*
+ * ===========================================================================
+ * Loom SDK
+ * Copyright 2011, 2012, 2013
+ * The Game Engine Company, LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ * ===========================================================================
+ */
+
+#include <math.h>
+
+#include "loom/script/loomscript.h"
+#include "loom/script/reflection/lsMethodInfo.h"
+#include "loom/script/reflection/lsPropertyInfo.h"
+
+using namespace LS;
+
+namespace Loom {
+/*
+ * Native side of TimeManager.  Ticked and animated objects are kept in
+ * priority order in a Lua array of object, function pairs, the function
+ * being the object's onTick or onFrame resolved when it is added.  Queued
+ * objects and scheduled calls wait in a four level timer wheel with
+ * millisecond slots, 64 per level, so a tick only visits the slots it
+ * advances over and the entries due in them.  Entries due further than
+ * the wheel spans wait in its last slot and are placed again as it turns.
+ * The entries of a millisecond slot are kept in due order, those due at
+ * the same time in the order they were queued.
+ *
+ * All Lua values live in the TimeManager's schedulerRefs table:
+ *
+ *   [ANIMATED], [TICKED]  object, function pairs in call order
+ *   [QUEUED]              item, function pairs by queue slot and the
+ *                         queue slot of each item, keyed by the item
+ */
+class TimeScheduler {
+public:
+
+    enum
+    {
+        ANIMATED = 1,
+        TICKED   = 2,
+        QUEUED   = 3
+    };
+
+    TimeScheduler() : tickRate(1000.0 / 60.0), maxTicksPerFrame(2), virtualTime(0), elapsed(0),
+        interpolationFactor(0), duringAdvance(false), needPurge(false), wheelTime(0), cascadedTime(-1),
+        queueSequence(0), queuedCount(0)
+    {
+        for (int level = 0; level < WHEEL_LEVELS; level++)
+        {
+            for (int i = 0; i < WHEEL_SIZE; i++)
+            {
+                wheel[level][i]     = -1;
+                wheelTail[level][i] = -1;
+            }
+        }
+    }
+
+    double getTickRate() const { return tickRate; }
+    void setTickRate(double value) { tickRate = value > 0 ? value : tickRate; }
+
+    int getMaxTicksPerFrame() const { return maxTicksPerFrame; }
+    void setMaxTicksPerFrame(int value) { maxTicksPerFrame = value; }
+
+    double getVirtualTime() const { return virtualTime; }
+    void setVirtualTime(double value) { virtualTime = value; }
+
+    double getElapsed() const { return elapsed; }
+    void setElapsed(double value) { elapsed = value; }
+
+    double getInterpolationFactor() const { return interpolationFactor; }
+
+    bool getDuringAdvance() const { return duringAdvance; }
+
+    int getAnimatedCount() const { return lists[0].count; }
+    int getTickedCount() const { return lists[1].count; }
+    int getQueuedCount() const { return queuedCount; }
+
+    // manager at 2, list at 3, object at 4, priority at 5
+    int addObject(lua_State *L)
+    {
+        ProcessList& list = getList(L, 3);
+        double priority   = lua_tonumber(L, 5);
+
+        pushRefs(L, 2);
+        lua_rawgeti(L, -1, (int)lua_tonumber(L, 3));
+        int listIdx = lua_gettop(L);
+
+        int position = (int)list.entries.size();
+
+        for (UTsize i = 0; i < list.entries.size(); i++)
+        {
+            lua_rawgeti(L, listIdx, (int)i * 2 + 1);
+            bool duplicate = lua_rawequal(L, -1, 4) != 0;
+            lua_pop(L, 1);
+
+            if (duplicate)
+            {
+                lua_pushboolean(L, 0);
+                return 1;
+            }
+
+            if ((position == (int)list.entries.size()) && (list.entries[i].priority < priority))
+            {
+                position = (int)i;
+            }
+        }
+
+        ProcessEntry entry;
+        entry.priority = priority;
+        entry.passSelf = pushMethod(L, 4, (int)lua_tonumber(L, 3) == ANIMATED ? "onFrame" : "onTick");
+
+        // open a gap at position, in the Lua array and in the entries
+        list.entries.push_back(entry);
+        for (int i = (int)list.entries.size() - 1; i > position; i--)
+        {
+            list.entries[i] = list.entries[i - 1];
+
+            lua_rawgeti(L, listIdx, i * 2 - 1);
+            lua_rawseti(L, listIdx, i * 2 + 1);
+            lua_rawgeti(L, listIdx, i * 2);
+            lua_rawseti(L, listIdx, i * 2 + 2);
+        }
+
+        list.entries[position] = entry;
+
+        lua_rawseti(L, listIdx, position * 2 + 2);
+        lua_pushvalue(L, 4);
+        lua_rawseti(L, listIdx, position * 2 + 1);
+
+        list.count++;
+
+        lua_pushboolean(L, 1);
+        return 1;
+    }
+
+    // manager at 2, list at 3, object at 4
+    int removeObject(lua_State *L)
+    {
+        ProcessList& list = getList(L, 3);
+
+        pushRefs(L, 2);
+        lua_rawgeti(L, -1, (int)lua_tonumber(L, 3));
+        int listIdx = lua_gettop(L);
+
+        int n = (int)list.entries.size();
+
+        for (int i = 0; i < n; i++)
+        {
+            lua_rawgeti(L, listIdx, i * 2 + 1);
+            bool found = lua_rawequal(L, -1, 4) != 0;
+            lua_pop(L, 1);
+
+            if (!found)
+            {
+                continue;
+            }
+
+            list.count--;
+
+            if (duringAdvance)
+            {
+                // the list is being called, leave a hole that is purged
+                // once the frame is done
+                lua_pushboolean(L, 0);
+                lua_rawseti(L, listIdx, i * 2 + 1);
+                lua_pushboolean(L, 0);
+                lua_rawseti(L, listIdx, i * 2 + 2);
+                needPurge = true;
+            }
+            else
+            {
+                for (int j = i; j < n - 1; j++)
+                {
+                    list.entries[j] = list.entries[j + 1];
+
+                    lua_rawgeti(L, listIdx, j * 2 + 3);
+                    lua_rawseti(L, listIdx, j * 2 + 1);
+                    lua_rawgeti(L, listIdx, j * 2 + 4);
+                    lua_rawseti(L, listIdx, j * 2 + 2);
+                }
+
+                list.entries.pop_back();
+
+                lua_pushnil(L);
+                lua_rawseti(L, listIdx, n * 2);
+                lua_pushnil(L);
+                lua_rawseti(L, listIdx, n * 2 - 1);
+            }
+
+            lua_pushboolean(L, 1);
+            return 1;
+        }
+
+        lua_pushboolean(L, 0);
+        return 1;
+    }
+
+    // manager at 2, item at 3, due time at 4, think flag at 5
+    int queue(lua_State *L)
+    {
+        bool think = lua_toboolean(L, 5) != 0;
+
+        pushRefs(L, 2);
+        lua_rawgeti(L, -1, QUEUED);
+        int queuedIdx = lua_gettop(L);
+
+        int slot = getQueueSlot(L, queuedIdx, 3);
+
+        if (slot == -1)
+        {
+            if (freeQueueSlots.size())
+            {
+                slot = freeQueueSlots.back();
+                freeQueueSlots.pop_back();
+            }
+            else
+            {
+                slot = (int)queueSlots.size();
+                queueSlots.push_back(QueueSlot());
+            }
+
+            queueSlots[slot].entry = -1;
+
+            lua_pushvalue(L, 3);
+            lua_pushnumber(L, slot);
+            lua_rawset(L, queuedIdx);
+
+            lua_pushvalue(L, 3);
+            lua_rawseti(L, queuedIdx, slot * 2 + 1);
+
+            queuedCount++;
+        }
+
+        QueueSlot& queueSlot = queueSlots[slot];
+
+        queueSlot.think    = think;
+        queueSlot.passSelf = pushMethod(L, 3, think ? "nextThinkCallback" : "fire");
+        lua_rawseti(L, queuedIdx, slot * 2 + 2);
+
+        // an earlier queueing of the item is taken out of the wheel and
+        // its entry placed again
+        int index = queueSlot.entry;
+
+        if (index != -1)
+        {
+            unlinkWheelEntry(index);
+        }
+        else if (freeWheelEntries.size())
+        {
+            index = freeWheelEntries.back();
+            freeWheelEntries.pop_back();
+        }
+        else
+        {
+            index = (int)wheelEntries.size();
+            wheelEntries.push_back(WheelEntry());
+        }
+
+        WheelEntry& entry = wheelEntries[index];
+        entry.due      = lua_tonumber(L, 4);
+        entry.sequence = queueSequence++;
+        entry.slot     = slot;
+
+        queueSlot.entry = index;
+        insertWheelEntry(index);
+
+        return 0;
+    }
+
+    // manager at 2, item at 3
+    int dequeue(lua_State *L)
+    {
+        pushRefs(L, 2);
+        lua_rawgeti(L, -1, QUEUED);
+        int queuedIdx = lua_gettop(L);
+
+        int slot = getQueueSlot(L, queuedIdx, 3);
+
+        if (slot != -1)
+        {
+            releaseQueueSlot(L, queuedIdx, slot);
+        }
+
+        lua_pushboolean(L, slot != -1);
+        return 1;
+    }
+
+    // manager at 2, delta time at 3, suppress safety flag at 4
+    int advanceTicks(lua_State *L)
+    {
+        bool suppressSafety = lua_toboolean(L, 4) != 0;
+
+        elapsed += lua_tonumber(L, 3);
+
+        lua_settop(L, 2);
+
+        int tickCount = 0;
+        while (elapsed >= tickRate && (suppressSafety || tickCount < maxTicksPerFrame))
+        {
+            tick(L);
+            tickCount++;
+        }
+
+        lua_pushnumber(L, tickCount);
+        return 1;
+    }
+
+    // manager at 2
+    int advanceFrame(lua_State *L)
+    {
+        lua_settop(L, 2);
+
+        // Make sure that we don't fall behind too far. This helps correct
+        // for short-term drops in framerate as well as the scenario where
+        // we are consistently running behind.
+        if (elapsed < 0)
+        {
+            elapsed = 0;
+        }
+        else if (elapsed > 300)
+        {
+            elapsed = 300;
+        }
+
+        bool wasDuringAdvance = duringAdvance;
+
+        duringAdvance       = true;
+        interpolationFactor = elapsed / tickRate;
+        callList(L, ANIMATED);
+        duringAdvance = wasDuringAdvance;
+
+        if (needPurge && !duringAdvance)
+        {
+            needPurge = false;
+            purgeList(L, ANIMATED);
+            purgeList(L, TICKED);
+        }
+
+        return 0;
+    }
+
+    // manager at 2
+    int fireTick(lua_State *L)
+    {
+        lua_settop(L, 2);
+        tick(L);
+        return 0;
+    }
+
+private:
+
+    enum
+    {
+        WHEEL_BITS   = 6,
+        WHEEL_SIZE   = 1 << WHEEL_BITS,
+        WHEEL_LEVELS = 4
+    };
+
+    struct ProcessEntry
+    {
+        double priority;
+        bool   passSelf;
+    };
+
+    struct ProcessList
+    {
+        utArray<ProcessEntry> entries;
+
+        // entries not removed while the list was being called
+        int count;
+
+        ProcessList() : count(0) {}
+    };
+
+    struct QueueSlot
+    {
+        // the slot's wheel entry, -1 once released
+        int  entry;
+        bool think;
+        bool passSelf;
+    };
+
+    struct WheelEntry
+    {
+        double  due;
+        UTint64 sequence;
+        int     slot;
+
+        // the wheel list holding the entry and its neighbours there
+        int level;
+        int wheelSlot;
+        int prev;
+        int next;
+    };
+
+    static Type *typeTimeManager;
+    static int  refsOrdinal;
+    static int  deferredMethodQueueOrdinal;
+    static int  processDeferredMethodsOrdinal;
+
+    double tickRate;
+    int    maxTicksPerFrame;
+    double virtualTime;
+    double elapsed;
+    double interpolationFactor;
+    bool   duringAdvance;
+    bool   needPurge;
+
+    ProcessList lists[2];
+
+    utArray<QueueSlot>  queueSlots;
+    utArray<int>        freeQueueSlots;
+    utArray<WheelEntry> wheelEntries;
+    utArray<int>        freeWheelEntries;
+
+    // head and tail entry of each slot, -1 when empty
+    int     wheel[WHEEL_LEVELS][WHEEL_SIZE];
+    int     wheelTail[WHEEL_LEVELS][WHEEL_SIZE];
+    UTint64 wheelTime;
+    UTint64 cascadedTime;
+
+    // orders the entries due at the same time
+    UTint64 queueSequence;
+
+    int queuedCount;
+
+    static void initialize(lua_State *L)
+    {
+        typeTimeManager = LSLuaState::getLuaState(L)->getType("loom.gameframework.TimeManager");
+        lmAssert(typeTimeManager, "unable to get loom.gameframework.TimeManager type");
+
+        refsOrdinal = typeTimeManager->getMemberOrdinal("schedulerRefs");
+        deferredMethodQueueOrdinal    = typeTimeManager->getMemberOrdinal("deferredMethodQueue");
+        processDeferredMethodsOrdinal = typeTimeManager->getMemberOrdinal("processDeferredMethods");
+    }
+
+    ProcessList& getList(lua_State *L, int index)
+    {
+        int list = (int)lua_tonumber(L, index);
+
+        lmAssert((list == ANIMATED) || (list == TICKED), "TimeScheduler was given an unknown list %d", list);
+
+        return lists[list - 1];
+    }
+
+    // pushes the refs table of the manager at index, creating it on first use
+    static void pushRefs(lua_State *L, int managerIdx)
+    {
+        if (!refsOrdinal)
+        {
+            initialize(L);
+        }
+
+        lua_rawgeti(L, managerIdx, refsOrdinal);
+
+        if (lua_isnil(L, -1))
+        {
+            lua_pop(L, 1);
+            lua_createtable(L, 3, 0);
+
+            for (int i = ANIMATED; i <= QUEUED; i++)
+            {
+                lua_newtable(L);
+                lua_rawseti(L, -2, i);
+            }
+
+            lua_pushvalue(L, -1);
+            lua_rawseti(L, managerIdx, refsOrdinal);
+        }
+    }
+
+    // Pushes the named method of the object at objIdx, or the getter if
+    // name is a property. Script methods are taken from the class and are
+    // called with the object as first argument, true is returned for those;
+    // anything else is bound to the object.
+    static bool pushMethod(lua_State *L, int objIdx, const char *name)
+    {
+        lua_rawgeti(L, objIdx, LSINDEXTYPE);
+        Type *type = (Type *)lua_topointer(L, -1);
+        lua_pop(L, 1);
+
+        lmAssert(type, "TimeScheduler was given an object without a type");
+
+        MemberInfo *member = type->findMember(name);
+        MethodBase *target = NULL;
+
+        if (member && member->isProperty())
+        {
+            target = ((PropertyInfo *)member)->getGetMethod();
+        }
+        else if (member && member->isMethod())
+        {
+            target = (MethodBase *)member;
+        }
+
+        lmAssert(target, "%s has no %s", type->getFullName().c_str(), name);
+
+        if (!target->isNative() && !target->isStatic())
+        {
+            lua_rawgeti(L, objIdx, LSINDEXCLASS);
+            lua_pushnumber(L, target->getOrdinal());
+            lua_gettable(L, -2);
+            lua_remove(L, -2);
+            return true;
+        }
+
+        lua_pushnumber(L, target->getOrdinal());
+        lua_gettable(L, objIdx);
+        return false;
+    }
+
+    static void call(lua_State *L, bool passSelf, int nresults)
+    {
+        // object and function on the top of the stack
+        if (passSelf)
+        {
+            lua_insert(L, -2);
+            lua_call(L, 1, nresults);
+        }
+        else
+        {
+            lua_remove(L, -2);
+            lua_call(L, 0, nresults);
+        }
+    }
+
+    void callList(lua_State *L, int list)
+    {
+        ProcessList& processList = lists[list - 1];
+
+        if (!processList.entries.size())
+        {
+            return;
+        }
+
+        int top = lua_gettop(L);
+
+        pushRefs(L, 2);
+        lua_rawgeti(L, -1, list);
+        int listIdx = lua_gettop(L);
+
+        // adds are deferred and removes leave holes while we are called,
+        // so the entries do not move
+        for (UTsize i = 0; i < processList.entries.size(); i++)
+        {
+            lua_rawgeti(L, listIdx, (int)i * 2 + 1);
+
+            if (!lua_toboolean(L, -1))
+            {
+                lua_pop(L, 1);
+                continue;
+            }
+
+            lua_rawgeti(L, listIdx, (int)i * 2 + 2);
+            call(L, processList.entries[i].passSelf, 0);
+        }
+
+        lua_settop(L, top);
+    }
+
+    void purgeList(lua_State *L, int list)
+    {
+        ProcessList& processList = lists[list - 1];
+
+        pushRefs(L, 2);
+        lua_rawgeti(L, -1, list);
+        int listIdx = lua_gettop(L);
+
+        int n     = (int)processList.entries.size();
+        int write = 0;
+
+        for (int read = 0; read < n; read++)
+        {
+            lua_rawgeti(L, listIdx, read * 2 + 1);
+            bool alive = lua_toboolean(L, -1) != 0;
+            lua_pop(L, 1);
+
+            if (!alive)
+            {
+                continue;
+            }
+
+            if (write != read)
+            {
+                processList.entries[write] = processList.entries[read];
+
+                lua_rawgeti(L, listIdx, read * 2 + 1);
+                lua_rawseti(L, listIdx, write * 2 + 1);
+                lua_rawgeti(L, listIdx, read * 2 + 2);
+                lua_rawseti(L, listIdx, write * 2 + 2);
+            }
+
+            write++;
+        }
+
+        for (int i = write * 2 + 1; i <= n * 2; i++)
+        {
+            lua_pushnil(L);
+            lua_rawseti(L, listIdx, i);
+        }
+
+        processList.entries.resize(write);
+
+        lua_pop(L, 2);
+    }
+
+    static int getQueueSlot(lua_State *L, int queuedIdx, int itemIdx)
+    {
+        lua_pushvalue(L, itemIdx);
+        lua_rawget(L, queuedIdx);
+
+        int slot = lua_isnil(L, -1) ? -1 : (int)lua_tonumber(L, -1);
+        lua_pop(L, 1);
+
+        return slot;
+    }
+
+    void releaseQueueSlot(lua_State *L, int queuedIdx, int slot)
+    {
+        lua_rawgeti(L, queuedIdx, slot * 2 + 1);
+        lua_pushnil(L);
+        lua_rawset(L, queuedIdx);
+
+        lua_pushnil(L);
+        lua_rawseti(L, queuedIdx, slot * 2 + 1);
+        lua_pushnil(L);
+        lua_rawseti(L, queuedIdx, slot * 2 + 2);
+
+        int index = queueSlots[slot].entry;
+        unlinkWheelEntry(index);
+        freeWheelEntries.push_back(index);
+
+        queueSlots[slot].entry = -1;
+        freeQueueSlots.push_back(slot);
+        queuedCount--;
+    }
+
+    // whether entry a is due after b
+    static bool isDueAfter(const WheelEntry& a, const WheelEntry& b)
+    {
+        return (a.due > b.due) || ((a.due == b.due) && (a.sequence > b.sequence));
+    }
+
+    void insertWheelEntry(int index)
+    {
+        WheelEntry& entry = wheelEntries[index];
+
+        UTint64 key = (UTint64)floor(entry.due);
+
+        if (key < wheelTime)
+        {
+            key = wheelTime;
+        }
+
+        // the highest level whose span the entry is beyond, entries
+        // further than the whole wheel wait in its last slot
+        UTint64 delta = key - wheelTime;
+        int     level = 0;
+
+        while ((level < WHEEL_LEVELS - 1) && (delta >= ((UTint64)1 << (WHEEL_BITS * (level + 1)))))
+        {
+            level++;
+        }
+
+        if (delta >= ((UTint64)1 << (WHEEL_BITS * WHEEL_LEVELS)))
+        {
+            key = wheelTime + ((UTint64)1 << (WHEEL_BITS * WHEEL_LEVELS)) - 1;
+        }
+
+        int slot = (int)((key >> (WHEEL_BITS * level)) & (WHEEL_SIZE - 1));
+
+        // the millisecond slots are kept in due order, searching from the
+        // tail as entries are mostly queued after those already there
+        int prev = wheelTail[level][slot];
+
+        if (level == 0)
+        {
+            while ((prev != -1) && isDueAfter(wheelEntries[prev], entry))
+            {
+                prev = wheelEntries[prev].prev;
+            }
+        }
+
+        int next = prev != -1 ? wheelEntries[prev].next : wheel[level][slot];
+
+        entry.level     = level;
+        entry.wheelSlot = slot;
+        entry.prev      = prev;
+        entry.next      = next;
+
+        if (prev != -1)
+        {
+            wheelEntries[prev].next = index;
+        }
+        else
+        {
+            wheel[level][slot] = index;
+        }
+
+        if (next != -1)
+        {
+            wheelEntries[next].prev = index;
+        }
+        else
+        {
+            wheelTail[level][slot] = index;
+        }
+    }
+
+    void unlinkWheelEntry(int index)
+    {
+        WheelEntry& entry = wheelEntries[index];
+
+        if (entry.prev != -1)
+        {
+            wheelEntries[entry.prev].next = entry.next;
+        }
+        else
+        {
+            wheel[entry.level][entry.wheelSlot] = entry.next;
+        }
+
+        if (entry.next != -1)
+        {
+            wheelEntries[entry.next].prev = entry.prev;
+        }
+        else
+        {
+            wheelTail[entry.level][entry.wheelSlot] = entry.prev;
+        }
+    }
+
+    // moves the entries of the slot at level to the levels below, as its
+    // time has come around
+    void cascade(int level, int slot)
+    {
+        int index = wheel[level][slot];
+
+        wheel[level][slot]     = -1;
+        wheelTail[level][slot] = -1;
+
+        while (index != -1)
+        {
+            int next = wheelEntries[index].next;
+
+            insertWheelEntry(index);
+
+            index = next;
+        }
+    }
+
+    // calls the queued items due at or before virtual time, a slot at a time
+    void processQueue(lua_State *L)
+    {
+        UTint64 now = (UTint64)floor(virtualTime);
+
+        // nothing to turn the wheel for, catch up with virtual time
+        if (!queuedCount && (now > wheelTime))
+        {
+            wheelTime = now;
+        }
+
+        pushRefs(L, 2);
+        lua_rawgeti(L, -1, QUEUED);
+        int queuedIdx = lua_gettop(L);
+
+        // the current slot also holds entries queued behind the wheel, which
+        // are due once virtual time reaches them
+        for ( ; ; )
+        {
+            if (cascadedTime != wheelTime)
+            {
+                cascadedTime = wheelTime;
+
+                for (int level = 1; level < WHEEL_LEVELS; level++)
+                {
+                    if (wheelTime & (((UTint64)1 << (WHEEL_BITS * level)) - 1))
+                    {
+                        break;
+                    }
+
+                    cascade(level, (int)((wheelTime >> (WHEEL_BITS * level)) & (WHEEL_SIZE - 1)));
+                }
+            }
+
+            int slot = (int)(wheelTime & (WHEEL_SIZE - 1));
+
+            // the slot is in due order, firing takes the entry out and
+            // callbacks may queue more into it
+            while ((wheel[0][slot] != -1) && (wheelEntries[wheel[0][slot]].due <= virtualTime))
+            {
+                fireQueueSlot(L, queuedIdx, wheelEntries[wheel[0][slot]].slot);
+            }
+
+            // the rest is later in the current millisecond
+            if ((wheel[0][slot] != -1) || (wheelTime > now))
+            {
+                break;
+            }
+
+            wheelTime++;
+        }
+
+        lua_pop(L, 2);
+    }
+
+    void fireQueueSlot(lua_State *L, int queuedIdx, int slot)
+    {
+        QueueSlot queueSlot = queueSlots[slot];
+
+        lua_rawgeti(L, queuedIdx, slot * 2 + 1);
+        lua_rawgeti(L, queuedIdx, slot * 2 + 2);
+
+        // the item is no longer queued when its callback runs, so it may
+        // queue itself again
+        releaseQueueSlot(L, queuedIdx, slot);
+
+        if (!queueSlot.think)
+        {
+            call(L, queueSlot.passSelf, 0);
+            return;
+        }
+
+        call(L, queueSlot.passSelf, 1);
+
+        // an empty callback means it unregistered
+        if (lua_isnil(L, -1))
+        {
+            lua_pop(L, 1);
+            return;
+        }
+
+        lua_call(L, 0, 0);
+    }
+
+    void processDeferredMethods(lua_State *L)
+    {
+        lua_rawgeti(L, 2, deferredMethodQueueOrdinal);
+        bool pending = lua_istable(L, -1) && lsr_vector_get_length(L, -1) > 0;
+        lua_pop(L, 1);
+
+        if (!pending)
+        {
+            return;
+        }
+
+        lua_rawgeti(L, 2, LSINDEXCLASS);
+        lua_pushnumber(L, processDeferredMethodsOrdinal);
+        lua_gettable(L, -2);
+        lua_pushvalue(L, 2);
+        lua_call(L, 1, 0);
+        lua_pop(L, 1);
+    }
+
+    void tick(lua_State *L)
+    {
+        if (!refsOrdinal)
+        {
+            initialize(L);
+        }
+
+        // Ticks always happen on interpolation boundary.
+        interpolationFactor = 0.0;
+
+        // Process pending events at this tick.
+        // This is done in the loop to ensure the correct order of events.
+        processDeferredMethods(L);
+        processQueue(L);
+
+        bool wasDuringAdvance = duringAdvance;
+
+        duringAdvance = true;
+        callList(L, TICKED);
+        duringAdvance = wasDuringAdvance;
+
+        // Update virtual time by subtracting from accumulator.
+        virtualTime += tickRate;
+        elapsed     -= tickRate;
+    }
+};
+
+Type *TimeScheduler::typeTimeManager;
+int  TimeScheduler::refsOrdinal;
+int  TimeScheduler::deferredMethodQueueOrdinal;
+int  TimeScheduler::processDeferredMethodsOrdinal;
+
+static int registerLoomTimeManager(lua_State *L)
+{
+    beginPackage(L, "loom.gameframework")
+
+       .beginClass<TimeScheduler>("TimeScheduler")
+
+       .addConstructor<void (*)(void)>()
+
+       .addProperty("tickRate", &TimeScheduler::getTickRate, &TimeScheduler::setTickRate)
+       .addProperty("maxTicksPerFrame", &TimeScheduler::getMaxTicksPerFrame, &TimeScheduler::setMaxTicksPerFrame)
+       .addProperty("virtualTime", &TimeScheduler::getVirtualTime, &TimeScheduler::setVirtualTime)
+       .addProperty("elapsed", &TimeScheduler::getElapsed, &TimeScheduler::setElapsed)
+       .addProperty("interpolationFactor", &TimeScheduler::getInterpolationFactor)
+       .addProperty("duringAdvance", &TimeScheduler::getDuringAdvance)
+       .addProperty("animatedCount", &TimeScheduler::getAnimatedCount)
+       .addProperty("tickedCount", &TimeScheduler::getTickedCount)
+       .addProperty("queuedCount", &TimeScheduler::getQueuedCount)
+
+       .addLuaFunction("addObject", &TimeScheduler::addObject)
+       .addLuaFunction("removeObject", &TimeScheduler::removeObject)
+       .addLuaFunction("queue", &TimeScheduler::queue)
+       .addLuaFunction("dequeue", &TimeScheduler::dequeue)
+       .addLuaFunction("advanceTicks", &TimeScheduler::advanceTicks)
+       .addLuaFunction("advanceFrame", &TimeScheduler::advanceFrame)
+       .addLuaFunction("fireTick", &TimeScheduler::fireTick)
+
+       .endClass()
+
+       .endPackage();
+
+    return 0;
+}
+}
+
+void installLoomTimeManager()
+{
+    LOOM_DECLARE_NATIVETYPE(Loom::TimeScheduler, Loom::registerLoomTimeManager);
+}
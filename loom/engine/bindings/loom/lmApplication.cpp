@@ -29,6 +29,7 @@ using namespace LS;
 #include "loom/common/platform/platformNetwork.h"
 #include "loom/common/platform/platformWebView.h"
 #include "loom/common/platform/platformTime.h"
+#include "loom/common/platform/platformIO.h"
 
 #include "loom/script/common/lsLog.h"
 #include "loom/script/common/lsFile.h"
@@ -218,6 +219,23 @@ void LoomApplication::initMainAssembly()
     rootVM->readExecutableAssemblyBinaryHeader(initBytes);
     Assembly *assembly = BinReader::loadMainAssemblyHeader();
     LoomApplicationConfig::parseApplicationConfig(assembly->getLoomConfig());
+
+    // the JIT settings apply to the main VM, so must be in place before it opens
+    LSLuaState::setJITEnabled(LoomApplicationConfig::jitEnabled());
+    for (UTsize i = 0; i < LoomApplicationConfig::jitDisabledAssemblies().size(); i++)
+    {
+        LSLuaState::disableJITForAssembly(LoomApplicationConfig::jitDisabledAssemblies()[i]);
+    }
+
+    // Mount the asset archives before anything is loaded out of them
+    for (UTsize i = 0; i < LoomApplicationConfig::assetArchives().size(); i++)
+    {
+        const char *archivePath = LoomApplicationConfig::assetArchives()[i].c_str();
+        if (!platform_mountArchive(archivePath))
+        {
+            lmLogWarn(applicationLogGroup, "Unable to mount asset archive '%s'", archivePath);
+        }
+    }
     
     Loom2D::Stage::initFromConfig();
 }
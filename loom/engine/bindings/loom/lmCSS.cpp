@@ -0,0 +1,769 @@
+/*
+ * ===========================================================================
+ * Loom SDK
+ * Copyright 2011, 2012, 2013
+ * The Game Engine Company, LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ * ===========================================================================
+ */
+
+#include "loom/script/loomscript.h"
+#include "loom/common/core/log.h"
+#include "loom/common/utils/utTypes.h"
+#include "loom/common/utils/utString.h"
+#include "loom/common/utils/utByteArray.h"
+
+lmDefineLogGroup(gCSSLogGroup, "css", 1, LoomLogInfo);
+
+using namespace LS;
+
+namespace Loom {
+// 'LCSS' read as a little endian int
+#define CSS_COMPILED_MAGIC      0x5353434C
+#define CSS_COMPILED_VERSION    1
+
+// Compiles style sheet text into the binary form read by StyleIndex::load.
+//
+// The grammar and warnings follow the script CSSParser this replaces, down
+// to the last character of the source never being read, so that existing
+// style sheets resolve to the same properties.
+//
+// Layout: magic, version, style count, then for each style block its name,
+// attribute count and attributes, property count and key, value pairs.
+class CSSCompiler
+{
+public:
+
+    CSSCompiler(const char *source, utByteArray *out)
+        : src(source ? source : ""), out(out), position(0), line(1)
+    {
+        length = (int)strlen(src);
+    }
+
+    void compile()
+    {
+        out->clear();
+        out->writeInt(CSS_COMPILED_MAGIC);
+        out->writeInt(CSS_COMPILED_VERSION);
+
+        unsigned int countPosition = out->getPosition();
+        out->writeInt(0);
+
+        int count = 0;
+        while (!end())
+        {
+            parseStyle();
+            count++;
+
+            skipCommentsAndWS();
+        }
+
+        unsigned int endPosition = out->getPosition();
+        out->setPosition(countPosition);
+        out->writeInt(count);
+        out->setPosition(endPosition);
+    }
+
+private:
+
+    const char  *src;
+    utByteArray *out;
+    int         length;
+    int         position;
+    int         line;
+
+    // properties of the block being parsed, a later key replaces the value
+    utArray<utString> keys;
+    utArray<utString> values;
+
+    char peek(int offset = 0) const
+    {
+        int at = position + offset;
+        return at >= 0 && at < length ? src[at] : 0;
+    }
+
+    void next()
+    {
+        if (peek() == '\n')
+        {
+            line++;
+        }
+
+        position++;
+    }
+
+    bool end() const
+    {
+        return position >= length - 1;
+    }
+
+    // past the last character, where peek has nothing left to match
+    bool exhausted() const
+    {
+        return position >= length;
+    }
+
+    void skipWS()
+    {
+        char c = peek();
+        while (c == ' ' || c == '\n' || c == '\t' || c == '\r')
+        {
+            next();
+            c = peek();
+        }
+    }
+
+    void skipCommentsAndWS()
+    {
+        skipWS();
+        if ((peek() == '/') && (peek(1) == '*'))
+        {
+            do
+            {
+                readUntil("*");
+                next();
+            } while (peek() != '/' && !exhausted());
+            next();
+        }
+        skipWS();
+    }
+
+    void error(const char *msg)
+    {
+        char c[2] = { peek(), 0 };
+
+        lmLogWarn(gCSSLogGroup, "Error in parsing CSS line %d char %s: %s", line, c, msg);
+    }
+
+    utString readUntil(const char *stops)
+    {
+        int start = position;
+
+        bool matched = peek() && strchr(stops, peek());
+        while (!matched)
+        {
+            next();
+            matched = peek() && strchr(stops, peek());
+
+            if (end())
+            {
+                error("EOF Reached, perhaps a string or brace is not closed?");
+                matched = true;
+            }
+        }
+
+        utString result;
+        int      stop = position < length ? position : length;
+        if (stop > start)
+        {
+            result.assign(src + start, stop - start);
+        }
+        return result;
+    }
+
+    void parseStyle()
+    {
+        skipCommentsAndWS();
+        out->writeString(readUntil("[\n\t {").c_str());
+
+        unsigned int countPosition = out->getPosition();
+        out->writeInt(0);
+
+        int attributeCount = 0;
+        if (peek() == '[')
+        {
+            // skip [
+            next();
+
+            while (peek() != ']' && !exhausted())
+            {
+                out->writeString(readUntil(" ,]").c_str());
+                attributeCount++;
+
+                if (peek() == ',')
+                {
+                    next();
+                }
+
+                skipCommentsAndWS();
+            }
+
+            // skip ]
+            next();
+        }
+
+        unsigned int endPosition = out->getPosition();
+        out->setPosition(countPosition);
+        out->writeInt(attributeCount);
+        out->setPosition(endPosition);
+
+        skipCommentsAndWS();
+
+        // skip the {
+        next();
+
+        keys.clear();
+        values.clear();
+        parseProperties();
+
+        out->writeInt((int)keys.size());
+        for (UTsize i = 0; i < keys.size(); i++)
+        {
+            out->writeString(keys[i].c_str());
+            out->writeString(values[i].c_str());
+        }
+    }
+
+    void parseProperties()
+    {
+        skipCommentsAndWS();
+
+        while (peek() != '}')
+        {
+            parseProperty();
+
+            if (end())
+            {
+                return;
+            }
+
+            skipCommentsAndWS();
+        }
+
+        // skip the }
+        next();
+    }
+
+    void parseProperty()
+    {
+        skipCommentsAndWS();
+
+        // read until some whitespace or a colon
+        utString key = readUntil(" :");
+        skipCommentsAndWS();
+
+        if (peek() != ':')
+        {
+            error("Expected ':'");
+            position = length;
+            return;
+        }
+
+        // skip ':'
+        next();
+
+        skipCommentsAndWS();
+
+        utString value;
+        char     quote = peek();
+        if ((quote == '"') || (quote == '\''))
+        {
+            // skip the first quote
+            next();
+
+            char stops[2] = { quote, 0 };
+            value = readUntil(stops);
+
+            // skip the second quote
+            next();
+        }
+        else
+        {
+            value = readUntil(";");
+        }
+
+        skipCommentsAndWS();
+        if (peek() != ';')
+        {
+            error("Expected ';'");
+        }
+
+        // skip ';'
+        next();
+
+        for (UTsize i = 0; i < keys.size(); i++)
+        {
+            if (keys[i] == key)
+            {
+                values[i] = value;
+                return;
+            }
+        }
+
+        keys.push_back(key);
+        values.push_back(value);
+    }
+};
+
+// The native side of StyleSheet.
+//
+// Holds the merged properties of every style block whose attributes are
+// defined, and caches the result of resolving the style string of a
+// display object, its type name, style names and id, so objects sharing
+// those resolve with a single hash lookup. Any change to the styles or
+// attributes drops the cache and bumps the generation.
+class StyleIndex
+{
+public:
+
+    StyleIndex() : generation(0)
+    {
+    }
+
+    ~StyleIndex()
+    {
+        for (UTsize i = 0; i < styles.size(); i++)
+        {
+            delete styles[i];
+        }
+
+        clearCache();
+    }
+
+    int getGeneration() const
+    {
+        return generation;
+    }
+
+    static bool compile(const char *css, utByteArray *out)
+    {
+        if (!out)
+        {
+            return false;
+        }
+
+        CSSCompiler compiler(css, out);
+        compiler.compile();
+        out->setPosition(0);
+        return true;
+    }
+
+    // parses style sheet text and merges its styles into the index
+    bool parse(const char *css)
+    {
+        utByteArray bytes;
+
+        compile(css, &bytes);
+        return load(&bytes);
+    }
+
+    // merges the styles of a compiled style sheet into the index
+    bool load(utByteArray *bytes)
+    {
+        if (!bytes)
+        {
+            return false;
+        }
+
+        bytes->setPosition(0);
+
+        int magic = 0, version = 0, count = 0;
+        if (!readInt(bytes, magic) || !readInt(bytes, version) || !readInt(bytes, count) ||
+            (magic != CSS_COMPILED_MAGIC) || (version != CSS_COMPILED_VERSION))
+        {
+            lmLogError(gCSSLogGroup, "Not a compiled style sheet");
+            return false;
+        }
+
+        clearCache();
+
+        utString name, key, value;
+        for (int i = 0; i < count; i++)
+        {
+            int attributeCount = 0;
+            if (!readString(bytes, name) || !readInt(bytes, attributeCount))
+            {
+                return truncated();
+            }
+
+            bool valid = true;
+            for (int j = 0; j < attributeCount; j++)
+            {
+                if (!readString(bytes, key))
+                {
+                    return truncated();
+                }
+
+                bool *defined = attributes.get(utHashedString(key));
+                if (!defined || !*defined)
+                {
+                    valid = false;
+                }
+            }
+
+            int propertyCount = 0;
+            if (!readInt(bytes, propertyCount))
+            {
+                return truncated();
+            }
+
+            Style *style = valid ? getOrCreate(name) : NULL;
+            if (style)
+            {
+                style->defined = true;
+            }
+
+            for (int j = 0; j < propertyCount; j++)
+            {
+                if (!readString(bytes, key) || !readString(bytes, value))
+                {
+                    return truncated();
+                }
+
+                if (style)
+                {
+                    setProperty(style->keys, style->values, key, value);
+                }
+            }
+        }
+
+        return true;
+    }
+
+    // styles with an attribute in brackets only apply if it is defined true
+    void defineAttribute(const char *name, bool value)
+    {
+        attributes.set(utHashedString(name ? name : ""), value);
+    }
+
+    bool hasStyle(const char *name)
+    {
+        Style *style = find(name);
+
+        return style && style->defined;
+    }
+
+    int getPropertyCount(const char *name)
+    {
+        Style *style = find(name);
+
+        return style ? (int)style->keys.size() : 0;
+    }
+
+    const char *getPropertyName(const char *name, int index)
+    {
+        Style *style = find(name);
+
+        return style && (index >= 0) && (index < (int)style->keys.size()) ? style->keys[index].c_str() : NULL;
+    }
+
+    const char *getPropertyValue(const char *name, int index)
+    {
+        Style *style = find(name);
+
+        return style && (index >= 0) && (index < (int)style->values.size()) ? style->values[index].c_str() : NULL;
+    }
+
+    // packed key, value pairs at stack 3 used in place of the properties of
+    // the style named at stack 2 until clearOverrides, as with
+    // StyleSheet.newStyle
+    int setOverride(lua_State *L)
+    {
+        Style *style = getOrCreate(utString(lua_isstring(L, 2) ? lua_tostring(L, 2) : ""));
+
+        style->overridden = true;
+        style->overrideKeys.clear();
+        style->overrideValues.clear();
+
+        if (!lua_isnil(L, 3))
+        {
+            int length = lsr_vector_get_length(L, 3);
+
+            lua_rawgeti(L, 3, LSINDEXVECTOR);
+            int vidx = lua_gettop(L);
+
+            for (int i = 0; i + 1 < length; i += 2)
+            {
+                lua_rawgeti(L, vidx, i);
+                lua_rawgeti(L, vidx, i + 1);
+
+                const char *key   = lua_tostring(L, -2);
+                const char *value = lua_tostring(L, -1);
+                setProperty(style->overrideKeys, style->overrideValues, utString(key ? key : ""), utString(value ? value : ""));
+
+                lua_pop(L, 2);
+            }
+
+            lua_pop(L, 1);
+        }
+
+        clearCache();
+        return 0;
+    }
+
+    void clearOverrides()
+    {
+        for (UTsize i = 0; i < styles.size(); i++)
+        {
+            styles[i]->overridden = false;
+            styles[i]->overrideKeys.clear();
+            styles[i]->overrideValues.clear();
+        }
+
+        clearCache();
+    }
+
+    // drops the resolved styles, handles from resolve are no longer valid
+    void clearCache()
+    {
+        for (UTsize i = 0; i < resolved.size(); i++)
+        {
+            delete resolved[i];
+        }
+
+        resolved.clear(true);
+        resolvedLookup.clear(true);
+        generation++;
+    }
+
+    // Resolves the style string DisplayObject.applyStyle builds from a type
+    // name, optional style names and optional id, merging the properties of
+    // each defined style in order. Returns a handle for getResolvedCount,
+    // getResolvedName and getResolvedValue, valid until the generation
+    // changes.
+    int resolve(const char *typeName, const char *styleName, const char *id)
+    {
+        utString selector(typeName ? typeName : "");
+
+        if (styleName)
+        {
+            selector += " ";
+            selector += styleName;
+        }
+
+        if (id)
+        {
+            selector += " .";
+            selector += id;
+        }
+
+        utHashedString key(selector);
+        int            *cached = resolvedLookup.get(key);
+        if (cached)
+        {
+            return *cached;
+        }
+
+        Resolved *result = new Resolved();
+
+        const char *names = selector.c_str();
+        utString   name;
+        for ( ; ; )
+        {
+            const char *space = strchr(names, ' ');
+            int        length = space ? (int)(space - names) : (int)strlen(names);
+
+            name.clear();
+            if (length)
+            {
+                name.assign(names, length);
+            }
+
+            Style *style = find(name.c_str());
+            if (style && style->defined)
+            {
+                utArray<utString>& keys   = style->overridden ? style->overrideKeys : style->keys;
+                utArray<utString>& values = style->overridden ? style->overrideValues : style->values;
+
+                for (UTsize i = 0; i < keys.size(); i++)
+                {
+                    setProperty(result->keys, result->values, keys[i], values[i]);
+                }
+            }
+
+            if (!space)
+            {
+                break;
+            }
+
+            names = space + 1;
+        }
+
+        int handle = (int)resolved.size();
+        resolved.push_back(result);
+        resolvedLookup.insert(key, handle);
+
+        return handle;
+    }
+
+    int getResolvedCount(int handle)
+    {
+        Resolved *result = getResolved(handle);
+
+        return result ? (int)result->keys.size() : 0;
+    }
+
+    const char *getResolvedName(int handle, int index)
+    {
+        Resolved *result = getResolved(handle);
+
+        return result && (index >= 0) && (index < (int)result->keys.size()) ? result->keys[index].c_str() : NULL;
+    }
+
+    const char *getResolvedValue(int handle, int index)
+    {
+        Resolved *result = getResolved(handle);
+
+        return result && (index >= 0) && (index < (int)result->values.size()) ? result->values[index].c_str() : NULL;
+    }
+
+private:
+
+    struct Style
+    {
+        Style() : defined(false), overridden(false) {}
+
+        // set once a block for the style passed the attribute check
+        bool              defined;
+        utArray<utString> keys;
+        utArray<utString> values;
+
+        bool              overridden;
+        utArray<utString> overrideKeys;
+        utArray<utString> overrideValues;
+    };
+
+    struct Resolved
+    {
+        utArray<utString> keys;
+        utArray<utString> values;
+    };
+
+    utArray<Style *> styles;
+    utHashTable<utHashedString, int> styleLookup;
+
+    utHashTable<utHashedString, bool> attributes;
+
+    utArray<Resolved *> resolved;
+    utHashTable<utHashedString, int> resolvedLookup;
+
+    int generation;
+
+    Style *find(const char *name)
+    {
+        int *index = styleLookup.get(utHashedString(name ? name : ""));
+
+        return index ? styles[*index] : NULL;
+    }
+
+    Style *getOrCreate(const utString& name)
+    {
+        utHashedString key(name);
+        int            *index = styleLookup.get(key);
+
+        if (index)
+        {
+            return styles[*index];
+        }
+
+        Style *style = new Style();
+        styleLookup.insert(key, (int)styles.size());
+        styles.push_back(style);
+        return style;
+    }
+
+    Resolved *getResolved(int handle)
+    {
+        return (handle >= 0) && (handle < (int)resolved.size()) ? resolved[handle] : NULL;
+    }
+
+    // later values replace earlier ones, keeping the first position
+    static void setProperty(utArray<utString>& keys, utArray<utString>& values, const utString& key, const utString& value)
+    {
+        for (UTsize i = 0; i < keys.size(); i++)
+        {
+            if (keys[i] == key)
+            {
+                values[i] = value;
+                return;
+            }
+        }
+
+        keys.push_back(key);
+        values.push_back(value);
+    }
+
+    static bool readInt(utByteArray *bytes, int& value)
+    {
+        if (bytes->bytesAvailable() < sizeof(int))
+        {
+            return false;
+        }
+
+        value = bytes->readInt();
+        return true;
+    }
+
+    static bool readString(utByteArray *bytes, utString& value)
+    {
+        unsigned int position = bytes->getPosition();
+        int          length   = 0;
+
+        if (!readInt(bytes, length) || (length < 0) || ((unsigned int)length > bytes->bytesAvailable()))
+        {
+            return false;
+        }
+
+        bytes->setPosition(position);
+        value = bytes->readString();
+        return true;
+    }
+
+    bool truncated()
+    {
+        lmLogError(gCSSLogGroup, "Compiled style sheet is truncated");
+        clearCache();
+        return false;
+    }
+};
+
+static int registerLoomCSS(lua_State *L)
+{
+    beginPackage(L, "loom.css")
+
+       .beginClass<StyleIndex>("StyleIndex")
+
+       .addConstructor<void (*)(void)>()
+
+       .addStaticMethod("compile", &StyleIndex::compile)
+
+       .addProperty("generation", &StyleIndex::getGeneration)
+
+       .addMethod("parse", &StyleIndex::parse)
+       .addMethod("load", &StyleIndex::load)
+       .addMethod("defineAttribute", &StyleIndex::defineAttribute)
+       .addMethod("hasStyle", &StyleIndex::hasStyle)
+       .addMethod("getPropertyCount", &StyleIndex::getPropertyCount)
+       .addMethod("getPropertyName", &StyleIndex::getPropertyName)
+       .addMethod("getPropertyValue", &StyleIndex::getPropertyValue)
+       .addLuaFunction("setOverride", &StyleIndex::setOverride)
+       .addMethod("clearOverrides", &StyleIndex::clearOverrides)
+       .addMethod("clearCache", &StyleIndex::clearCache)
+       .addMethod("resolve", &StyleIndex::resolve)
+       .addMethod("getResolvedCount", &StyleIndex::getResolvedCount)
+       .addMethod("getResolvedName", &StyleIndex::getResolvedName)
+       .addMethod("getResolvedValue", &StyleIndex::getResolvedValue)
+
+       .endClass()
+
+       .endPackage();
+
+    return 0;
+}
+}
+
+void installLoomCSS()
+{
+    LOOM_DECLARE_MANAGEDNATIVETYPE(Loom::StyleIndex, Loom::registerLoomCSS);
+}
@@ -0,0 +1,430 @@
+/*
+ * ===========================================================================
+ * Loom SDK
+ * Copyright 2011, 2012, 2013
+ * The Game Engine Company, LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ * ===========================================================================
+ */
+
+#include "loom/script/loomscript.h"
+#include "loom/common/core/log.h"
+#include "loom/common/utils/utTypes.h"
+#include "loom/common/utils/utString.h"
+#include "loom/common/utils/utByteArray.h"
+#include "loom/common/xml/tinyxml2.h"
+
+lmDefineLogGroup(gLMLLogGroup, "lml", 1, LoomLogInfo);
+
+using namespace LS;
+using namespace tinyxml2;
+
+namespace Loom {
+// 'LLML' read as a little endian int
+#define LML_COMPILED_MAGIC      0x4C4D4C4C
+#define LML_COMPILED_VERSION    1
+
+// An LML document flattened into its elements in document order.
+//
+// Each node keeps its type name, id and attributes, with the number and
+// boolean readings of every attribute taken once up front, and the index
+// past its last descendant, so script walks the tree without an XML DOM.
+//
+// The compiled form is: magic, version, node count, then for each node its
+// type, whether it has an id and the id, attribute count and for each
+// attribute its name, value, number and boolean, then its descendant count.
+class LMLTree
+{
+public:
+
+    LMLTree() : errorCode(XML_NO_ERROR)
+    {
+    }
+
+    int getNodeCount() const
+    {
+        return (int)nodes.size();
+    }
+
+    const char *getErrorStr1() const
+    {
+        return errorStr1.size() ? errorStr1.c_str() : NULL;
+    }
+
+    const char *getErrorStr2() const
+    {
+        return errorStr2.size() ? errorStr2.c_str() : NULL;
+    }
+
+    // compiles LML text, returns the XMLError from parsing it
+    static int compile(const char *text, utByteArray *out)
+    {
+        if (!out)
+        {
+            return XML_ERROR_PARSING;
+        }
+
+        XMLDocument document;
+        return compileDocument(document, text, out);
+    }
+
+    // parses LML text into the tree, returns the XMLError from parsing it
+    int parse(const char *text)
+    {
+        XMLDocument document;
+        utByteArray bytes;
+
+        errorCode = compileDocument(document, text, &bytes);
+        errorStr1 = document.GetErrorStr1() ? document.GetErrorStr1() : "";
+        errorStr2 = document.GetErrorStr2() ? document.GetErrorStr2() : "";
+
+        if (errorCode != XML_NO_ERROR)
+        {
+            clear();
+            return errorCode;
+        }
+
+        load(&bytes);
+        return errorCode;
+    }
+
+    // reads a compiled document into the tree
+    bool load(utByteArray *bytes)
+    {
+        clear();
+
+        if (!bytes)
+        {
+            return false;
+        }
+
+        bytes->setPosition(0);
+
+        int magic = 0, version = 0, count = 0;
+        if (!readInt(bytes, magic) || !readInt(bytes, version) || !readInt(bytes, count) ||
+            (magic != LML_COMPILED_MAGIC) || (version != LML_COMPILED_VERSION) || (count < 0) || ((unsigned int)count > bytes->bytesAvailable()))
+        {
+            lmLogError(gLMLLogGroup, "Not a compiled LML document");
+            return false;
+        }
+
+        nodes.resize(count);
+        for (int i = 0; i < count; i++)
+        {
+            Node& node = nodes[i];
+
+            int hasId = 0, attributeCount = 0, descendants = 0;
+            if (!readString(bytes, node.type) || !readInt(bytes, hasId) || !readString(bytes, node.id) ||
+                !readInt(bytes, attributeCount) || (attributeCount < 0))
+            {
+                return truncated();
+            }
+
+            node.hasId          = hasId != 0;
+            node.firstAttribute = (int)attributes.size();
+            node.attributeCount = attributeCount;
+
+            for (int j = 0; j < attributeCount; j++)
+            {
+                Attribute attribute;
+                int       boolean = 0;
+
+                if (!readString(bytes, attribute.name) || !readString(bytes, attribute.value) ||
+                    !readDouble(bytes, attribute.number) || !readInt(bytes, boolean))
+                {
+                    return truncated();
+                }
+
+                attribute.boolean = boolean != 0;
+                attributes.push_back(attribute);
+            }
+
+            if (!readInt(bytes, descendants) || (descendants < 0) || (descendants >= count - i))
+            {
+                return truncated();
+            }
+
+            node.end = i + 1 + descendants;
+        }
+
+        return true;
+    }
+
+    const char *getNodeType(int index)
+    {
+        Node *node = getNode(index);
+
+        return node ? node->type.c_str() : NULL;
+    }
+
+    // the id attribute of the node, null if it has none
+    const char *getId(int index)
+    {
+        Node *node = getNode(index);
+
+        return node && node->hasId ? node->id.c_str() : NULL;
+    }
+
+    // the index past the last descendant, which is the next sibling if any
+    int getNodeEnd(int index)
+    {
+        Node *node = getNode(index);
+
+        return node ? node->end : index + 1;
+    }
+
+    int getAttributeCount(int index)
+    {
+        Node *node = getNode(index);
+
+        return node ? node->attributeCount : 0;
+    }
+
+    const char *getAttributeName(int index, int attribute)
+    {
+        Attribute *a = getAttribute(index, attribute);
+
+        return a ? a->name.c_str() : NULL;
+    }
+
+    const char *getAttributeValue(int index, int attribute)
+    {
+        Attribute *a = getAttribute(index, attribute);
+
+        return a ? a->value.c_str() : NULL;
+    }
+
+    double getAttributeNumber(int index, int attribute)
+    {
+        Attribute *a = getAttribute(index, attribute);
+
+        return a ? a->number : 0;
+    }
+
+    bool getAttributeBoolean(int index, int attribute)
+    {
+        Attribute *a = getAttribute(index, attribute);
+
+        return a ? a->boolean : false;
+    }
+
+private:
+
+    struct Node
+    {
+        utString type;
+        bool     hasId;
+        utString id;
+        int      firstAttribute;
+        int      attributeCount;
+        int      end;
+    };
+
+    struct Attribute
+    {
+        utString name;
+        utString value;
+        double   number;
+        bool     boolean;
+    };
+
+    utArray<Node>      nodes;
+    utArray<Attribute> attributes;
+
+    int      errorCode;
+    utString errorStr1;
+    utString errorStr2;
+
+    void clear()
+    {
+        nodes.clear();
+        attributes.clear();
+    }
+
+    Node *getNode(int index)
+    {
+        return (index >= 0) && (index < (int)nodes.size()) ? &nodes[index] : NULL;
+    }
+
+    Attribute *getAttribute(int index, int attribute)
+    {
+        Node *node = getNode(index);
+
+        if (!node || (attribute < 0) || (attribute >= node->attributeCount))
+        {
+            return NULL;
+        }
+
+        return &attributes[node->firstAttribute + attribute];
+    }
+
+    static int compileDocument(XMLDocument& document, const char *text, utByteArray *out)
+    {
+        out->clear();
+
+        int code = document.Parse(text ? text : "");
+        if (code != XML_NO_ERROR)
+        {
+            return code;
+        }
+
+        out->writeInt(LML_COMPILED_MAGIC);
+        out->writeInt(LML_COMPILED_VERSION);
+
+        unsigned int countPosition = out->getPosition();
+        out->writeInt(0);
+
+        int          count = 0;
+        XMLElement   *root = document.RootElement();
+        if (root)
+        {
+            count = writeElement(root, out);
+        }
+
+        unsigned int endPosition = out->getPosition();
+        out->setPosition(countPosition);
+        out->writeInt(count);
+        out->setPosition(endPosition);
+
+        out->setPosition(0);
+        return XML_NO_ERROR;
+    }
+
+    // writes the element and its descendants, returns how many were written
+    static int writeElement(XMLElement *element, utByteArray *out)
+    {
+        const char *id = element->Attribute("id");
+
+        out->writeString(element->Value());
+        out->writeInt(id ? 1 : 0);
+        out->writeString(id);
+
+        unsigned int countPosition = out->getPosition();
+        out->writeInt(0);
+
+        int attributeCount = 0;
+        for (const XMLAttribute *attribute = element->FirstAttribute(); attribute; attribute = attribute->Next())
+        {
+            out->writeString(attribute->Name());
+            out->writeString(attribute->Value());
+            out->writeDouble(attribute->DoubleValue());
+            out->writeInt(attribute->BoolValue() ? 1 : 0);
+            attributeCount++;
+        }
+
+        unsigned int endPosition = out->getPosition();
+        out->setPosition(countPosition);
+        out->writeInt(attributeCount);
+        out->setPosition(endPosition);
+
+        // the descendant count is only known once the children are written
+        unsigned int descendantPosition = out->getPosition();
+        out->writeInt(0);
+
+        int written = 1;
+        for (XMLElement *child = element->FirstChildElement(); child; child = child->NextSiblingElement())
+        {
+            written += writeElement(child, out);
+        }
+
+        endPosition = out->getPosition();
+        out->setPosition(descendantPosition);
+        out->writeInt(written - 1);
+        out->setPosition(endPosition);
+
+        return written;
+    }
+
+    static bool readInt(utByteArray *bytes, int& value)
+    {
+        if (bytes->bytesAvailable() < sizeof(int))
+        {
+            return false;
+        }
+
+        value = bytes->readInt();
+        return true;
+    }
+
+    static bool readDouble(utByteArray *bytes, double& value)
+    {
+        if (bytes->bytesAvailable() < sizeof(double))
+        {
+            return false;
+        }
+
+        value = bytes->readDouble();
+        return true;
+    }
+
+    static bool readString(utByteArray *bytes, utString& value)
+    {
+        unsigned int position = bytes->getPosition();
+        int          length   = 0;
+
+        if (!readInt(bytes, length) || (length < 0) || ((unsigned int)length > bytes->bytesAvailable()))
+        {
+            return false;
+        }
+
+        bytes->setPosition(position);
+        value = bytes->readString();
+        return true;
+    }
+
+    bool truncated()
+    {
+        lmLogError(gLMLLogGroup, "Compiled LML document is truncated");
+        clear();
+        return false;
+    }
+};
+
+static int registerLoomLML(lua_State *L)
+{
+    beginPackage(L, "loom.lml")
+
+       .beginClass<LMLTree>("LMLTree")
+
+       .addConstructor<void (*)(void)>()
+
+       .addStaticMethod("compile", &LMLTree::compile)
+
+       .addProperty("nodeCount", &LMLTree::getNodeCount)
+       .addProperty("errorStr1", &LMLTree::getErrorStr1)
+       .addProperty("errorStr2", &LMLTree::getErrorStr2)
+
+       .addMethod("parse", &LMLTree::parse)
+       .addMethod("load", &LMLTree::load)
+       .addMethod("getNodeType", &LMLTree::getNodeType)
+       .addMethod("getId", &LMLTree::getId)
+       .addMethod("getNodeEnd", &LMLTree::getNodeEnd)
+       .addMethod("getAttributeCount", &LMLTree::getAttributeCount)
+       .addMethod("getAttributeName", &LMLTree::getAttributeName)
+       .addMethod("getAttributeValue", &LMLTree::getAttributeValue)
+       .addMethod("getAttributeNumber", &LMLTree::getAttributeNumber)
+       .addMethod("getAttributeBoolean", &LMLTree::getAttributeBoolean)
+
+       .endClass()
+
+       .endPackage();
+
+    return 0;
+}
+}
+
+void installLoomLML()
+{
+    LOOM_DECLARE_MANAGEDNATIVETYPE(Loom::LMLTree, Loom::registerLoomLML);
+}
@@ -23,6 +23,7 @@ void installPackageCocos2DX();
 void installLoomAssets();
 void installLoomBox2D();
 void installLoomPropertyManager();
+void installLoomTimeManager();
 void installLoomWebView();
 void installLoomAdMobAd();
 void installLoomHTTPRequest();
@@ -41,6 +42,8 @@ void installLoomSQLite();
 void installLoomModestMaps();
 void installLoomGameController();
 void installLoomUserDefault();
+void installLoomCSS();
+void installLoomLML();
 
 void installPackageLoom()
 {
@@ -51,6 +54,7 @@ void installPackageLoom()
     installLoomAssets();
     installLoomBox2D();
     installLoomPropertyManager();
+    installLoomTimeManager();
     installLoomNativeStore();
     installLoomVideo();
     installLoomMobile();
@@ -63,6 +67,8 @@ void installPackageLoom()
 	installLoomSystem();
     installLoomGameController();
     installLoomUserDefault();
+    installLoomCSS();
+    installLoomLML();
 
     // Should be its own package for maximum correctness.
     //installPackageCocos2DX();
@@ -21,6 +21,7 @@
 #include "loom/script/loomscript.h"
 #include "loom/script/runtime/lsRuntime.h"
 #include "loom/common/core/log.h"
+#include "loom/common/core/telemetry.h"
 #include "loom/script/native/lsNativeDelegate.h"
 #include "loom/vendor/sqlite3/sqlite3.h"
 #include "loom/common/utils/utTypes.h"
@@ -357,6 +358,8 @@ int Statement::stepAsyncProgress(void *param)
 
 int __stdcall Statement::stepAsyncBody(void *param)
 {
+    TelemetryThreadScope traceThread("sqlite step");
+
     int result;
     Statement *s;
 
@@ -364,7 +367,9 @@ int __stdcall Statement::stepAsyncBody(void *param)
     s = (Statement *)param;
 
     //call the internal SQLite step function, then yield the thread
+    LOOM_PROFILE_START(sqliteStepAsync);
     result = sqlite3_step(s->statementHandle); 
+    LOOM_PROFILE_END(sqliteStepAsync);
 
     //NOTE: shouldn't need to yield the thread here as the thread will die now anyways...
     // loom_thread_yield();
@@ -487,6 +492,9 @@ void Connection::backgroundImportDone(int result)
 
 int __stdcall Connection::backgroundImportBody(void *param)
 {
+    TelemetryThreadScope traceThread("sqlite import");
+    LOOM_PROFILE_SCOPE(sqliteBackgroundImport);
+
     int i, j;
     int numRows;
     int result;
@@ -32,6 +32,11 @@ Type       *DisplayObject::typeDisplayObject;
 lua_Number DisplayObject::_transformationMatrixOrdinal;
 bool       DisplayObject::cacheAsBitmapInProgress = false;
 
+EventDispatcher *DisplayObject::getBubbleParent() const
+{
+    return parent;
+}
+
 bool DisplayObject::renderCached(lua_State *L)
 {
     if (!cacheAsBitmapValid) return false;
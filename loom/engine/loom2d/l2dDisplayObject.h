@@ -223,6 +223,9 @@ public:
         parent = _parent;
     }
 
+    // events bubble up the display list
+    EventDispatcher *getBubbleParent() const;
+
     inline void updateLocalTransform()
     {
         if (!transformDirty)
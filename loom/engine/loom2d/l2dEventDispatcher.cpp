@@ -0,0 +1,403 @@
+/*
+ * ===========================================================================
+ * Loom SDK
+ * Copyright 2011, 2012, 2013
+ * The Game Engine Company, LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ * ===========================================================================
+ */
+
+#include "loom/engine/loom2d/l2dEventDispatcher.h"
+#include "loom/script/runtime/lsRuntime.h"
+
+namespace Loom2D
+{
+Type *EventDispatcher::typeEventDispatcher;
+Type *EventDispatcher::typeEvent;
+
+int EventDispatcher::listenersOrdinal;
+int EventDispatcher::targetOrdinal;
+int EventDispatcher::currentTargetOrdinal;
+int EventDispatcher::typeOrdinal;
+int EventDispatcher::bubblesOrdinal;
+int EventDispatcher::dataOrdinal;
+int EventDispatcher::stopsPropagationOrdinal;
+int EventDispatcher::stopsImmediatePropagationOrdinal;
+
+void EventDispatcher::initialize(lua_State *L)
+{
+    typeEventDispatcher = LSLuaState::getLuaState(L)->getType("loom2d.events.EventDispatcher");
+    lmAssert(typeEventDispatcher, "unable to get loom2d.events.EventDispatcher type");
+
+    typeEvent = LSLuaState::getLuaState(L)->getType("loom2d.events.Event");
+    lmAssert(typeEvent, "unable to get loom2d.events.Event type");
+
+    listenersOrdinal = typeEventDispatcher->getMemberOrdinal("mEventListeners");
+
+    targetOrdinal                    = typeEvent->getMemberOrdinal("mTarget");
+    currentTargetOrdinal             = typeEvent->getMemberOrdinal("mCurrentTarget");
+    typeOrdinal                      = typeEvent->getMemberOrdinal("mType");
+    bubblesOrdinal                   = typeEvent->getMemberOrdinal("mBubbles");
+    dataOrdinal                      = typeEvent->getMemberOrdinal("mData");
+    stopsPropagationOrdinal          = typeEvent->getMemberOrdinal("mStopsPropagation");
+    stopsImmediatePropagationOrdinal = typeEvent->getMemberOrdinal("mStopsImmediatePropagation");
+}
+
+
+void EventDispatcher::pushListeners(lua_State *L, int dispatcherIdx, int typeIdx)
+{
+    lua_rawgeti(L, dispatcherIdx, listenersOrdinal);
+
+    if (lua_isnil(L, -1))
+    {
+        return;
+    }
+
+    lua_rawgeti(L, -1, LSINDEXDICTPAIRS);
+    lua_pushvalue(L, typeIdx);
+    lua_rawget(L, -2);
+    lua_replace(L, -3);
+    lua_pop(L, 1);
+}
+
+
+void EventDispatcher::prepareListenersForWrite(lua_State *L, int dispatcherIdx, int typeIdx)
+{
+    lua_rawgeti(L, -1, 0);
+    bool dispatching = !lua_isnil(L, -1);
+    lua_pop(L, 1);
+
+    if (!dispatching)
+    {
+        return;
+    }
+
+    // a dispatch is iterating the list, it keeps the original
+    int n = (int)lua_objlen(L, -1);
+
+    lua_createtable(L, n, 0);
+    for (int j = 1; j <= n; j++)
+    {
+        lua_rawgeti(L, -2, j);
+        lua_rawseti(L, -2, j);
+    }
+
+    lua_replace(L, -2);
+
+    lua_rawgeti(L, dispatcherIdx, listenersOrdinal);
+    lua_rawgeti(L, -1, LSINDEXDICTPAIRS);
+    lua_pushvalue(L, typeIdx);
+    lua_pushvalue(L, -4);
+    lua_rawset(L, -3);
+    lua_pop(L, 2);
+}
+
+
+int EventDispatcher::addListener(lua_State *L)
+{
+    if (!listenersOrdinal)
+    {
+        initialize(L);
+    }
+
+    lmAssert(lua_isfunction(L, 3), "EventDispatcher.addEventListener called with a null listener");
+
+    pushListeners(L, 1, 2);
+
+    if (lua_isnil(L, -1))
+    {
+        lua_pop(L, 1);
+        lua_newtable(L);
+
+        lua_rawgeti(L, 1, listenersOrdinal);
+        lua_rawgeti(L, -1, LSINDEXDICTPAIRS);
+        lua_pushvalue(L, 2);
+        lua_pushvalue(L, -4);
+        lua_rawset(L, -3);
+        lua_pop(L, 2);
+    }
+    else
+    {
+        // check for duplicates
+        int n = (int)lua_objlen(L, -1);
+        for (int i = 1; i <= n; i += 2)
+        {
+            lua_rawgeti(L, -1, i);
+            bool duplicate = lua_rawequal(L, -1, 3) != 0;
+            lua_pop(L, 1);
+
+            if (duplicate)
+            {
+                return 0;
+            }
+        }
+
+        prepareListenersForWrite(L, 1, 2);
+    }
+
+    int n = (int)lua_objlen(L, -1);
+
+    lua_pushvalue(L, 3);
+    lua_rawseti(L, -2, n + 1);
+
+    // the parameter count decides how the listener is called, it is
+    // looked up once here rather than on every dispatch
+    lua_pushnumber(L, lsr_function_get_numparameters(L, 3));
+    lua_rawseti(L, -2, n + 2);
+
+    return 0;
+}
+
+
+int EventDispatcher::removeListener(lua_State *L)
+{
+    if (!listenersOrdinal)
+    {
+        initialize(L);
+    }
+
+    pushListeners(L, 1, 2);
+
+    if (lua_isnil(L, -1))
+    {
+        return 0;
+    }
+
+    int n     = (int)lua_objlen(L, -1);
+    int index = 0;
+
+    for (int i = 1; i <= n; i += 2)
+    {
+        lua_rawgeti(L, -1, i);
+        bool found = lua_rawequal(L, -1, 3) != 0;
+        lua_pop(L, 1);
+
+        if (found)
+        {
+            index = i;
+            break;
+        }
+    }
+
+    if (!index)
+    {
+        return 0;
+    }
+
+    if (n == 2)
+    {
+        // last listener of the type, drop the list
+        lua_rawgeti(L, 1, listenersOrdinal);
+        lua_rawgeti(L, -1, LSINDEXDICTPAIRS);
+        lua_pushvalue(L, 2);
+        lua_pushnil(L);
+        lua_rawset(L, -3);
+        return 0;
+    }
+
+    prepareListenersForWrite(L, 1, 2);
+
+    for (int i = index; i < n - 1; i++)
+    {
+        lua_rawgeti(L, -1, i + 2);
+        lua_rawseti(L, -2, i);
+    }
+
+    lua_pushnil(L);
+    lua_rawseti(L, -2, n);
+    lua_pushnil(L);
+    lua_rawseti(L, -2, n - 1);
+
+    return 0;
+}
+
+
+bool EventDispatcher::invokeListeners(lua_State *L, int dispatcherIdx, int eventIdx)
+{
+    int top = lua_gettop(L);
+
+    lua_rawgeti(L, eventIdx, typeOrdinal);
+    pushListeners(L, dispatcherIdx, top + 1);
+
+    int listIdx = top + 2;
+    int n       = lua_istable(L, listIdx) ? (int)lua_objlen(L, listIdx) : 0;
+
+    if (!n)
+    {
+        lua_settop(L, top);
+        return false;
+    }
+
+    lua_pushvalue(L, dispatcherIdx);
+    lua_rawseti(L, eventIdx, currentTargetOrdinal);
+
+    // listeners added or removed while we loop go to a copy of the list,
+    // the dispatch depth is kept in the list so a listener raising an error
+    // can't leave it behind anywhere else: the next change just copies it
+    lua_rawgeti(L, listIdx, 0);
+    int depth = (int)lua_tonumber(L, -1);
+    lua_pop(L, 1);
+
+    lua_pushnumber(L, depth + 1);
+    lua_rawseti(L, listIdx, 0);
+
+    bool stop = false;
+
+    for (int i = 1; i <= n; i += 2)
+    {
+        lua_rawgeti(L, listIdx, i);
+        lua_rawgeti(L, listIdx, i + 1);
+        int numArgs = (int)lua_tonumber(L, -1);
+        lua_pop(L, 1);
+
+        if (numArgs == 0)
+        {
+            lua_call(L, 0, 0);
+        }
+        else if (numArgs == 1)
+        {
+            lua_pushvalue(L, eventIdx);
+            lua_call(L, 1, 0);
+        }
+        else
+        {
+            lua_pushvalue(L, eventIdx);
+            lua_rawgeti(L, eventIdx, dataOrdinal);
+            lua_call(L, 2, 0);
+        }
+
+        lua_rawgeti(L, eventIdx, stopsImmediatePropagationOrdinal);
+        stop = lua_toboolean(L, -1) != 0;
+        lua_pop(L, 1);
+
+        if (stop)
+        {
+            break;
+        }
+    }
+
+    if (depth)
+    {
+        lua_pushnumber(L, depth);
+    }
+    else
+    {
+        lua_pushnil(L);
+    }
+
+    lua_rawseti(L, listIdx, 0);
+
+    if (!stop)
+    {
+        lua_rawgeti(L, eventIdx, stopsPropagationOrdinal);
+        stop = lua_toboolean(L, -1) != 0;
+    }
+
+    lua_settop(L, top);
+
+    return stop;
+}
+
+
+void EventDispatcher::bubbleEvent(lua_State *L, int dispatcherIdx, int eventIdx)
+{
+    // we determine the bubble chain before starting to invoke the listeners,
+    // that way changes done by the listeners won't affect the bubble chain
+    int top = lua_gettop(L);
+
+    lua_pushvalue(L, dispatcherIdx);
+
+    EventDispatcher *element = (EventDispatcher *)lualoom_getnativepointer(L, dispatcherIdx);
+
+    for (element = element ? element->getBubbleParent() : NULL; element; element = element->getBubbleParent())
+    {
+        luaL_checkstack(L, 1, "event bubble chain too deep");
+        lualoom_pushnative<EventDispatcher>(L, element);
+    }
+
+    int chainEnd = lua_gettop(L);
+
+    for (int i = top + 1; i <= chainEnd; i++)
+    {
+        if (invokeListeners(L, i, eventIdx))
+        {
+            break;
+        }
+    }
+
+    lua_settop(L, top);
+}
+
+
+int EventDispatcher::dispatch(lua_State *L)
+{
+    if (!listenersOrdinal)
+    {
+        initialize(L);
+    }
+
+    // we save the current target and restore it later;
+    // this allows users to re-dispatch events without creating a clone.
+    lua_rawgeti(L, 2, targetOrdinal);
+    int previousTargetIdx = lua_gettop(L);
+
+    lua_pushvalue(L, 1);
+    lua_rawseti(L, 2, targetOrdinal);
+
+    lua_rawgeti(L, 2, bubblesOrdinal);
+    bool bubbles = lua_toboolean(L, -1) != 0;
+    lua_pop(L, 1);
+
+    if (bubbles)
+    {
+        bubbleEvent(L, 1, 2);
+    }
+    else
+    {
+        invokeListeners(L, 1, 2);
+    }
+
+    if (!lua_isnil(L, previousTargetIdx))
+    {
+        lua_pushvalue(L, previousTargetIdx);
+        lua_rawseti(L, 2, targetOrdinal);
+    }
+
+    return 0;
+}
+
+
+int EventDispatcher::bubble(lua_State *L)
+{
+    if (!listenersOrdinal)
+    {
+        initialize(L);
+    }
+
+    bubbleEvent(L, 1, 2);
+    return 0;
+}
+
+
+int EventDispatcher::invoke(lua_State *L)
+{
+    if (!listenersOrdinal)
+    {
+        initialize(L);
+    }
+
+    lua_pushboolean(L, invokeListeners(L, 1, 2));
+    return 1;
+}
+}
@@ -18,12 +18,20 @@
  * ===========================================================================
  */
 
+#include "loom/common/utils/utTypes.h"
 #include "loom/script/loomscript.h"
 
 #pragma once
 
 namespace Loom2D
 {
+// Native side of the EventDispatcher script class. The script class keeps
+// its listeners in a Dictionary from event type to a listener list; the
+// lists are plain Lua arrays owned by the natives here, holding each
+// listener followed by its parameter count. Lists are copied when they are
+// changed during a dispatch over them, which is counted at their index 0, so
+// removing a listener doesn't allocate, and dispatching reads the event fields and walks the bubble
+// chain natively without any script allocations.
 class EventDispatcher
 {
 public:
@@ -31,5 +39,55 @@ public:
     virtual ~EventDispatcher()
     {
     }
+
+    // The dispatcher an event bubbles to next, DisplayObjects bubble to
+    // their parent.
+    virtual EventDispatcher *getBubbleParent() const
+    {
+        return NULL;
+    }
+
+    // cache member ordinals
+    static void initialize(lua_State *L);
+
+    // Script static natives, stack: dispatcher, type, listener.
+    static int addListener(lua_State *L);
+    static int removeListener(lua_State *L);
+
+    // Script static natives, stack: dispatcher, event.
+    static int dispatch(lua_State *L);
+    static int bubble(lua_State *L);
+    static int invoke(lua_State *L);
+
+protected:
+
+    static Type *typeEventDispatcher;
+    static Type *typeEvent;
+
+    static int listenersOrdinal;
+    static int targetOrdinal;
+    static int currentTargetOrdinal;
+    static int typeOrdinal;
+    static int bubblesOrdinal;
+    static int dataOrdinal;
+    static int stopsPropagationOrdinal;
+    static int stopsImmediatePropagationOrdinal;
+
+private:
+
+    // Pushes the listener list of type for the dispatcher at index, or nil.
+    static void pushListeners(lua_State *L, int dispatcherIdx, int typeIdx);
+
+    // Replaces the list at the top of the stack with a copy if it is being
+    // dispatched, storing the copy for type.
+    static void prepareListenersForWrite(lua_State *L, int dispatcherIdx, int typeIdx);
+
+    // Invokes the listeners of the dispatcher at index, returns true if
+    // the event stopped propagating.
+    static bool invokeListeners(lua_State *L, int dispatcherIdx, int eventIdx);
+
+    // Invokes along the chain from the dispatcher at index up the bubble
+    // parents, stopping where propagation is stopped.
+    static void bubbleEvent(lua_State *L, int dispatcherIdx, int eventIdx);
 };
 }
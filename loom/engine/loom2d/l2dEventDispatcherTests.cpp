@@ -0,0 +1,207 @@
+/*
+ * ===========================================================================
+ * Loom SDK
+ * Copyright 2011, 2012, 2013
+ * The Game Engine Company, LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ * ===========================================================================
+ */
+
+#include "seatest.h"
+#include "loom/engine/loom2d/l2dEventDispatcher.h"
+#include "loom/script/runtime/lsRuntime.h"
+
+using namespace Loom2D;
+
+SEATEST_FIXTURE(l2dEventDispatcher)
+{
+    SEATEST_FIXTURE_ENTRY(eventDispatcher_listenerArguments);
+    SEATEST_FIXTURE_ENTRY(eventDispatcher_changesDuringDispatch);
+    SEATEST_FIXTURE_ENTRY(eventDispatcher_stopImmediatePropagation);
+    SEATEST_FIXTURE_ENTRY(eventDispatcher_listenerError);
+}
+
+// The natives only use the member ordinals of the script classes, so the
+// tests stand in plain tables for dispatchers and events.
+class EventDispatcherTestTypes : public EventDispatcher
+{
+public:
+
+    static void setOrdinals()
+    {
+        listenersOrdinal                 = 1;
+        targetOrdinal                    = 1;
+        currentTargetOrdinal             = 2;
+        typeOrdinal                      = 3;
+        bubblesOrdinal                   = 4;
+        dataOrdinal                      = 5;
+        stopsPropagationOrdinal          = 6;
+        stopsImmediatePropagationOrdinal = 7;
+    }
+};
+
+// Dispatchers are { [1] = { [LSINDEXDICTPAIRS] = {} } } and events
+// { [3] = type, [5] = data }. Script listeners have their parameter count in
+// a __ls_funcinfo_arginfo upvalue, listener() makes one that logs its name.
+static const char *eventDispatcherFixture =
+    "local pairsIndex = ...\n"
+    "log = ''\n"
+    "function dispatcher() return { { [pairsIndex] = {} } } end\n"
+    "function event(type, data) return { nil, nil, type, false, data, false, false } end\n"
+    "function listeners(d, type) return d[1][pairsIndex][type] end\n"
+    "function listener(name, numParameters, body)\n"
+    "    local __ls_funcinfo_arginfo = numParameters * 65536\n"
+    "    return function(...)\n"
+    "        local _ = __ls_funcinfo_arginfo\n"
+    "        log = log .. name .. select('#', ...)\n"
+    "        if body then body(...) end\n"
+    "    end\n"
+    "end\n";
+
+static lua_State *newEventDispatcherState()
+{
+    EventDispatcherTestTypes::setOrdinals();
+
+    lua_State *L = luaL_newstate();
+    luaL_openlibs(L);
+
+    lua_newtable(L);
+    lua_rawseti(L, LUA_GLOBALSINDEX, LSINDEXMETHODLOOKUP);
+
+    lua_register(L, "add", EventDispatcher::addListener);
+    lua_register(L, "remove", EventDispatcher::removeListener);
+    lua_register(L, "dispatch", EventDispatcher::dispatch);
+
+    luaL_loadstring(L, eventDispatcherFixture);
+    lua_pushnumber(L, LSINDEXDICTPAIRS);
+    lua_call(L, 1, 0);
+
+    return L;
+}
+
+
+// Runs a test chunk, returning the listener log or the error message.
+static const char *run(lua_State *L, const char *chunk)
+{
+    if (luaL_loadstring(L, chunk) || lua_pcall(L, 0, 0, 0))
+    {
+        return lua_tostring(L, -1);
+    }
+
+    lua_getglobal(L, "log");
+    return lua_tostring(L, -1);
+}
+
+
+SEATEST_TEST(eventDispatcher_listenerArguments)
+{
+    lua_State *L = newEventDispatcherState();
+
+    // listeners get nothing, the event or the event and its data depending
+    // on their parameter count, adding one twice is ignored
+    assert_string_equal("a0b1c2a0b1c2",
+                        run(L,
+                            "local d = dispatcher()\n"
+                            "local a, b, c = listener('a', 0), listener('b', 1), listener('c', 2)\n"
+                            "add(d, 'x', a) add(d, 'x', b) add(d, 'x', c) add(d, 'x', a)\n"
+                            "add(d, 'y', b)\n"
+                            "dispatch(d, event('x'))\n"
+                            "dispatch(d, event('x', 1))\n"));
+
+    assert_string_equal("ok",
+                        run(L,
+                            "local d = dispatcher()\n"
+                            "local e = event('x')\n"
+                            "add(d, 'x', listener('a', 1, function(e) assert(e[1] == d and e[2] == d) end))\n"
+                            "dispatch(d, e)\n"
+                            "log = listeners(d, 'x')[0] == nil and 'ok' or 'depth left'\n"));
+
+    lua_close(L);
+}
+
+
+SEATEST_TEST(eventDispatcher_changesDuringDispatch)
+{
+    lua_State *L = newEventDispatcherState();
+
+    // a dispatch calls the listeners it started with, changes apply to the
+    // next one
+    assert_string_equal("a1b1a1c1",
+                        run(L,
+                            "local d = dispatcher()\n"
+                            "local b, c = listener('b', 1), listener('c', 1)\n"
+                            "add(d, 'x', listener('a', 1, function() remove(d, 'x', b) add(d, 'x', c) end))\n"
+                            "add(d, 'x', b)\n"
+                            "dispatch(d, event('x'))\n"
+                            "dispatch(d, event('x'))\n"));
+
+    // nested dispatches over the same list, a listener removed by the inner
+    // one is still called by the outer one
+    assert_string_equal("a1a1b1b1",
+                        run(L,
+                            "log = ''\n"
+                            "local d = dispatcher()\n"
+                            "local nested = false\n"
+                            "local a\n"
+                            "a = listener('a', 1, function()\n"
+                            "    if not nested then nested = true dispatch(d, event('x')) end\n"
+                            "    remove(d, 'x', a)\n"
+                            "end)\n"
+                            "add(d, 'x', a)\n"
+                            "add(d, 'x', listener('b', 1))\n"
+                            "dispatch(d, event('x'))\n"
+                            "assert(listeners(d, 'x')[0] == nil)\n"
+                            "dispatch(d, event('y'))\n"));
+
+    lua_close(L);
+}
+
+
+SEATEST_TEST(eventDispatcher_stopImmediatePropagation)
+{
+    lua_State *L = newEventDispatcherState();
+
+    assert_string_equal("a1",
+                        run(L,
+                            "local d = dispatcher()\n"
+                            "add(d, 'x', listener('a', 1, function(e) e[7] = true end))\n"
+                            "add(d, 'x', listener('b', 1))\n"
+                            "dispatch(d, event('x'))\n"));
+
+    lua_close(L);
+}
+
+
+SEATEST_TEST(eventDispatcher_listenerError)
+{
+    lua_State *L = newEventDispatcherState();
+
+    // a listener raising an error leaves its list marked as dispatched, the
+    // next change replaces it and dispatching carries on as before
+    assert_string_equal("a1b1c1",
+                        run(L,
+                            "local d = dispatcher()\n"
+                            "local b, c = listener('b', 1), listener('c', 1)\n"
+                            "local a = listener('a', 1, function() error('listener failed') end)\n"
+                            "add(d, 'x', a)\n"
+                            "add(d, 'x', b)\n"
+                            "assert(not pcall(dispatch, d, event('x')))\n"
+                            "local list = listeners(d, 'x')\n"
+                            "remove(d, 'x', a)\n"
+                            "add(d, 'x', c)\n"
+                            "assert(listeners(d, 'x') ~= list and listeners(d, 'x')[0] == nil)\n"
+                            "dispatch(d, event('x'))\n"));
+
+    lua_close(L);
+}
@@ -0,0 +1,965 @@
+/*
+ * ===========================================================================
+ * Loom SDK
+ * Copyright 2011, 2012, 2013
+ * The Game Engine Company, LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ * ===========================================================================
+ */
+
+#include "loom/engine/loom2d/l2dLayoutSolver.h"
+#include "loom/script/runtime/lsRuntime.h"
+
+#include <string.h>
+#include <limits>
+
+namespace Loom2D
+{
+static const lmscalar kNaN      = std::numeric_limits<lmscalar>::quiet_NaN();
+static const lmscalar kInfinity = std::numeric_limits<lmscalar>::infinity();
+
+static inline bool isNaN(lmscalar value)
+{
+    return value != value;
+}
+
+
+static inline bool sameValue(lmscalar a, lmscalar b)
+{
+    return a == b || (isNaN(a) && isNaN(b));
+}
+
+
+// Math.max and Math.min as script sees them, a NaN in either argument is
+// kept or dropped depending on its position
+static inline lmscalar scriptMax(lmscalar a, lmscalar b)
+{
+    return a >= b ? a : b;
+}
+
+
+static inline lmscalar scriptMin(lmscalar a, lmscalar b)
+{
+    return a <= b ? a : b;
+}
+
+
+// offset of a run of totalSize inside availableSize for an alignment
+static inline lmscalar alignOffset(int align, lmscalar totalSize, lmscalar availableSize)
+{
+    if (!(totalSize < availableSize))
+    {
+        return 0;
+    }
+
+    if (align == LayoutSolver::ALIGN_END)
+    {
+        return availableSize - totalSize;
+    }
+
+    if (align == LayoutSolver::ALIGN_CENTER)
+    {
+        return (availableSize - totalSize) / 2;
+    }
+
+    return 0;
+}
+
+
+LayoutSolver::LayoutSolver()
+{
+    mode                = MODE_VERTICAL;
+    gap                 = horizontalGap = verticalGap = 0;
+    paddingTop          = paddingRight = paddingBottom = paddingLeft = 0;
+    horizontalAlign     = verticalAlign = ALIGN_START;
+    tileHorizontalAlign = tileVerticalAlign = ALIGN_CENTER;
+    paging              = PAGING_NONE;
+    useVirtualLayout    = false;
+    useSquareTiles      = false;
+    manageVisibility    = false;
+    typicalItemWidth    = typicalItemHeight = 0;
+    leadingSpace        = trailingSpace = 0;
+    boundsX             = boundsY = 0;
+    scrollX             = scrollY = 0;
+    explicitWidth       = explicitHeight = kNaN;
+    minWidth            = minHeight = 0;
+    maxWidth            = maxHeight = kInfinity;
+
+    contentWidth = contentHeight = 0;
+    viewPortWidth = viewPortHeight = 0;
+
+    firstDirty = 0;
+
+    memset(&last, 0, sizeof(last));
+}
+
+
+void LayoutSolver::setItemCount(int count)
+{
+    lmAssert(count >= 0, "LayoutSolver.itemCount must not be negative");
+
+    int oldCount = (int)items.size();
+
+    if (count == oldCount)
+    {
+        return;
+    }
+
+    Item item;
+
+    item.size[0]     = item.size[1] = kNaN;
+    item.pos[0]      = item.pos[1] = 0;
+    item.assigned[0] = item.assigned[1] = kNaN;
+    item.start       = item.cursorAfter = item.crossAfter = 0;
+    item.present     = false;
+    item.excluded    = item.listed = false;
+    item.visible     = true;
+
+    items.resize(count, item);
+
+    markDirty(count < oldCount ? count : oldCount);
+}
+
+
+void LayoutSolver::invalidate()
+{
+    firstDirty = 0;
+}
+
+
+lmscalar LayoutSolver::getItemX(int index) const
+{
+    lmAssert(index >= 0 && index < (int)items.size(), "LayoutSolver.getItemX index %d out of range", index);
+    return items[index].pos[0];
+}
+
+
+lmscalar LayoutSolver::getItemY(int index) const
+{
+    lmAssert(index >= 0 && index < (int)items.size(), "LayoutSolver.getItemY index %d out of range", index);
+    return items[index].pos[1];
+}
+
+
+lmscalar LayoutSolver::getAssignedWidth(int index) const
+{
+    lmAssert(index >= 0 && index < (int)items.size(), "LayoutSolver.getAssignedWidth index %d out of range", index);
+    return items[index].assigned[0];
+}
+
+
+lmscalar LayoutSolver::getAssignedHeight(int index) const
+{
+    lmAssert(index >= 0 && index < (int)items.size(), "LayoutSolver.getAssignedHeight index %d out of range", index);
+    return items[index].assigned[1];
+}
+
+
+void LayoutSolver::setSize(int index, lmscalar width, lmscalar height)
+{
+    Item& item = items[index];
+
+    if (!sameValue(item.size[0], width) || !sameValue(item.size[1], height))
+    {
+        item.size[0] = width;
+        item.size[1] = height;
+        markDirty(index);
+    }
+}
+
+
+void LayoutSolver::setSizes(const lmscalar *sizes, int first, int count)
+{
+    lmAssert(first >= 0, "LayoutSolver.setSizes first index must not be negative");
+
+    if (first + count > (int)items.size())
+    {
+        setItemCount(first + count);
+    }
+
+    for (int i = 0; i < count; i++)
+    {
+        setSize(first + i, sizes[i * 2], sizes[i * 2 + 1]);
+    }
+}
+
+
+int LayoutSolver::setSizes(lua_State *L)
+{
+    int first = (int)lua_tonumber(L, 3);
+    int count = lsr_vector_get_length(L, 2) / 2;
+
+    lmAssert(first >= 0, "LayoutSolver.setSizes first index must not be negative");
+
+    if (first + count > (int)items.size())
+    {
+        setItemCount(first + count);
+    }
+
+    lua_rawgeti(L, 2, LSINDEXVECTOR);
+
+    for (int i = 0; i < count; i++)
+    {
+        lua_rawgeti(L, -1, i * 2);
+        lua_rawgeti(L, -2, i * 2 + 1);
+        setSize(first + i, (lmscalar)lua_tonumber(L, -2), (lmscalar)lua_tonumber(L, -1));
+        lua_pop(L, 2);
+    }
+
+    lua_pop(L, 1);
+
+    return 0;
+}
+
+
+void LayoutSolver::setAnchors(const lmscalar *rules, int first, int count)
+{
+    lmAssert(first >= 0, "LayoutSolver.setAnchors first index must not be negative");
+
+    int end = (first + count) * LAYOUTSOLVER_ANCHOR_STRIDE;
+    if (end > (int)anchors.size())
+    {
+        anchors.resize(end, kNaN);
+    }
+
+    memcpy(anchors.ptr() + first * LAYOUTSOLVER_ANCHOR_STRIDE, rules, count * LAYOUTSOLVER_ANCHOR_STRIDE * sizeof(lmscalar));
+}
+
+
+int LayoutSolver::setAnchors(lua_State *L)
+{
+    int first = (int)lua_tonumber(L, 3);
+    int count = lsr_vector_get_length(L, 2);
+
+    lmAssert(first >= 0, "LayoutSolver.setAnchors first index must not be negative");
+    lmAssert(count % LAYOUTSOLVER_ANCHOR_STRIDE == 0, "LayoutSolver.setAnchors expects %d values per item", LAYOUTSOLVER_ANCHOR_STRIDE);
+
+    int end = first * LAYOUTSOLVER_ANCHOR_STRIDE + count;
+    if (end > (int)anchors.size())
+    {
+        anchors.resize(end, kNaN);
+    }
+
+    lua_rawgeti(L, 2, LSINDEXVECTOR);
+
+    lmscalar *rule = anchors.ptr() + first * LAYOUTSOLVER_ANCHOR_STRIDE;
+    for (int i = 0; i < count; i++)
+    {
+        lua_rawgeti(L, -1, i);
+        rule[i] = lua_isnil(L, -1) ? kNaN : (lmscalar)lua_tonumber(L, -1);
+        lua_pop(L, 1);
+    }
+
+    lua_pop(L, 1);
+
+    return 0;
+}
+
+
+void LayoutSolver::setExcluded(const int *indices, int count)
+{
+    int itemCount = (int)items.size();
+
+    for (int i = 0; i < count; i++)
+    {
+        lmAssert(indices[i] >= 0 && indices[i] < itemCount, "LayoutSolver.setExcluded index %d out of range", indices[i]);
+        items[indices[i]].listed = true;
+    }
+
+    for (int i = 0; i < itemCount; i++)
+    {
+        Item& item = items[i];
+
+        if (item.excluded != item.listed)
+        {
+            item.excluded = item.listed;
+            markDirty(i);
+        }
+
+        item.listed = false;
+    }
+}
+
+
+int LayoutSolver::setExcluded(lua_State *L)
+{
+    int count = lsr_vector_get_length(L, 2);
+
+    excludedIndices.resize(count);
+
+    lua_rawgeti(L, 2, LSINDEXVECTOR);
+
+    for (int i = 0; i < count; i++)
+    {
+        lua_rawgeti(L, -1, i);
+        excludedIndices[i] = (int)lua_tonumber(L, -1);
+        lua_pop(L, 1);
+    }
+
+    lua_pop(L, 1);
+
+    setExcluded(excludedIndices.ptr(), count);
+
+    return 0;
+}
+
+
+void LayoutSolver::takeSnapshot(Snapshot& snapshot) const
+{
+    memset(&snapshot, 0, sizeof(snapshot));
+
+    snapshot.mode              = mode;
+    snapshot.gap               = gap;
+    snapshot.padding[0]        = paddingTop;
+    snapshot.padding[1]        = paddingRight;
+    snapshot.padding[2]        = paddingBottom;
+    snapshot.padding[3]        = paddingLeft;
+    snapshot.leadingSpace      = leadingSpace;
+    snapshot.boundsX           = boundsX;
+    snapshot.boundsY           = boundsY;
+    snapshot.typicalItemWidth  = typicalItemWidth;
+    snapshot.typicalItemHeight = typicalItemHeight;
+    snapshot.useVirtualLayout  = useVirtualLayout;
+}
+
+
+bool LayoutSolver::snapshotChanged() const
+{
+    Snapshot current;
+
+    takeSnapshot(current);
+    return memcmp(&current, &last, sizeof(current)) != 0;
+}
+
+
+void LayoutSolver::layout(DisplayObject **objects, int count)
+{
+    lmAssert(count == (int)items.size(), "LayoutSolver.layout was given %d items for %d measurements", count, (int)items.size());
+
+    targets.resize(count);
+
+    for (int i = 0; i < count; i++)
+    {
+        targets[i] = objects[i];
+    }
+
+    layoutTargets();
+}
+
+
+int LayoutSolver::layout(lua_State *L)
+{
+    int count = lsr_vector_get_length(L, 2);
+
+    lmAssert(count == (int)items.size(), "LayoutSolver.layout was given %d items for %d measurements", count, (int)items.size());
+
+    targets.resize(count);
+
+    lua_rawgeti(L, 2, LSINDEXVECTOR);
+    int vectorIdx = lua_gettop(L);
+
+    for (int i = 0; i < count; i++)
+    {
+        lua_rawgeti(L, vectorIdx, i);
+        targets[i] = lua_isnil(L, -1) ? NULL : (DisplayObject *)lualoom_getnativepointer(L, -1);
+        lua_pop(L, 1);
+    }
+
+    lua_pop(L, 1);
+
+    layoutTargets();
+
+    return 0;
+}
+
+
+void LayoutSolver::layoutTargets()
+{
+    int count = (int)targets.size();
+
+    for (int i = 0; i < count; i++)
+    {
+        Item& item = items[i];
+        item.assigned[0] = item.assigned[1] = kNaN;
+
+        if (item.present != (targets[i] != NULL))
+        {
+            item.present = targets[i] != NULL;
+            markDirty(i);
+        }
+    }
+
+    if (snapshotChanged())
+    {
+        firstDirty = 0;
+    }
+
+    switch (mode)
+    {
+    case MODE_VERTICAL:
+        solveLinear(1);
+        break;
+
+    case MODE_HORIZONTAL:
+        solveLinear(0);
+        break;
+
+    case MODE_TILED_ROWS:
+        solveTiled(0);
+        break;
+
+    case MODE_TILED_COLUMNS:
+        solveTiled(1);
+        break;
+
+    case MODE_ANCHOR:
+        solveAnchors();
+        break;
+
+    default:
+        lmAssert(false, "LayoutSolver has an unknown mode %d", mode);
+    }
+
+    takeSnapshot(last);
+    firstDirty = count;
+
+    // write what moved, an unchanged item keeps its cached transform
+    bool writeVisible = manageVisibility && mode != MODE_ANCHOR;
+
+    for (int i = 0; i < count; i++)
+    {
+        DisplayObject *target = targets[i];
+        const Item&   item    = items[i];
+
+        if (!target || (mode != MODE_ANCHOR && isNaN(item.size[0])))
+        {
+            continue;
+        }
+
+        if (target->x != item.pos[0])
+        {
+            target->setX(item.pos[0]);
+        }
+
+        if (target->y != item.pos[1])
+        {
+            target->setY(item.pos[1]);
+        }
+
+        if (writeVisible && (target->visible != item.visible))
+        {
+            target->setVisible(item.visible);
+        }
+    }
+}
+
+
+void LayoutSolver::solveLinear(int mainAxis)
+{
+    const int crossAxis = 1 - mainAxis;
+
+    const lmscalar bounds[2]       = { boundsX, boundsY };
+    const lmscalar scroll[2]       = { scrollX, scrollY };
+    const lmscalar paddingStart[2] = { paddingLeft, paddingTop };
+    const lmscalar paddingEnd[2]   = { paddingRight, paddingBottom };
+    const lmscalar explicitSize[2] = { explicitWidth, explicitHeight };
+    const lmscalar minSize[2]      = { minWidth, minHeight };
+    const lmscalar maxSize[2]      = { maxWidth, maxHeight };
+    const lmscalar typical[2]      = { typicalItemWidth, typicalItemHeight };
+    const int      align[2]        = { horizontalAlign, verticalAlign };
+
+    int count = (int)items.size();
+    int first = firstDirty < count ? firstDirty : count;
+
+    // pick up the running position where the first changed item starts
+    lmscalar cursor;
+    lmscalar maxCross;
+
+    if (first == 0)
+    {
+        cursor   = bounds[mainAxis] + paddingStart[mainAxis] + leadingSpace;
+        maxCross = useVirtualLayout ? typical[crossAxis] : 0;
+    }
+    else
+    {
+        cursor   = items[first - 1].cursorAfter;
+        maxCross = items[first - 1].crossAfter;
+    }
+
+    for (int i = first; i < count; i++)
+    {
+        Item& item = items[i];
+
+        if (!isNaN(item.size[0]) && !item.excluded)
+        {
+            item.start = cursor;
+            cursor    += item.size[mainAxis] + gap;
+
+            if (item.present)
+            {
+                maxCross = scriptMax(maxCross, item.size[crossAxis]);
+            }
+        }
+
+        item.cursorAfter = cursor;
+        item.crossAfter  = maxCross;
+    }
+
+    cursor += trailingSpace;
+
+    lmscalar totalCross     = maxCross + paddingStart[crossAxis] + paddingEnd[crossAxis];
+    lmscalar availableCross = isNaN(explicitSize[crossAxis]) ? scriptMin(maxSize[crossAxis], scriptMax(minSize[crossAxis], totalCross)) : explicitSize[crossAxis];
+
+    lmscalar totalMain     = cursor - gap + paddingEnd[mainAxis] - bounds[mainAxis];
+    lmscalar availableMain = isNaN(explicitSize[mainAxis]) ? scriptMin(maxSize[mainAxis], scriptMax(minSize[mainAxis], totalMain)) : explicitSize[mainAxis];
+
+    lmscalar mainOffset = alignOffset(align[mainAxis], totalMain, availableMain);
+
+    lmscalar crossStart = bounds[crossAxis] + paddingStart[crossAxis];
+    lmscalar crossInner = availableCross - paddingStart[crossAxis] - paddingEnd[crossAxis];
+
+    for (int i = 0; i < count; i++)
+    {
+        Item& item = items[i];
+
+        if (!item.present || isNaN(item.size[0]))
+        {
+            continue;
+        }
+
+        // an excluded item takes no space but is aligned where it is
+        if (item.excluded)
+        {
+            item.pos[mainAxis] = (mainAxis == 0 ? targets[i]->x : targets[i]->y) + mainOffset;
+        }
+        else
+        {
+            item.pos[mainAxis] = item.start + mainOffset;
+        }
+
+        switch (align[crossAxis])
+        {
+        case ALIGN_END:
+            item.pos[crossAxis] = bounds[crossAxis] + availableCross - paddingEnd[crossAxis] - item.size[crossAxis];
+            break;
+
+        case ALIGN_CENTER:
+            item.pos[crossAxis] = crossStart + (crossInner - item.size[crossAxis]) / 2;
+            break;
+
+        case ALIGN_JUSTIFY:
+            item.pos[crossAxis]      = crossStart;
+            item.assigned[crossAxis] = crossInner;
+            break;
+
+        default:
+            item.pos[crossAxis] = crossStart;
+        }
+
+        item.visible = (item.pos[mainAxis] + item.size[mainAxis] >= bounds[mainAxis] + scroll[mainAxis]) &&
+                       (item.pos[mainAxis] < scroll[mainAxis] + availableMain);
+    }
+
+    lmscalar content[2];
+    lmscalar viewPort[2];
+
+    content[mainAxis]   = totalMain;
+    content[crossAxis]  = align[crossAxis] == ALIGN_JUSTIFY ? availableCross : totalCross;
+    viewPort[mainAxis]  = availableMain;
+    viewPort[crossAxis] = availableCross;
+
+    contentWidth   = content[0];
+    contentHeight  = content[1];
+    viewPortWidth  = viewPort[0];
+    viewPortHeight = viewPort[1];
+}
+
+
+void LayoutSolver::solveTiled(int flowAxis)
+{
+    // items flow along flowAxis and wrap onto the next line of tiles along
+    // stackAxis; rows flow horizontally, columns vertically
+    const int stackAxis = 1 - flowAxis;
+
+    const lmscalar bounds[2]       = { boundsX, boundsY };
+    const lmscalar scroll[2]       = { scrollX, scrollY };
+    const lmscalar tileGap[2]      = { horizontalGap, verticalGap };
+    const lmscalar paddingStart[2] = { paddingLeft, paddingTop };
+    const lmscalar paddingEnd[2]   = { paddingRight, paddingBottom };
+    const lmscalar minSize[2]      = { minWidth, minHeight };
+    const lmscalar maxSize[2]      = { maxWidth, maxHeight };
+    const int      align[2]        = { horizontalAlign, verticalAlign };
+    const int      tileAlign[2]    = { tileHorizontalAlign, tileVerticalAlign };
+    const int      pagingAxis      = paging == PAGING_HORIZONTAL ? 0 : (paging == PAGING_VERTICAL ? 1 : -1);
+
+    int count = (int)items.size();
+
+    // a virtual layout assumes that all items are the size of the typical
+    // item, otherwise the tile fits the largest item
+    lmscalar tile[2];
+
+    tile[0] = useSquareTiles ? scriptMax(scriptMax(0, typicalItemWidth), typicalItemHeight) : typicalItemWidth;
+    tile[1] = useSquareTiles ? tile[0] : typicalItemHeight;
+
+    if (!useVirtualLayout)
+    {
+        for (int i = 0; i < count; i++)
+        {
+            const Item& item = items[i];
+
+            if (!item.present || isNaN(item.size[0]) || item.excluded)
+            {
+                continue;
+            }
+
+            tile[0] = useSquareTiles ? scriptMax(scriptMax(tile[0], item.size[0]), item.size[1]) : scriptMax(tile[0], item.size[0]);
+            tile[1] = useSquareTiles ? scriptMax(tile[0], tile[1]) : scriptMax(tile[1], item.size[1]);
+        }
+    }
+
+    lmscalar available[2] = { explicitWidth, explicitHeight };
+    lmscalar tileCount[2];
+
+    tileCount[flowAxis]  = scriptMax(1, (lmscalar)count);
+    tileCount[stackAxis] = 1;
+
+    for (int axis = 0; axis < 2; axis++)
+    {
+        if (isNaN(available[axis]))
+        {
+            available[axis] = maxSize[axis];
+        }
+
+        if (!isNaN(available[axis]))
+        {
+            lmscalar singleTile = scriptMax(1, tile[axis] + tileGap[axis]);
+            tileCount[axis] = scriptMax(1, floor((available[axis] - paddingStart[axis] - paddingEnd[axis] + tileGap[axis]) / singleTile));
+        }
+    }
+
+    lmscalar totalPage[2];
+    lmscalar availablePage[2];
+    lmscalar start[2];
+
+    for (int axis = 0; axis < 2; axis++)
+    {
+        totalPage[axis]     = tileCount[axis] * (tile[axis] + tileGap[axis]) - tileGap[axis] + paddingStart[axis] + paddingEnd[axis];
+        availablePage[axis] = isNaN(available[axis]) ? totalPage[axis] : available[axis];
+        start[axis]         = bounds[axis] + paddingStart[axis];
+    }
+
+    const lmscalar perPage = tileCount[0] * tileCount[1];
+
+    lmscalar pageIndex          = 0;
+    lmscalar nextPageStartIndex = perPage;
+    lmscalar itemIndex          = 0;
+    lmscalar pageStart[2]       = { start[0], start[1] };
+    lmscalar cursor[2]          = { start[0], start[1] };
+    int      lastPageStart      = 0;
+
+    for (int i = 0; i < count; i++)
+    {
+        Item& item = items[i];
+
+        if (isNaN(item.size[0]) || item.excluded)
+        {
+            continue;
+        }
+
+        // TiledColumnsLayout counts the excluded items when it wraps
+        lmscalar wrapIndex = flowAxis == 0 ? itemIndex : (lmscalar)i;
+
+        if ((itemIndex != 0) && (fmod(wrapIndex, tileCount[flowAxis]) == 0))
+        {
+            cursor[flowAxis]   = pageStart[flowAxis];
+            cursor[stackAxis] += tile[stackAxis] + tileGap[stackAxis];
+        }
+
+        if (itemIndex == nextPageStartIndex)
+        {
+            lastPageStart = i;
+            pageIndex++;
+            nextPageStartIndex += perPage;
+
+            if (pagingAxis == flowAxis)
+            {
+                cursor[flowAxis]  = pageStart[flowAxis] = start[flowAxis] + available[flowAxis] * pageIndex;
+                cursor[stackAxis] = start[stackAxis];
+            }
+            else if (pagingAxis == stackAxis)
+            {
+                cursor[stackAxis] = start[stackAxis] + available[stackAxis] * pageIndex;
+            }
+        }
+
+        if (item.present)
+        {
+            for (int axis = 0; axis < 2; axis++)
+            {
+                switch (tileAlign[axis])
+                {
+                case ALIGN_JUSTIFY:
+                    item.pos[axis]      = cursor[axis];
+                    item.assigned[axis] = tile[axis];
+                    break;
+
+                case ALIGN_START:
+                    item.pos[axis] = cursor[axis];
+                    break;
+
+                case ALIGN_END:
+                    item.pos[axis] = cursor[axis] + tile[axis] - item.size[axis];
+                    break;
+
+                default:
+                    item.pos[axis] = cursor[axis] + (tile[axis] - item.size[axis]) / 2;
+                }
+            }
+        }
+
+        cursor[flowAxis] += tile[flowAxis] + tileGap[flowAxis];
+        itemIndex++;
+    }
+
+    lmscalar total[2];
+
+    total[flowAxis] = totalPage[flowAxis];
+    if (!isNaN(available[flowAxis]) && (pagingAxis == flowAxis))
+    {
+        total[flowAxis] = ceil(count / perPage) * available[flowAxis];
+    }
+
+    total[stackAxis] = cursor[stackAxis] + tile[stackAxis] + paddingEnd[stackAxis];
+    if (!isNaN(available[stackAxis]))
+    {
+        if (pagingAxis == flowAxis)
+        {
+            total[stackAxis] = available[stackAxis];
+        }
+        else if (pagingAxis == stackAxis)
+        {
+            total[stackAxis] = ceil(count / perPage) * available[stackAxis];
+        }
+    }
+
+    for (int axis = 0; axis < 2; axis++)
+    {
+        if (isNaN(available[axis]))
+        {
+            available[axis] = total[axis];
+        }
+
+        available[axis] = scriptMax(minSize[axis], available[axis]);
+    }
+
+    // every page is aligned the same way, within the page when paging and
+    // within the whole layout otherwise
+    lmscalar offset[2];
+
+    for (int axis = 0; axis < 2; axis++)
+    {
+        offset[axis] = pagingAxis >= 0 ? alignOffset(align[axis], totalPage[axis], availablePage[axis])
+                                       : alignOffset(align[axis], total[axis], available[axis]);
+    }
+
+    for (int i = 0; i < count; i++)
+    {
+        Item& item = items[i];
+
+        if (!item.present || isNaN(item.size[0]))
+        {
+            continue;
+        }
+
+        // an excluded item takes no tile but is aligned where it is
+        if (item.excluded)
+        {
+            item.pos[0] = targets[i]->x + offset[0];
+            item.pos[1] = targets[i]->y + offset[1];
+        }
+        else
+        {
+            item.pos[0] += offset[0];
+            item.pos[1] += offset[1];
+        }
+
+        // a virtual layout with paging only manages the visibility of its
+        // last page, the same as the script layouts did
+        if (useVirtualLayout && (pagingAxis >= 0) && (i < lastPageStart))
+        {
+            item.visible = targets[i]->visible;
+            continue;
+        }
+
+        lmscalar size = isNaN(item.assigned[stackAxis]) ? item.size[stackAxis] : item.assigned[stackAxis];
+
+        item.visible = (item.pos[stackAxis] + size >= bounds[stackAxis] + scroll[stackAxis]) &&
+                       (item.pos[stackAxis] < scroll[stackAxis] + available[stackAxis]);
+    }
+
+    contentWidth   = total[0];
+    contentHeight  = total[1];
+    viewPortWidth  = available[0];
+    viewPortHeight = available[1];
+}
+
+
+// rule layout, per axis: start edge, end edge, center, then the same three
+// as indices of the items they are relative to (-1 for the bounds)
+enum
+{
+    ANCHOR_LEFT,
+    ANCHOR_RIGHT,
+    ANCHOR_HORIZONTAL_CENTER,
+    ANCHOR_TOP,
+    ANCHOR_BOTTOM,
+    ANCHOR_VERTICAL_CENTER,
+    ANCHOR_REFERENCE
+};
+
+static inline bool hasAnchorRule(const lmscalar *rule)
+{
+    for (int i = 0; i < ANCHOR_REFERENCE; i++)
+    {
+        if (!isNaN(rule[i]) || (rule[ANCHOR_REFERENCE + i] >= 0))
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+
+void LayoutSolver::positionAnchored(int index, int axis)
+{
+    const lmscalar *rule = anchors.ptr() + index * LAYOUTSOLVER_ANCHOR_STRIDE;
+
+    const int startSlot  = axis == 0 ? ANCHOR_LEFT : ANCHOR_TOP;
+    const int endSlot    = startSlot + 1;
+    const int centerSlot = startSlot + 2;
+
+    const int startRef  = isNaN(rule[ANCHOR_REFERENCE + startSlot]) ? -1 : (int)rule[ANCHOR_REFERENCE + startSlot];
+    const int endRef    = isNaN(rule[ANCHOR_REFERENCE + endSlot]) ? -1 : (int)rule[ANCHOR_REFERENCE + endSlot];
+    const int centerRef = isNaN(rule[ANCHOR_REFERENCE + centerSlot]) ? -1 : (int)rule[ANCHOR_REFERENCE + centerSlot];
+
+    const lmscalar bounds   = axis == 0 ? boundsX : boundsY;
+    const lmscalar viewPort = axis == 0 ? explicitWidth : explicitHeight;
+
+    Item& item = items[index];
+
+    const lmscalar startEdge = rule[startSlot];
+    const lmscalar endEdge   = rule[endSlot];
+    const lmscalar center    = rule[centerSlot];
+
+    const bool hasStart  = !isNaN(startEdge);
+    const bool hasEnd    = !isNaN(endEdge);
+    const bool hasCenter = !isNaN(center);
+
+    if (hasStart)
+    {
+        if (startRef >= 0)
+        {
+            const Item& anchor = items[startRef];
+            item.pos[axis] = anchor.pos[axis] + anchor.size[axis] + startEdge;
+        }
+        else
+        {
+            item.pos[axis] = bounds + startEdge;
+        }
+    }
+
+    if (hasEnd)
+    {
+        if (hasStart)
+        {
+            lmscalar span = viewPort;
+            if (endRef >= 0)
+            {
+                span = items[endRef].pos[axis];
+            }
+            if (startRef >= 0)
+            {
+                span -= items[startRef].pos[axis] + items[startRef].size[axis];
+            }
+
+            item.size[axis] = item.assigned[axis] = span - endEdge - startEdge;
+        }
+        else if (hasCenter)
+        {
+            lmscalar centerPos = centerRef >= 0 ? items[centerRef].pos[axis] + items[centerRef].size[axis] / 2 + center : viewPort / 2 + center;
+            lmscalar endPos    = endRef >= 0 ? items[endRef].pos[axis] - endEdge : viewPort - endEdge;
+
+            item.size[axis] = item.assigned[axis] = 2 * (endPos - centerPos);
+            item.pos[axis]  = viewPort - endEdge - item.size[axis];
+        }
+        else if (endRef >= 0)
+        {
+            item.pos[axis] = items[endRef].pos[axis] - item.size[axis] - endEdge;
+        }
+        else
+        {
+            item.pos[axis] = bounds + viewPort - endEdge - item.size[axis];
+        }
+    }
+    else if (hasCenter)
+    {
+        lmscalar centerPos = centerRef >= 0 ? items[centerRef].pos[axis] + items[centerRef].size[axis] / 2 + center : viewPort / 2 + center;
+
+        if (hasStart)
+        {
+            item.size[axis] = item.assigned[axis] = 2 * (centerPos - item.pos[axis]);
+        }
+        else
+        {
+            item.pos[axis] = centerPos - item.size[axis] / 2;
+        }
+    }
+}
+
+
+void LayoutSolver::solveAnchors()
+{
+    int count = (int)items.size();
+
+    if ((int)anchors.size() < count * LAYOUTSOLVER_ANCHOR_STRIDE)
+    {
+        anchors.resize(count * LAYOUTSOLVER_ANCHOR_STRIDE, kNaN);
+    }
+
+    // items are positioned relative to where their anchors are now
+    for (int i = 0; i < count; i++)
+    {
+        Item& item = items[i];
+
+        item.pos[0] = targets[i] ? targets[i]->x : 0;
+        item.pos[1] = targets[i] ? targets[i]->y : 0;
+    }
+
+    // AnchorLayout only defers an item anchored to an earlier item which
+    // was itself deferred, which never happens to the first one, so every
+    // item is positioned in order in a single pass. An item anchored to a
+    // later one uses where that one was before this layout.
+    for (int i = 0; i < count; i++)
+    {
+        if (!hasAnchorRule(anchors.ptr() + i * LAYOUTSOLVER_ANCHOR_STRIDE))
+        {
+            continue;
+        }
+
+        positionAnchored(i, 0);
+        positionAnchored(i, 1);
+    }
+}
+}
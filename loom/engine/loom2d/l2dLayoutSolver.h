@@ -0,0 +1,238 @@
+/*
+ * ===========================================================================
+ * Loom SDK
+ * Copyright 2011, 2012, 2013
+ * The Game Engine Company, LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ * ===========================================================================
+ */
+
+#pragma once
+
+#include "loom/engine/loom2d/l2dDisplayObject.h"
+
+namespace Loom2D
+{
+// Number of values per item in the packed vector given to setAnchors.
+#define LAYOUTSOLVER_ANCHOR_STRIDE    12
+
+// Positions a list of display objects from packed item measurements.
+//
+// Script measures the items once into a vector of width, height pairs
+// (a NaN width leaves the item out of the layout) and calls layout with
+// the items themselves; the solver writes x, y and visible straight into
+// the native DisplayObject fields and only touches the ones which moved.
+// Excluded items, those with includeInLayout off, take no space in the
+// flow but are still aligned from where they are.
+// Sizes the layout decides on, such as justified widths, are left for
+// script to assign through getAssignedWidth and getAssignedHeight since
+// most controls implement width and height in script.
+//
+// Vertical and horizontal layouts keep the running position of every
+// item, so when only a range of measurements changed the next layout
+// resumes from the first changed item instead of starting over.
+class LayoutSolver
+{
+public:
+
+    enum Mode
+    {
+        MODE_VERTICAL,
+        MODE_HORIZONTAL,
+        MODE_TILED_ROWS,
+        MODE_TILED_COLUMNS,
+        MODE_ANCHOR
+    };
+
+    enum Align
+    {
+        ALIGN_START,
+        ALIGN_CENTER,
+        ALIGN_END,
+        ALIGN_JUSTIFY
+    };
+
+    enum Paging
+    {
+        PAGING_NONE,
+        PAGING_HORIZONTAL,
+        PAGING_VERTICAL
+    };
+
+    int      mode;
+
+    lmscalar gap;
+    lmscalar horizontalGap;
+    lmscalar verticalGap;
+
+    lmscalar paddingTop;
+    lmscalar paddingRight;
+    lmscalar paddingBottom;
+    lmscalar paddingLeft;
+
+    int      horizontalAlign;
+    int      verticalAlign;
+    int      tileHorizontalAlign;
+    int      tileVerticalAlign;
+    int      paging;
+
+    bool     useVirtualLayout;
+    bool     useSquareTiles;
+    bool     manageVisibility;
+
+    lmscalar typicalItemWidth;
+    lmscalar typicalItemHeight;
+
+    // space taken by virtualized items before and after the measured ones
+    lmscalar leadingSpace;
+    lmscalar trailingSpace;
+
+    lmscalar boundsX;
+    lmscalar boundsY;
+    lmscalar scrollX;
+    lmscalar scrollY;
+    lmscalar explicitWidth;
+    lmscalar explicitHeight;
+    lmscalar minWidth;
+    lmscalar minHeight;
+    lmscalar maxWidth;
+    lmscalar maxHeight;
+
+    LayoutSolver();
+
+    int getItemCount() const
+    {
+        return (int)items.size();
+    }
+
+    void setItemCount(int count);
+
+    // forget the cached positions, the next layout starts from the first item
+    void invalidate();
+
+    lmscalar getContentWidth() const { return contentWidth; }
+    lmscalar getContentHeight() const { return contentHeight; }
+    lmscalar getViewPortWidth() const { return viewPortWidth; }
+    lmscalar getViewPortHeight() const { return viewPortHeight; }
+
+    lmscalar getItemX(int index) const;
+    lmscalar getItemY(int index) const;
+
+    // the size the last layout gave an item, NaN if it kept its own
+    lmscalar getAssignedWidth(int index) const;
+    lmscalar getAssignedHeight(int index) const;
+
+    // count width, height pairs copied over the items starting at first
+    void setSizes(const lmscalar *sizes, int first, int count);
+
+    // Script version of setSizes. Stack: this, sizes vector, first.
+    int setSizes(lua_State *L);
+
+    // anchor rules for count items copied over the items starting at
+    // first, see LAYOUTSOLVER_ANCHOR_STRIDE
+    void setAnchors(const lmscalar *rules, int first, int count);
+
+    // Script version of setAnchors. Stack: this, rules vector, first.
+    int setAnchors(lua_State *L);
+
+    // the items at these indices are excluded, all others are included
+    void setExcluded(const int *indices, int count);
+
+    // Script version of setExcluded. Stack: this, indices vector.
+    int setExcluded(lua_State *L);
+
+    // solves the layout for count objects, which may be NULL, and writes
+    // the positions to them
+    void layout(DisplayObject **objects, int count);
+
+    // Script version of layout. Stack: this, Vector.<DisplayObject>.
+    int layout(lua_State *L);
+
+private:
+
+    struct Item
+    {
+        // width and height as measured by script
+        lmscalar size[2];
+
+        // resolved position, and the size the layout assigned or NaN
+        lmscalar pos[2];
+        lmscalar assigned[2];
+
+        // position along the main axis before alignment, and the running
+        // main position and cross size after this item, for resuming
+        lmscalar start;
+        lmscalar cursorAfter;
+        lmscalar crossAfter;
+
+        bool present;
+        bool excluded;
+        bool visible;
+
+        // set while setExcluded goes through its indices
+        bool listed;
+    };
+
+    // the configuration the cached positions were computed with
+    struct Snapshot
+    {
+        int      mode;
+        lmscalar gap;
+        lmscalar padding[4];
+        lmscalar leadingSpace;
+        lmscalar boundsX, boundsY;
+        lmscalar typicalItemWidth, typicalItemHeight;
+        bool     useVirtualLayout;
+    };
+
+    utArray<Item>            items;
+    utArray<lmscalar>        anchors;
+    utArray<DisplayObject *> targets;
+
+    // indices read by the script version of setExcluded
+    utArray<int> excludedIndices;
+
+    // the first item whose measurement changed since the last layout
+    int firstDirty;
+
+    Snapshot last;
+
+    lmscalar contentWidth;
+    lmscalar contentHeight;
+    lmscalar viewPortWidth;
+    lmscalar viewPortHeight;
+
+    void markDirty(int index)
+    {
+        if (index < firstDirty)
+        {
+            firstDirty = index;
+        }
+    }
+
+    void setSize(int index, lmscalar width, lmscalar height);
+
+    void takeSnapshot(Snapshot& snapshot) const;
+    bool snapshotChanged() const;
+
+    // solves the layout for the objects in targets
+    void layoutTargets();
+
+    void solveLinear(int mainAxis);
+    void solveTiled(int flowAxis);
+    void solveAnchors();
+
+    void positionAnchored(int index, int axis);
+};
+}
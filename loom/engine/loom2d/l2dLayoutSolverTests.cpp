@@ -0,0 +1,471 @@
+/*
+ * ===========================================================================
+ * Loom SDK
+ * Copyright 2011, 2012, 2013
+ * The Game Engine Company, LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ * ===========================================================================
+ */
+
+#include "seatest.h"
+#include "loom/engine/loom2d/l2dLayoutSolver.h"
+
+#include <limits>
+
+using namespace Loom2D;
+
+SEATEST_FIXTURE(l2dLayoutSolver)
+{
+    SEATEST_FIXTURE_ENTRY(layoutSolver_vertical);
+    SEATEST_FIXTURE_ENTRY(layoutSolver_horizontal);
+    SEATEST_FIXTURE_ENTRY(layoutSolver_resume);
+    SEATEST_FIXTURE_ENTRY(layoutSolver_tiledRows);
+    SEATEST_FIXTURE_ENTRY(layoutSolver_tiledRowsPaging);
+    SEATEST_FIXTURE_ENTRY(layoutSolver_tiledColumns);
+    SEATEST_FIXTURE_ENTRY(layoutSolver_anchors);
+}
+
+// The expected positions are what the feathers layouts computed in script
+// before they moved to the solver, for the same items and settings.
+
+#define LAYOUTTEST_MAX_ITEMS    10
+
+// Display objects for a test, boxes holds x, y, width and height for each
+// and the sizes are packed the way the layouts measure them.
+struct LayoutTestItems
+{
+    DisplayObject objects[LAYOUTTEST_MAX_ITEMS];
+    DisplayObject *targets[LAYOUTTEST_MAX_ITEMS];
+    lmscalar      sizes[LAYOUTTEST_MAX_ITEMS * 2];
+    int           count;
+
+    LayoutTestItems(const lmscalar *boxes, int _count)
+    {
+        count = _count;
+
+        for (int i = 0; i < count; i++)
+        {
+            objects[i].x     = boxes[i * 4];
+            objects[i].y     = boxes[i * 4 + 1];
+            targets[i]       = &objects[i];
+            sizes[i * 2]     = boxes[i * 4 + 2];
+            sizes[i * 2 + 1] = boxes[i * 4 + 3];
+        }
+    }
+
+    void layout(LayoutSolver& solver, const int *excluded = NULL, int excludedCount = 0)
+    {
+        solver.setItemCount(count);
+        solver.setSizes(sizes, 0, count);
+        solver.setExcluded(excluded, excludedCount);
+        solver.layout(targets, count);
+    }
+};
+
+
+SEATEST_TEST(layoutSolver_vertical)
+{
+    static const lmscalar boxes[] =
+    {
+        0, 0, 30, 10,
+        5, 7, 20,  8,
+        0, 0, 50, 12,
+        0, 0, 40,  6
+    };
+    static const int excluded[] = { 1 };
+
+    LayoutSolver solver;
+
+    solver.mode             = LayoutSolver::MODE_VERTICAL;
+    solver.gap              = 2;
+    solver.paddingTop       = 3;
+    solver.paddingRight     = 4;
+    solver.paddingBottom    = 5;
+    solver.paddingLeft      = 6;
+    solver.horizontalAlign  = LayoutSolver::ALIGN_CENTER;
+    solver.verticalAlign    = LayoutSolver::ALIGN_CENTER;
+    solver.manageVisibility = true;
+    solver.boundsX          = 10;
+    solver.boundsY          = 20;
+    solver.explicitWidth    = 100;
+    solver.explicitHeight   = 80;
+
+    // the excluded item takes no space but is still aligned where it is
+    static const lmscalar centered[] =
+    {
+        46, 43,
+        51, 27,
+        36, 55,
+        41, 69
+    };
+
+    LayoutTestItems items(boxes, 4);
+    items.layout(solver, excluded, 1);
+
+    for (int i = 0; i < 4; i++)
+    {
+        assert_double_equal(centered[i * 2], items.objects[i].x, 0.001);
+        assert_double_equal(centered[i * 2 + 1], items.objects[i].y, 0.001);
+        assert_true(items.objects[i].visible);
+    }
+
+    assert_double_equal(60, solver.getContentWidth(), 0.001);
+    assert_double_equal(40, solver.getContentHeight(), 0.001);
+    assert_double_equal(100, solver.getViewPortWidth(), 0.001);
+    assert_double_equal(80, solver.getViewPortHeight(), 0.001);
+
+    solver.horizontalAlign = LayoutSolver::ALIGN_JUSTIFY;
+    solver.verticalAlign   = LayoutSolver::ALIGN_END;
+    solver.boundsX         = solver.boundsY = 0;
+    solver.scrollY         = 16;
+    solver.explicitWidth   = std::numeric_limits<lmscalar>::quiet_NaN();
+    solver.explicitHeight  = 20;
+
+    // justified items, the excluded one too, and the ones scrolled past
+    // hidden
+    static const lmscalar justified[] =
+    {
+        6,  3, 0,
+        6,  7, 0,
+        6, 15, 1,
+        6, 29, 1
+    };
+
+    LayoutTestItems scrolled(boxes, 4);
+    scrolled.layout(solver, excluded, 1);
+
+    for (int i = 0; i < 4; i++)
+    {
+        assert_double_equal(justified[i * 3], scrolled.objects[i].x, 0.001);
+        assert_double_equal(justified[i * 3 + 1], scrolled.objects[i].y, 0.001);
+        assert_int_equal((int)justified[i * 3 + 2], scrolled.objects[i].visible);
+        assert_double_equal(50, solver.getAssignedWidth(i), 0.001);
+    }
+
+    assert_double_equal(60, solver.getContentWidth(), 0.001);
+    assert_double_equal(40, solver.getContentHeight(), 0.001);
+    assert_double_equal(60, solver.getViewPortWidth(), 0.001);
+    assert_double_equal(20, solver.getViewPortHeight(), 0.001);
+}
+
+
+SEATEST_TEST(layoutSolver_horizontal)
+{
+    static const lmscalar boxes[] =
+    {
+        0, 0, 10, 30,
+        3, 4,  8, 20,
+        0, 0, 12, 50
+    };
+    static const int excluded[] = { 1 };
+
+    LayoutSolver solver;
+
+    solver.mode             = LayoutSolver::MODE_HORIZONTAL;
+    solver.gap              = 1;
+    solver.horizontalAlign  = LayoutSolver::ALIGN_END;
+    solver.verticalAlign    = LayoutSolver::ALIGN_JUSTIFY;
+    solver.manageVisibility = true;
+    solver.scrollX          = 48;
+    solver.explicitWidth    = 60;
+
+    static const lmscalar expected[] =
+    {
+        37, 0, 0,
+        40, 0, 1,
+        48, 0, 1
+    };
+
+    LayoutTestItems items(boxes, 3);
+    items.layout(solver, excluded, 1);
+
+    for (int i = 0; i < 3; i++)
+    {
+        assert_double_equal(expected[i * 3], items.objects[i].x, 0.001);
+        assert_double_equal(expected[i * 3 + 1], items.objects[i].y, 0.001);
+        assert_int_equal((int)expected[i * 3 + 2], items.objects[i].visible);
+        assert_double_equal(50, solver.getAssignedHeight(i), 0.001);
+    }
+
+    assert_double_equal(23, solver.getContentWidth(), 0.001);
+    assert_double_equal(50, solver.getContentHeight(), 0.001);
+    assert_double_equal(60, solver.getViewPortWidth(), 0.001);
+    assert_double_equal(50, solver.getViewPortHeight(), 0.001);
+}
+
+
+SEATEST_TEST(layoutSolver_resume)
+{
+    static const lmscalar boxes[] =
+    {
+        0, 0, 10, 10,
+        0, 0, 10, 20,
+        0, 0, 10, 30,
+        0, 0, 10, 40,
+        0, 0, 10, 50
+    };
+
+    LayoutSolver solver;
+
+    solver.mode = LayoutSolver::MODE_VERTICAL;
+    solver.gap  = 1;
+
+    LayoutTestItems items(boxes, 5);
+    items.layout(solver);
+
+    // growing an item moves the ones after it, starting over from the
+    // cached position of the one before
+    items.sizes[2 * 2 + 1] = 35;
+    items.layout(solver);
+
+    static const lmscalar expected[] = { 0, 11, 32, 68, 109 };
+
+    for (int i = 0; i < 5; i++)
+    {
+        assert_double_equal(0, items.objects[i].x, 0.001);
+        assert_double_equal(expected[i], items.objects[i].y, 0.001);
+    }
+
+    assert_double_equal(159, solver.getContentHeight(), 0.001);
+}
+
+
+SEATEST_TEST(layoutSolver_tiledRows)
+{
+    static const lmscalar boxes[] =
+    {
+        0, 0, 20, 10,
+        0, 0, 10, 20,
+        1, 2,  5,  5,
+        0, 0, 15, 15,
+        0, 0, 20, 20,
+        0, 0,  8,  8
+    };
+    static const int excluded[] = { 2 };
+
+    LayoutSolver solver;
+
+    solver.mode             = LayoutSolver::MODE_TILED_ROWS;
+    solver.horizontalGap    = 2;
+    solver.verticalGap      = 3;
+    solver.paddingTop       = solver.paddingRight = solver.paddingBottom = solver.paddingLeft = 1;
+    solver.horizontalAlign  = LayoutSolver::ALIGN_CENTER;
+    solver.verticalAlign    = LayoutSolver::ALIGN_END;
+    solver.manageVisibility = true;
+    solver.scrollY          = 70;
+    solver.explicitWidth    = 70;
+    solver.explicitHeight   = 100;
+
+    // the excluded item takes no tile, is aligned where it is and is
+    // scrolled out of view
+    static const lmscalar expected[] =
+    {
+          3,   61, 1,
+         30,   56, 1,
+          3,   57, 0,
+        49.5, 58.5, 1,
+          3,   79, 1,
+         31,   85, 1
+    };
+
+    LayoutTestItems items(boxes, 6);
+    items.layout(solver, excluded, 1);
+
+    for (int i = 0; i < 6; i++)
+    {
+        assert_double_equal(expected[i * 3], items.objects[i].x, 0.001);
+        assert_double_equal(expected[i * 3 + 1], items.objects[i].y, 0.001);
+        assert_int_equal((int)expected[i * 3 + 2], items.objects[i].visible);
+    }
+
+    assert_double_equal(66, solver.getContentWidth(), 0.001);
+    assert_double_equal(45, solver.getContentHeight(), 0.001);
+    assert_double_equal(70, solver.getViewPortWidth(), 0.001);
+    assert_double_equal(100, solver.getViewPortHeight(), 0.001);
+}
+
+
+SEATEST_TEST(layoutSolver_tiledRowsPaging)
+{
+    LayoutSolver solver;
+
+    solver.mode              = LayoutSolver::MODE_TILED_ROWS;
+    solver.horizontalAlign   = LayoutSolver::ALIGN_CENTER;
+    solver.verticalAlign     = LayoutSolver::ALIGN_CENTER;
+    solver.paging            = LayoutSolver::PAGING_HORIZONTAL;
+    solver.useVirtualLayout  = true;
+    solver.useSquareTiles    = true;
+    solver.manageVisibility  = true;
+    solver.typicalItemWidth  = 20;
+    solver.typicalItemHeight = 20;
+    solver.explicitWidth     = 50;
+    solver.explicitHeight    = 50;
+
+    lmscalar boxes[9 * 4];
+
+    for (int i = 0; i < 9; i++)
+    {
+        boxes[i * 4]     = boxes[i * 4 + 1] = 0;
+        boxes[i * 4 + 2] = boxes[i * 4 + 3] = 10;
+    }
+
+    LayoutTestItems items(boxes, 9);
+
+    for (int i = 0; i < 9; i++)
+    {
+        items.objects[i].visible = false;
+    }
+
+    // a virtualized item still takes up its tile
+    items.targets[3]   = NULL;
+    items.sizes[3 * 2] = items.sizes[3 * 2 + 1] = 0;
+
+    items.layout(solver);
+
+    // four tiles to a page, only the items of the last page have their
+    // visibility managed
+    static const lmscalar expected[] =
+    {
+         10, 10, 0,
+         30, 10, 0,
+         10, 30, 0,
+          0,  0, 0,
+         60, 10, 0,
+         80, 10, 0,
+         60, 30, 0,
+         80, 30, 0,
+        110, 10, 1
+    };
+
+    for (int i = 0; i < 9; i++)
+    {
+        assert_double_equal(expected[i * 3], items.objects[i].x, 0.001);
+        assert_double_equal(expected[i * 3 + 1], items.objects[i].y, 0.001);
+        assert_int_equal((int)expected[i * 3 + 2], items.objects[i].visible);
+    }
+
+    assert_double_equal(150, solver.getContentWidth(), 0.001);
+    assert_double_equal(50, solver.getContentHeight(), 0.001);
+    assert_double_equal(50, solver.getViewPortWidth(), 0.001);
+    assert_double_equal(50, solver.getViewPortHeight(), 0.001);
+}
+
+
+SEATEST_TEST(layoutSolver_tiledColumns)
+{
+    static const lmscalar boxes[] =
+    {
+        0, 0, 10, 10,
+        0, 0, 10, 10,
+        0, 0, 10, 10,
+        0, 0, 10, 10,
+        0, 0, 10, 10
+    };
+    static const int excluded[] = { 1 };
+
+    LayoutSolver solver;
+
+    solver.mode           = LayoutSolver::MODE_TILED_COLUMNS;
+    solver.explicitHeight = 20;
+
+    // two tiles to a column, and the excluded item counts towards when a
+    // column wraps
+    static const lmscalar expected[] =
+    {
+         0,  0,
+         0,  0,
+        10,  0,
+        10, 10,
+        20,  0
+    };
+
+    LayoutTestItems items(boxes, 5);
+    items.layout(solver, excluded, 1);
+
+    for (int i = 0; i < 5; i++)
+    {
+        assert_double_equal(expected[i * 2], items.objects[i].x, 0.001);
+        assert_double_equal(expected[i * 2 + 1], items.objects[i].y, 0.001);
+    }
+
+    assert_double_equal(30, solver.getContentWidth(), 0.001);
+    assert_double_equal(20, solver.getContentHeight(), 0.001);
+    assert_double_equal(20, solver.getViewPortHeight(), 0.001);
+}
+
+
+SEATEST_TEST(layoutSolver_anchors)
+{
+    static const lmscalar boxes[] =
+    {
+         0,  0, 20, 10,
+         1,  1, 30, 10,
+        50, 50, 10, 10,
+         7,  7, 10, 10,
+        60, 30, 10, 10,
+         2,  3, 10, 10,
+         4,  4, 10, 10
+    };
+
+    const lmscalar n = std::numeric_limits<lmscalar>::quiet_NaN();
+
+    // left, right, horizontalCenter, top, bottom, verticalCenter, then the
+    // item each is relative to; item 3 and 4 are anchored to each other and
+    // items 5 and 6 have no rules
+    const lmscalar rules[] =
+    {
+        10,  n, n, 5, n, n,    -1, -1, -1, -1, -1, -1,
+         5, 10, n, 2, n, n,     0, -1, -1,  0, -1, -1,
+         n,  n, 0, n, n, 0,    -1, -1, -1, -1, -1, -1,
+         0,  n, n, n, 4, n,     4, -1, -1, -1, -1, -1,
+         n,  3, n, n, n, n,    -1,  3, -1, -1, -1, -1,
+         n,  n, n, n, n, n,    -1, -1, -1, -1, -1, -1,
+         n,  n, n, n, n, n,    -1, -1, -1, -1, -1, -1
+    };
+
+    LayoutSolver solver;
+
+    solver.mode           = LayoutSolver::MODE_ANCHOR;
+    solver.boundsX        = 5;
+    solver.boundsY        = 6;
+    solver.explicitWidth  = 100;
+    solver.explicitHeight = 80;
+
+    LayoutTestItems items(boxes, 7);
+    solver.setItemCount(7);
+    solver.setAnchors(rules, 0, 7);
+    items.layout(solver);
+
+    // the items are placed in order in one pass, an item anchored to a
+    // later one uses where that one was before the layout
+    static const lmscalar expected[] =
+    {
+        15, 11,
+        40, 23,
+        45, 35,
+        70, 72,
+        57, 30,
+         2,  3,
+         4,  4
+    };
+
+    for (int i = 0; i < 7; i++)
+    {
+        assert_double_equal(expected[i * 2], items.objects[i].x, 0.001);
+        assert_double_equal(expected[i * 2 + 1], items.objects[i].y, 0.001);
+    }
+
+    assert_double_equal(50, solver.getAssignedWidth(1), 0.001);
+    assert_true(solver.getAssignedWidth(0) != solver.getAssignedWidth(0));
+}
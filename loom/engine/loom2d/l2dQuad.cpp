@@ -45,47 +45,35 @@ void Quad::updateNativeVertexData(lua_State *L, int index)
         lualoom_getmember(L, index, vmember);
 
         lualoom_getmember(L, -1, "mRawData");
-        lua_rawgeti(L, -1, LSINDEXVECTOR);
 
-        int rawDataTable = lua_gettop(L);
-        int rcounter     = 0;
+        // x, y, a, b, g, r, u, v per vertex
+        float raw[32] = { 0 };
+        lsr_vector_read_floats(L, -1, raw, 32);
+
+        const float *rv = raw;
 
         tinted = false;
 
-        for (int i = 0; i < 4; i++)
+        for (int i = 0; i < 4; i++, rv += 8)
         {
             GFX::VertexPosColorTex *v = &quadVertices[i];
-            lua_rawgeti(L, rawDataTable, rcounter++);
-            v->x = (float)lua_tonumber(L, -1);
-            lua_rawgeti(L, rawDataTable, rcounter++);
-            v->y = (float)lua_tonumber(L, -1);
-
-            //printf("%i %f %f\n", i, v->x, v->y);
-
+            v->x = rv[0];
+            v->y = rv[1];
             v->z = 0.0f;
 
             GFX::Color c(0);
-            lua_rawgeti(L, rawDataTable, rcounter++);
-            c.a = (float)lua_tonumber(L, -1);
-            lua_rawgeti(L, rawDataTable, rcounter++);
-            c.b = (float)lua_tonumber(L, -1);
-            lua_rawgeti(L, rawDataTable, rcounter++);
-            c.g = (float)lua_tonumber(L, -1);
-            lua_rawgeti(L, rawDataTable, rcounter++);
-            c.r = (float)lua_tonumber(L, -1);
-
-            // todo: optimize this too:
+            c.a = rv[2];
+            c.b = rv[3];
+            c.g = rv[4];
+            c.r = rv[5];
 
             v->abgr = c.getHex();
 
             if(v->abgr != 0x00FFFFFFFF)
                 tinted = true;
 
-            lua_rawgeti(L, rawDataTable, rcounter++);
-            v->u = (float)lua_tonumber(L, -1);
-
-            lua_rawgeti(L, rawDataTable, rcounter++);
-            v->v = (float)lua_tonumber(L, -1);
+            v->u = rv[6];
+            v->v = rv[7];
         }
 
         lua_settop(L, didx);
@@ -66,6 +66,22 @@ void QuadBatch::render(lua_State *L)
     
     Matrix mtx;
     getTargetTransformationMatrix(NULL, &mtx);
+
+    // large batches that didn't change this frame are drawn straight from
+    // their vertex buffer, uploading it only after the quads changed
+    if ((numQuads >= RETAINED_MIN_QUADS) && (numQuads <= MAXBATCHQUADS) &&
+        (changedFrame != GFX::Graphics::getCurrentFrame()) &&
+        ((renderState.alpha == 1.0f) || shader->appliesAlpha()))
+    {
+        if (retainedDirty || !GFX::QuadRenderer::isRetainedValid(retainedBuffer))
+        {
+            GFX::QuadRenderer::uploadRetained(retainedBuffer, quadData, 4 * numQuads);
+            retainedDirty = false;
+        }
+
+        GFX::QuadRenderer::drawRetained(retainedBuffer, 4 * numQuads, nativeTextureID, blendEnabled, blendSrc, blendDst, shader, mtx, renderState.alpha);
+        return;
+    }
     
     // quick render and early out of the entire function if the transform is identity and there is no alpha modulation by the render state
     bool isIdentity = mtx.isIdentity();
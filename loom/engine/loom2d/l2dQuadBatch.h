@@ -32,6 +32,11 @@ namespace Loom2D
 {
 #define DEFAULT_QUADS    32
 
+// Batches of at least this many quads that stay unchanged between frames
+// are drawn from their own vertex buffer. Smaller ones are cheaper to merge
+// into the QuadRenderer batch than to draw separately.
+#define RETAINED_MIN_QUADS    64
+
 // Native side of the QuadBatch script class
 class QuadBatch : public DisplayObject
 {
@@ -61,6 +66,17 @@ public:
 
     GFX::ShaderProgram *shader;
 
+    // GPU copy of quadData, drawn with the transform and alpha applied in
+    // the shader so moving the batch doesn't touch the vertices
+    GFX::RetainedVertexBuffer retainedBuffer;
+
+    // true if quadData changed since it was last uploaded
+    bool retainedDirty;
+
+    // frame the quads last changed in, batches still changing every frame
+    // keep going through the QuadRenderer batch
+    uint32_t changedFrame;
+
     // renders the QuadBatch
     void render(lua_State *L);
 
@@ -78,6 +94,7 @@ public:
         numQuads        = 0;
         nativeTextureID = -1;
         shader = GFX::ShaderProgram::getDefaultShader();
+        markChanged();
     }
 
     ~QuadBatch()
@@ -86,6 +103,15 @@ public:
         {
             lmFree(NULL, quadData);
         }
+
+        GFX::QuadRenderer::destroyRetained(retainedBuffer);
+    }
+
+    // flags the quads for upload and keeps them batched for this frame
+    inline void markChanged()
+    {
+        retainedDirty = true;
+        changedFrame  = GFX::Graphics::getCurrentFrame();
     }
 
     // property accessors for native texture id
@@ -113,6 +139,7 @@ public:
     int reset(lua_State *L)
     {
         numQuads = 0;
+        markChanged();
         return 0;
     }
 
@@ -239,6 +266,7 @@ public:
     void _setQuadData(int quadID, Quad *quad, Matrix *mtx)
     {
         nativeTextureID = quad->nativeTextureID;
+        markChanged();
 
         GFX::VertexPosColorTex *dst = &quadData[quadID * 4];
         GFX::VertexPosColorTex *src = quad->quadVertices;
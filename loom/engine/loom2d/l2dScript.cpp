@@ -32,6 +32,9 @@
 #include "loom/engine/loom2d/l2dQuad.h"
 #include "loom/engine/loom2d/l2dImage.h"
 #include "loom/engine/loom2d/l2dQuadBatch.h"
+#include "loom/engine/loom2d/l2dTileLayer.h"
+#include "loom/engine/loom2d/l2dTMXMap.h"
+#include "loom/engine/loom2d/l2dLayoutSolver.h"
 
 #include "loom/graphics/gfxShader.h"
 
@@ -52,12 +55,14 @@ public:
         Rectangle::initialize(L);
         Matrix::initialize(L);
 
+        EventDispatcher::initialize(L);
         DisplayObject::initialize(L);
         DisplayObjectContainer::initialize(L);
         Sprite::initialize(L);
         Quad::initialize(L);
         Image::initialize(L);
         QuadBatch::initialize(L);
+        TileLayer::initialize(L);
 
         sInitialized = true;
     }
@@ -164,6 +169,11 @@ static int registerLoom2D(lua_State *L)
 
        .beginClass<EventDispatcher>("EventDispatcher")
        .addConstructor<void (*)(void)>()
+       .addStaticLuaFunction("_addEventListener", &EventDispatcher::addListener)
+       .addStaticLuaFunction("_removeEventListener", &EventDispatcher::removeListener)
+       .addStaticLuaFunction("_dispatchEvent", &EventDispatcher::dispatch)
+       .addStaticLuaFunction("_bubbleEvent", &EventDispatcher::bubble)
+       .addStaticLuaFunction("_invokeEvent", &EventDispatcher::invoke)
        .endClass()
 
        .endPackage();
@@ -352,6 +362,95 @@ static int registerLoom2D(lua_State *L)
        .addLuaFunction("reset", &QuadBatch::reset)
        .endClass()
 
+    // TileLayer
+       .deriveClass<TileLayer, DisplayObject>("TileLayer")
+       .addConstructor<void (*)(void)>()
+       .addVarAccessor("shader", &TileLayer::getShader, &TileLayer::setShader)
+       .addProperty("mapWidth", &TileLayer::getMapWidth)
+       .addProperty("mapHeight", &TileLayer::getMapHeight)
+       .addProperty("numChunks", &TileLayer::getChunkCount)
+       .addProperty("numVisibleChunks", &TileLayer::getVisibleChunkCount)
+       .addMethod("setTilesetTexture", &TileLayer::setTilesetTexture)
+       .addMethod("setLayer", &TileLayer::setLayer)
+       .addMethod("getTile", &TileLayer::getTile)
+       .addMethod("setTile", &TileLayer::setTile)
+       .addLuaFunction("_getBounds", &TileLayer::_getBounds)
+       .endClass()
+
+    // LayoutSolver
+       .beginClass<LayoutSolver>("LayoutSolver")
+       .addConstructor<void (*)(void)>()
+       .addVar("mode", &LayoutSolver::mode)
+       .addVar("gap", &LayoutSolver::gap)
+       .addVar("horizontalGap", &LayoutSolver::horizontalGap)
+       .addVar("verticalGap", &LayoutSolver::verticalGap)
+       .addVar("paddingTop", &LayoutSolver::paddingTop)
+       .addVar("paddingRight", &LayoutSolver::paddingRight)
+       .addVar("paddingBottom", &LayoutSolver::paddingBottom)
+       .addVar("paddingLeft", &LayoutSolver::paddingLeft)
+       .addVar("horizontalAlign", &LayoutSolver::horizontalAlign)
+       .addVar("verticalAlign", &LayoutSolver::verticalAlign)
+       .addVar("tileHorizontalAlign", &LayoutSolver::tileHorizontalAlign)
+       .addVar("tileVerticalAlign", &LayoutSolver::tileVerticalAlign)
+       .addVar("paging", &LayoutSolver::paging)
+       .addVar("useVirtualLayout", &LayoutSolver::useVirtualLayout)
+       .addVar("useSquareTiles", &LayoutSolver::useSquareTiles)
+       .addVar("manageVisibility", &LayoutSolver::manageVisibility)
+       .addVar("typicalItemWidth", &LayoutSolver::typicalItemWidth)
+       .addVar("typicalItemHeight", &LayoutSolver::typicalItemHeight)
+       .addVar("leadingSpace", &LayoutSolver::leadingSpace)
+       .addVar("trailingSpace", &LayoutSolver::trailingSpace)
+       .addVar("boundsX", &LayoutSolver::boundsX)
+       .addVar("boundsY", &LayoutSolver::boundsY)
+       .addVar("scrollX", &LayoutSolver::scrollX)
+       .addVar("scrollY", &LayoutSolver::scrollY)
+       .addVar("explicitWidth", &LayoutSolver::explicitWidth)
+       .addVar("explicitHeight", &LayoutSolver::explicitHeight)
+       .addVar("minWidth", &LayoutSolver::minWidth)
+       .addVar("minHeight", &LayoutSolver::minHeight)
+       .addVar("maxWidth", &LayoutSolver::maxWidth)
+       .addVar("maxHeight", &LayoutSolver::maxHeight)
+       .addProperty("itemCount", &LayoutSolver::getItemCount, &LayoutSolver::setItemCount)
+       .addProperty("contentWidth", &LayoutSolver::getContentWidth)
+       .addProperty("contentHeight", &LayoutSolver::getContentHeight)
+       .addProperty("viewPortWidth", &LayoutSolver::getViewPortWidth)
+       .addProperty("viewPortHeight", &LayoutSolver::getViewPortHeight)
+       .addMethod("invalidate", &LayoutSolver::invalidate)
+       .addMethod("getItemX", &LayoutSolver::getItemX)
+       .addMethod("getItemY", &LayoutSolver::getItemY)
+       .addMethod("getAssignedWidth", &LayoutSolver::getAssignedWidth)
+       .addMethod("getAssignedHeight", &LayoutSolver::getAssignedHeight)
+       .addLuaFunction("setSizes", &LayoutSolver::setSizes)
+       .addLuaFunction("setAnchors", &LayoutSolver::setAnchors)
+       .addLuaFunction("setExcluded", &LayoutSolver::setExcluded)
+       .addLuaFunction("layout", &LayoutSolver::layout)
+       .endClass()
+
+
+       .endPackage();
+
+    beginPackage(L, "loom2d.tmx")
+
+    // TMXMap
+       .beginClass<TMXMap>("TMXMap")
+       .addConstructor<void (*)(void)>()
+       .addMethod("load", &TMXMap::load)
+       .addMethod("parse", &TMXMap::parse)
+       .addProperty("orientation", &TMXMap::getOrientation)
+       .addProperty("width", &TMXMap::getWidth)
+       .addProperty("height", &TMXMap::getHeight)
+       .addProperty("tileWidth", &TMXMap::getTileWidth)
+       .addProperty("tileHeight", &TMXMap::getTileHeight)
+       .addProperty("numTilesets", &TMXMap::getTilesetCount)
+       .addProperty("numLayers", &TMXMap::getLayerCount)
+       .addMethod("getTilesetImage", &TMXMap::getTilesetImage)
+       .addMethod("getTilesetFirstGid", &TMXMap::getTilesetFirstGid)
+       .addMethod("getLayerName", &TMXMap::getLayerName)
+       .addMethod("getLayerOpacity", &TMXMap::getLayerOpacity)
+       .addMethod("getLayerVisible", &TMXMap::getLayerVisible)
+       .addMethod("getTileGid", &TMXMap::getTileGid)
+       .addMethod("findLayer", &TMXMap::findLayer)
+       .endClass()
 
        .endPackage();
 
@@ -380,4 +479,7 @@ void installLoom2D()
     LOOM_DECLARE_MANAGEDNATIVETYPE(Loom2D::Image, Loom2D::registerLoom2D);
     LOOM_DECLARE_MANAGEDNATIVETYPE(Loom2D::Quad, Loom2D::registerLoom2D);
     LOOM_DECLARE_MANAGEDNATIVETYPE(Loom2D::QuadBatch, Loom2D::registerLoom2D);
+    LOOM_DECLARE_MANAGEDNATIVETYPE(Loom2D::TileLayer, Loom2D::registerLoom2D);
+    LOOM_DECLARE_MANAGEDNATIVETYPE(Loom2D::TMXMap, Loom2D::registerLoom2D);
+    LOOM_DECLARE_MANAGEDNATIVETYPE(Loom2D::LayoutSolver, Loom2D::registerLoom2D);
 }
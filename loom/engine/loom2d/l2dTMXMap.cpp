@@ -0,0 +1,412 @@
+/*
+ * ===========================================================================
+ * Loom SDK
+ * Copyright 2011, 2012, 2013
+ * The Game Engine Company, LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ * ===========================================================================
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "loom/common/core/allocator.h"
+#include "loom/common/core/log.h"
+#include "loom/common/utils/utBase64.h"
+#include "loom/common/utils/utByteArray.h"
+#include "loom/common/xml/tinyxml2.h"
+#include "loom/engine/loom2d/l2dTMXMap.h"
+
+using namespace tinyxml2;
+
+lmDefineLogGroup(gTMXLogGroup, "tmx", 1, LoomLogInfo);
+
+namespace Loom2D
+{
+
+// Folder part of path including the trailing delimiter, so relative paths
+// in the document can be appended to it.
+static utString folderOf(const char *path)
+{
+    const char *slash     = strrchr(path, '/');
+    const char *backslash = strrchr(path, '\\');
+
+    if (backslash > slash)
+    {
+        slash = backslash;
+    }
+
+    if (!slash)
+    {
+        return utString();
+    }
+
+    utString folder;
+    folder.assign(path, (int)(slash - path + 1));
+    return folder;
+}
+
+
+void TMXMap::clear()
+{
+    for (UTsize i = 0; i < layers.size(); i++)
+    {
+        lmDelete(NULL, layers[i]);
+    }
+
+    layers.clear();
+    tilesets.clear();
+
+    orientation = "";
+    width       = height = tileWidth = tileHeight = 0;
+}
+
+
+bool TMXMap::load(const char *path)
+{
+    clear();
+
+    XMLDocument doc;
+
+    if (doc.LoadFile(path) != XML_NO_ERROR)
+    {
+        lmLogError(gTMXLogGroup, "Unable to load TMX file '%s'", path);
+        return false;
+    }
+
+    return parseDocument(&doc, path);
+}
+
+
+bool TMXMap::parse(const char *xml, const char *path)
+{
+    clear();
+
+    XMLDocument doc;
+
+    if (doc.Parse(xml) != XML_NO_ERROR)
+    {
+        lmLogError(gTMXLogGroup, "Unable to parse TMX file '%s': %s", path, doc.GetErrorStr1() ? doc.GetErrorStr1() : "");
+        return false;
+    }
+
+    return parseDocument(&doc, path);
+}
+
+
+bool TMXMap::parseDocument(XMLDocument *doc, const char *path)
+{
+    XMLElement *root = doc->RootElement();
+
+    if (!root || strcmp(root->Value(), "map"))
+    {
+        lmLogError(gTMXLogGroup, "Expected 'map' as root node of TMX file '%s'", path);
+        return false;
+    }
+
+    const char *orientationAttr = root->Attribute("orientation");
+    orientation = orientationAttr ? orientationAttr : "orthogonal";
+    width       = root->IntAttribute("width");
+    height      = root->IntAttribute("height");
+    tileWidth   = root->IntAttribute("tilewidth");
+    tileHeight  = root->IntAttribute("tileheight");
+
+    utString folder = folderOf(path);
+    bool     result = true;
+
+    for (XMLElement *child = root->FirstChildElement(); child; child = child->NextSiblingElement())
+    {
+        if (!strcmp(child->Value(), "tileset"))
+        {
+            TMXMapTileset tileset;
+            tileset.firstGid   = child->UnsignedAttribute("firstgid");
+            tileset.tileWidth  = tileWidth;
+            tileset.tileHeight = tileHeight;
+            tileset.spacing    = tileset.margin = 0;
+            tileset.imageWidth = tileset.imageHeight = 0;
+
+            const char *source = child->Attribute("source");
+            if (source)
+            {
+                // External TSX tileset, image paths are relative to the TSX.
+                utString tsxPath = folder + source;
+
+                XMLDocument tsx;
+                if ((tsx.LoadFile(tsxPath.c_str()) != XML_NO_ERROR) || !tsx.RootElement())
+                {
+                    lmLogError(gTMXLogGroup, "Unable to load tileset '%s'", tsxPath.c_str());
+                    result = false;
+                }
+                else
+                {
+                    result &= parseTileset(tsx.RootElement(), folderOf(tsxPath.c_str()), tileset);
+                }
+            }
+            else
+            {
+                result &= parseTileset(child, folder, tileset);
+            }
+
+            tilesets.push_back(tileset);
+        }
+        else if (!strcmp(child->Value(), "layer"))
+        {
+            TMXMapLayer *layer = lmNew(NULL) TMXMapLayer();
+            result &= parseLayer(child, layer);
+            layers.push_back(layer);
+        }
+    }
+
+    return result;
+}
+
+
+bool TMXMap::parseTileset(XMLElement *element, const utString& folder, TMXMapTileset& tileset)
+{
+    const char *name = element->Attribute("name");
+
+    tileset.name = name ? name : "";
+    element->QueryIntAttribute("tilewidth", &tileset.tileWidth);
+    element->QueryIntAttribute("tileheight", &tileset.tileHeight);
+    element->QueryIntAttribute("spacing", &tileset.spacing);
+    element->QueryIntAttribute("margin", &tileset.margin);
+
+    XMLElement *image = element->FirstChildElement("image");
+    if (image)
+    {
+        const char *source = image->Attribute("source");
+        tileset.imageSource = source ? folder + source : utString();
+        tileset.imageWidth  = image->IntAttribute("width");
+        tileset.imageHeight = image->IntAttribute("height");
+    }
+
+    return true;
+}
+
+
+bool TMXMap::parseLayer(XMLElement *element, TMXMapLayer *layer)
+{
+    const char *name = element->Attribute("name");
+
+    layer->name    = name ? name : "";
+    layer->width   = element->IntAttribute("width");
+    layer->height  = element->IntAttribute("height");
+    layer->opacity = 1.0f;
+    layer->visible = true;
+    element->QueryFloatAttribute("opacity", &layer->opacity);
+
+    int visible = 1;
+    element->QueryIntAttribute("visible", &visible);
+    layer->visible = visible != 0;
+
+    if ((layer->width > 0) && (layer->height > 0) && (layer->width > 0x3FFFFFFF / layer->height))
+    {
+        lmLogError(gTMXLogGroup, "Layer '%s' is too big at %dx%d", layer->name.c_str(), layer->width, layer->height);
+        return false;
+    }
+
+    UTsize count = (UTsize)(layer->width > 0 && layer->height > 0 ? layer->width * layer->height : 0);
+    layer->tiles.resize(count);
+    for (UTsize i = 0; i < count; i++)
+    {
+        layer->tiles[i] = 0;
+    }
+
+    XMLElement *data = element->FirstChildElement("data");
+    if (!data)
+    {
+        return true;
+    }
+
+    const char *encoding    = data->Attribute("encoding");
+    const char *compression = data->Attribute("compression");
+    const char *text        = data->GetText();
+    UTsize     decoded      = 0;
+
+    if (!encoding)
+    {
+        for (XMLElement *tile = data->FirstChildElement("tile"); tile && decoded < count; tile = tile->NextSiblingElement("tile"))
+        {
+            layer->tiles[decoded++] = tile->UnsignedAttribute("gid");
+        }
+    }
+    else if (!strcmp(encoding, "csv"))
+    {
+        const char *p = text;
+        while (p && *p && decoded < count)
+        {
+            char *end;
+            unsigned long gid = strtoul(p, &end, 10);
+            if (end == p)
+            {
+                p++;
+                continue;
+            }
+            layer->tiles[decoded++] = (unsigned int)gid;
+            p = end;
+        }
+    }
+    else if (!strcmp(encoding, "base64"))
+    {
+        utBase64 base64 = utBase64::decode64(utString(text ? text : ""));
+
+        const utArray<unsigned char>& raw = base64.getData();
+
+        utByteArray bytes;
+        if (raw.size())
+        {
+            bytes.allocateAndCopy((void *)raw.ptr(), (int)raw.size());
+        }
+
+        if (compression)
+        {
+            if (strcmp(compression, "zlib") && strcmp(compression, "gzip"))
+            {
+                lmLogError(gTMXLogGroup, "Layer '%s' uses unsupported compression '%s'", layer->name.c_str(), compression);
+                return false;
+            }
+
+            // a failed inflate leaves the array empty
+            bytes.uncompress((int)count * 4);
+        }
+
+        const unsigned char *p = (const unsigned char *)bytes.getDataPtr();
+        UTsize available = bytes.getSize() / 4;
+        for ( ; decoded < count && decoded < available; decoded++, p += 4)
+        {
+            layer->tiles[decoded] = p[0] | (p[1] << 8) | (p[2] << 16) | ((unsigned int)p[3] << 24);
+        }
+    }
+    else
+    {
+        lmLogError(gTMXLogGroup, "Layer '%s' uses unsupported encoding '%s'", layer->name.c_str(), encoding);
+        return false;
+    }
+
+    // corrupt or truncated data must not load as blank tiles, so the
+    // script can fall back to decoding it
+    if (decoded < count)
+    {
+        lmLogError(gTMXLogGroup, "Layer '%s' has %d of its %d tiles", layer->name.c_str(), (int)decoded, (int)count);
+        return false;
+    }
+
+    return true;
+}
+
+
+int TMXMap::findTileset(unsigned int gid) const
+{
+    gid &= TMX_GID_MASK;
+
+    // tilesets are sorted by firstgid, the holder is the last one at or below gid
+    int result = -1;
+    for (UTsize i = 0; i < tilesets.size(); i++)
+    {
+        if ((gid >= tilesets[i].firstGid) && (result == -1 || tilesets[i].firstGid >= tilesets[result].firstGid))
+        {
+            result = (int)i;
+        }
+    }
+
+    return gid ? result : -1;
+}
+
+
+int TMXMap::findLayer(const char *name) const
+{
+    for (UTsize i = 0; i < layers.size(); i++)
+    {
+        if (layers[i]->name == name)
+        {
+            return (int)i;
+        }
+    }
+
+    return -1;
+}
+
+
+const char *TMXMap::getTilesetImage(int index) const
+{
+    if ((index < 0) || (index >= (int)tilesets.size()))
+    {
+        return NULL;
+    }
+
+    return tilesets[index].imageSource.c_str();
+}
+
+
+unsigned int TMXMap::getTilesetFirstGid(int index) const
+{
+    if ((index < 0) || (index >= (int)tilesets.size()))
+    {
+        return 0;
+    }
+
+    return tilesets[index].firstGid;
+}
+
+
+const char *TMXMap::getLayerName(int index) const
+{
+    if ((index < 0) || (index >= (int)layers.size()))
+    {
+        return NULL;
+    }
+
+    return layers[index]->name.c_str();
+}
+
+
+float TMXMap::getLayerOpacity(int index) const
+{
+    if ((index < 0) || (index >= (int)layers.size()))
+    {
+        return 0.0f;
+    }
+
+    return layers[index]->opacity;
+}
+
+
+bool TMXMap::getLayerVisible(int index) const
+{
+    if ((index < 0) || (index >= (int)layers.size()))
+    {
+        return false;
+    }
+
+    return layers[index]->visible;
+}
+
+
+unsigned int TMXMap::getTileGid(int layer, int x, int y) const
+{
+    if ((layer < 0) || (layer >= (int)layers.size()))
+    {
+        return 0;
+    }
+
+    const TMXMapLayer *l = layers[layer];
+
+    if ((x < 0) || (y < 0) || (x >= l->width) || (y >= l->height))
+    {
+        return 0;
+    }
+
+    return l->tiles[y * l->width + x];
+}
+}
@@ -0,0 +1,142 @@
+/*
+ * ===========================================================================
+ * Loom SDK
+ * Copyright 2011, 2012, 2013
+ * The Game Engine Company, LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ * ===========================================================================
+ */
+
+#pragma once
+
+#include "loom/common/utils/utString.h"
+#include "loom/common/utils/utTypes.h"
+
+namespace tinyxml2
+{
+class XMLDocument;
+class XMLElement;
+}
+
+namespace Loom2D
+{
+// Flags Tiled stores in the top bits of a tile gid.
+#define TMX_FLIPPED_HORIZONTALLY    0x80000000
+#define TMX_FLIPPED_VERTICALLY      0x40000000
+#define TMX_FLIPPED_DIAGONALLY      0x20000000
+#define TMX_GID_MASK                0x1FFFFFFF
+
+// A tileset of a TMX map, either inline or loaded from a TSX file.
+struct TMXMapTileset
+{
+    utString     name;
+
+    // image path, relative to the working directory like the map path
+    utString     imageSource;
+
+    unsigned int firstGid;
+    int          tileWidth;
+    int          tileHeight;
+    int          spacing;
+    int          margin;
+    int          imageWidth;
+    int          imageHeight;
+
+    // number of tile columns in the image, 0 if the image size is unknown
+    int getColumns() const
+    {
+        if ((imageWidth <= 0) || (tileWidth + spacing <= 0))
+        {
+            return 0;
+        }
+
+        return (imageWidth - 2 * margin + spacing) / (tileWidth + spacing);
+    }
+};
+
+// A decoded tile layer, width * height gids in row order.
+struct TMXMapLayer
+{
+    utString              name;
+    int                   width;
+    int                   height;
+    float                 opacity;
+    bool                  visible;
+    utArray<unsigned int> tiles;
+};
+
+// Native side of the TMXMap script class. Parses a TMX map and any TSX
+// tilesets it references, decoding tile layer data stored as XML, CSV or
+// base64 (optionally zlib or gzip compressed). Object groups, image layers
+// and properties are left to the script TMXDocument.
+class TMXMap
+{
+public:
+
+    utString                orientation;
+    int                     width;
+    int                     height;
+    int                     tileWidth;
+    int                     tileHeight;
+
+    utArray<TMXMapTileset>  tilesets;
+    utArray<TMXMapLayer *>  layers;
+
+    TMXMap()
+    {
+        width = height = tileWidth = tileHeight = 0;
+    }
+
+    ~TMXMap()
+    {
+        clear();
+    }
+
+    void clear();
+
+    // load and parse the TMX file at path
+    bool load(const char *path);
+
+    // parse TMX xml, path is used to resolve tilesets and images
+    bool parse(const char *xml, const char *path);
+
+    // returns the index of the tileset holding the given gid, or -1
+    int findTileset(unsigned int gid) const;
+
+    // returns the index of the named layer, or -1
+    int findLayer(const char *name) const;
+
+    // script accessors
+    const char *getOrientation() const { return orientation.c_str(); }
+    int getWidth() const { return width; }
+    int getHeight() const { return height; }
+    int getTileWidth() const { return tileWidth; }
+    int getTileHeight() const { return tileHeight; }
+    int getTilesetCount() const { return (int)tilesets.size(); }
+    int getLayerCount() const { return (int)layers.size(); }
+
+    const char *getTilesetImage(int index) const;
+    unsigned int getTilesetFirstGid(int index) const;
+    const char *getLayerName(int index) const;
+    float getLayerOpacity(int index) const;
+    bool getLayerVisible(int index) const;
+    unsigned int getTileGid(int layer, int x, int y) const;
+
+private:
+
+    bool parseDocument(tinyxml2::XMLDocument *doc, const char *path);
+    bool parseTileset(tinyxml2::XMLElement *element, const utString& folder, TMXMapTileset& tileset);
+    bool parseLayer(tinyxml2::XMLElement *element, TMXMapLayer *layer);
+};
+}
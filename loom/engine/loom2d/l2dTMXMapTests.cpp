@@ -0,0 +1,194 @@
+/*
+ * ===========================================================================
+ * Loom SDK
+ * Copyright 2011, 2012, 2013
+ * The Game Engine Company, LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ * ===========================================================================
+ */
+
+#include "seatest.h"
+#include "loom/common/utils/utString.h"
+#include "loom/engine/loom2d/l2dTMXMap.h"
+
+using namespace Loom2D;
+
+SEATEST_FIXTURE(l2dTMXMap)
+{
+    SEATEST_FIXTURE_ENTRY(tmxMap_encodings);
+    SEATEST_FIXTURE_ENTRY(tmxMap_tilesets);
+    SEATEST_FIXTURE_ENTRY(tmxMap_shortData);
+}
+
+// The 4x3 layer every encoding below holds, with each flip flag set on
+// some tiles.
+static const unsigned int tmxTestGids[12] =
+{
+    1, 2, 3, 10,
+    0, 11, 0x80000002, 0x4000000A,
+    0x20000003, 1, 12, 0xE0000001
+};
+
+static const char *tmxTestBase64 = "AQAAAAIAAAADAAAACgAAAAAAAAALAAAAAgAAgAoAAEADAAAgAQAAAAwAAAABAADg";
+static const char *tmxTestZlib   = "eJxjZGBgYAJiZiDmYoAAbohYA5DvABRXYATyeYAYSD8AABakAfk=";
+static const char *tmxTestGzip   = "H4sIAAAAAAACA2NkYGBgAmJmIOZigABuiFgDkO8AFFdgBPJ5gBhIPwAA09lFkDAAAAA=";
+
+// The first 10 tiles only, raw and zlib compressed, and the zlib stream cut
+// in half.
+static const char *tmxTestShortBase64 = "AQAAAAIAAAADAAAACgAAAAAAAAALAAAAAgAAgAoAAEADAAAgAQAAAA==";
+static const char *tmxTestShortZlib   = "eJxjZGBgYAJiZiDmYoAAbohYA5DvABRXYATyAQ0AAQw=";
+static const char *tmxTestCutZlib     = "eJxjZGBgYAJiZiDmYoAAbohYAw==";
+
+static utString tmxTestLayer(const char *name, const char *attributes, const utString& data)
+{
+    utString layer = "<layer name=\"";
+
+    layer += name;
+    layer += "\" width=\"4\" height=\"3\"><data";
+    layer += attributes;
+    layer += ">";
+    layer += data;
+    layer += "</data></layer>\n";
+    return layer;
+}
+
+static utString tmxTestMap(const utString& layers)
+{
+    utString map = "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+                   "<map version=\"1.0\" orientation=\"isometric\" width=\"4\" height=\"3\" tilewidth=\"32\" tileheight=\"16\">\n"
+                   " <tileset firstgid=\"1\" name=\"a\" tilewidth=\"32\" tileheight=\"32\" spacing=\"2\" margin=\"1\">"
+                   "<image source=\"img/a.png\" width=\"100\" height=\"70\"/></tileset>\n"
+                   " <tileset firstgid=\"10\" name=\"b\"><image source=\"b.png\" width=\"64\" height=\"64\"/></tileset>\n";
+
+    map += layers;
+    map += "</map>\n";
+    return map;
+}
+
+static bool tmxTestLayerMatches(const TMXMap& map, int layer)
+{
+    for (int i = 0; i < 12; i++)
+    {
+        if (map.getTileGid(layer, i % 4, i / 4) != tmxTestGids[i])
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+
+SEATEST_TEST(tmxMap_encodings)
+{
+    utString xml, csv;
+
+    for (int i = 0; i < 12; i++)
+    {
+        char gid[32];
+        sprintf(gid, "%u", tmxTestGids[i]);
+
+        xml += "<tile gid=\"";
+        xml += gid;
+        xml += "\"/>";
+
+        csv += i ? ",\n" : "\n";
+        csv += gid;
+    }
+
+    utString layers;
+    layers += tmxTestLayer("xml", "", xml);
+    layers += tmxTestLayer("csv", " encoding=\"csv\"", csv);
+    layers += tmxTestLayer("base64", " encoding=\"base64\"", utString("\n   ") + tmxTestBase64 + "\n  ");
+    layers += tmxTestLayer("zlib", " encoding=\"base64\" compression=\"zlib\"", tmxTestZlib);
+    layers += tmxTestLayer("gzip", " encoding=\"base64\" compression=\"gzip\"", tmxTestGzip);
+
+    TMXMap map;
+    assert_true(map.parse(tmxTestMap(layers).c_str(), "maps/test.tmx"));
+
+    assert_string_equal("isometric", map.getOrientation());
+    assert_int_equal(4, map.getWidth());
+    assert_int_equal(3, map.getHeight());
+    assert_int_equal(32, map.getTileWidth());
+    assert_int_equal(16, map.getTileHeight());
+
+    assert_int_equal(5, map.getLayerCount());
+    for (int i = 0; i < map.getLayerCount(); i++)
+    {
+        assert_true(tmxTestLayerMatches(map, i));
+    }
+
+    assert_int_equal(3, map.findLayer("zlib"));
+    assert_int_equal(-1, map.findLayer("missing"));
+    assert_string_equal("gzip", map.getLayerName(4));
+
+    // the flags stay on the gid, out of range reads are empty
+    assert_true(map.getTileGid(1, 2, 1) & TMX_FLIPPED_HORIZONTALLY);
+    assert_int_equal(2, map.getTileGid(1, 2, 1) & TMX_GID_MASK);
+    assert_int_equal(0, map.getTileGid(0, 4, 0));
+    assert_int_equal(0, map.getTileGid(5, 0, 0));
+}
+
+
+SEATEST_TEST(tmxMap_tilesets)
+{
+    TMXMap map;
+    assert_true(map.parse(tmxTestMap("").c_str(), "maps/test.tmx"));
+
+    assert_int_equal(2, map.getTilesetCount());
+    assert_int_equal(10, map.getTilesetFirstGid(1));
+    assert_string_equal("maps/img/a.png", map.getTilesetImage(0));
+    assert_true(map.getTilesetImage(2) == NULL);
+
+    // (100 - 2 * 1 + 2) / (32 + 2) columns, the size falls back to the map's
+    assert_int_equal(2, map.tilesets[0].getColumns());
+    assert_int_equal(32, map.tilesets[1].tileWidth);
+    assert_int_equal(16, map.tilesets[1].tileHeight);
+
+    assert_int_equal(-1, map.findTileset(0));
+    assert_int_equal(0, map.findTileset(1));
+    assert_int_equal(0, map.findTileset(9));
+    assert_int_equal(1, map.findTileset(10));
+    assert_int_equal(1, map.findTileset(500));
+
+    // flip flags don't change the tileset
+    assert_int_equal(0, map.findTileset(0xE0000001));
+    assert_int_equal(1, map.findTileset(TMX_FLIPPED_VERTICALLY | 10));
+    assert_int_equal(-1, map.findTileset(TMX_FLIPPED_DIAGONALLY));
+}
+
+
+SEATEST_TEST(tmxMap_shortData)
+{
+    TMXMap map;
+
+    // short data in any encoding fails the load rather than leaving the
+    // rest of the layer blank
+    assert_false(map.parse(tmxTestMap(tmxTestLayer("xml", "", "<tile gid=\"1\"/><tile gid=\"2\"/>")).c_str(), "test.tmx"));
+    assert_false(map.parse(tmxTestMap(tmxTestLayer("csv", " encoding=\"csv\"", "1,2,3,4,5")).c_str(), "test.tmx"));
+    assert_false(map.parse(tmxTestMap(tmxTestLayer("base64", " encoding=\"base64\"", tmxTestShortBase64)).c_str(), "test.tmx"));
+    assert_false(map.parse(tmxTestMap(tmxTestLayer("zlib", " encoding=\"base64\" compression=\"zlib\"", tmxTestShortZlib)).c_str(), "test.tmx"));
+
+    // as does data that doesn't inflate
+    assert_false(map.parse(tmxTestMap(tmxTestLayer("cut", " encoding=\"base64\" compression=\"zlib\"", tmxTestCutZlib)).c_str(), "test.tmx"));
+    assert_false(map.parse(tmxTestMap(tmxTestLayer("raw", " encoding=\"base64\" compression=\"zlib\"", tmxTestBase64)).c_str(), "test.tmx"));
+
+    // and unknown encodings
+    assert_false(map.parse(tmxTestMap(tmxTestLayer("zstd", " encoding=\"base64\" compression=\"zstd\"", tmxTestZlib)).c_str(), "test.tmx"));
+    assert_false(map.parse(tmxTestMap(tmxTestLayer("hex", " encoding=\"hex\"", "00")).c_str(), "test.tmx"));
+
+    // a layer without data is empty
+    assert_true(map.parse(tmxTestMap("<layer name=\"empty\" width=\"4\" height=\"3\"/>\n").c_str(), "test.tmx"));
+    assert_int_equal(0, map.getTileGid(0, 1, 1));
+}
@@ -0,0 +1,535 @@
+/*
+ * ===========================================================================
+ * Loom SDK
+ * Copyright 2011, 2012, 2013
+ * The Game Engine Company, LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ * ===========================================================================
+ */
+
+#include "loom/engine/loom2d/l2dTileLayer.h"
+#include "loom/engine/loom2d/l2dBlendMode.h"
+#include "loom/graphics/gfxGraphics.h"
+
+namespace Loom2D
+{
+Type *TileLayer::typeTileLayer = NULL;
+
+static inline int clampChunk(float index, int count)
+{
+    return index < 0 ? 0 : (index > count - 1 ? count - 1 : (int)index);
+}
+
+
+TileLayer::TileLayer()
+{
+    type          = typeTileLayer;
+    shader        = GFX::ShaderProgram::getDefaultShader();
+    mapWidth      = mapHeight = 0;
+    tileWidth     = tileHeight = 0;
+    isometric     = false;
+    chunksX       = chunksY = 0;
+    visibleChunks = 0;
+}
+
+
+TileLayer::~TileLayer()
+{
+    clearChunks();
+}
+
+
+void TileLayer::clearChunks()
+{
+    for (UTsize i = 0; i < chunks.size(); i++)
+    {
+        lmDelete(NULL, chunks[i]);
+    }
+
+    chunks.clear();
+    chunksX = chunksY = 0;
+}
+
+
+void TileLayer::setTilesetTexture(int tilesetIndex, int nativeTextureID)
+{
+    if (tilesetIndex < 0)
+    {
+        return;
+    }
+
+    while ((int)tilesetTextures.size() <= tilesetIndex)
+    {
+        tilesetTextures.push_back(-1);
+    }
+
+    tilesetTextures[tilesetIndex] = nativeTextureID;
+
+    for (UTsize i = 0; i < chunks.size(); i++)
+    {
+        chunks[i]->dirty = true;
+    }
+}
+
+
+bool TileLayer::setLayer(TMXMap *map, int layerIndex)
+{
+    if (!map || (layerIndex < 0) || (layerIndex >= map->getLayerCount()))
+    {
+        return false;
+    }
+
+    const TMXMapLayer *layer = map->layers[layerIndex];
+
+    mapWidth   = layer->width;
+    mapHeight  = layer->height;
+    tileWidth  = map->tileWidth;
+    tileHeight = map->tileHeight;
+    isometric  = map->orientation == "isometric";
+    tiles      = layer->tiles;
+    tilesets   = map->tilesets;
+
+    clearChunks();
+
+    chunksX = (mapWidth + TILELAYER_CHUNK_SIZE - 1) / TILELAYER_CHUNK_SIZE;
+    chunksY = (mapHeight + TILELAYER_CHUNK_SIZE - 1) / TILELAYER_CHUNK_SIZE;
+
+    for (int i = 0; i < chunksX * chunksY; i++)
+    {
+        Chunk *chunk = lmNew(NULL) Chunk();
+        chunk->minX  = chunk->minY = chunk->maxX = chunk->maxY = 0;
+        chunk->dirty = true;
+        chunks.push_back(chunk);
+    }
+
+    return true;
+}
+
+
+unsigned int TileLayer::getTile(int x, int y) const
+{
+    if ((x < 0) || (y < 0) || (x >= mapWidth) || (y >= mapHeight))
+    {
+        return 0;
+    }
+
+    return tiles[y * mapWidth + x];
+}
+
+
+void TileLayer::setTile(int x, int y, unsigned int gid)
+{
+    if ((x < 0) || (y < 0) || (x >= mapWidth) || (y >= mapHeight))
+    {
+        return;
+    }
+
+    tiles[y * mapWidth + x] = gid;
+
+    chunks[(y / TILELAYER_CHUNK_SIZE) * chunksX + x / TILELAYER_CHUNK_SIZE]->dirty = true;
+}
+
+
+void TileLayer::cellOrigin(int x, int y, float& px, float& py) const
+{
+    if (isometric)
+    {
+        px = (float)(x - y) * tileWidth * 0.5f;
+        py = (float)(x + y) * tileHeight * 0.5f;
+    }
+    else
+    {
+        px = (float)x * tileWidth;
+        py = (float)y * tileHeight;
+    }
+}
+
+
+void TileLayer::getLocalBounds(float& minX, float& minY, float& maxX, float& maxY) const
+{
+    if (isometric)
+    {
+        minX = -(float)(mapHeight - 1) * tileWidth * 0.5f;
+        maxX = (float)mapWidth * tileWidth * 0.5f + tileWidth * 0.5f;
+        minY = 0;
+        maxY = (float)(mapWidth + mapHeight) * tileHeight * 0.5f;
+    }
+    else
+    {
+        minX = 0;
+        minY = 0;
+        maxX = (float)mapWidth * tileWidth;
+        maxY = (float)mapHeight * tileHeight;
+    }
+}
+
+
+void TileLayer::buildChunk(int cx, int cy)
+{
+    Chunk *chunk = chunks[cy * chunksX + cx];
+
+    chunk->vertices.clear();
+    chunk->runs.clear();
+    chunk->minX  = chunk->minY = 1000000;
+    chunk->maxX  = chunk->maxY = -1000000;
+    chunk->dirty = false;
+
+    int x0 = cx * TILELAYER_CHUNK_SIZE;
+    int y0 = cy * TILELAYER_CHUNK_SIZE;
+    int x1 = x0 + TILELAYER_CHUNK_SIZE < mapWidth ? x0 + TILELAYER_CHUNK_SIZE : mapWidth;
+    int y1 = y0 + TILELAYER_CHUNK_SIZE < mapHeight ? y0 + TILELAYER_CHUNK_SIZE : mapHeight;
+
+    // One run per tileset, so each texture is bound once per chunk.
+    for (UTsize t = 0; t < tilesets.size(); t++)
+    {
+        if ((t >= tilesetTextures.size()) || (tilesetTextures[t] == -1))
+        {
+            continue;
+        }
+
+        const TMXMapTileset& tileset = tilesets[t];
+
+        GFX::TextureInfo *tinfo = GFX::Texture::getTextureInfo(tilesetTextures[t]);
+        if (!tinfo)
+        {
+            continue;
+        }
+
+        // Prefer the image size from the map so UVs stay right when the
+        // texture is scaled, fall back to the texture itself.
+        int imageWidth  = tileset.imageWidth > 0 ? tileset.imageWidth : tinfo->width;
+        int imageHeight = tileset.imageHeight > 0 ? tileset.imageHeight : tinfo->height;
+
+        if ((imageWidth <= 0) || (imageHeight <= 0))
+        {
+            // texture not loaded yet, try again next frame
+            chunk->dirty = true;
+            continue;
+        }
+
+        int columns = (imageWidth - 2 * tileset.margin + tileset.spacing) / (tileset.tileWidth + tileset.spacing);
+        if (columns <= 0)
+        {
+            continue;
+        }
+
+        // next tileset's first gid bounds this one
+        unsigned int lastGid = TMX_GID_MASK;
+        for (UTsize n = 0; n < tilesets.size(); n++)
+        {
+            if ((tilesets[n].firstGid > tileset.firstGid) && (tilesets[n].firstGid - 1 < lastGid))
+            {
+                lastGid = tilesets[n].firstGid - 1;
+            }
+        }
+
+        ChunkRun run;
+        run.texture = tilesetTextures[t];
+        run.start   = (int)chunk->vertices.size();
+        run.count   = 0;
+
+        for (int y = y0; y < y1; y++)
+        {
+            for (int x = x0; x < x1; x++)
+            {
+                unsigned int gid = tiles[y * mapWidth + x];
+                unsigned int id  = gid & TMX_GID_MASK;
+
+                if ((id == 0) || (id < tileset.firstGid) || (id > lastGid))
+                {
+                    continue;
+                }
+
+                int local = (int)(id - tileset.firstGid);
+                int sx    = tileset.margin + (local % columns) * (tileset.tileWidth + tileset.spacing);
+                int sy    = tileset.margin + (local / columns) * (tileset.tileHeight + tileset.spacing);
+
+                // inset by half a texel so neighbouring tiles don't bleed
+                float u0 = (sx + 0.5f) / imageWidth;
+                float v0 = (sy + 0.5f) / imageHeight;
+                float u1 = (sx + tileset.tileWidth - 0.5f) / imageWidth;
+                float v1 = (sy + tileset.tileHeight - 0.5f) / imageHeight;
+
+                // Tiles are bottom aligned to their cell, like Tiled draws them.
+                float px, py;
+                cellOrigin(x, y, px, py);
+                py += tileHeight - tileset.tileHeight;
+
+                float qx1 = px + tileset.tileWidth;
+                float qy1 = py + tileset.tileHeight;
+
+                // corners in top left, top right, bottom left, bottom right order
+                float cu[4] = { u0, u1, u0, u1 };
+                float cv[4] = { v0, v0, v1, v1 };
+                float tmp;
+
+                // Tiled applies the diagonal flip first, then horizontal and vertical.
+                if (gid & TMX_FLIPPED_DIAGONALLY)
+                {
+                    tmp = cu[1]; cu[1] = cu[2]; cu[2] = tmp;
+                    tmp = cv[1]; cv[1] = cv[2]; cv[2] = tmp;
+                }
+
+                if (gid & TMX_FLIPPED_HORIZONTALLY)
+                {
+                    tmp = cu[0]; cu[0] = cu[1]; cu[1] = tmp;
+                    tmp = cv[0]; cv[0] = cv[1]; cv[1] = tmp;
+                    tmp = cu[2]; cu[2] = cu[3]; cu[3] = tmp;
+                    tmp = cv[2]; cv[2] = cv[3]; cv[3] = tmp;
+                }
+
+                if (gid & TMX_FLIPPED_VERTICALLY)
+                {
+                    tmp = cu[0]; cu[0] = cu[2]; cu[2] = tmp;
+                    tmp = cv[0]; cv[0] = cv[2]; cv[2] = tmp;
+                    tmp = cu[1]; cu[1] = cu[3]; cu[3] = tmp;
+                    tmp = cv[1]; cv[1] = cv[3]; cv[3] = tmp;
+                }
+
+                float qx[4] = { px, qx1, px, qx1 };
+                float qy[4] = { py, py, qy1, qy1 };
+
+                for (int i = 0; i < 4; i++)
+                {
+                    GFX::VertexPosColorTex v;
+                    v.x    = qx[i];
+                    v.y    = qy[i];
+                    v.z    = 0;
+                    v.abgr = 0xFFFFFFFF;
+                    v.u    = cu[i];
+                    v.v    = cv[i];
+                    chunk->vertices.push_back(v);
+                }
+
+                chunk->minX = px < chunk->minX ? px : chunk->minX;
+                chunk->minY = py < chunk->minY ? py : chunk->minY;
+                chunk->maxX = qx1 > chunk->maxX ? qx1 : chunk->maxX;
+                chunk->maxY = qy1 > chunk->maxY ? qy1 : chunk->maxY;
+
+                run.count += 4;
+            }
+        }
+
+        if (run.count)
+        {
+            chunk->runs.push_back(run);
+        }
+    }
+}
+
+
+int TileLayer::_getBounds(lua_State *L)
+{
+    DisplayObject *targetSpace = NULL;
+
+    // check if we're given a DisplayObject to use as target space
+    if (!lua_isnil(L, 2))
+    {
+        targetSpace = (DisplayObject *)lualoom_getnativepointer(L, 2);
+    }
+
+    // get the Rectangle to store the bounds into
+    Rectangle *resultRect = (Rectangle *)lualoom_getnativepointer(L, 3);
+
+    // transform to target space
+    Matrix mtx;
+    getTargetTransformationMatrix(targetSpace, &mtx);
+
+    float lx0, ly0, lx1, ly1;
+    getLocalBounds(lx0, ly0, lx1, ly1);
+
+    float cornersX[4] = { lx0, lx1, lx0, lx1 };
+    float cornersY[4] = { ly0, ly0, ly1, ly1 };
+
+    lmscalar minx = 1000000;
+    lmscalar maxx = -1000000;
+    lmscalar miny = 1000000;
+    lmscalar maxy = -1000000;
+
+    for (int i = 0; i < 4; i++)
+    {
+        lmscalar x = mtx.a * cornersX[i] + mtx.c * cornersY[i] + mtx.tx;
+        lmscalar y = mtx.b * cornersX[i] + mtx.d * cornersY[i] + mtx.ty;
+
+        minx = x < minx ? x : minx;
+        maxx = x > maxx ? x : maxx;
+        miny = y < miny ? y : miny;
+        maxy = y > maxy ? y : maxy;
+    }
+
+    resultRect->x      = minx;
+    resultRect->y      = miny;
+    resultRect->width  = maxx - minx;
+    resultRect->height = maxy - miny;
+
+    return 0;
+}
+
+
+void TileLayer::render(lua_State *L)
+{
+    visibleChunks = 0;
+
+    if (!chunks.size())
+    {
+        return;
+    }
+
+    // apply the parent alpha
+    renderState.alpha = parent ? parent->renderState.alpha * alpha : alpha;
+    renderState.clampAlpha();
+
+    if (renderState.alpha == 0.0f)
+    {
+        return;
+    }
+
+    renderState.clipRect = parent ? parent->renderState.clipRect : Loom2D::Rectangle(0, 0, -1, -1);
+    if (renderState.isClipping()) GFX::Graphics::setClipRect((int)renderState.clipRect.x, (int)renderState.clipRect.y, (int)renderState.clipRect.width, (int)renderState.clipRect.height);
+
+    //set blend mode based to be unique or that of our parent
+    renderState.blendMode = (blendMode == BlendMode::AUTO && parent) ? parent->renderState.blendMode : blendMode;
+
+    unsigned int blendSrc, blendDst;
+    BlendMode::BlendFunction(renderState.blendMode, blendSrc, blendDst);
+
+    // update and get our transformation matrix
+    updateLocalTransform();
+
+    Matrix mtx;
+    getTargetTransformationMatrix(NULL, &mtx);
+
+    lmscalar det = mtx.a * mtx.d - mtx.b * mtx.c;
+    if (det == 0)
+    {
+        return;
+    }
+
+    // Bring the viewport, or clip rect, into layer space.
+    float sx0 = 0, sy0 = 0;
+    float sx1 = (float)GFX::Graphics::getWidth(), sy1 = (float)GFX::Graphics::getHeight();
+
+    if (renderState.isClipping())
+    {
+        sx0 = (float)renderState.clipRect.x;
+        sy0 = (float)renderState.clipRect.y;
+        sx1 = sx0 + (float)renderState.clipRect.width;
+        sy1 = sy0 + (float)renderState.clipRect.height;
+    }
+
+    Matrix inverse;
+    inverse.invertOther(&mtx);
+
+    float screenX[4] = { sx0, sx1, sx0, sx1 };
+    float screenY[4] = { sy0, sy0, sy1, sy1 };
+
+    float vx0 = 1e30f, vy0 = 1e30f, vx1 = -1e30f, vy1 = -1e30f;
+    for (int i = 0; i < 4; i++)
+    {
+        float x = (float)(inverse.a * screenX[i] + inverse.c * screenY[i] + inverse.tx);
+        float y = (float)(inverse.b * screenX[i] + inverse.d * screenY[i] + inverse.ty);
+
+        vx0 = x < vx0 ? x : vx0;
+        vx1 = x > vx1 ? x : vx1;
+        vy0 = y < vy0 ? y : vy0;
+        vy1 = y > vy1 ? y : vy1;
+    }
+
+    // Orthogonal chunks sit on a grid so the candidate range comes straight
+    // from the viewport, with a chunk of slack for tiles bigger than a cell.
+    // Isometric chunks are checked against their bounds.
+    int cx0 = 0, cy0 = 0, cx1 = chunksX - 1, cy1 = chunksY - 1;
+
+    if (!isometric && (tileWidth > 0) && (tileHeight > 0))
+    {
+        float chunkW = (float)tileWidth * TILELAYER_CHUNK_SIZE;
+        float chunkH = (float)tileHeight * TILELAYER_CHUNK_SIZE;
+
+        cx0 = clampChunk(floorf(vx0 / chunkW) - 1, chunksX);
+        cy0 = clampChunk(floorf(vy0 / chunkH) - 1, chunksY);
+        cx1 = clampChunk(floorf(vx1 / chunkW) + 1, chunksX);
+        cy1 = clampChunk(floorf(vy1 / chunkH) + 1, chunksY);
+    }
+
+    bool isIdentity = mtx.isIdentity();
+
+    for (int cy = cy0; cy <= cy1; cy++)
+    {
+        for (int cx = cx0; cx <= cx1; cx++)
+        {
+            Chunk *chunk = chunks[cy * chunksX + cx];
+
+            if (chunk->dirty)
+            {
+                buildChunk(cx, cy);
+            }
+
+            if (!chunk->runs.size())
+            {
+                continue;
+            }
+
+            if ((chunk->maxX < vx0) || (chunk->minX > vx1) || (chunk->maxY < vy0) || (chunk->minY > vy1))
+            {
+                continue;
+            }
+
+            visibleChunks++;
+
+            for (UTsize r = 0; r < chunk->runs.size(); r++)
+            {
+                const ChunkRun& run = chunk->runs[r];
+                GFX::VertexPosColorTex *src = chunk->vertices.ptr() + run.start;
+
+                // quick path if the vertices can go out as they are
+                if ((renderState.alpha == 1.0f) && isIdentity)
+                {
+                    GFX::QuadRenderer::batch(src, (uint16_t)run.count, run.texture, blendEnabled, blendSrc, blendDst, shader);
+                    continue;
+                }
+
+                GFX::VertexPosColorTex *v = GFX::QuadRenderer::getQuadVertexMemory((uint16_t)run.count, run.texture, blendEnabled, blendSrc, blendDst, shader);
+                if (!v)
+                {
+                    continue;
+                }
+
+                for (int i = 0; i < run.count; i++)
+                {
+                    *v = *src;
+
+                    if (!isIdentity)
+                    {
+                        lmscalar _x = mtx.a * v->x + mtx.c * v->y + mtx.tx;
+                        lmscalar _y = mtx.b * v->x + mtx.d * v->y + mtx.ty;
+
+                        v->x = (float) _x;
+                        v->y = (float) _y;
+                    }
+
+                    // modulate vertex alpha by our DisplayObject alpha setting
+                    if (renderState.alpha != 1.0f)
+                    {
+                        lmscalar va = ((lmscalar)(v->abgr >> 24)) * renderState.alpha;
+                        v->abgr = ((uint32_t)va << 24) | (v->abgr & 0x00FFFFFF);
+                    }
+
+                    v++;
+                    src++;
+                }
+            }
+        }
+    }
+}
+}
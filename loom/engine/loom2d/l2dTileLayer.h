@@ -0,0 +1,128 @@
+/*
+ * ===========================================================================
+ * Loom SDK
+ * Copyright 2011, 2012, 2013
+ * The Game Engine Company, LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ * ===========================================================================
+ */
+
+#pragma once
+
+#include "loom/engine/loom2d/l2dDisplayObject.h"
+#include "loom/engine/loom2d/l2dDisplayObjectContainer.h"
+#include "loom/engine/loom2d/l2dTMXMap.h"
+#include "loom/graphics/gfxQuadRenderer.h"
+#include "loom/graphics/gfxShader.h"
+
+namespace Loom2D
+{
+// Tiles along each side of a chunk, a full chunk is a single batch of
+// 4 * 16 * 16 vertices per texture.
+#define TILELAYER_CHUNK_SIZE    16
+
+// Native side of the TileLayer script class. Renders one tile layer of a
+// TMXMap as a grid of chunks; each chunk caches its vertices until one of
+// its tiles changes, and only chunks overlapping the viewport are submitted
+// to the QuadRenderer.
+class TileLayer : public DisplayObject
+{
+public:
+
+    // static type cache
+    static Type *typeTileLayer;
+
+    // initialize type information
+    static void initialize(lua_State *L)
+    {
+        typeTileLayer = LSLuaState::getLuaState(L)->getType("loom2d.display.TileLayer");
+        lmAssert(typeTileLayer, "unable to get loom2d.display.TileLayer type");
+    }
+
+    GFX::ShaderProgram *shader;
+
+    TileLayer();
+    ~TileLayer();
+
+    // assign the texture used by a tileset of the map, by tileset index
+    void setTilesetTexture(int tilesetIndex, int nativeTextureID);
+
+    // copy tiles and tilesets from a layer of map, returns false if there
+    // is no such layer
+    bool setLayer(TMXMap *map, int layerIndex);
+
+    // tile gid, including flip flags, at the given cell
+    unsigned int getTile(int x, int y) const;
+    void setTile(int x, int y, unsigned int gid);
+
+    int getMapWidth() const { return mapWidth; }
+    int getMapHeight() const { return mapHeight; }
+    int getChunkCount() const { return (int)chunks.size(); }
+    int getVisibleChunkCount() const { return visibleChunks; }
+
+    void setShader(GFX::ShaderProgram* sh)
+    {
+        shader = sh;
+    }
+
+    GFX::ShaderProgram* getShader() const
+    {
+        return shader;
+    }
+
+    // gets the bounding rectangle of the layer
+    int _getBounds(lua_State *L);
+
+    // renders the visible chunks
+    void render(lua_State *L);
+
+private:
+
+    // A run of quads in a chunk sharing a texture.
+    struct ChunkRun
+    {
+        GFX::TextureID texture;
+        int            start;
+        int            count;
+    };
+
+    struct Chunk
+    {
+        utArray<GFX::VertexPosColorTex> vertices;
+        utArray<ChunkRun>               runs;
+
+        // bounds in layer space, only valid once built
+        float minX, minY, maxX, maxY;
+
+        bool  dirty;
+    };
+
+    int mapWidth, mapHeight;
+    int tileWidth, tileHeight;
+    bool isometric;
+
+    int chunksX, chunksY;
+    int visibleChunks;
+
+    utArray<unsigned int>  tiles;
+    utArray<TMXMapTileset> tilesets;
+    utArray<int>           tilesetTextures;
+    utArray<Chunk *>       chunks;
+
+    void clearChunks();
+    void buildChunk(int cx, int cy);
+    void cellOrigin(int x, int y, float& px, float& py) const;
+    void getLocalBounds(float& minX, float& minY, float& maxX, float& maxY) const;
+};
+}
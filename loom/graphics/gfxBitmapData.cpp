@@ -26,11 +26,22 @@
 #include "loom/common/assets/assetsImage.h"
 #include "loom/common/core/log.h"
 #include "loom/common/core/string.h"
+#include "loom/common/core/telemetry.h"
+#include "loom/common/platform/platformThread.h"
+#include "loom/script/loomscript.h"
 
 #include "stb_image_write.h"
 #include <math.h>
 #include <string.h>
 
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define LOOM_BITMAP_SSE2    1
+#elif defined(__ARM_NEON__) || defined(__ARM_NEON)
+#include <arm_neon.h>
+#define LOOM_BITMAP_NEON    1
+#endif
+
 
 const int DATA_BPP = 4;
 
@@ -51,6 +62,59 @@ namespace GFX
         }
     }
 
+    LS::NativeDelegate BitmapData::_onFramebufferReadDelegate;
+
+    BitmapData* BitmapData::create(unsigned int width, unsigned int height, rgba_t color)
+    {
+        if (width == 0 || height == 0)
+        {
+            lmLogError(gGFXLogGroup, "Invalid BitmapData size %d x %d", width, height);
+            return NULL;
+        }
+
+        BitmapData* result = lmNew(NULL) BitmapData(width, height);
+        result->fillRect(0, 0, width, height, color);
+        return result;
+    }
+
+    bool BitmapData::clip(int& x, int& y, int& width, int& height) const
+    {
+        if (x < 0)
+        {
+            width += x;
+            x = 0;
+        }
+
+        if (y < 0)
+        {
+            height += y;
+            y = 0;
+        }
+
+        if (x + width > (int)w)
+            width = (int)w - x;
+
+        if (y + height > (int)h)
+            height = (int)h - y;
+
+        return width > 0 && height > 0;
+    }
+
+    void BitmapData::flipRows()
+    {
+        size_t stride = w * DATA_BPP;
+        channel_t* row = (channel_t*)lmAlloc(NULL, stride);
+
+        for (unsigned int top = 0, bottom = h - 1; top < bottom; top++, bottom--)
+        {
+            memcpy(row, data + top * stride, stride);
+            memcpy(data + top * stride, data + bottom * stride, stride);
+            memcpy(data + bottom * stride, row, stride);
+        }
+
+        lmFree(NULL, row);
+    }
+
     void BitmapData::save(const char* path) const
     {
         const char* ext = strrchr(path, '.');
@@ -126,7 +190,238 @@ namespace GFX
         return Texture::load(data, w, h, info->id);
     }
 
-    const BitmapData* BitmapData::fromFramebuffer()
+    void BitmapData::fillRect(int x, int y, int width, int height, rgba_t color)
+    {
+        if (!clip(x, y, width, height))
+            return;
+
+        rgba_t value = convertHostToBEndian(color);
+        rgba_t* first = reinterpret_cast<rgba_t*>(data) + x + y * w;
+
+        for (int i = 0; i < width; i++)
+            first[i] = value;
+
+        // the rest of the rows are copies of the first
+        for (int j = 1; j < height; j++)
+            memcpy(first + j * w, first, width * DATA_BPP);
+    }
+
+    void BitmapData::copyPixels(const BitmapData* source, int sourceX, int sourceY, int width, int height, int destX, int destY, bool mergeAlpha)
+    {
+        if (source == NULL)
+            return;
+
+        // clip against the source, then against this bitmap
+        int sx = sourceX, sy = sourceY;
+        if (!source->clip(sx, sy, width, height))
+            return;
+
+        destX += sx - sourceX;
+        destY += sy - sourceY;
+
+        int dx = destX, dy = destY;
+        if (!clip(dx, dy, width, height))
+            return;
+
+        sx += dx - destX;
+        sy += dy - destY;
+
+        size_t rowBytes = width * DATA_BPP;
+
+        // copying within one bitmap walks rows bottom up when moving down
+        // so the source isn't overwritten before it is read
+        bool reverse = source == this && dy > sy;
+
+        for (int r = 0; r < height; r++)
+        {
+            int j = reverse ? height - 1 - r : r;
+
+            const channel_t* src = source->data + ((sy + j) * source->w + sx) * DATA_BPP;
+            channel_t* dst = data + ((dy + j) * w + dx) * DATA_BPP;
+
+            if (!mergeAlpha)
+            {
+                memmove(dst, src, rowBytes);
+                continue;
+            }
+
+            // overlapping rows in the same bitmap are blended from a copy
+            channel_t* copy = NULL;
+            if (source == this)
+            {
+                copy = (channel_t*)lmAlloc(NULL, rowBytes);
+                memcpy(copy, src, rowBytes);
+                src = copy;
+            }
+
+            for (int i = 0; i < width; i++, src += DATA_BPP, dst += DATA_BPP)
+            {
+                unsigned int sa = src[3];
+
+                if (sa == 255)
+                {
+                    memcpy(dst, src, DATA_BPP);
+                    continue;
+                }
+
+                unsigned int ia = 255 - sa;
+                dst[0] = (channel_t)((src[0] * sa + dst[0] * ia + 127) / 255);
+                dst[1] = (channel_t)((src[1] * sa + dst[1] * ia + 127) / 255);
+                dst[2] = (channel_t)((src[2] * sa + dst[2] * ia + 127) / 255);
+                dst[3] = (channel_t)(sa + (dst[3] * ia + 127) / 255);
+            }
+
+            if (copy)
+                lmFree(NULL, copy);
+        }
+    }
+
+    void BitmapData::colorTransform(int x, int y, int width, int height, const float* multipliers, const float* offsets)
+    {
+        if (!clip(x, y, width, height))
+            return;
+
+        // every channel value maps to the same result, so the transform is
+        // done through a table per channel
+        channel_t table[DATA_BPP][256];
+        for (int c = 0; c < DATA_BPP; c++)
+        {
+            for (int v = 0; v < 256; v++)
+            {
+                float result = v * multipliers[c] + offsets[c];
+                table[c][v] = (channel_t)(result <= 0.0f ? 0 : result >= 255.0f ? 255 : (int)(result + 0.5f));
+            }
+        }
+
+        for (int j = 0; j < height; j++)
+        {
+            channel_t* p = data + ((y + j) * w + x) * DATA_BPP;
+
+            for (int i = 0; i < width; i++, p += DATA_BPP)
+            {
+                p[0] = table[0][p[0]];
+                p[1] = table[1][p[1]];
+                p[2] = table[2][p[2]];
+                p[3] = table[3][p[3]];
+            }
+        }
+    }
+
+    int BitmapData::colorTransform(lua_State *L)
+    {
+        float multipliers[DATA_BPP];
+        float offsets[DATA_BPP];
+
+        for (int c = 0; c < DATA_BPP; c++)
+        {
+            multipliers[c] = (float)lua_tonumber(L, 6 + c);
+            offsets[c] = (float)lua_tonumber(L, 10 + c);
+        }
+
+        colorTransform((int)lua_tonumber(L, 2), (int)lua_tonumber(L, 3), (int)lua_tonumber(L, 4), (int)lua_tonumber(L, 5), multipliers, offsets);
+
+        return 0;
+    }
+
+    int BitmapData::threshold(int x, int y, int width, int height, const char* operation, rgba_t threshold, rgba_t color, rgba_t mask)
+    {
+        enum { LESS, LESSEQUAL, GREATER, GREATEREQUAL, EQUAL, NOTEQUAL } op;
+
+        if (operation == NULL)
+            operation = "";
+
+        if (!strcmp(operation, "<"))
+            op = LESS;
+        else if (!strcmp(operation, "<="))
+            op = LESSEQUAL;
+        else if (!strcmp(operation, ">"))
+            op = GREATER;
+        else if (!strcmp(operation, ">="))
+            op = GREATEREQUAL;
+        else if (!strcmp(operation, "=="))
+            op = EQUAL;
+        else if (!strcmp(operation, "!="))
+            op = NOTEQUAL;
+        else
+        {
+            lmLogError(gGFXLogGroup, "Unknown BitmapData threshold operation '%s'", operation);
+            return 0;
+        }
+
+        if (!clip(x, y, width, height))
+            return 0;
+
+        rgba_t value = convertHostToBEndian(color);
+        rgba_t limit = threshold & mask;
+        int changed = 0;
+
+        for (int j = 0; j < height; j++)
+        {
+            rgba_t* p = reinterpret_cast<rgba_t*>(data) + x + (y + j) * w;
+
+            for (int i = 0; i < width; i++)
+            {
+                rgba_t masked = convertHostToBEndian(p[i]) & mask;
+                bool pass;
+
+                switch (op)
+                {
+                case LESS:          pass = masked < limit; break;
+                case LESSEQUAL:     pass = masked <= limit; break;
+                case GREATER:       pass = masked > limit; break;
+                case GREATEREQUAL:  pass = masked >= limit; break;
+                case EQUAL:         pass = masked == limit; break;
+                default:            pass = masked != limit; break;
+                }
+
+                if (pass)
+                {
+                    p[i] = value;
+                    changed++;
+                }
+            }
+        }
+
+        return changed;
+    }
+
+    void BitmapData::histogram(int x, int y, int width, int height, unsigned int* counts)
+    {
+        memset(counts, 0, DATA_BPP * 256 * sizeof(unsigned int));
+
+        if (!clip(x, y, width, height))
+            return;
+
+        for (int j = 0; j < height; j++)
+        {
+            const channel_t* p = data + ((y + j) * w + x) * DATA_BPP;
+
+            for (int i = 0; i < width; i++, p += DATA_BPP)
+            {
+                counts[p[0]]++;
+                counts[256 + p[1]]++;
+                counts[512 + p[2]]++;
+                counts[768 + p[3]]++;
+            }
+        }
+    }
+
+    int BitmapData::histogram(lua_State *L)
+    {
+        unsigned int counts[DATA_BPP * 256];
+        histogram((int)lua_tonumber(L, 2), (int)lua_tonumber(L, 3), (int)lua_tonumber(L, 4), (int)lua_tonumber(L, 5), counts);
+
+        lua_Number numbers[DATA_BPP * 256];
+        for (int i = 0; i < DATA_BPP * 256; i++)
+            numbers[i] = (lua_Number)counts[i];
+
+        lsr_vector_set_length(L, 6, DATA_BPP * 256);
+        lsr_vector_write_numbers(L, 6, 0, numbers, DATA_BPP * 256);
+
+        return 0;
+    }
+
+    BitmapData* BitmapData::readFramebuffer()
     {
         int w = GFX::Graphics::getWidth();
         int h = GFX::Graphics::getHeight();
@@ -146,18 +441,200 @@ namespace GFX
 
         GFX::GL_Context* ctx = GFX::Graphics::context();
 
-        utByteArray tmp;
-        tmp.resize(result->w * result->h * DATA_BPP);
-
         ctx->glPixelStorei(GL_PACK_ALIGNMENT, 1);
-        ctx->glReadPixels(0, 0, result->w, result->h, GL_RGBA, GL_UNSIGNED_BYTE, tmp.getDataPtr());
+        ctx->glReadPixels(0, 0, result->w, result->h, GL_RGBA, GL_UNSIGNED_BYTE, result->data);
+
+        return result;
+    }
+
+    const BitmapData* BitmapData::fromFramebuffer()
+    {
+        BitmapData* result = readFramebuffer();
+
+        if (result != NULL)
+            result->flipRows();
+
+        return result;
+    }
+
+    // A framebuffer read waiting for the worker, saved to path and released
+    // there when path is set, otherwise delivered to onFramebufferRead.
+    struct FramebufferRead
+    {
+        BitmapData* bitmap;
+        utString    path;
+    };
+
+    // Requests made this frame, main thread only.
+    static int                     gFramebufferReadsRequested = 0;
+    static utArray<utString>       gFramebufferSavesRequested;
+
+    // Shared with the worker, which drains the queue like the image rescaler.
+    static MutexHandle             gFramebufferReadMutex = NULL;
+    static utList<FramebufferRead*> gFramebufferReadQueue;
+    static utArray<BitmapData*>    gFramebufferReadsDone;
+    static bool                    gFramebufferReadWorkerRunning = false;
 
-        for (int i = result->h - 1; i >= 0; i--)
+    // The last worker started, joined before the next one starts and on
+    // shutdown. Main thread only.
+    static ThreadHandle            gFramebufferReadWorker = NULL;
+
+    void BitmapData::fromFramebufferAsync()
+    {
+        gFramebufferReadsRequested++;
+    }
+
+    void BitmapData::saveFramebufferAsync(const char* path)
+    {
+        gFramebufferSavesRequested.push_back(path);
+    }
+
+    int __stdcall BitmapData::asyncReadWorker(void *param)
+    {
+        TelemetryThreadScope traceThread("framebuffer read");
+
+        while (true)
+        {
+            loom_mutex_lock(gFramebufferReadMutex);
+
+            if (gFramebufferReadQueue.empty())
+            {
+                gFramebufferReadWorkerRunning = false;
+                loom_mutex_unlock(gFramebufferReadMutex);
+                break;
+            }
+
+            FramebufferRead* read = gFramebufferReadQueue.front();
+            gFramebufferReadQueue.pop_front();
+
+            loom_mutex_unlock(gFramebufferReadMutex);
+
+            {
+                LOOM_PROFILE_SCOPE(framebufferReadFinish);
+
+                read->bitmap->flipRows();
+
+                if (read->path.size())
+                {
+                    read->bitmap->save(read->path.c_str());
+                    lmDelete(NULL, read->bitmap);
+                }
+                else
+                {
+                    loom_mutex_lock(gFramebufferReadMutex);
+                    gFramebufferReadsDone.push_back(read->bitmap);
+                    loom_mutex_unlock(gFramebufferReadMutex);
+                }
+            }
+
+            lmDelete(NULL, read);
+        }
+
+        return 0;
+    }
+
+    void BitmapData::processFramebufferReads()
+    {
+        if (gFramebufferReadMutex == NULL)
         {
-            memcpy(result->data + (result->h - 1 - i) * result->w * DATA_BPP, (channel_t*)tmp.getDataPtr() + i * result->w * DATA_BPP, result->w * DATA_BPP);
+            if (!gFramebufferReadsRequested && !gFramebufferSavesRequested.size())
+                return;
+
+            gFramebufferReadMutex = loom_mutex_create();
         }
 
-        return result;
+        // Deliver the reads the worker has finished.
+        utArray<BitmapData*> done;
+
+        loom_mutex_lock(gFramebufferReadMutex);
+        for (UTsize i = 0; i < gFramebufferReadsDone.size(); i++)
+            done.push_back(gFramebufferReadsDone[i]);
+        gFramebufferReadsDone.clear();
+        loom_mutex_unlock(gFramebufferReadMutex);
+
+        for (UTsize i = 0; i < done.size(); i++)
+        {
+            if (_onFramebufferReadDelegate.getCount() == 0)
+            {
+                lmDelete(NULL, done[i]);
+                continue;
+            }
+
+            lualoom_pushnative<BitmapData>(_onFramebufferReadDelegate.getVM(), done[i]);
+            _onFramebufferReadDelegate.incArgCount();
+            _onFramebufferReadDelegate.invoke();
+        }
+
+        // Read the framebuffer once for everything requested this frame.
+        int requests = gFramebufferReadsRequested + (int)gFramebufferSavesRequested.size();
+        if (requests == 0)
+            return;
+
+        BitmapData* frame = readFramebuffer();
+
+        loom_mutex_lock(gFramebufferReadMutex);
+
+        for (int i = 0; frame != NULL && i < requests; i++)
+        {
+            FramebufferRead* read = lmNew(NULL) FramebufferRead();
+
+            read->bitmap = frame;
+            if (i < requests - 1)
+            {
+                read->bitmap = lmNew(NULL) BitmapData(frame->w, frame->h);
+                memcpy(read->bitmap->data, frame->data, frame->w * frame->h * DATA_BPP);
+            }
+
+            if (i < (int)gFramebufferSavesRequested.size())
+                read->path = gFramebufferSavesRequested[i];
+
+            gFramebufferReadQueue.push_back(read);
+        }
+
+        bool startWorker = false;
+        if (!gFramebufferReadWorkerRunning && !gFramebufferReadQueue.empty())
+        {
+            gFramebufferReadWorkerRunning = true;
+            startWorker = true;
+        }
+
+        loom_mutex_unlock(gFramebufferReadMutex);
+
+        if (startWorker)
+        {
+            // The previous worker found the queue empty and is exiting
+            if (gFramebufferReadWorker != NULL)
+                loom_thread_join(gFramebufferReadWorker);
+
+            gFramebufferReadWorker = loom_thread_start(asyncReadWorker, NULL);
+        }
+
+        gFramebufferReadsRequested = 0;
+        gFramebufferSavesRequested.clear();
+    }
+
+    void BitmapData::shutdownFramebufferReads()
+    {
+        // The worker runs until the queue is empty, so this also finishes
+        // writing every queued save
+        if (gFramebufferReadWorker != NULL)
+        {
+            loom_thread_join(gFramebufferReadWorker);
+            gFramebufferReadWorker = NULL;
+        }
+
+        gFramebufferReadsRequested = 0;
+        gFramebufferSavesRequested.clear();
+
+        if (gFramebufferReadMutex == NULL)
+            return;
+
+        for (UTsize i = 0; i < gFramebufferReadsDone.size(); i++)
+            lmDelete(NULL, gFramebufferReadsDone[i]);
+        gFramebufferReadsDone.clear();
+
+        loom_mutex_destroy(gFramebufferReadMutex);
+        gFramebufferReadMutex = NULL;
     }
 
     const BitmapData* BitmapData::fromAsset(const char* name)
@@ -168,6 +645,11 @@ namespace GFX
         if (img == NULL)
             return NULL;
 
+        const void* bits = loom_asset_imageDecode(img);
+
+        if (bits == NULL)
+            return NULL;
+
         BitmapData* result = lmNew(NULL) BitmapData(
             (size_t)img->width,
             (size_t)img->height
@@ -178,27 +660,48 @@ namespace GFX
             return NULL;
         }
 
-        memcpy(result->data, img->bits, img->width * img->height * DATA_BPP);
+        memcpy(result->data, bits, (size_t)img->width * img->height * DATA_BPP);
 
         return result;
     }
 
     lmscalar BitmapData::compare(const BitmapData* a, const BitmapData* b)
     {
-        lmscalar result = 0;
         if (a->w != b->w || a->h != b->h)
             return (lmscalar)1.0;
 
-        rgba_t* pixelptr_a = reinterpret_cast<rgba_t*>(a->data);
-        rgba_t* pixelptr_b = reinterpret_cast<rgba_t*>(b->data);
+        const rgba_t* pixelptr_a = reinterpret_cast<const rgba_t*>(a->data);
+        const rgba_t* pixelptr_b = reinterpret_cast<const rgba_t*>(b->data);
+
+        size_t count = a->w * a->h;
+        size_t i = 0;
+        size_t differing = 0;
+
+#if LOOM_BITMAP_SSE2
+        // Four pixels at a time, each equal pixel sets four mask bits.
+        for (; i + 4 <= count; i += 4)
+        {
+            __m128i pa = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pixelptr_a + i));
+            __m128i pb = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pixelptr_b + i));
+            int equal = _mm_movemask_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(pa, pb)));
+            differing += 4 - ((equal & 1) + ((equal >> 1) & 1) + ((equal >> 2) & 1) + ((equal >> 3) & 1));
+        }
+#elif LOOM_BITMAP_NEON
+        for (; i + 4 <= count; i += 4)
+        {
+            uint32x4_t equal = vshrq_n_u32(vceqq_u32(vld1q_u32(pixelptr_a + i), vld1q_u32(pixelptr_b + i)), 31);
+            uint32x2_t sum = vpadd_u32(vget_low_u32(equal), vget_high_u32(equal));
+            differing += 4 - (vget_lane_u32(sum, 0) + vget_lane_u32(sum, 1));
+        }
+#endif
 
-        for (size_t i = 0; i < a->w * a->h; i++)
+        for (; i < count; i++)
         {
             if (pixelptr_a[i] != pixelptr_b[i])
-                result += 1;
+                differing++;
         }
 
-        return result / (a->w * a->h);
+        return (lmscalar)differing / count;
     }
 
     BitmapData* BitmapData::diff(const BitmapData* a, const BitmapData* b)
@@ -216,17 +719,37 @@ namespace GFX
             return NULL;
         }
 
-        rgba_t* pixelptr_a = reinterpret_cast<rgba_t*>(a->data);
-        rgba_t* pixelptr_b = reinterpret_cast<rgba_t*>(b->data);
-        rgba_t* resultptr = reinterpret_cast<rgba_t*>(result->data);
+        const channel_t* pa = a->data;
+        const channel_t* pb = b->data;
+        channel_t* pr = result->data;
+
+        size_t bytes = a->w * a->h * DATA_BPP;
+        size_t i = 0;
+
+        // Absolute difference of each color channel, alpha is always opaque.
+#if LOOM_BITMAP_SSE2
+        const __m128i opaque = _mm_set1_epi32(convertHostToBEndian(0x000000FF));
+        for (; i + 16 <= bytes; i += 16)
+        {
+            __m128i va = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pa + i));
+            __m128i vb = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pb + i));
+            __m128i d = _mm_or_si128(_mm_subs_epu8(va, vb), _mm_subs_epu8(vb, va));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(pr + i), _mm_or_si128(d, opaque));
+        }
+#elif LOOM_BITMAP_NEON
+        const uint8x16_t opaque = vreinterpretq_u8_u32(vdupq_n_u32(convertHostToBEndian(0x000000FF)));
+        for (; i + 16 <= bytes; i += 16)
+        {
+            uint8x16_t d = vabdq_u8(vld1q_u8(pa + i), vld1q_u8(pb + i));
+            vst1q_u8(pr + i, vorrq_u8(d, opaque));
+        }
+#endif
 
-        for (size_t i = 0; i < a->w * a->h; i++)
+        for (; i < bytes; i += DATA_BPP)
         {
-            Color ap(convertHostToBEndian(pixelptr_a[i]));
-            Color bp(convertHostToBEndian(pixelptr_b[i]));
-            Color rp(fabsf(ap.r - bp.r), fabsf(ap.g - bp.g), fabsf(ap.b - bp.b), 1.0f);
-            rgba_t a = rp.getHex();
-            resultptr[i] = convertBEndianToHost(a);
+            for (int c = 0; c < DATA_BPP - 1; c++)
+                pr[i + c] = (channel_t)(pa[i + c] > pb[i + c] ? pa[i + c] - pb[i + c] : pb[i + c] - pa[i + c]);
+            pr[i + DATA_BPP - 1] = 255;
         }
 
         return result;
@@ -23,6 +23,7 @@
 #include "loom/common/utils/utCommon.h"
 #include "loom/graphics/gfxColor.h"
 #include "loom/graphics/gfxTexture.h"
+#include "loom/script/native/lsNativeDelegate.h"
 
 namespace GFX
 {
@@ -33,6 +34,12 @@ namespace GFX
  * BitmapData can be loaded from the current framebuffer or from an asset.
  * Then this data can be compared and get a numeric result or a diff image can
  * be generated.
+ *
+ * Framebuffer reads can be asynchronous: the pixels are read at the end of
+ * the frame and flipped (or saved) on a worker thread, then handed to the
+ * onFramebufferRead delegate at the end of a later frame. The bulk pixel
+ * operations work on whole rectangles so image processing doesn't go through
+ * getPixel/setPixel calls, rectangles are clipped to the bitmap.
  */
 class BitmapData
 {
@@ -45,10 +52,30 @@ private:
     // Private constructor. Use only static methods for construction.
     BitmapData(unsigned int width, unsigned int height);
 
+    // Clips a rectangle to the bitmap, returns false if nothing is left.
+    bool clip(int& x, int& y, int& width, int& height) const;
+
+    // Reverses the row order, GL reads the framebuffer bottom row first.
+    void flipRows();
+
+    // Reads the framebuffer into a new bitmap without flipping it.
+    static BitmapData* readFramebuffer();
+
+    // Flips and saves or queues for delivery the queued framebuffer reads.
+    static int __stdcall asyncReadWorker(void *param);
+
 public:
 
     ~BitmapData();
 
+    LOOM_STATICDELEGATE(onFramebufferRead);
+
+    // Creates a bitmap of the given size filled with a RGBA color.
+    static BitmapData* create(unsigned int width, unsigned int height, rgba_t color);
+
+    unsigned int getWidth() const { return w; }
+    unsigned int getHeight() const { return h; }
+
     // Saves the loaded data to a file. Supported file formats are BMP, PNG and TGA.
     void save(const char* path) const;
 
@@ -60,8 +87,55 @@ public:
 
     TextureInfo* createTextureInfo() const;
 
+    // Fills a rectangle with a RGBA color.
+    void fillRect(int x, int y, int width, int height, rgba_t color);
+
+    // Copies a rectangle of source to (destX, destY). With mergeAlpha the
+    // source is blended over this bitmap using its alpha, otherwise pixels
+    // are replaced.
+    void copyPixels(const BitmapData* source, int sourceX, int sourceY, int width, int height, int destX, int destY, bool mergeAlpha);
+
+    // Multiplies each channel of a rectangle then adds an offset (in 0-255
+    // units), like flash.geom.ColorTransform. Multipliers and offsets are in
+    // RGBA order.
+    void colorTransform(int x, int y, int width, int height, const float* multipliers, const float* offsets);
+
+    // Script version of colorTransform. Stack: this, x, y, width, height,
+    // 4 multipliers and 4 offsets.
+    int colorTransform(lua_State *L);
+
+    // Sets pixels of a rectangle whose masked value passes the test against
+    // threshold to color. Operations are "<", "<=", ">", ">=", "==" and
+    // "!=". Returns the number of pixels changed.
+    int threshold(int x, int y, int width, int height, const char* operation, rgba_t threshold, rgba_t color, rgba_t mask);
+
+    // Counts channel values of a rectangle into 1024 counts, 256 for each of
+    // red, green, blue and alpha.
+    void histogram(int x, int y, int width, int height, unsigned int* counts);
+
+    // Script version of histogram, into a Number vector. Stack: this, x, y,
+    // width, height, vector.
+    int histogram(lua_State *L);
+
     // Loads data from the current framebuffer
     static const BitmapData* fromFramebuffer();
+
+    // Reads the current framebuffer at the end of the frame, the result is
+    // passed to onFramebufferRead at the end of a later frame
+    static void fromFramebufferAsync();
+
+    // Reads the current framebuffer at the end of the frame and saves it
+    // to path on a worker thread
+    static void saveFramebufferAsync(const char* path);
+
+    // Issues the framebuffer reads queued this frame and delivers completed
+    // ones, called by Graphics::endFrame
+    static void processFramebufferReads();
+
+    // Waits for the worker to finish the queued reads and saves, then frees
+    // the reads that were never delivered, called by Graphics::shutdown
+    static void shutdownFramebufferReads();
+
     // Loads data from an asset
     static const BitmapData* fromAsset(const char* name);
 
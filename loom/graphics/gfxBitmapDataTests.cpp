@@ -0,0 +1,216 @@
+/*
+ * ===========================================================================
+ * Loom SDK
+ * Copyright 2011, 2012, 2013
+ * The Game Engine Company, LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ * ===========================================================================
+ */
+
+#include "seatest.h"
+#include "loom/common/core/allocator.h"
+#include "loom/graphics/gfxBitmapData.h"
+
+using namespace GFX;
+
+SEATEST_FIXTURE(gfxBitmapData)
+{
+    SEATEST_FIXTURE_ENTRY(bitmapData_fillRect);
+    SEATEST_FIXTURE_ENTRY(bitmapData_copyPixels);
+    SEATEST_FIXTURE_ENTRY(bitmapData_colorTransform);
+    SEATEST_FIXTURE_ENTRY(bitmapData_threshold);
+    SEATEST_FIXTURE_ENTRY(bitmapData_histogram);
+    SEATEST_FIXTURE_ENTRY(bitmapData_compare);
+    SEATEST_FIXTURE_ENTRY(bitmapData_diff);
+}
+
+SEATEST_TEST(bitmapData_fillRect)
+{
+    BitmapData *bitmap = BitmapData::create(5, 4, 0x000000FF);
+
+    assert_true(bitmap != NULL);
+    assert_int_equal(5, bitmap->getWidth());
+    assert_int_equal(4, bitmap->getHeight());
+    assert_ulong_equal(0x000000FF, bitmap->getPixel(4, 3));
+
+    // Channels are stored in RGBA order whatever the host's endianness.
+    bitmap->fillRect(1, 1, 2, 2, 0x11223344);
+    assert_int_equal(0x11, bitmap->getData()[(1 * 5 + 1) * 4]);
+    assert_int_equal(0x44, bitmap->getData()[(1 * 5 + 1) * 4 + 3]);
+    assert_ulong_equal(0x11223344, bitmap->getPixel(2, 2));
+    assert_ulong_equal(0x000000FF, bitmap->getPixel(3, 2));
+    assert_ulong_equal(0x000000FF, bitmap->getPixel(1, 3));
+
+    // Rectangles are clipped to the bitmap.
+    bitmap->fillRect(-2, 3, 10, 10, 0xFFFFFFFF);
+    assert_ulong_equal(0xFFFFFFFF, bitmap->getPixel(0, 3));
+    assert_ulong_equal(0xFFFFFFFF, bitmap->getPixel(4, 3));
+    assert_ulong_equal(0x11223344, bitmap->getPixel(1, 2));
+
+    bitmap->fillRect(5, 0, 1, 1, 0xFF0000FF);
+    bitmap->fillRect(0, 0, 0, 4, 0xFF0000FF);
+    assert_ulong_equal(0x000000FF, bitmap->getPixel(0, 0));
+
+    assert_true(BitmapData::create(0, 4, 0) == NULL);
+
+    lmDelete(NULL, bitmap);
+}
+
+SEATEST_TEST(bitmapData_copyPixels)
+{
+    BitmapData *source = BitmapData::create(4, 4, 0xFF000080);
+    BitmapData *dest   = BitmapData::create(4, 4, 0x0000FFFF);
+
+    source->setPixel(0, 0, 0x00FF00FF);
+
+    // Replacing pixels, clipped against both bitmaps.
+    dest->copyPixels(source, -1, -1, 3, 3, 2, 2, false);
+    assert_ulong_equal(0x0000FFFF, dest->getPixel(2, 2));
+    assert_ulong_equal(0x00FF00FF, dest->getPixel(3, 3));
+    assert_ulong_equal(0x0000FFFF, dest->getPixel(1, 1));
+
+    // Merging alpha blends the source over the destination.
+    dest->copyPixels(source, 1, 1, 1, 1, 0, 0, true);
+    assert_ulong_equal(0x80007FFF, dest->getPixel(0, 0));
+
+    // Opaque source pixels replace the destination.
+    dest->copyPixels(source, 0, 0, 1, 1, 1, 0, true);
+    assert_ulong_equal(0x00FF00FF, dest->getPixel(1, 0));
+
+    // Overlapping copies within a bitmap read the source before writing it.
+    BitmapData *strip = BitmapData::create(1, 4, 0);
+    strip->setPixel(0, 0, 0x01);
+    strip->setPixel(0, 1, 0x02);
+    strip->setPixel(0, 2, 0x03);
+    strip->copyPixels(strip, 0, 0, 1, 3, 0, 1, false);
+    assert_ulong_equal(0x01, strip->getPixel(0, 1));
+    assert_ulong_equal(0x02, strip->getPixel(0, 2));
+    assert_ulong_equal(0x03, strip->getPixel(0, 3));
+
+    lmDelete(NULL, strip);
+    lmDelete(NULL, dest);
+    lmDelete(NULL, source);
+}
+
+SEATEST_TEST(bitmapData_colorTransform)
+{
+    BitmapData *bitmap = BitmapData::create(3, 1, 0x804020FF);
+
+    float multipliers[4] = { 0.5f, 2.0f, 1.0f, 1.0f };
+    float offsets[4]     = { 0.0f, 0.0f, 300.0f, -127.0f };
+
+    bitmap->colorTransform(1, 0, 5, 1, multipliers, offsets);
+
+    // Results are rounded and clamped to 0-255.
+    assert_ulong_equal(0x4080FF80, bitmap->getPixel(1, 0));
+    assert_ulong_equal(0x4080FF80, bitmap->getPixel(2, 0));
+    assert_ulong_equal(0x804020FF, bitmap->getPixel(0, 0));
+
+    lmDelete(NULL, bitmap);
+}
+
+SEATEST_TEST(bitmapData_threshold)
+{
+    BitmapData *bitmap = BitmapData::create(4, 1, 0);
+
+    bitmap->setPixel(0, 0, 0x10000000);
+    bitmap->setPixel(1, 0, 0x20000000);
+    bitmap->setPixel(2, 0, 0x300000FF);
+    bitmap->setPixel(3, 0, 0x400000FE);
+
+    // Only the masked red channel is compared.
+    assert_int_equal(2, bitmap->threshold(0, 0, 4, 1, "<=", 0x20FFFFFF, 0xFFFFFFFF, 0xFF000000));
+    assert_ulong_equal(0xFFFFFFFF, bitmap->getPixel(0, 0));
+    assert_ulong_equal(0xFFFFFFFF, bitmap->getPixel(1, 0));
+    assert_ulong_equal(0x300000FF, bitmap->getPixel(2, 0));
+
+    assert_int_equal(1, bitmap->threshold(2, 0, 10, 1, "==", 0x000000FF, 0x00000000, 0x0000FFFF));
+    assert_ulong_equal(0x00000000, bitmap->getPixel(2, 0));
+    assert_ulong_equal(0x400000FE, bitmap->getPixel(3, 0));
+
+    assert_int_equal(3, bitmap->threshold(0, 0, 4, 1, ">", 0x30000000, 0x12345678, 0xFF000000));
+    assert_ulong_equal(0x12345678, bitmap->getPixel(3, 0));
+    assert_int_equal(0, bitmap->threshold(0, 0, 4, 1, "<>", 0, 0, 0));
+
+    lmDelete(NULL, bitmap);
+}
+
+SEATEST_TEST(bitmapData_histogram)
+{
+    BitmapData *bitmap = BitmapData::create(3, 2, 0x102030FF);
+
+    bitmap->setPixel(2, 1, 0x10FF0000);
+
+    unsigned int counts[1024];
+
+    bitmap->histogram(1, 0, 10, 10, counts);
+    assert_int_equal(4, counts[0x10]);
+    assert_int_equal(3, counts[256 + 0x20]);
+    assert_int_equal(1, counts[256 + 0xFF]);
+    assert_int_equal(3, counts[512 + 0x30]);
+    assert_int_equal(1, counts[512 + 0x00]);
+    assert_int_equal(3, counts[768 + 0xFF]);
+    assert_int_equal(1, counts[768 + 0x00]);
+    assert_int_equal(0, counts[0x20]);
+
+    // Nothing is counted outside the bitmap.
+    bitmap->histogram(3, 0, 1, 1, counts);
+    assert_int_equal(0, counts[0x10]);
+
+    lmDelete(NULL, bitmap);
+}
+
+// Sizes which aren't a multiple of the vector width also test the scalar tail.
+SEATEST_TEST(bitmapData_compare)
+{
+    BitmapData *a = BitmapData::create(7, 3, 0x336699FF);
+    BitmapData *b = BitmapData::create(7, 3, 0x336699FF);
+
+    assert_double_equal(0.0, BitmapData::compare(a, b), 0.0001);
+
+    b->setPixel(0, 0, 0x336699FE);
+    b->setPixel(3, 1, 0x000000FF);
+    b->setPixel(6, 2, 0x326699FF);
+    assert_double_equal(3.0 / 21.0, BitmapData::compare(a, b), 0.0001);
+
+    BitmapData *c = BitmapData::create(3, 7, 0x336699FF);
+    assert_double_equal(1.0, BitmapData::compare(a, c), 0.0001);
+
+    lmDelete(NULL, c);
+    lmDelete(NULL, b);
+    lmDelete(NULL, a);
+}
+
+SEATEST_TEST(bitmapData_diff)
+{
+    BitmapData *a = BitmapData::create(5, 1, 0x10F08000);
+    BitmapData *b = BitmapData::create(5, 1, 0x20E08040);
+
+    b->setPixel(4, 0, 0xFF000000);
+
+    // Channel differences are absolute, alpha is opaque.
+    BitmapData *d = BitmapData::diff(a, b);
+    assert_true(d != NULL);
+    assert_ulong_equal(0x101000FF, d->getPixel(0, 0));
+    assert_ulong_equal(0x101000FF, d->getPixel(3, 0));
+    assert_ulong_equal(0xEFF080FF, d->getPixel(4, 0));
+
+    BitmapData *c = BitmapData::create(1, 5, 0);
+    assert_true(BitmapData::diff(a, c) == NULL);
+
+    lmDelete(NULL, c);
+    lmDelete(NULL, d);
+    lmDelete(NULL, b);
+    lmDelete(NULL, a);
+}
@@ -153,6 +153,7 @@ void Graphics::resume()
 
 void Graphics::shutdown()
 {
+    BitmapData::shutdownFramebufferReads();
     Texture::shutdown();
     QuadRenderer::destroyGraphicsResources();
     VectorRenderer::destroyGraphicsResources();
@@ -262,28 +263,36 @@ void Graphics::endFrame()
     if(pendingScreenshot[0] != 0 || gettingScreenshotData)
     {
         SDL_ClearError();
-        SDL_Window* sdlWindow = gSDLWindow;
 
         const BitmapData* fb = BitmapData::fromFramebuffer();
 
+        if (fb != NULL)
+        {
+            // If there is a pending screenshot write, do that
+            if (pendingScreenshot[0] != 0) {
+                fb->save(pendingScreenshot);
+            }
 
-        // If there is a pending screenshot write, do that
-        if (pendingScreenshot[0] != 0) {
-            fb->save(pendingScreenshot);
-        }
+            // If there is a pending data request, do that
+            if (gettingScreenshotData) {
+                utByteArray *retData = stbi_data_png(sTarget.width, sTarget.height, 4 /* RGBA */, fb->getData(), sTarget.width * fb->getBpp());
 
-        // If there is a pending data request, do that
-        if (gettingScreenshotData) {
-            utByteArray *retData = stbi_data_png(sTarget.width, sTarget.height, 4 /* RGBA */, fb->getData(), sTarget.width * fb->getBpp());
+                // Send the delegate along
+                _onScreenshotDataDelegate.pushArgument(retData);
+                _onScreenshotDataDelegate.invoke();
+            }
 
-            // Send the delegate along
-            _onScreenshotDataDelegate.pushArgument(retData);
-            _onScreenshotDataDelegate.invoke();
+            lmDelete(NULL, const_cast<BitmapData*>(fb));
         }
 
         pendingScreenshot[0] = 0;
         gettingScreenshotData = false;
     }
+
+    // Asynchronous reads only come from BitmapData.fromFramebufferAsync and
+    // saveFramebufferAsync
+
+    BitmapData::processFramebufferReads();
 }
 
 int Graphics::render(lua_State *L)
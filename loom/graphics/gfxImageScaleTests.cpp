@@ -0,0 +1,284 @@
+/*
+ * ===========================================================================
+ * Loom SDK
+ * Copyright 2011, 2012, 2013
+ * The Game Engine Company, LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ * ===========================================================================
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "seatest.h"
+#include "loom/common/core/allocator.h"
+#include "loom/graphics/gfxResampler.h"
+#include "loom/vendor/geldreich/jpge.h"
+#include "loom/vendor/jpgd/jpgd.h"
+
+using namespace GFX;
+
+SEATEST_FIXTURE(gfxImageScale)
+{
+    SEATEST_FIXTURE_ENTRY(imageScale_jpegScaled444);
+    SEATEST_FIXTURE_ENTRY(imageScale_jpegScaled420);
+    SEATEST_FIXTURE_ENTRY(imageScale_resamplerScalar);
+    SEATEST_FIXTURE_ENTRY(imageScale_resamplerGray);
+}
+
+// A smooth RGB test image, so the JPEG round trip stays close to it and
+// chroma subsampling loses little.
+static unsigned char *imageScaleTestImage(int width, int height)
+{
+    unsigned char *pixels = (unsigned char *)lmAlloc(NULL, width * height * 3);
+
+    for (int y = 0; y < height; y++)
+    {
+        for (int x = 0; x < width; x++)
+        {
+            unsigned char *p = pixels + (y * width + x) * 3;
+            p[0] = (unsigned char)(128 + 80 * sin(x * 0.09 + y * 0.04));
+            p[1] = (unsigned char)(40 + (x * 150) / width + (y * 40) / height);
+            p[2] = (unsigned char)(128 + 60 * cos(y * 0.07 - x * 0.03));
+        }
+    }
+
+    return pixels;
+}
+
+// Decodes jpeg at 1 << shift reduction into RGBA.
+static unsigned char *imageScaleDecode(const unsigned char *jpeg, int size, int shift, int *width, int *height)
+{
+    jpgd::jpeg_decoder_mem_stream stream(jpeg, (jpgd::uint)size);
+    jpgd::jpeg_decoder decoder(&stream);
+
+    decoder.set_scale_shift(shift);
+    if ((decoder.get_error_code() != jpgd::JPGD_SUCCESS) || (decoder.begin_decoding() != jpgd::JPGD_SUCCESS))
+    {
+        return NULL;
+    }
+
+    *width  = decoder.get_scaled_width();
+    *height = decoder.get_scaled_height();
+
+    unsigned char *pixels = (unsigned char *)lmAlloc(NULL, *width * *height * 4);
+
+    for (int y = 0; y < *height; y++)
+    {
+        const void *line;
+        jpgd::uint lineLength;
+        if ((decoder.decode(&line, &lineLength) != jpgd::JPGD_SUCCESS) || ((int)lineLength != *width * 4))
+        {
+            lmFree(NULL, pixels);
+            return NULL;
+        }
+        memcpy(pixels + y * *width * 4, line, *width * 4);
+    }
+
+    return pixels;
+}
+
+// Encodes the test image with the given chroma subsampling, then checks the
+// DCT scaled decodes against box filtering the full size decode. Averaging
+// happens before color conversion and chroma blocks line up with the
+// output differently than the upsampled full decode, so they only match to
+// within a tolerance.
+static bool imageScaleCheckJpeg(jpge::subsampling_t subsampling, int width, int height, int maxError, double maxMeanError)
+{
+    unsigned char *image = imageScaleTestImage(width, height);
+
+    jpge::params params;
+    params.m_quality     = 95;
+    params.m_subsampling = subsampling;
+
+    int           jpegSize = width * height * 3 + 1024;
+    unsigned char *jpeg    = (unsigned char *)lmAlloc(NULL, jpegSize);
+    bool          result   = jpge::compress_image_to_jpeg_file_in_memory(jpeg, jpegSize, width, height, 3, image, params);
+
+    int           fullWidth = 0, fullHeight = 0;
+    unsigned char *full     = result ? imageScaleDecode(jpeg, jpegSize, 0, &fullWidth, &fullHeight) : NULL;
+
+    result = full && (fullWidth == width) && (fullHeight == height);
+
+    for (int shift = 1; result && shift <= 3; shift++)
+    {
+        const int factor = 1 << shift;
+
+        int           scaledWidth = 0, scaledHeight = 0;
+        unsigned char *scaled     = imageScaleDecode(jpeg, jpegSize, shift, &scaledWidth, &scaledHeight);
+
+        result = scaled && (scaledWidth == (width + factor - 1) / factor) && (scaledHeight == (height + factor - 1) / factor);
+
+        int    worst = 0;
+        double total = 0.0;
+
+        for (int y = 0; result && y < scaledHeight; y++)
+        {
+            for (int x = 0; x < scaledWidth; x++)
+            {
+                const unsigned char *p = scaled + (y * scaledWidth + x) * 4;
+
+                // edge pixels only average what is inside the image
+                int sum[3] = { 0, 0, 0 }, count = 0;
+                for (int sy = y * factor; sy < (y + 1) * factor && sy < height; sy++)
+                {
+                    for (int sx = x * factor; sx < (x + 1) * factor && sx < width; sx++)
+                    {
+                        const unsigned char *q = full + (sy * width + sx) * 4;
+                        sum[0] += q[0];
+                        sum[1] += q[1];
+                        sum[2] += q[2];
+                        count++;
+                    }
+                }
+
+                for (int c = 0; c < 3; c++)
+                {
+                    int error = abs(p[c] - (sum[c] + count / 2) / count);
+                    worst  = error > worst ? error : worst;
+                    total += error;
+                }
+
+                result = p[3] == 255;
+            }
+        }
+
+        if (result && ((worst > maxError) || (total / (scaledWidth * scaledHeight * 3) > maxMeanError)))
+        {
+            printf("1/%d decode is off by up to %d, %.2f on average\n", factor, worst, total / (scaledWidth * scaledHeight * 3));
+            result = false;
+        }
+
+        if (scaled)
+        {
+            lmFree(NULL, scaled);
+        }
+    }
+
+    if (full)
+    {
+        lmFree(NULL, full);
+    }
+    lmFree(NULL, jpeg);
+    lmFree(NULL, image);
+
+    return result;
+}
+
+SEATEST_TEST(imageScale_jpegScaled444)
+{
+    assert_true(imageScaleCheckJpeg(jpge::H1V1, 64, 48, 4, 1.0));
+
+    // partial blocks on the right and bottom also average the encoder's
+    // edge padding
+    assert_true(imageScaleCheckJpeg(jpge::H1V1, 61, 45, 8, 1.0));
+}
+
+SEATEST_TEST(imageScale_jpegScaled420)
+{
+    assert_true(imageScaleCheckJpeg(jpge::H2V2, 64, 48, 5, 1.0));
+    assert_true(imageScaleCheckJpeg(jpge::H2V2, 61, 45, 8, 1.0));
+}
+
+// Resamples the same rows with the vector and scalar filters, they have to
+// agree to within rounding.
+static bool imageScaleCheckResampler(int srcWidth, int srcHeight, int dstWidth, int dstHeight, int bpp)
+{
+    unsigned char *rows = (unsigned char *)lmAlloc(NULL, srcWidth * srcHeight * bpp);
+    for (int i = 0; i < srcWidth * srcHeight * bpp; i++)
+    {
+        rows[i] = (unsigned char)((i * 37 + (i / 7) * 11) & 0xFF);
+    }
+
+    unsigned char *vectorOut = (unsigned char *)lmAlloc(NULL, dstWidth * dstHeight * 3);
+    unsigned char *scalarOut = (unsigned char *)lmAlloc(NULL, dstWidth * dstHeight * 3);
+
+    RGBAResampler vectorResampler, scalarResampler;
+    memset(&vectorResampler, 0, sizeof(vectorResampler));
+    memset(&scalarResampler, 0, sizeof(scalarResampler));
+
+    bool result = rgbaResampler_init(&vectorResampler, srcWidth, srcHeight, dstWidth, dstHeight) &&
+                  rgbaResampler_init(&scalarResampler, srcWidth, srcHeight, dstWidth, dstHeight, true);
+
+    int vectorRows = 0, scalarRows = 0;
+    for (int y = 0; result && y < srcHeight; y++)
+    {
+        vectorRows = rgbaResampler_putRow(&vectorResampler, rows + y * srcWidth * bpp, bpp, vectorOut);
+        scalarRows = rgbaResampler_putRow(&scalarResampler, rows + y * srcWidth * bpp, bpp, scalarOut);
+        result     = vectorRows == scalarRows;
+    }
+
+    result = result && (vectorRows == dstHeight);
+
+    for (int i = 0; result && i < dstWidth * dstHeight * 3; i++)
+    {
+        result = abs(vectorOut[i] - scalarOut[i]) <= 1;
+    }
+
+    if (vectorResampler.filter)
+    {
+        rgbaResampler_shutdown(&vectorResampler);
+    }
+    if (scalarResampler.filter)
+    {
+        rgbaResampler_shutdown(&scalarResampler);
+    }
+
+    lmFree(NULL, scalarOut);
+    lmFree(NULL, vectorOut);
+    lmFree(NULL, rows);
+
+    return result;
+}
+
+// None of the widths are a multiple of the 4 floats a vector holds.
+SEATEST_TEST(imageScale_resamplerScalar)
+{
+    assert_true(imageScaleCheckResampler(37, 29, 13, 11, 4));
+    assert_true(imageScaleCheckResampler(101, 7, 33, 3, 4));
+    assert_true(imageScaleCheckResampler(9, 9, 5, 7, 4));
+    assert_true(imageScaleCheckResampler(3, 5, 1, 1, 4));
+
+    // upscaling too
+    assert_true(imageScaleCheckResampler(5, 3, 19, 10, 4));
+}
+
+SEATEST_TEST(imageScale_resamplerGray)
+{
+    assert_true(imageScaleCheckResampler(37, 29, 13, 11, 1));
+
+    // a flat gray image stays flat
+    unsigned char row[23];
+    memset(row, 77, sizeof(row));
+
+    unsigned char out[7 * 5 * 3];
+    memset(out, 0, sizeof(out));
+
+    RGBAResampler resampler;
+    assert_true(rgbaResampler_init(&resampler, 23, 17, 7, 5));
+
+    for (int y = 0; y < 17; y++)
+    {
+        rgbaResampler_putRow(&resampler, row, 1, out);
+    }
+
+    rgbaResampler_shutdown(&resampler);
+
+    for (int i = 0; i < (int)sizeof(out); i++)
+    {
+        assert_int_equal(77, out[i]);
+    }
+}
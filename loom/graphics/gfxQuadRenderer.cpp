@@ -52,6 +52,7 @@ size_t QuadRenderer::batchedVertexCount;
 TextureID QuadRenderer::currentTexture;
 
 int QuadRenderer::numFrameSubmit;
+int QuadRenderer::generation = 0;
 
 static loom_allocator_t *gQuadMemoryAllocator = NULL;
 static bool sTextureStateValid = false;
@@ -97,6 +98,7 @@ void QuadRenderer::submit()
                 Loom2D::Matrix mvp;
                 mvp.copyFromMatrix4(Graphics::getMVP());
                 sCurrentShader->setMVP(mvp);
+                sCurrentShader->setAlpha(1.0f);
                 sCurrentShader->setTextureId(0);
                 sCurrentShader->bind();
 
@@ -224,6 +226,100 @@ void QuadRenderer::batch(VertexPosColorTex *vertices, uint16_t vertexCount, Text
 }
 
 
+void QuadRenderer::uploadRetained(RetainedVertexBuffer& buffer, VertexPosColorTex *vertices, uint16_t vertexCount)
+{
+    LOOM_PROFILE_SCOPE(quadUploadRetained);
+
+    GL_Context* ctx = Graphics::context();
+
+    // A buffer from a lost context is already gone, don't delete its id
+    if (!isRetainedValid(buffer))
+    {
+        ctx->glGenBuffers(1, &buffer.id);
+        buffer.generation = generation;
+    }
+
+    ctx->glBindBuffer(GL_ARRAY_BUFFER, buffer.id);
+    ctx->glBufferData(GL_ARRAY_BUFFER, vertexCount*sizeof(VertexPosColorTex), vertices, GL_STATIC_DRAW);
+    ctx->glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+
+void QuadRenderer::destroyRetained(RetainedVertexBuffer& buffer)
+{
+    if (isRetainedValid(buffer))
+    {
+        Graphics::context()->glDeleteBuffers(1, &buffer.id);
+    }
+
+    buffer.id = 0;
+    buffer.generation = -1;
+}
+
+
+void QuadRenderer::drawRetained(RetainedVertexBuffer& buffer, uint16_t vertexCount, TextureID texture, bool blendEnabled, uint32_t srcBlend, uint32_t dstBlend, ShaderProgram *shader, const Loom2D::Matrix& model, float alpha)
+{
+    LOOM_PROFILE_SCOPE(quadDrawRetained);
+
+    if (!vertexCount || (texture < 0) || (vertexCount > MAXBATCHQUADS * 4) || shader == NULL || !isRetainedValid(buffer))
+    {
+        return;
+    }
+
+    // keep the draw order of everything batched so far
+    submit();
+
+    TextureInfo &tinfo = *Texture::getTextureInfo(texture);
+
+    if (tinfo.handle == (GLuint)-1 || !tinfo.visible)
+    {
+        return;
+    }
+
+    numFrameSubmit++;
+
+    GL_Context* ctx = Graphics::context();
+
+    ctx->glBindBuffer(GL_ARRAY_BUFFER, buffer.id);
+
+    // the model transform goes into the shader instead of the vertices
+    Loom2D::Matrix mvp;
+    mvp.copyFromMatrix4(Graphics::getMVP());
+    Loom2D::Matrix modelViewProjection = model;
+    modelViewProjection.concat(&mvp);
+
+    shader->setMVP(modelViewProjection);
+    shader->setAlpha(alpha);
+    shader->setTextureId(0);
+    shader->bind();
+    shader->bindTexture(texture, 0);
+    shader->bindTextures();
+
+    if (blendEnabled)
+    {
+        ctx->glEnable(GL_BLEND);
+        ctx->glBlendFuncSeparate(srcBlend, dstBlend, (Graphics::getFlags() & Graphics::FLAG_PREMULTIPLIED_ALPHA) ? GL_ONE : srcBlend, dstBlend);
+    }
+    else
+    {
+        ctx->glDisable(GL_BLEND);
+    }
+
+    ctx->glDisable(GL_CULL_FACE);
+
+    Graphics_SetCurrentGLState(GFX_OPENGL_STATE_QUAD);
+
+    ctx->glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, indexBufferId);
+    ctx->glDrawElements(GL_TRIANGLES, (GLsizei)(vertexCount / 4 * 6), GL_UNSIGNED_SHORT, NULL);
+
+    // The attribute pointers now refer to the retained buffer and the shader
+    // holds our uniforms, so the next batch has to set everything up again
+    sShaderStateValid = false;
+    sTextureStateValid = false;
+    sBlendStateValid = false;
+}
+
+
 void QuadRenderer::beginFrame()
 {
     LOOM_PROFILE_SCOPE(quadBegin);
@@ -248,7 +344,8 @@ void QuadRenderer::endFrame()
 
 void QuadRenderer::destroyGraphicsResources()
 {
-    // Probably do something someday.
+    // Retained buffers created so far belong to the old context
+    generation++;
 }
 
 void QuadRenderer::initializeGraphicsResources()
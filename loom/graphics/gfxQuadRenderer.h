@@ -38,6 +38,20 @@ struct VertexPosColorTex
     float    u, v;
 };
 
+// A vertex buffer owned by a renderable that keeps its vertices on the GPU
+// across frames, uploaded with QuadRenderer::uploadRetained and drawn with
+// QuadRenderer::drawRetained.
+struct RetainedVertexBuffer
+{
+    GLuint id;
+
+    // QuadRenderer generation the buffer was created in, buffers from
+    // before a context loss are stale and get recreated
+    int generation;
+
+    RetainedVertexBuffer() : id(0), generation(-1) {}
+};
+
 class QuadRenderer
 {
     friend class Graphics;
@@ -54,6 +68,9 @@ private:
 
     static int numFrameSubmit;
 
+    // bumped whenever the graphics resources are destroyed
+    static int generation;
+
     // initial initialization
     static void initialize();
 
@@ -74,5 +91,20 @@ public:
     static VertexPosColorTex *getQuadVertexMemory(uint16_t numVertices, TextureID texture, bool blendEnabled, uint32_t srcBlend, uint32_t dstBlend, ShaderProgram *shader);
 
     static void batch(VertexPosColorTex *vertices, uint16_t vertexCount, TextureID texture, bool blendEnabled, uint32_t srcBlend, uint32_t dstBlend, ShaderProgram *shader);
+
+    // returns true if the retained buffer holds vertices of the current context
+    static inline bool isRetainedValid(const RetainedVertexBuffer& buffer)
+    {
+        return buffer.id != 0 && buffer.generation == generation;
+    }
+
+    // (re)uploads vertices into a retained buffer, creating it if needed
+    static void uploadRetained(RetainedVertexBuffer& buffer, VertexPosColorTex *vertices, uint16_t vertexCount);
+
+    static void destroyRetained(RetainedVertexBuffer& buffer);
+
+    // draws a retained buffer with the model matrix and alpha applied by the
+    // shader instead of on the CPU, flushing the current batch first
+    static void drawRetained(RetainedVertexBuffer& buffer, uint16_t vertexCount, TextureID texture, bool blendEnabled, uint32_t srcBlend, uint32_t dstBlend, ShaderProgram *shader, const Loom2D::Matrix& model, float alpha);
 };
 }
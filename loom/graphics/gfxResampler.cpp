@@ -0,0 +1,234 @@
+/*
+ * ===========================================================================
+ * Loom SDK
+ * Copyright 2011, 2012, 2013
+ * The Game Engine Company, LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ * ===========================================================================
+ */
+
+#include <string.h>
+
+#include "loom/common/core/allocator.h"
+#include "loom/graphics/gfxResampler.h"
+
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#include <xmmintrin.h>
+#define LOOM_RESAMPLE_SSE     1
+#elif defined(__ARM_NEON__) || defined(__ARM_NEON)
+#include <arm_neon.h>
+#define LOOM_RESAMPLE_NEON    1
+#endif
+
+extern loom_allocator_t *gRescalerAllocator;
+
+namespace GFX
+{
+// One float RGBA pixel. Pixel4Vector filters all four channels with a
+// single vector operation where the hardware allows, Pixel4Scalar is the
+// fallback and the reference the vector path is tested against.
+struct Pixel4Scalar
+{
+    struct Value { float c[4]; };
+
+    static inline Value zero() { Value r = { { 0.0f, 0.0f, 0.0f, 0.0f } }; return r; }
+    static inline Value load(const float *p) { Value r = { { p[0], p[1], p[2], p[3] } }; return r; }
+    static inline void store(float *p, Value v) { p[0] = v.c[0]; p[1] = v.c[1]; p[2] = v.c[2]; p[3] = v.c[3]; }
+    static inline Value mulAdd(Value acc, Value v, float w)
+    {
+        for (int i = 0; i < 4; i++)
+        {
+            acc.c[i] += v.c[i] * w;
+        }
+        return acc;
+    }
+};
+
+#if LOOM_RESAMPLE_SSE
+struct Pixel4Vector
+{
+    typedef __m128 Value;
+
+    static inline Value zero() { return _mm_setzero_ps(); }
+    static inline Value load(const float *p) { return _mm_loadu_ps(p); }
+    static inline void store(float *p, Value v) { _mm_storeu_ps(p, v); }
+    static inline Value mulAdd(Value acc, Value v, float w) { return _mm_add_ps(acc, _mm_mul_ps(v, _mm_set1_ps(w))); }
+};
+#elif LOOM_RESAMPLE_NEON
+struct Pixel4Vector
+{
+    typedef float32x4_t Value;
+
+    static inline Value zero() { return vdupq_n_f32(0.0f); }
+    static inline Value load(const float *p) { return vld1q_f32(p); }
+    static inline void store(float *p, Value v) { vst1q_f32(p, v); }
+    static inline Value mulAdd(Value acc, Value v, float w) { return vmlaq_n_f32(acc, v, w); }
+};
+#else
+typedef Pixel4Scalar Pixel4Vector;
+#endif
+
+bool rgbaResampler_init(RGBAResampler *rs, int srcWidth, int srcHeight, int dstWidth, int dstHeight, bool scalar)
+{
+    memset(rs, 0, sizeof(RGBAResampler));
+    rs->srcWidth  = srcWidth;
+    rs->srcHeight = srcHeight;
+    rs->dstWidth  = dstWidth;
+    rs->dstHeight = dstHeight;
+    rs->scalar    = scalar;
+
+    rs->filter = lmNew(gRescalerAllocator) Resampler(srcWidth, srcHeight, dstWidth, dstHeight, Resampler::BOUNDARY_CLAMP, 0.0f, 1.0f, "blackman");
+    if (rs->filter->status() != Resampler::STATUS_OKAY)
+    {
+        lmDelete(gRescalerAllocator, rs->filter);
+        rs->filter = NULL;
+        return false;
+    }
+
+    rs->clistX = rs->filter->get_clist_x();
+    rs->clistY = rs->filter->get_clist_y();
+
+    // Work out when each output row completes and how many filtered source
+    // rows have to stay around for it.
+    rs->emitAt   = (int *)lmAlloc(gRescalerAllocator, sizeof(int) * dstHeight);
+    rs->ringSize = 1;
+
+    int emitAt = 0;
+    for (int y = 0; y < dstHeight; y++)
+    {
+        const Resampler::Contrib_List &list = rs->clistY[y];
+        int first = srcHeight, last = 0;
+        for (int i = 0; i < list.n; i++)
+        {
+            first = list.p[i].pixel < first ? list.p[i].pixel : first;
+            last  = list.p[i].pixel > last ? list.p[i].pixel : last;
+        }
+
+        emitAt        = last > emitAt ? last : emitAt;
+        rs->emitAt[y] = emitAt;
+
+        if (list.n > 0 && emitAt - first + 1 > rs->ringSize)
+        {
+            rs->ringSize = emitAt - first + 1;
+        }
+    }
+
+    rs->ring   = (float *)lmAlloc(gRescalerAllocator, sizeof(float) * 4 * dstWidth * rs->ringSize);
+    rs->srcRow = (float *)lmAlloc(gRescalerAllocator, sizeof(float) * 4 * srcWidth);
+    rs->dstRow = (float *)lmAlloc(gRescalerAllocator, sizeof(float) * 4 * dstWidth);
+
+    return true;
+}
+
+
+void rgbaResampler_shutdown(RGBAResampler *rs)
+{
+    lmDelete(gRescalerAllocator, rs->filter);
+    lmSafeFree(gRescalerAllocator, rs->emitAt);
+    lmSafeFree(gRescalerAllocator, rs->ring);
+    lmSafeFree(gRescalerAllocator, rs->srcRow);
+    lmSafeFree(gRescalerAllocator, rs->dstRow);
+}
+
+
+// Both filter passes over the row already expanded into rs->srcRow.
+template<typename Pixel4>
+static void rgbaResampler_filterRow(RGBAResampler *rs, unsigned char *out)
+{
+    typedef typename Pixel4::Value Value;
+
+    const float *src = rs->srcRow;
+
+    // Horizontal pass into the ring.
+    float *filtered = rs->ring + (rs->srcY % rs->ringSize) * rs->dstWidth * 4;
+    for (int x = 0; x < rs->dstWidth; x++)
+    {
+        const Resampler::Contrib_List &list = rs->clistX[x];
+        Value acc = Pixel4::zero();
+        for (int i = 0; i < list.n; i++)
+        {
+            acc = Pixel4::mulAdd(acc, Pixel4::load(src + list.p[i].pixel * 4), list.p[i].weight);
+        }
+        Pixel4::store(filtered + x * 4, acc);
+    }
+
+    // Vertical pass for every output row that is now complete.
+    while (rs->dstY < rs->dstHeight && rs->emitAt[rs->dstY] <= rs->srcY)
+    {
+        const Resampler::Contrib_List &list = rs->clistY[rs->dstY];
+        float *dst = rs->dstRow;
+
+        for (int x = 0; x < rs->dstWidth; x++)
+        {
+            Pixel4::store(dst + x * 4, Pixel4::zero());
+        }
+
+        for (int i = 0; i < list.n; i++)
+        {
+            const float *ringRow = rs->ring + (list.p[i].pixel % rs->ringSize) * rs->dstWidth * 4;
+            const float weight   = list.p[i].weight;
+            for (int x = 0; x < rs->dstWidth; x++)
+            {
+                Pixel4::store(dst + x * 4, Pixel4::mulAdd(Pixel4::load(dst + x * 4), Pixel4::load(ringRow + x * 4), weight));
+            }
+        }
+
+        unsigned char *outRow = out + rs->dstY * rs->dstWidth * 3;
+        for (int x = 0; x < rs->dstWidth; x++)
+        {
+            for (int c = 0; c < 3; c++)
+            {
+                float v = dst[x * 4 + c] + 0.5f;
+                outRow[x * 3 + c] = (unsigned char)(v < 0.0f ? 0 : (v > 255.0f ? 255 : (int)v));
+            }
+        }
+
+        rs->dstY++;
+    }
+}
+
+
+int rgbaResampler_putRow(RGBAResampler *rs, const unsigned char *row, int bpp, unsigned char *out)
+{
+    float *src = rs->srcRow;
+
+    if (bpp == 1)
+    {
+        for (int x = 0; x < rs->srcWidth; x++)
+        {
+            src[x * 4 + 0] = src[x * 4 + 1] = src[x * 4 + 2] = src[x * 4 + 3] = row[x];
+        }
+    }
+    else
+    {
+        for (int i = 0; i < rs->srcWidth * 4; i++)
+        {
+            src[i] = row[i];
+        }
+    }
+
+    if (rs->scalar)
+    {
+        rgbaResampler_filterRow<Pixel4Scalar>(rs, out);
+    }
+    else
+    {
+        rgbaResampler_filterRow<Pixel4Vector>(rs, out);
+    }
+
+    rs->srcY++;
+
+    return rs->dstY;
+}
+}
@@ -0,0 +1,68 @@
+/*
+ * ===========================================================================
+ * Loom SDK
+ * Copyright 2011, 2012, 2013
+ * The Game Engine Company, LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ * ===========================================================================
+ */
+
+#pragma once
+
+#include "loom/vendor/geldreich/resampler.h"
+
+namespace GFX
+{
+/**
+ * Separable resampler over interleaved RGBA rows. The filter weights come
+ * from the geldreich Resampler; source rows are filtered horizontally as
+ * they arrive into a small ring, and each output row is gathered from the
+ * ring as soon as its last contributing source row is in.
+ *
+ * All four channels are filtered with one SSE or NEON operation where the
+ * hardware allows.
+ */
+struct RGBAResampler
+{
+    int srcWidth, srcHeight;
+    int dstWidth, dstHeight;
+
+    // Filter with plain floats even where SIMD is available.
+    bool scalar;
+
+    Resampler               *filter;
+    Resampler::Contrib_List *clistX;
+    Resampler::Contrib_List *clistY;
+
+    // Source row index at which each output row can be emitted.
+    int *emitAt;
+
+    int   ringSize;
+    float *ring;
+    float *srcRow;
+    float *dstRow;
+
+    int srcY;
+    int dstY;
+};
+
+bool rgbaResampler_init(RGBAResampler *rs, int srcWidth, int srcHeight, int dstWidth, int dstHeight, bool scalar = false);
+
+void rgbaResampler_shutdown(RGBAResampler *rs);
+
+// Submit the next source row, in 1 (gray) or 4 (RGBA) bytes per pixel.
+// Completed output rows are written to out as RGB; returns the number of
+// output rows finished so far.
+int rgbaResampler_putRow(RGBAResampler *rs, const unsigned char *row, int bpp, unsigned char *out);
+}
@@ -23,17 +23,20 @@
 #include "loom/script/loomscript.h"
 
 #include "loom/common/core/log.h"
+#include "loom/common/core/telemetry.h"
 
 #include "loom/graphics/gfxGraphics.h"
 #include "loom/graphics/gfxTexture.h"
 #include "loom/graphics/gfxShader.h"
 #include "loom/graphics/gfxBitmapData.h"
+#include "loom/graphics/gfxResampler.h"
 
 // Includes for the resize operation.
 #include "loom/common/platform/platformThread.h"
 #include "loom/common/platform/platformTime.h"
+#include "loom/common/platform/platformIO.h"
 #include "loom/vendor/geldreich/jpge.h"
-#include "loom/vendor/geldreich/resampler.h"
+#include "loom/vendor/jpgd/jpgd.h"
 #include "loom/vendor/stb/stb_image.h"
 
 #include "loom/common/core/allocator.h"
@@ -43,9 +46,14 @@
 // for exif encoding
 #include "loom/vendor/jheadexif/jhead.h"
 
+extern "C" int exifinfo_parse_orientation(const unsigned char *buf, unsigned len);
+
 lmDeclareLogGroup(gGFXTextureLogGroup);
 loom_allocator_t *gRescalerAllocator = NULL;
 
+// Used by the jpgd decoder.
+loom_allocator_t *gSTBImageAllocator = NULL;
+
 namespace GFX
 {
 /**
@@ -121,30 +129,77 @@ static void postResampleEvent(const char *path, float progress, const char *asse
     loom_mutex_unlock(gEventQueueMutex);
 }
 
-static int __stdcall scaleImageOnDisk_body(void *param)
+static void scaleImageOnDisk_body(RescaleNote *rn)
 {
+    LOOM_PROFILE_SCOPE(imageRescale);
+
     // Grab our arguments.
-    RescaleNote *rn            = (RescaleNote *)param;
     const char  *outPath       = rn->outPath.c_str();
     const char  *inPath        = rn->inPath.c_str();
     int         outWidth       = rn->outWidth;
     int         outHeight      = rn->outHeight;
     bool        preserveAspect = rn->preserveAspect;
 
-    // Load the image. We always work in 4 components (rgba).
     int t0 = platform_getMilliseconds();
 
-    loom_asset_image *lai = NULL;
+    // JPEG files are decoded straight from disk so they can be reduced by
+    // up to 8x during decode. Anything else is loaded via the asset system,
+    // always in 4 components (rgba).
+    void                *jpegBytes = NULL;
+    long                jpegSize   = 0;
+    jpgd::jpeg_decoder  *decoder   = NULL;
+    jpgd::jpeg_decoder_mem_stream *jpegStream = NULL;
+    loom_asset_image    *lai       = NULL;
+    const unsigned char *imageBits = NULL;
+
+    if (platform_mapFile(inPath, &jpegBytes, &jpegSize))
+    {
+        const unsigned char *bytes = (const unsigned char *)jpegBytes;
+        if (jpegSize > 2 && bytes[0] == 0xFF && bytes[1] == 0xD8)
+        {
+            jpegStream = lmNew(gRescalerAllocator) jpgd::jpeg_decoder_mem_stream(bytes, (jpgd::uint)jpegSize);
+            decoder    = lmNew(gRescalerAllocator) jpgd::jpeg_decoder(jpegStream);
+            if (decoder->get_error_code() != jpgd::JPGD_SUCCESS)
+            {
+                lmLogWarn(gGFXTextureLogGroup, "Unable to decode JPEG '%s' directly, error %d", inPath, decoder->get_error_code());
+                lmDelete(gRescalerAllocator, decoder);
+                decoder = NULL;
+            }
+            if (!decoder)
+            {
+                lmDelete(gRescalerAllocator, jpegStream);
+                jpegStream = NULL;
+            }
+        }
 
-    // Load async since we're in a background thread.
-    loom_asset_preload(inPath);
-    loom_thread_yield();
-    while((lai = (loom_asset_image *)loom_asset_lock(inPath, LATImage, 0)) == NULL)
+        if (!decoder)
+        {
+            platform_unmapFile(jpegBytes);
+            jpegBytes = NULL;
+        }
+    }
+
+    int imageX, imageY, orientation;
+
+    if (decoder)
+    {
+        imageX      = decoder->get_width();
+        imageY      = decoder->get_height();
+        orientation = exifinfo_parse_orientation((const unsigned char *)jpegBytes, (unsigned int)jpegSize);
+    }
+    else
+    {
+        // Load async since we're in a background thread.
+        loom_asset_preload(inPath);
         loom_thread_yield();
+        while((lai = (loom_asset_image *)loom_asset_lock(inPath, LATImage, 0)) == NULL)
+            loom_thread_yield();
 
-    int     imageX     = lai->width;
-    int     imageY     = lai->height;
-    stbi_uc *imageBits = (stbi_uc *)lai->bits;
+        imageX      = lai->width;
+        imageY      = lai->height;
+        imageBits   = (const unsigned char *)loom_asset_imageDecode(lai);
+        orientation = lai->orientation;
+    }
 
     lmLogDebug(gGFXTextureLogGroup, "Image setup took %dms", t0 - platform_getMilliseconds());
 
@@ -163,90 +218,106 @@ static int __stdcall scaleImageOnDisk_body(void *param)
         lmLogDebug(gGFXTextureLogGroup, "Scale to %d %d due to scale %f %f actual=%f", outWidth, outHeight, scaleX, scaleY, actualScale);
     }
 
-    // Build a buffer for byte->float conversions...
-    Resampler::Sample *buffRed   = (Resampler::Sample *)lmAlloc(gRescalerAllocator, sizeof(Resampler::Sample) * imageX);
-    Resampler::Sample *buffGreen = (Resampler::Sample *)lmAlloc(gRescalerAllocator, sizeof(Resampler::Sample) * imageX);
-    Resampler::Sample *buffBlue  = (Resampler::Sample *)lmAlloc(gRescalerAllocator, sizeof(Resampler::Sample) * imageX);
+    outWidth  = outWidth < 1 ? 1 : outWidth;
+    outHeight = outHeight < 1 ? 1 : outHeight;
 
-    // And the downsampled image. Give a slight margin because the scaling routine above can give
-    // up to outWidth inclusive as an output value.
-    stbi_uc *outBuffer = (stbi_uc*)lmAlloc(gRescalerAllocator, sizeof(stbi_uc) * 3 * (outWidth+1) * (outHeight+1));
+    int sourceX = imageX, sourceY = imageY, sourceBpp = 4;
 
-    // Set up the resamplers, reusing filter constants.
-    const char *pFilter = "blackman";
-    float filter_scale = 1.0;
-    Resampler resizeR(imageX, imageY, outWidth, outHeight, Resampler::BOUNDARY_CLAMP, 0.0f, 1.0f, pFilter, NULL, NULL, filter_scale, filter_scale);
-    Resampler resizeG(imageX, imageY, outWidth, outHeight, Resampler::BOUNDARY_CLAMP, 0.0f, 1.0f, pFilter,
-                      resizeR.get_clist_x(), resizeR.get_clist_y(), filter_scale, filter_scale);
-    Resampler resizeB(imageX, imageY, outWidth, outHeight, Resampler::BOUNDARY_CLAMP, 0.0f, 1.0f, pFilter,
-                      resizeR.get_clist_x(), resizeR.get_clist_y(), filter_scale, filter_scale);
+    if (decoder)
+    {
+        // Take the biggest DCT reduction that still leaves at least the
+        // output size, the resampler does the rest.
+        int shift = 0;
+        while (shift < 3 && (imageX >> (shift + 1)) >= outWidth && (imageY >> (shift + 1)) >= outHeight)
+        {
+            shift++;
+        }
+
+        decoder->set_scale_shift(shift);
+        if (decoder->begin_decoding() != jpgd::JPGD_SUCCESS)
+        {
+            lmLogError(gGFXTextureLogGroup, "Unable to decode JPEG '%s', error %d", inPath, decoder->get_error_code());
+        }
+
+        sourceX   = decoder->get_scaled_width();
+        sourceY   = decoder->get_scaled_height();
+        sourceBpp = decoder->get_bytes_per_pixel();
 
-    int resultY = 0;
+        lmLogDebug(gGFXTextureLogGroup, "Decoding %dx%d JPEG at 1/%d scale", imageX, imageY, 1 << shift);
+    }
+
+    // The downsampled image.
+    unsigned char *outBuffer = (unsigned char *)lmAlloc(gRescalerAllocator, 3 * outWidth * outHeight);
+    memset(outBuffer, 0, 3 * outWidth * outHeight);
+
+    RGBAResampler resampler;
+    bool          resampling = rgbaResampler_init(&resampler, sourceX, sourceY, outWidth, outHeight);
 
     lmLogDebug(gGFXTextureLogGroup, "Resample setup took %dms", t1 - platform_getMilliseconds());
 
     int t2 = platform_getMilliseconds();
 
+    int reportedY = 0;
+
     // Process each row of the image.
-    for (int y = 0; y < imageY; y++)
+    for (int y = 0; resampling && y < sourceY; y++)
     {
-        // Deinterleave each row.
-        for (int x = 0; x < imageX; x++)
-        {
-            buffRed[x]   = Resampler::Sample(imageBits[(y * imageX * 4) + (x * 4) + 0]) / Resampler::Sample(255.f);
-            buffGreen[x] = Resampler::Sample(imageBits[(y * imageX * 4) + (x * 4) + 1]) / Resampler::Sample(255.f);
-            buffBlue[x]  = Resampler::Sample(imageBits[(y * imageX * 4) + (x * 4) + 2]) / Resampler::Sample(255.f);
-        }
-
-        // Submit to resampler.
-        lmAssert(resizeR.put_line(buffRed), "bad red");
-        lmAssert(resizeG.put_line(buffGreen), "bad green");
-        lmAssert(resizeB.put_line(buffBlue), "bad blue");
+        const unsigned char *row;
 
-        // If there are results, reinterleave and consume them.
-        while (resizeR.check_line() && resizeG.check_line() && resizeB.check_line() && resultY < outHeight)
+        if (decoder)
         {
-            const Resampler::Sample *outRowR = resizeR.get_line();
-            const Resampler::Sample *outRowG = resizeG.get_line();
-            const Resampler::Sample *outRowB = resizeB.get_line();
-
-            if (outRowR || outRowG || outRowB)
-            {
-                lmAssert(outRowR && outRowG && outRowB, "Somehow got one line without others!");
-            }
-            else
+            const void *line;
+            jpgd::uint lineLength;
+            if (decoder->decode(&line, &lineLength) != jpgd::JPGD_SUCCESS)
             {
+                lmLogError(gGFXTextureLogGroup, "JPEG '%s' decode failed at row %d, error %d", inPath, y, decoder->get_error_code());
                 break;
             }
+            row = (const unsigned char *)line;
+        }
+        else
+        {
+            row = imageBits + y * imageX * 4;
+        }
 
-            // Find the row for output.
-            stbi_uc *imageOutBits = outBuffer + (resultY * outWidth * 3);
-            resultY++;
+        int resultY = rgbaResampler_putRow(&resampler, row, sourceBpp, outBuffer);
 
-            for (int i = 0; i < outWidth; i++)
-            {
-                imageOutBits[i * 3 + 0] = int(outRowR[i] * Resampler::Sample(255.f));
-                imageOutBits[i * 3 + 1] = int(outRowG[i] * Resampler::Sample(255.f));
-                imageOutBits[i * 3 + 2] = int(outRowB[i] * Resampler::Sample(255.f));
-            }
-
-            // Every hundred lines post an update.
-            if(resultY % 100 == 0)
-            {
-                // calculate the progress, but keep from reporting 1.0 as this is used to
-                // mark completion
-                float value = (float)resultY / (float)outHeight;
-                if (value == 1.0f)
-                    value = .99f;
-                postResampleEvent(outPath, value , inPath);
-            }
+        // Every hundred lines post an update.
+        if (resultY - reportedY >= 100)
+        {
+            reportedY = resultY - resultY % 100;
+
+            // calculate the progress, but keep from reporting 1.0 as this is used to
+            // mark completion
+            float value = (float)resultY / (float)outHeight;
+            if (value == 1.0f)
+                value = .99f;
+            postResampleEvent(outPath, value , inPath);
         }
     }
 
+    if (resampling)
+    {
+        rgbaResampler_shutdown(&resampler);
+    }
+    else
+    {
+        lmLogError(gGFXTextureLogGroup, "Unable to set up resampling of '%s' to %dx%d", inPath, outWidth, outHeight);
+    }
+
     lmLogDebug(gGFXTextureLogGroup, "Resample took %dms", t2 - platform_getMilliseconds());
 
     // Release the image, we are done with it!
-    loom_asset_unlock(inPath);
+    if (decoder)
+    {
+        lmDelete(gRescalerAllocator, decoder);
+        lmDelete(gRescalerAllocator, jpegStream);
+        platform_unmapFile(jpegBytes);
+    }
+    else
+    {
+        loom_asset_unlock(inPath);
+    }
 
     // Write it back out.
     int t3 = platform_getMilliseconds();
@@ -254,7 +325,7 @@ static int __stdcall scaleImageOnDisk_body(void *param)
     lmLogDebug(gGFXTextureLogGroup, "JPEG output took %dms", t3 - platform_getMilliseconds());
 
     // preserve orientation (but only if we need to)
-    if (lai->orientation > IMAGE_ORIENTATION_UPPER_LEFT)
+    if (orientation > IMAGE_ORIENTATION_UPPER_LEFT)
     {
         ResetJpgfile();
 
@@ -262,7 +333,7 @@ static int __stdcall scaleImageOnDisk_body(void *param)
         if (ReadJpegFile(outPath, READ_ALL))
         {
             // create the exif segment and attach it to jpeg image
-            create_EXIF(lai->orientation);
+            create_EXIF(orientation);
 
             // write it out with exif data
             WriteJpegFile(outPath);
@@ -273,9 +344,6 @@ static int __stdcall scaleImageOnDisk_body(void *param)
     }
 
     // Free everything!
-    lmFree(gRescalerAllocator, buffRed);
-    lmFree(gRescalerAllocator, buffGreen);
-    lmFree(gRescalerAllocator, buffBlue);
     lmFree(gRescalerAllocator, outBuffer);
 
     // Post completion event.
@@ -285,8 +353,39 @@ static int __stdcall scaleImageOnDisk_body(void *param)
 
     if(rn->skipPreload == false)
         loom_asset_preload(outPath);
+}
+
+
+// A single worker drains the queue, so scaling many images doesn't start
+// a thread per image.
+static MutexHandle          gRescaleQueueMutex    = NULL;
+static utList<RescaleNote*> gRescaleQueue;
+static bool                 gRescaleWorkerRunning = false;
+
+static int __stdcall scaleImageOnDisk_worker(void *param)
+{
+    TelemetryThreadScope traceThread("image rescale");
+
+    while (true)
+    {
+        loom_mutex_lock(gRescaleQueueMutex);
 
-    delete rn;
+        if (gRescaleQueue.empty())
+        {
+            gRescaleWorkerRunning = false;
+            loom_mutex_unlock(gRescaleQueueMutex);
+            break;
+        }
+
+        RescaleNote *rn = gRescaleQueue.front();
+        gRescaleQueue.pop_front();
+
+        loom_mutex_unlock(gRescaleQueueMutex);
+
+        scaleImageOnDisk_body(rn);
+
+        delete rn;
+    }
 
     return 0;
 }
@@ -305,7 +404,28 @@ static void scaleImageOnDisk(const char *outPath, const char *inPath, int outWid
 
     Texture::enableAssetNotifications(false);
 
-    loom_thread_start(scaleImageOnDisk_body, rn);
+    if (gRescaleQueueMutex == NULL)
+    {
+        gRescaleQueueMutex = loom_mutex_create();
+    }
+
+    // Created here so the worker never races to create it.
+    if (gEventQueueMutex == NULL)
+    {
+        gEventQueueMutex = loom_mutex_create();
+    }
+
+    loom_mutex_lock(gRescaleQueueMutex);
+
+    gRescaleQueue.push_back(rn);
+
+    if (!gRescaleWorkerRunning)
+    {
+        gRescaleWorkerRunning = true;
+        loom_thread_start(scaleImageOnDisk_worker, NULL);
+    }
+
+    loom_mutex_unlock(gRescaleQueueMutex);
 }
 
 
@@ -393,8 +513,19 @@ static int registerLoomGraphics(lua_State *L)
        .addMethod("save", &BitmapData::save)
        .addMethod("getPixel", &BitmapData::getPixel)
        .addMethod("setPixel", &BitmapData::setPixel)
+       .addProperty("width", &BitmapData::getWidth)
+       .addProperty("height", &BitmapData::getHeight)
+       .addMethod("fillRect", &BitmapData::fillRect)
+       .addMethod("copyPixels", &BitmapData::copyPixels)
+       .addLuaFunction("colorTransform", &BitmapData::colorTransform)
+       .addMethod("threshold", &BitmapData::threshold)
+       .addLuaFunction("histogram", &BitmapData::histogram)
        .addMethod("createTextureInfo", &BitmapData::createTextureInfo)
+       .addStaticMethod("create", &BitmapData::create)
        .addStaticMethod("fromFramebuffer", &BitmapData::fromFramebuffer)
+       .addStaticMethod("fromFramebufferAsync", &BitmapData::fromFramebufferAsync)
+       .addStaticMethod("saveFramebufferAsync", &BitmapData::saveFramebufferAsync)
+       .addStaticProperty("onFramebufferRead", &BitmapData::getonFramebufferReadDelegate)
        .addStaticMethod("fromAsset", &BitmapData::fromAsset)
        .addStaticMethod("compare", &BitmapData::compare)
        .addStaticMethod("diff", &BitmapData::diff)
@@ -276,6 +276,7 @@ GFX::ShaderProgram* GFX::ShaderProgram::getTintlessDefaultShader()
 
 GFX::ShaderProgram::ShaderProgram()
 : programId(0)
+, alpha(1.0f)
 {
 
 }
@@ -499,16 +500,8 @@ int GFX::ShaderProgram::setUniform1fv(lua_State *L)
     int length = lsr_vector_get_length(L, 3);
 
     utArray<float> values;
-
-    lua_rawgeti(L, 3, LSINDEXVECTOR);
-    int vidx = lua_gettop(L);
-
-    for (int i = 0; i < length; i++)
-    {
-        lua_rawgeti(L, vidx, i);
-        float value = (float)lua_tonumber(L, -1);
-        values.push_back(value);
-    }
+    values.resize(length);
+    lsr_vector_read_floats(L, 3, values.ptr(), length);
 
     Graphics::context()->glUniform1fv(location, values.size(), values.ptr());
     return 0;
@@ -531,23 +524,8 @@ int GFX::ShaderProgram::setUniform2fv(lua_State *L)
     lmAssert(length % 2 == 0, "values size must be a multiple of 2");
 
     utArray<float> values;
-
-    lua_rawgeti(L, 3, LSINDEXVECTOR);
-    int vidx = lua_gettop(L);
-
-    for (int i = 0; i < length; i++)
-    {
-        lua_rawgeti(L, vidx, i);
-        float value = (float)lua_tonumber(L, -1);
-        values.push_back(value);
-    }
-
-    // Pop the vector
-    lua_pop(L, 3);
-    // Pop location
-    lua_pop(L, 2);
-
-    lmAssert(length % 2 == 0, "values size must be a multiple of 2");
+    values.resize(length);
+    lsr_vector_read_floats(L, 3, values.ptr(), length);
 
     Graphics::context()->glUniform2fv(location, values.size(), values.ptr());
     return 0;
@@ -570,21 +548,8 @@ int GFX::ShaderProgram::setUniform3fv(lua_State *L)
     lmAssert(length % 3 == 0, "values size must be a multiple of 3");
 
     utArray<float> values;
-
-    lua_rawgeti(L, 3, LSINDEXVECTOR);
-    int vidx = lua_gettop(L);
-
-    for (int i = 0; i < length; i++)
-    {
-        lua_rawgeti(L, vidx, i);
-        float value = (float)lua_tonumber(L, -1);
-        values.push_back(value);
-    }
-
-    // Pop the vector
-    lua_pop(L, 3);
-    // Pop location
-    lua_pop(L, 2);
+    values.resize(length);
+    lsr_vector_read_floats(L, 3, values.ptr(), length);
 
     Graphics::context()->glUniform3fv(location, values.size(), values.ptr());
     return 0;
@@ -802,6 +767,21 @@ void GFX::ShaderProgram::setTextureId(GLuint id)
     textureId = id;
 }
 
+GLfloat GFX::ShaderProgram::getAlpha() const
+{
+    return alpha;
+}
+
+void GFX::ShaderProgram::setAlpha(GLfloat _alpha)
+{
+    alpha = _alpha;
+}
+
+bool GFX::ShaderProgram::appliesAlpha() const
+{
+    return false;
+}
+
 void GFX::ShaderProgram::bind()
 {
     if (programId == 0)
@@ -870,10 +850,11 @@ const char * defaultVertexShader =
 "varying vec2 v_texcoord0;                                           \n"
 "varying vec4 v_color0;                                              \n"
 "uniform mat4 u_mvp;                                                 \n"
+"uniform float u_alpha;                                              \n"
 "void main()                                                         \n"
 "{                                                                   \n"
 "    gl_Position = u_mvp * a_position;                               \n"
-"    v_color0 = a_color0;                                            \n"
+"    v_color0 = vec4(a_color0.rgb, a_color0.a * u_alpha);            \n"
 "    v_texcoord0 = a_texcoord0;                                      \n"
 "}                                                                   \n";
 
@@ -900,14 +881,21 @@ GFX::DefaultShader::DefaultShader()
 
     uTexture = ctx->glGetUniformLocation(programId, "u_texture");
     uMVP = ctx->glGetUniformLocation(programId, "u_mvp");
+    uAlpha = ctx->glGetUniformLocation(programId, "u_alpha");
 }
 
 void GFX::DefaultShader::bind()
 {
     GFX::ShaderProgram::bind();
 
-    Graphics::context()->glUniformMatrix4fv(uMVP, 1, GL_FALSE, Graphics::getMVP());
+    setUniformMatrix4f(uMVP, false, &mvp);
     Graphics::context()->glUniform1i(uTexture, textureId);
+    Graphics::context()->glUniform1f(uAlpha, alpha);
+}
+
+bool GFX::DefaultShader::appliesAlpha() const
+{
+    return true;
 }
 
 const char * tintlessFragmentShader =
@@ -938,6 +926,12 @@ void GFX::TintlessDefaultShader::bind()
 {
     GFX::ShaderProgram::bind();
 
-    Graphics::context()->glUniformMatrix4fv(uMVP, 1, GL_FALSE, Graphics::getMVP());
+    setUniformMatrix4f(uMVP, false, &mvp);
     Graphics::context()->glUniform1i(uTexture, textureId);
 }
+
+// The tinting is dropped along with the vertex alpha
+bool GFX::TintlessDefaultShader::appliesAlpha() const
+{
+    return true;
+}
@@ -90,6 +90,7 @@ public:
  * of methods - this can be achieved using a delegate 'onBind'.
  *
  * 'mvp' and 'textureId' are automatically set by the renderer before binding.
+ * 'mvp' includes the model transform when a retained QuadBatch is drawn.
  *
  * By default, Quads and QuadBatches are assigned DefaultShader.
  */
@@ -118,6 +119,7 @@ protected:
 
     Loom2D::Matrix mvp;
     GLuint textureId;
+    GLfloat alpha;
 
     // Disable copy constructor
     ShaderProgram(const ShaderProgram& copy);
@@ -163,6 +165,15 @@ public:
     GLuint getTextureId() const;
     void setTextureId(GLuint _id);
 
+    // Alpha the vertex colors are modulated with, only used by shaders
+    // that apply it, see appliesAlpha
+    GLfloat getAlpha() const;
+    void setAlpha(GLfloat _alpha);
+
+    // Returns true if the shader applies 'alpha', otherwise the renderer has
+    // to modulate the vertex colors itself
+    virtual bool appliesAlpha() const;
+
     virtual void bind();
     virtual void bindTextures();
 
@@ -177,11 +188,13 @@ protected:
 
 GLint uTexture;
 GLint uMVP;
+GLint uAlpha;
 
 public:
     DefaultShader();
 
     virtual void bind();
+    virtual bool appliesAlpha() const;
 };
 
 // Just like DefaultShader, but without tinting.
@@ -196,6 +209,7 @@ public:
     TintlessDefaultShader();
 
     virtual void bind();
+    virtual bool appliesAlpha() const;
 };
 
 }
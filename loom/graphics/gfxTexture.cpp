@@ -26,6 +26,7 @@
 #include "loom/common/core/assert.h"
 #include "loom/common/core/allocator.h"
 #include "loom/common/core/log.h"
+#include "loom/common/core/telemetry.h"
 #include "loom/common/utils/utTypes.h"
 
 #include "loom/graphics/gfxGraphics.h"
@@ -48,6 +49,7 @@ TextureInfo Texture::sTextureInfos[MAXTEXTURES];
 utHashTable<utFastStringHash, TextureID> Texture::sTexturePathLookup;
 bool Texture::sTextureAssetNofificationsEnabled = true;
 bool Texture::supportsFullNPOT;
+utArray<int> Texture::sCompressedFormats;
 TextureID Texture::currentRenderTexture = -1;
 
 //queue of textures to load in the async loading thread
@@ -107,6 +109,52 @@ void Texture::initialize()
     Texture::supportsFullNPOT = true;
 #endif
 
+    // Block compressed formats the GPU can sample directly, images in any
+    // other format are software decoded at load.
+    GLint numCompressedFormats = 0;
+    Graphics::context()->glGetIntegerv(GL_NUM_COMPRESSED_TEXTURE_FORMATS, &numCompressedFormats);
+    if (numCompressedFormats > 0)
+    {
+        utArray<GLint> formats;
+        formats.resize(numCompressedFormats);
+        Graphics::context()->glGetIntegerv(GL_COMPRESSED_TEXTURE_FORMATS, formats.ptr());
+        for (int i = 0; i < numCompressedFormats; i++)
+        {
+            sCompressedFormats.push_back(formats[i]);
+        }
+    }
+
+    // Some drivers only advertise the extensions.
+    if (Graphics::queryExtension("GL_EXT_texture_compression_s3tc"))
+    {
+        sCompressedFormats.push_back(LOOM_IMAGE_FORMAT_DXT1);
+        sCompressedFormats.push_back(LOOM_IMAGE_FORMAT_DXT3);
+        sCompressedFormats.push_back(LOOM_IMAGE_FORMAT_DXT5);
+    }
+    if (Graphics::queryExtension("GL_OES_compressed_ETC1_RGB8_texture"))
+    {
+        sCompressedFormats.push_back(LOOM_IMAGE_FORMAT_ETC1);
+    }
+    if (Graphics::queryExtension("GL_ARB_ES3_compatibility"))
+    {
+        sCompressedFormats.push_back(LOOM_IMAGE_FORMAT_ETC2_RGB);
+        sCompressedFormats.push_back(LOOM_IMAGE_FORMAT_ETC2_RGBA);
+    }
+
+    lmLogDebug(gGFXTextureLogGroup, "%d compressed texture formats supported", (int)sCompressedFormats.size());
+}
+
+bool Texture::supportsCompressedFormat(int format)
+{
+    for (UTsize i = 0; i < sCompressedFormats.size(); i++)
+    {
+        if (sCompressedFormats[i] == format)
+        {
+            return true;
+        }
+    }
+
+    return false;
 }
 
 void Texture::shutdown()
@@ -346,7 +394,7 @@ TextureInfo *Texture::getTextureInfo(TextureID id)
 }
 
 
-TextureInfo *Texture::load(uint8_t *data, uint16_t width, uint16_t height, TextureID id)
+TextureInfo *Texture::load(uint8_t *data, uint16_t width, uint16_t height, TextureID id, const loom_compressed_image_t *compressed)
 {
     LOOM_PROFILE_SCOPE(textureLoad);
 
@@ -365,7 +413,9 @@ TextureInfo *Texture::load(uint8_t *data, uint16_t width, uint16_t height, Textu
 
     TextureInfo &tinfo = *Texture::getTextureInfo(id);
 
-    bool newTexture = !tinfo.reload || (tinfo.width != width) || (tinfo.height != height);
+    int format = compressed ? compressed->format : 0;
+
+    bool newTexture = !tinfo.reload || (tinfo.width != width) || (tinfo.height != height) || (tinfo.compressedFormat != format);
 
     if (newTexture)
     {
@@ -394,7 +444,15 @@ TextureInfo *Texture::load(uint8_t *data, uint16_t width, uint16_t height, Textu
     }
 
 
-    upload(tinfo, data, width, height);
+    if (compressed)
+    {
+        uploadCompressed(tinfo, compressed, width, height);
+    }
+    else
+    {
+        tinfo.compressedFormat = 0;
+        upload(tinfo, data, width, height);
+    }
 
     // Setup the framebuffer if it's a render texture
     if (newTexture && tinfo.renderTarget)
@@ -525,6 +583,44 @@ void Texture::upload(TextureInfo &tinfo, uint8_t *data, uint16_t width, uint16_t
     }
 }
 
+void Texture::uploadCompressed(TextureInfo &tinfo, const loom_compressed_image_t *image, uint16_t width, uint16_t height)
+{
+    int baseLevel = 0;
+    while (baseLevel < image->levelCount - 1 && (image->levels[baseLevel].width > width || image->levels[baseLevel].height > height))
+    {
+        baseLevel++;
+    }
+
+    Graphics::context()->glBindTexture(GL_TEXTURE_2D, tinfo.handle);
+
+    tinfo.width            = width;
+    tinfo.height           = height;
+    tinfo.compressedFormat = image->format;
+
+    LOOM_PROFILE_START(textureLoadUploadCompressed);
+    for (int level = baseLevel; level < image->levelCount; level++)
+    {
+        const loom_image_level_t &mip = image->levels[level];
+        Graphics::context()->glCompressedTexImage2D(GL_TEXTURE_2D, level - baseLevel, image->format, mip.width, mip.height, 0, (GLsizei)mip.size, mip.data);
+    }
+    LOOM_PROFILE_END(textureLoadUploadCompressed);
+
+    if (supportsFullNPOT || tinfo.isPowerOfTwo())
+    {
+        // Mipmaps can't be generated from compressed data, so only sample
+        // them when the container has the whole chain.
+        const loom_image_level_t &last = image->levels[image->levelCount - 1];
+        tinfo.clampOnly = false;
+        tinfo.mipmaps   = last.width == 1 && last.height == 1;
+    }
+    else
+    {
+        tinfo.clampOnly = true;
+        tinfo.mipmaps   = false;
+        lmLogWarn(gGFXTextureLogGroup, "Non-power-of-two textures not fully supported by device, consider using a power-of-two texture size.")
+    }
+}
+
 TextureInfo *Texture::initEmptyTexture(int width, int height)
 {
     LOOM_PROFILE_SCOPE(textureNewEmpty);
@@ -629,6 +725,8 @@ TextureInfo *Texture::initFromBytes(utByteArray *bytes, const char *name)
 
 int __stdcall Texture::loadTextureAsync_body(void *param)
 {
+    TelemetryThreadScope traceThread("texture async");
+
     const char *path = NULL;
 
     //remain in a loop here so long as we have notes to process
@@ -668,6 +766,7 @@ int __stdcall Texture::loadTextureAsync_body(void *param)
             loom_mutex_unlock(Texture::sTexInfoLock);
 
             //handle Asset vs ByteArray texture load
+            LOOM_PROFILE_START(textureAsyncLoad);
             if(path)
             {
                 // Load async since we're in a background thread.
@@ -691,7 +790,13 @@ int __stdcall Texture::loadTextureAsync_body(void *param)
                 {
                     lmLogError(gGFXTextureLogGroup, "Unable to deserialize image bytes!");
                 }
+                else if (threadNote.imageAsset->compressed && !supportsCompressedFormat(threadNote.imageAsset->compressed->format))
+                {
+                    // Decode here rather than stalling the main thread.
+                    loom_asset_imageDecode(threadNote.imageAsset);
+                }
             }
+            LOOM_PROFILE_END(textureAsyncLoad);
 
             //add to the CreateQueue that happens in the main thread because bgfx cannot create textures from side threads
             loom_mutex_lock(Texture::sAsyncQueueMutex);
@@ -886,6 +991,13 @@ void Texture::updateFromBytesAsync(TextureID id, utByteArray *bytes, bool highPr
 
 void Texture::updateImageAsset(loom_asset_image_t *lat, TextureInfo *tinfo)
 {
+    // Compressed textures can't be updated in place, so respecify them.
+    if (lat->compressed || tinfo->compressedFormat)
+    {
+        loadImageAsset(lat, tinfo->id);
+        return;
+    }
+
     // See if it's over 2048 - if so, downsize to fit.
     const int maxSize = 2048;
     uint32_t* localBits = (uint32_t*)lat->bits;
@@ -1048,6 +1160,34 @@ void Texture::loadImageAsset(loom_asset_image_t *lat, TextureID id)
 {
     // See if it's over 2048 - if so, downsize to fit.
     const int          maxSize     = 2048;
+
+    if (lat->compressed)
+    {
+        const loom_compressed_image_t *image = lat->compressed;
+
+        // Start from the first level that fits, if the container has one.
+        int baseLevel = 0;
+        while (baseLevel < image->levelCount && (image->levels[baseLevel].width > maxSize || image->levels[baseLevel].height > maxSize))
+        {
+            baseLevel++;
+        }
+
+        if (baseLevel < image->levelCount && supportsCompressedFormat(image->format))
+        {
+            const loom_image_level_t &base = image->levels[baseLevel];
+            if (baseLevel > 0)
+            {
+                lmLog(gGFXTextureLogGroup, "Texture too big at %dx%d, using %dx%d mip level", lat->width, lat->height, base.width, base.height);
+            }
+
+            load(NULL, (uint16_t)base.width, (uint16_t)base.height, id, image);
+            return;
+        }
+
+        lmLogDebug(gGFXTextureLogGroup, "Compressed format 0x%x not supported by the GPU, decoding", image->format);
+        loom_asset_imageDecode(lat);
+    }
+
     void               *localBits  = lat->bits;
     void               *localMem   = NULL;
     int                localWidth  = lat->width;
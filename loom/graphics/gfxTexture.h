@@ -60,7 +60,8 @@ struct TextureInfo
     // been recycled, since the version increments every time the texture is recycled.
     TextureID                id;
 
-    // todo: format
+    // GL internal format of block compressed textures, 0 for RGBA.
+    int                      compressedFormat;
 
     int                      width;
     int                      height;
@@ -127,6 +128,7 @@ struct TextureInfo
     void reset()
     {
         width        = height = 0;
+        compressedFormat = 0;
         smoothing    = TEXTUREINFO_SMOOTHING_NONE;
         wrapU        = TEXTUREINFO_WRAP_CLAMP;
         wrapV        = TEXTUREINFO_WRAP_CLAMP;
@@ -172,6 +174,7 @@ private:
     static utHashTable<utFastStringHash, TextureID> sTexturePathLookup;
     static bool sTextureAssetNofificationsEnabled;
     static bool supportsFullNPOT;
+    static utArray<int> sCompressedFormats;
     static TextureID currentRenderTexture;
 
     // simple linear TextureID -> TextureHandle
@@ -277,6 +280,8 @@ private:
 
     static void handleAssetNotification(void *payload, const char *name);
 
+    static bool supportsCompressedFormat(int format);
+
     static void loadImageAsset(loom_asset_image_t *lat, TextureID id);
     static void updateImageAsset(loom_asset_image_t *lat, TextureInfo *info);
 
@@ -328,8 +333,13 @@ public:
 
     static void upload(TextureInfo &tinfo, uint8_t *data, uint16_t width, uint16_t height, int xoffset = -1, int yoffset = -1);
 
-    // This method accepts rgba data.
-    static TextureInfo *load(uint8_t *data, uint16_t width, uint16_t height, TextureID id = -1);
+    // Uploads the mip chain of a block compressed image, skipping levels
+    // larger than width x height.
+    static void uploadCompressed(TextureInfo &tinfo, const loom_compressed_image_t *image, uint16_t width, uint16_t height);
+
+    // This method accepts rgba data, or a block compressed image in a format
+    // the GPU supports, in which case data is ignored.
+    static TextureInfo *load(uint8_t *data, uint16_t width, uint16_t height, TextureID id = -1, const loom_compressed_image_t *compressed = NULL);
 
     static TextureInfo *initFromAssetManager(const char *path);
     static TextureInfo *initFromBytes(utByteArray *bytes, const char *name);
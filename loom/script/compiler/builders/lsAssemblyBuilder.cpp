@@ -56,6 +56,12 @@ void AssemblyBuilder::setAssembly(Assembly *assembly)
 }
 
 
+json_t *AssemblyBuilder::write()
+{
+    return writer.write();
+}
+
+
 void AssemblyBuilder::writeToString(utString& out)
 {
     writer.writeToString(out);
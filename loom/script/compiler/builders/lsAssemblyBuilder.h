@@ -77,6 +77,8 @@ public:
 
     void injectTypes(Assembly *assembly);
 
+    json_t *write();
+
     void writeToString(utString& out);
 
     void writeToFile(const utString& filename);
@@ -21,6 +21,7 @@
 #include "loom/common/core/assert.h"
 #include "loom/script/compiler/builders/lsAssemblyBuilder.h"
 #include "loom/script/compiler/builders/lsTypeBuilder.h"
+#include "loom/script/compiler/lsScalarForm.h"
 
 
 namespace LS {
@@ -83,6 +84,27 @@ void FieldInfoBuilder::injectType(Type *type)
     {
         writer.addUniqueMetaInfo("OriginalType", "Type", varDecl->originalType->getFullName().c_str());
     }
+
+    // const value for propagation by assemblies which reference this one
+    if (varDecl->constantValue)
+    {
+        Expression *value = varDecl->initializer;
+
+        if (value->astType == AST_NUMBERLITERAL)
+        {
+            char buffer[64];
+            snprintf(buffer, sizeof(buffer), "%.17g", ((NumberLiteral *)value)->value);
+            writer.addUniqueMetaInfo("ConstValue", "Number", buffer);
+        }
+        else if (value->astType == AST_STRINGLITERAL)
+        {
+            writer.addUniqueMetaInfo("ConstValue", "String", ((StringLiteral *)value)->string);
+        }
+        else if (value->astType == AST_BOOLEANLITERAL)
+        {
+            writer.addUniqueMetaInfo("ConstValue", "Boolean", ((BooleanLiteral *)value)->value ? "true" : "false");
+        }
+    }
 }
 
 
@@ -289,6 +311,140 @@ void MethodBaseBuilder::injectTypes(Assembly *assembly)
 }
 
 
+// Resolves an expression of the form "field" or "this.field" to a field
+// declared on the accessor's own class, returns NULL for anything else
+static VariableDeclaration *resolveAccessorField(FunctionLiteral *function, Expression *expression)
+{
+    utString fieldName;
+
+    if (expression->astType == AST_IDENTIFIER)
+    {
+        fieldName = ((Identifier *)expression)->string;
+    }
+    else if (expression->astType == AST_PROPERTYEXPRESSION)
+    {
+        PropertyExpression *p = (PropertyExpression *)expression;
+
+        if (p->arrayAccess || function->isStatic ||
+            (p->leftExpression->astType != AST_THISLITERAL) ||
+            (p->rightExpression->astType != AST_STRINGLITERAL))
+        {
+            return NULL;
+        }
+
+        fieldName = ((StringLiteral *)p->rightExpression)->string;
+    }
+    else
+    {
+        return NULL;
+    }
+
+    ClassDeclaration *cls = function->classDecl;
+
+    for (UTsize i = 0; i < cls->varDecls.size(); i++)
+    {
+        VariableDeclaration *vd = cls->varDecls.at(i);
+
+        if (vd->identifier->string != fieldName)
+        {
+            continue;
+        }
+
+        // the field must live in the same table the accessor is called on
+        // and must have an explicit type which we can match up
+        if ((vd->isStatic != function->isStatic) || vd->isNative || vd->assignType)
+        {
+            return NULL;
+        }
+
+        return vd;
+    }
+
+    return NULL;
+}
+
+
+// Detects accessors of the form:
+//
+//     function get x():Number { return _x; }
+//     function set x(value:Number) { _x = value; }
+//
+// returning the backing field, or NULL if the accessor does anything else
+static VariableDeclaration *findTrivialAccessorField(FunctionLiteral *function)
+{
+    if (function->isNative || function->isCoroutine || !function->statements ||
+        (function->statements->size() != 1) || function->classDecl->isInterface ||
+        function->classDecl->isNative())
+    {
+        return NULL;
+    }
+
+    Statement *statement = function->statements->at(0);
+
+    if (function->isGetter)
+    {
+        if (statement->astType != AST_RETURNSTATEMENT)
+        {
+            return NULL;
+        }
+
+        utArray<Expression *> *result = ((ReturnStatement *)statement)->result;
+
+        if (!result || (result->size() != 1) || !function->retType)
+        {
+            return NULL;
+        }
+
+        VariableDeclaration *field = resolveAccessorField(function, result->at(0));
+
+        if (!field || (field->typeString != function->retType->string))
+        {
+            return NULL;
+        }
+
+        return field;
+    }
+
+    if (function->isSetter)
+    {
+        if (!function->parameters || (function->parameters->size() != 1) ||
+            (statement->astType != AST_EXPRESSIONSTATEMENT))
+        {
+            return NULL;
+        }
+
+        Expression *expression = ((ExpressionStatement *)statement)->expression;
+
+        if (expression->astType != AST_ASSIGNMENTEXPRESSION)
+        {
+            return NULL;
+        }
+
+        AssignmentExpression *assign = (AssignmentExpression *)expression;
+        VariableDeclaration  *param  = function->parameters->at(0);
+
+        if ((assign->rightExpression->astType != AST_IDENTIFIER) ||
+            (((Identifier *)assign->rightExpression)->string != param->identifier->string))
+        {
+            return NULL;
+        }
+
+        VariableDeclaration *field = resolveAccessorField(function, assign->leftExpression);
+
+        // a parameter with the same name as the field shadows it
+        if (!field || (field->identifier->string == param->identifier->string) ||
+            (field->typeString != param->typeString))
+        {
+            return NULL;
+        }
+
+        return field;
+    }
+
+    return NULL;
+}
+
+
 void MethodBaseBuilder::build(MethodBaseWriter *writer)
 {
     MemberInfoBuilder::build(writer, function);
@@ -297,6 +453,27 @@ void MethodBaseBuilder::build(MethodBaseWriter *writer)
 
     writer->setMethodAttributes(attr);
 
+    // tag trivial accessors with their backing field, so that the compiler
+    // may access the field directly (this works across assemblies as the
+    // tag is serialized with the type information)
+    VariableDeclaration *field = findTrivialAccessorField(function);
+
+    if (field)
+    {
+        writer->addUniqueMetaInfo("InlineAccessor", "field", field->identifier->string);
+    }
+
+    // struct methods which only do arithmetic on Number fields are tagged
+    // with their effect, so that the optimizer may expand them inline on
+    // struct locals it has replaced with their fields
+    ScalarForm *form = ScalarForm::analyze(function);
+
+    if (form)
+    {
+        form->write(writer);
+        delete form;
+    }
+
     // parameters
     for (UTsize i = 0; i < parameters.size(); i++)
     {
@@ -351,6 +528,11 @@ void MethodBaseBuilder::initialize(MethodBaseWriter *writer,
         attr.isOperator = true;
     }
 
+    if (function->isFinal)
+    {
+        attr.isFinal = true;
+    }
+
     // parameters
     if (function->parameters)
     {
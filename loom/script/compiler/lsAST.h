@@ -614,11 +614,17 @@ public:
     utArray<Expression *> *arguments;
     MethodBase            *methodBase;
 
+    // set by the OptimizationVisitor when the call target can't be overridden
+    // and all arguments are supplied, so the method may be called straight
+    // off of its declaring class table rather than through a bound method
+    bool directCall;
+
     CallExpression()
     {
         function   = NULL;
         arguments  = NULL;
         methodBase = NULL;
+        directCall = false;
 
         astType = AST_CALLEXPRESSION;
     }
@@ -963,6 +969,10 @@ public:
     // this will contain the original type before the rewrite
     Type *originalType;
 
+    // true for a static const whose initializer has been reduced to a literal
+    // which is propagated to the sites that reference it
+    bool constantValue;
+
     VariableDeclaration(Identifier *identifier, Expression *initializer,
                         bool _isPublic, bool _isProtected, bool _isStatic, bool _isNative) :
         defaultInitializer(false), function(NULL), classDecl(NULL),
@@ -975,6 +985,7 @@ public:
         assignType        = false;
         assignForIn       = false;
         originalType      = NULL;
+        constantValue     = false;
     }
 
     Expression *visitExpression(Visitor *visitor)
@@ -1335,12 +1346,17 @@ public:
     bool isNative;
     bool isOperator;
     bool isCoroutine;
+    bool isFinal;
 
     bool isGetter;
     bool isSetter;
 
     bool hasSuperCall;
 
+    // set when the compiler has inserted a super call into a constructor
+    // without one, as the type may be compiled more than once
+    bool implicitSuperCall;
+
     bool isDefaultConstructor;
 
     // While generating bytecode, variable args
@@ -1384,14 +1400,18 @@ public:
     // the index we're at in the child functions of parent
     int childIndex;
 
+    // number of bytecode instructions generated for this function
+    int numInstructions;
+
     FunctionLiteral() :
         isPublic(false), isProtected(false), isStatic(false),
         isConstructor(false), isNative(false),
-        isOperator(false), isCoroutine(false), isGetter(false), isSetter(false),
-        hasSuperCall(false), isDefaultConstructor(false), curVarArgCalls(0), numVarArgCalls(0),
+        isOperator(false), isCoroutine(false), isFinal(false), isGetter(false), isSetter(false),
+        hasSuperCall(false), implicitSuperCall(false), isDefaultConstructor(false), curVarArgCalls(0), numVarArgCalls(0),
         retType(NULL), parameters(NULL), name(NULL), classDecl(NULL),
         functions(NULL), statements(NULL), methodBase(NULL),
-        toperator(NULL), property(NULL), parentFunction(NULL), childIndex(-1)
+        toperator(NULL), property(NULL), parentFunction(NULL), childIndex(-1),
+        numInstructions(0)
     {
         astType = AST_FUNCTIONLITERAL;
     }
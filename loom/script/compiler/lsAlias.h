@@ -45,7 +45,8 @@ public:
     {
         static utString none("");
 
-        utString *alias = aliases.get(source);
+        // source files are lexed in parallel, leave the lookup cache alone
+        const utString *alias = aliases.getUncached(source);
 
         if (!alias)
         {
@@ -22,6 +22,7 @@
 
 #include "loom/common/utils/utTypes.h"
 #include "loom/common/platform/platformFile.h"
+#include "loom/common/platform/platformThread.h"
 
 #include "loom/script/common/lsError.h"
 #include "loom/script/common/lsSimpleGlob.h"
@@ -31,23 +32,59 @@
 #include "loom/script/compiler/lsCompilerLog.h"
 
 #include "loom/script/compiler/lsBuildInfo.h"
+#include "loom/script/compiler/lsAlias.h"
 #include "loom/script/compiler/lsDeclarationVisitor.h"
 #include "loom/script/serialize/lsAssemblyReader.h"
 
 namespace LS {
-void ModuleBuildInfo::parseSourceFile(const utString& filename,
-                                      utString&       code)
+/*
+ * Source files of a module, which are lexed and parsed by a pool of threads
+ */
+struct ParseJob
 {
-    LSCompiler::logVerbose("Parsing %s", filename.c_str());
+    const utString  *filename;
+    const utString  *code;
+    CompilationUnit *cunit;
+};
 
-    Parser parser(code, filename);
+struct ParseQueue
+{
+    BuildInfo         *buildInfo;
+    utArray<ParseJob> jobs;
+    UTsize            next;
+    MutexHandle       mutex;
+};
 
-    int numErrors = LSCompilerLog::getNumErrors();
+static int __stdcall parseThread(void *param)
+{
+    ParseQueue *queue = (ParseQueue *)param;
 
-    CompilationUnit *cunit = parser.parseCompilationUnit(buildInfo);
+    for ( ; ; )
+    {
+        loom_mutex_lock(queue->mutex);
+        UTsize idx = queue->next++;
+        loom_mutex_unlock(queue->mutex);
+
+        if (idx >= queue->jobs.size())
+        {
+            break;
+        }
 
+        ParseJob& job = queue->jobs[idx];
+
+        Parser parser(*job.code, *job.filename);
+        job.cunit = parser.parseCompilationUnit(queue->buildInfo);
+    }
+
+    return 0;
+}
+
+
+void ModuleBuildInfo::addCompilationUnit(const utString& filename,
+                                         CompilationUnit *cunit)
+{
     // if we have parse errors return
-    if (numErrors < LSCompilerLog::getNumErrors())
+    if (LSCompilerLog::getNumErrors(filename))
     {
         buildInfo->parseErrors = true;
         return;
@@ -69,6 +106,70 @@ void ModuleBuildInfo::parseSourceFile(const utString& filename,
 }
 
 
+void ModuleBuildInfo::parseSourceFiles()
+{
+    for (UTsize i = 0; i < sourceFiles.size(); i++)
+    {
+        utString code;
+        utString sourceFile = sourceFiles[i];
+
+        loadSourceFile(sourceFile, code);
+        sourceCode.insert(utHashedString(sourceFile), code);
+    }
+
+    ParseQueue queue;
+    queue.buildInfo = buildInfo;
+    queue.next      = 0;
+
+    for (UTsize i = 0; i < sourceFiles.size(); i++)
+    {
+        LSCompiler::logVerbose("Parsing %s", sourceFiles[i].c_str());
+
+        ParseJob job;
+        job.filename = &sourceFiles[i];
+        job.code     = sourceCode.get(utHashedString(sourceFiles[i]));
+        job.cunit    = NULL;
+        queue.jobs.push_back(job);
+    }
+
+    // the parser lazily initializes the aliases, do so before we go wide
+    Aliases::initialize();
+
+    int numThreads = LSCompiler::getJobs();
+
+    if (numThreads > (int)queue.jobs.size())
+    {
+        numThreads = (int)queue.jobs.size();
+    }
+
+    queue.mutex = loom_mutex_create();
+
+    // the calling thread parses too
+    utArray<ThreadHandle> threads;
+
+    for (int i = 1; i < numThreads; i++)
+    {
+        threads.push_back(loom_thread_start(parseThread, &queue));
+    }
+
+    parseThread(&queue);
+
+    for (UTsize i = 0; i < threads.size(); i++)
+    {
+        loom_thread_join(threads[i]);
+    }
+
+    loom_mutex_destroy(queue.mutex);
+
+    // declarations are processed in source order so the build is deterministic
+    for (UTsize i = 0; i < queue.jobs.size(); i++)
+    {
+        ParseJob& job = queue.jobs[i];
+        addCompilationUnit(*job.filename, job.cunit);
+    }
+}
+
+
 void ModuleBuildInfo::loadSourceFile(const utString& filename, utString& code)
 {
     utFileStream fs;
@@ -174,17 +275,7 @@ void ModuleBuildInfo::parse(json_t *json)
         recursiveGlob(path.c_str(), "ls", sourceFiles);
     }
 
-    for (UTsize i = 0; i < sourceFiles.size(); i++)
-    {
-        utString code;
-        utString sourceFile = sourceFiles[i];
-
-        loadSourceFile(sourceFile, code);
-        sourceCode.insert(utHashedString(sourceFile), code);
-
-        // and parse
-        parseSourceFile(sourceFile, code);
-    }
+    parseSourceFiles();
 
     // if we have any compiler errors, dump them and exit
     if (LSCompilerLog::getNumErrors())
@@ -278,17 +369,7 @@ BuildInfo *BuildInfo::createDefaultBuildFile()
         recursiveGlob(path.c_str(), "ls", mi->sourceFiles);
     }
 
-    for (UTsize i = 0; i < mi->sourceFiles.size(); i++)
-    {
-        utString code;
-        utString sourceFile = mi->sourceFiles[i];
-
-        mi->loadSourceFile(sourceFile, code);
-        mi->sourceCode.insert(utHashedString(sourceFile), code);
-
-        // and parse
-        mi->parseSourceFile(sourceFile, code);
-    }
+    mi->parseSourceFiles();
 
     binfo->modules.insert(utHashedString("Main"), mi);
 
@@ -46,9 +46,12 @@ class ModuleBuildInfo {
 
     BuildInfo *buildInfo;
 
-    void parseSourceFile(const utString& filename, utString& code);
+    void addCompilationUnit(const utString& filename, CompilationUnit *cunit);
     void loadSourceFile(const utString& filename, utString& code);
 
+    // loads and parses the module's source files across LSCompiler::getJobs() threads
+    void parseSourceFiles();
+
     void parse(json_t *json);
 
 public:
@@ -22,6 +22,7 @@
 #include "loom/common/core/log.h"
 #include "loom/common/platform/platformFile.h"
 #include "loom/common/platform/platformIO.h"
+#include "loom/common/platform/platformThread.h"
 #include "loom/common/utils/utBase64.h"
 #include "loom/script/compiler/builders/lsAssemblyBuilder.h"
 #include "loom/script/compiler/lsCompiler.h"
@@ -35,11 +36,23 @@
 #include "loom/script/serialize/lsBinWriter.h"
 #include "loom/script/serialize/lsBinReader.h"
 #include "loom/script/compiler/lsTypeValidator.h"
+#include "loom/script/compiler/lsOptimizationVisitor.h"
+#include "loom/script/compiler/lsCompilerCache.h"
 
 
 namespace LS {
 bool LSCompiler::debugBuild = true;
 
+bool LSCompiler::inlineAccessors = false;
+
+bool LSCompiler::optimize = false;
+
+bool LSCompiler::incremental = false;
+
+int LSCompiler::jobs = 0;
+
+bool LSCompiler::compressExecutable = true;
+
 utString LSCompiler::sdkPath = ".";
 
 // for build files + source
@@ -177,20 +190,190 @@ void LSCompiler::processTypes(ModuleBuildInfo *mbi)
 }
 
 
-void LSCompiler::compileModules()
+void LSCompiler::optimizeTypes(utArray<CompilationUnit *>& cunits, OptimizationVisitor& optimizer)
+{
+    for (UTsize j = 0; j < cunits.size(); j++)
+    {
+        CompilationUnit *cunit = cunits.at(j);
+
+        logVerbose("Optimizing %s", cunit->filename.c_str());
+
+        optimizer.optimize(cunit);
+    }
+
+    // if we have any compiler errors, dump them and exit
+    if (LSCompilerLog::getNumErrors())
+    {
+        LSCompilerLog::dump();
+        exit(EXIT_FAILURE);
+    }
+}
+
+
+void LSCompiler::logInstructionCounts(ModuleBuildInfo *mbi, utArray<CompilationUnit *>& cunits,
+                                      utHashTable<utPointerHashKey, int>& unoptimized)
+{
+    int totalBefore = 0;
+    int totalAfter  = 0;
+
+    for (UTsize j = 0; j < cunits.size(); j++)
+    {
+        CompilationUnit *cunit = cunits.at(j);
+
+        for (UTsize k = 0; k < cunit->classDecls.size(); k++)
+        {
+            utArray<FunctionLiteral *> functions;
+            CompilerCache::getClassFunctions(cunit->classDecls.at(k), functions);
+
+            for (UTsize i = 0; i < functions.size(); i++)
+            {
+                FunctionLiteral *function = functions.at(i);
+
+                int *before = unoptimized.get(function);
+
+                if (!before || !function->methodBase)
+                {
+                    continue;
+                }
+
+                totalBefore += *before;
+                totalAfter  += function->numInstructions;
+
+                if (*before != function->numInstructions)
+                {
+                    logVerbose("    %s: %i -> %i instructions", function->methodBase->getFullMemberName(),
+                               *before, function->numInstructions);
+                }
+            }
+        }
+    }
+
+    logVerbose("Optimized %s: %i -> %i instructions", mbi->getModuleName().c_str(), totalBefore, totalAfter);
+}
+
+
+void LSCompiler::compileModules(json_t *typesJSON)
 {
+    OptimizationVisitor optimizer(vm);
+
+    CompilerCache *cache = NULL;
+
+    if (incremental)
+    {
+        cache = new CompilerCache(vm, buildInfo, typesJSON, optimize ? &optimizer : NULL);
+        cache->load();
+    }
+
     for (UTsize i = 0; i < buildInfo->getNumModules(); i++)
     {
         ModuleBuildInfo *mbi = buildInfo->getModule(i);
 
         processTypes(mbi);
 
+        // gather the constants of the module before optimizing any of it,
+        // so propagation doesn't depend on source file order
+        if (optimize)
+        {
+            for (UTsize j = 0; j < mbi->getNumSourceFiles(); j++)
+            {
+                optimizer.collect(mbi->getCompilationUnit(mbi->getSourceFilename(j)));
+            }
+        }
+
+        // the compilation units which weren't restored from the cache
+        utArray<CompilationUnit *> cunits;
+
         for (UTsize j = 0; j < mbi->getNumSourceFiles(); j++)
         {
             utString        filename = mbi->getSourceFilename(j);
             CompilationUnit *cunit   = mbi->getCompilationUnit(filename);
-            compileTypes(cunit);
+
+            if (cache)
+            {
+                cache->computeKey(cunit, mbi->getSourceCode(filename));
+
+                if (cache->restore(cunit))
+                {
+                    logVerbose("Cached %s", filename.c_str());
+
+                    // the const values are still written to the assembly
+                    if (optimize)
+                    {
+                        optimizer.resolveConstants(cunit);
+                    }
+
+                    continue;
+                }
+            }
+
+            cunits.push_back(cunit);
         }
+
+        // in verbose mode, compile the unoptimized module first so that
+        // we can report the reduction in instructions per method
+        bool reportInstructions = optimize && loom_log_getGlobalLevel() <= LoomLogDebug;
+
+        utHashTable<utPointerHashKey, int> unoptimized;
+
+        if (reportInstructions)
+        {
+            for (UTsize j = 0; j < cunits.size(); j++)
+            {
+                CompilationUnit *cunit = cunits.at(j);
+                compileTypes(cunit);
+
+                for (UTsize k = 0; k < cunit->classDecls.size(); k++)
+                {
+                    utArray<FunctionLiteral *> functions;
+                    CompilerCache::getClassFunctions(cunit->classDecls.at(k), functions);
+
+                    for (UTsize f = 0; f < functions.size(); f++)
+                    {
+                        unoptimized.insert(functions.at(f), functions.at(f)->numInstructions);
+                    }
+                }
+            }
+        }
+
+        if (optimize)
+        {
+            optimizeTypes(cunits, optimizer);
+        }
+
+        for (UTsize j = 0; j < cunits.size(); j++)
+        {
+            compileTypes(cunits.at(j));
+        }
+
+        if (reportInstructions)
+        {
+            logInstructionCounts(mbi, cunits, unoptimized);
+        }
+
+        if (cache)
+        {
+            logVerbose("%s: %i of %i source files cached", mbi->getModuleName().c_str(),
+                       (int)(mbi->getNumSourceFiles() - cunits.size()), (int)mbi->getNumSourceFiles());
+
+            // only store units which compiled without errors
+            for (UTsize j = 0; j < cunits.size(); j++)
+            {
+                if (!LSCompilerLog::getNumErrors(cunits.at(j)->filename))
+                {
+                    cache->store(cunits.at(j));
+                }
+            }
+        }
+    }
+
+    if (cache)
+    {
+        if (!LSCompilerLog::getNumErrors())
+        {
+            cache->save();
+        }
+
+        delete cache;
     }
 }
 
@@ -345,16 +528,16 @@ void LSCompiler::compileAssembly(BuildInfo *buildInfo)
     // build 1st pass assembly which contains type signatures but no code
     AssemblyBuilder *ab = AssemblyBuilder::create(compiler->buildInfo);
 
-    utString typesAssembly;
-
     // write out temporary assembly
-    ab->writeToString(typesAssembly);
+    json_t *typesJSON = ab->write();
 
     //load the type signature assembly into our VM (also loads any references)
-    Assembly *assembly = compiler->vm->loadTypeAssembly(typesAssembly);
+    Assembly *assembly = compiler->vm->loadTypeAssembly(typesJSON);
 
     // compile all modules (types)
-    compiler->compileModules();
+    compiler->compileModules(typesJSON);
+
+    json_decref(typesJSON);
 
     // dump any errors/warnings
     LSCompilerLog::dump();
@@ -670,7 +853,7 @@ void LSCompiler::linkRootAssembly(const utString& sjson)
     utString execSource = rootBuildInfo->getOutputDir() + utString(platform_getFolderDelimiter()) + rootBuildInfo->getAssemblyName() + ".loom";
 
     // generate binary assembly for executable
-    BinWriter::writeExecutable(execSource.c_str(), json);
+    BinWriter::writeExecutable(execSource.c_str(), json, compressExecutable);
 
     log("Compile successful: %s", execSource.c_str());
 }
@@ -709,6 +892,12 @@ void LSCompiler::log(const char *format, ...)
 }
 
 
+int LSCompiler::getJobs()
+{
+    return jobs > 0 ? jobs : platform_getLogicalThreadCount();
+}
+
+
 void LSCompiler::logVerbose(const char *format, ...)
 {
     char* buff;
@@ -34,6 +34,7 @@
 
 namespace LS {
 class AssemblyBuilder;
+class OptimizationVisitor;
 
 enum LSLogType
 {
@@ -55,6 +56,22 @@ private:
 
     static bool debugBuild;
 
+    // whether trivial property accessors are compiled to direct field access
+    static bool inlineAccessors;
+
+    // whether the OptimizationVisitor is run ahead of bytecode generation
+    static bool optimize;
+
+    // whether bytecode is cached per source file and reused when neither
+    // the source nor the signatures of the types it depends on change
+    static bool incremental;
+
+    // number of threads source files are parsed on, 0 for one per logical core
+    static int jobs;
+
+    // whether the executable body is compressed, rather than stored to be read in place
+    static bool compressExecutable;
+
     void openCompilerVM();
     void closeCompilerVM();
 
@@ -62,7 +79,14 @@ private:
 
     void processTypes(ModuleBuildInfo *mbi);
 
-    void compileModules();
+    void optimizeTypes(utArray<CompilationUnit *>& cunits, OptimizationVisitor& optimizer);
+
+    // logs the instruction count of each method against the count
+    // recorded before optimization
+    void logInstructionCounts(ModuleBuildInfo *mbi, utArray<CompilationUnit *>& cunits,
+                              utHashTable<utPointerHashKey, int>& unoptimized);
+
+    void compileModules(json_t *typesJSON);
 
     // path to the sdk we're building with
     static utString sdkPath;
@@ -135,6 +159,53 @@ public:
         debugBuild = _debugBuild;
     }
 
+    static bool getInlineAccessors()
+    {
+        return inlineAccessors;
+    }
+
+    static void setInlineAccessors(bool _inlineAccessors)
+    {
+        inlineAccessors = _inlineAccessors;
+    }
+
+    static bool getOptimize()
+    {
+        return optimize;
+    }
+
+    static void setOptimize(bool _optimize)
+    {
+        optimize = _optimize;
+    }
+
+    static bool getIncremental()
+    {
+        return incremental;
+    }
+
+    static void setIncremental(bool _incremental)
+    {
+        incremental = _incremental;
+    }
+
+    static int getJobs();
+
+    static bool getCompressExecutable()
+    {
+        return compressExecutable;
+    }
+
+    static void setCompressExecutable(bool _compressExecutable)
+    {
+        compressExecutable = _compressExecutable;
+    }
+
+    static void setJobs(int _jobs)
+    {
+        jobs = _jobs;
+    }
+
     static void setSDKBuild(const utString& lscPath);
 
     static void setConfigOverride(const char *config);
@@ -0,0 +1,619 @@
+/*
+ * ===========================================================================
+ * Loom SDK
+ * Copyright 2011, 2012, 2013
+ * The Game Engine Company, LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ * ===========================================================================
+ */
+
+#include "loom/common/core/assert.h"
+#include "loom/common/platform/platformFile.h"
+#include "loom/common/utils/utStreams.h"
+#include "loom/common/utils/md5.h"
+
+#include "loom/script/compiler/lsCompiler.h"
+#include "loom/script/compiler/lsCompilerCache.h"
+#include "loom/script/compiler/lsTraversalVisitor.h"
+#include "loom/script/compiler/lsOptimizationVisitor.h"
+#include "loom/script/reflection/lsFieldInfo.h"
+
+namespace LS {
+#define LOOM_COMPILER_CACHE_MAGIC      0x4c534343
+#define LOOM_COMPILER_CACHE_VERSION    3
+#define LOOM_COMPILER_CACHE_DIR        ".lscache"
+
+/*
+ * Gathers the types the code generated for a compilation unit depends on
+ */
+class DependencyVisitor : public TraversalVisitor {
+public:
+
+    utArray<Type *> types;
+
+    DependencyVisitor() : TraversalVisitor()
+    {
+        visitor = this;
+    }
+
+    void addType(Type *type)
+    {
+        if (!type || (types.find(type) != UT_NPOS))
+        {
+            return;
+        }
+
+        types.push_back(type);
+
+        // the member ordinals of a type follow those of its bases, which
+        // aren't in its signature as it is taken before types are processed
+        addType(type->getBaseType());
+
+        for (UTsize i = 0; i < type->getNumInterfaces(); i++)
+        {
+            addType(type->getInterface(i));
+        }
+    }
+
+    void addTemplateInfo(TemplateInfo *templateInfo)
+    {
+        if (!templateInfo)
+        {
+            return;
+        }
+
+        addType(templateInfo->type);
+
+        for (UTsize i = 0; i < templateInfo->types.size(); i++)
+        {
+            addTemplateInfo(templateInfo->types.at(i));
+        }
+    }
+
+    void addMemberInfo(MemberInfo *memberInfo)
+    {
+        if (memberInfo)
+        {
+            addType(memberInfo->getDeclaringType());
+            addTemplateInfo(memberInfo->getTemplateInfo());
+        }
+    }
+
+    Expression *visitExpression(Expression *expression)
+    {
+        if (expression != NULL)
+        {
+            addType(expression->type);
+            addMemberInfo(expression->memberInfo);
+            addTemplateInfo(expression->templateInfo);
+
+            if (expression->astType == AST_CALLEXPRESSION)
+            {
+                addMemberInfo(((CallExpression *)expression)->methodBase);
+            }
+        }
+
+        return TraversalVisitor::visitExpression(expression);
+    }
+
+    void gather(CompilationUnit *cunit)
+    {
+        for (UTsize i = 0; i < cunit->classDecls.size(); i++)
+        {
+            Type *type = cunit->classDecls.at(i)->type;
+
+            // the type itself, its bases and interfaces
+            addType(type);
+
+            utArray<Type *> imports;
+            type->getImports(imports);
+
+            for (UTsize j = 0; j < imports.size(); j++)
+            {
+                addType(imports.at(j));
+            }
+        }
+
+        TraversalVisitor::visit(cunit);
+    }
+};
+
+// source locations and type ids don't change the code generated against a type
+static void stripSignature(json_t *json)
+{
+    if (json_is_array(json))
+    {
+        for (size_t i = 0; i < json_array_size(json); i++)
+        {
+            stripSignature(json_array_get(json, i));
+        }
+    }
+    else if (json_is_object(json))
+    {
+        json_object_del(json, "source");
+        json_object_del(json, "line");
+        json_object_del(json, "docString");
+        json_object_del(json, "typeid");
+
+        for (void *iter = json_object_iter(json); iter; iter = json_object_iter_next(json, iter))
+        {
+            stripSignature(json_object_iter_value(iter));
+        }
+    }
+}
+
+
+static int compareSignatures(const void *a, const void *b)
+{
+    return strcmp(*(const char **)a, *(const char **)b);
+}
+
+
+CompilerCache::CompilerCache(LSLuaState *vm, BuildInfo *buildInfo, json_t *typesJSON, OptimizationVisitor *optimizer) :
+    vm(vm), buildInfo(buildInfo), optimizer(optimizer)
+{
+    path  = LOOM_COMPILER_CACHE_DIR;
+    path += platform_getFolderDelimiter();
+    path += buildInfo->getAssemblyName();
+    path += ".lscache";
+
+    computeSignatures(typesJSON);
+}
+
+
+CompilerCache::~CompilerCache()
+{
+    for (UTsize i = 0; i < entries.size(); i++)
+    {
+        delete entries.at(i);
+    }
+}
+
+
+void CompilerCache::computeSignatures(json_t *typesJSON)
+{
+    json_t *modules = json_object_get(typesJSON, "modules");
+
+    for (size_t i = 0; i < json_array_size(modules); i++)
+    {
+        json_t *types = json_object_get(json_array_get(modules, i), "types");
+
+        for (size_t j = 0; j < json_array_size(types); j++)
+        {
+            json_t *type = json_deep_copy(json_array_get(types, j));
+
+            utString fullName  = json_string_value(json_object_get(type, "package"));
+            fullName += ".";
+            fullName += json_string_value(json_object_get(type, "name"));
+
+            stripSignature(type);
+
+            char *signature = json_dumps(type, JSON_SORT_KEYS | JSON_COMPACT);
+
+            MDFive md5;
+            md5.update(signature, strlen(signature));
+            md5.finalize();
+
+            signatures.insert(utHashedString(fullName), md5.hexdigest().c_str());
+
+            free(signature);
+            json_decref(type);
+        }
+    }
+}
+
+
+utString CompilerCache::getSignature(Type *type)
+{
+    utString *signature = signatures.get(utHashedString(type->getFullName()));
+
+    // types from referenced assemblies change with the assembly
+    if (!signature)
+    {
+        Assembly *assembly = type->getAssembly();
+        utString uid = assembly ? assembly->getUniqueId() : utString();
+        return type->getFullName() + ":" + uid;
+    }
+
+    if (!optimizer)
+    {
+        return *signature;
+    }
+
+    // propagated consts are compiled into the sites that reference them
+    utString result = *signature;
+
+    for (int i = 0; i < type->getFieldInfoCount(); i++)
+    {
+        FieldInfo  *field = type->getFieldInfo(i);
+        Expression *value = field->isStatic() && field->isConst() ? optimizer->getConstantValue(field) : NULL;
+
+        if (!value)
+        {
+            continue;
+        }
+
+        result += ":";
+        result += field->getName();
+        result += "=";
+
+        if (value->astType == AST_NUMBERLITERAL)
+        {
+            char buffer[64];
+            snprintf(buffer, sizeof(buffer), "%.17g", ((NumberLiteral *)value)->value);
+            result += buffer;
+        }
+        else if (value->astType == AST_STRINGLITERAL)
+        {
+            result += ((StringLiteral *)value)->string;
+        }
+        else if (value->astType == AST_BOOLEANLITERAL)
+        {
+            result += ((BooleanLiteral *)value)->value ? "true" : "false";
+        }
+    }
+
+    return result;
+}
+
+
+void CompilerCache::computeKey(CompilationUnit *cunit, const utString& source)
+{
+    MDFive md5;
+
+    char flags[128];
+    snprintf(flags, sizeof(flags), "%d:%d:%d:%d:%d", LOOM_COMPILER_CACHE_VERSION,
+             (int)buildInfo->isDebugBuild(), (int)LSCompiler::getOptimize(),
+             (int)LSCompiler::getInlineAccessors(),
+#ifdef LOOM_ENABLE_JIT
+             1
+#else
+             0
+#endif
+             );
+
+    md5.update(flags, strlen(flags));
+    md5.update(source.c_str(), source.length());
+
+    DependencyVisitor dependencies;
+    dependencies.gather(cunit);
+
+    // sort so the key doesn't depend on traversal order
+    utArray<utString> typeSignatures;
+
+    for (UTsize i = 0; i < dependencies.types.size(); i++)
+    {
+        typeSignatures.push_back(dependencies.types.at(i)->getFullName() + "@" + getSignature(dependencies.types.at(i)));
+    }
+
+    utArray<const char *> sorted;
+
+    for (UTsize i = 0; i < typeSignatures.size(); i++)
+    {
+        sorted.push_back(typeSignatures.at(i).c_str());
+    }
+
+    if (sorted.size())
+    {
+        qsort(sorted.ptr(), sorted.size(), sizeof(const char *), compareSignatures);
+    }
+
+    for (UTsize i = 0; i < sorted.size(); i++)
+    {
+        md5.update(sorted.at(i), strlen(sorted.at(i)));
+    }
+
+    md5.finalize();
+
+    keys.insert(cunit, md5.hexdigest().c_str());
+}
+
+
+void CompilerCache::getClassFunctions(ClassDeclaration *cls, utArray<FunctionLiteral *>& functions)
+{
+    if (cls->constructor)
+    {
+        functions.push_back(cls->constructor);
+    }
+
+    for (UTsize i = 0; i < cls->functionDecls.size(); i++)
+    {
+        functions.push_back(cls->functionDecls.at(i));
+    }
+
+    for (UTsize i = 0; i < cls->properties.size(); i++)
+    {
+        PropertyLiteral *property = cls->properties.at(i);
+
+        if (property->getter)
+        {
+            functions.push_back(property->getter);
+        }
+
+        if (property->setter)
+        {
+            functions.push_back(property->setter);
+        }
+    }
+}
+
+
+void CompilerCache::writeByteCode(utByteArray& bytes, ByteCode *byteCode)
+{
+    bytes.writeBoolean(byteCode != NULL);
+
+    if (byteCode)
+    {
+        byteCode->serialize(&bytes);
+    }
+}
+
+
+ByteCode *CompilerCache::readByteCode(utByteArray& bytes)
+{
+    if (!bytes.readBoolean())
+    {
+        return NULL;
+    }
+
+    ByteCode *byteCode = lmNew(NULL) ByteCode();
+    byteCode->deserialize(&bytes);
+
+    return byteCode;
+}
+
+
+bool CompilerCache::restore(CompilationUnit *cunit)
+{
+    utString *key   = keys.get(cunit);
+    Entry    **entry = entries.get(utHashedString(cunit->filename));
+
+    if (!key || !entry || ((*entry)->key != *key))
+    {
+        return false;
+    }
+
+    utByteArray bytes;
+    bytes.allocateAndCopy((*entry)->data.ptr(), (*entry)->data.size());
+
+    // the source is unchanged, so the classes and functions line up with the stored ones
+    for (UTsize i = 0; i < cunit->classDecls.size(); i++)
+    {
+        ClassDeclaration *cls  = cunit->classDecls.at(i);
+        Type             *type = cls->type;
+
+        // imports added during compilation
+        int numImports = bytes.readInt();
+
+        for (int j = 0; j < numImports; j++)
+        {
+            Type *import = vm->getType(bytes.readString());
+
+            utArray<Type *> imports;
+            type->getImports(imports);
+
+            if (import && (imports.find(import) == UT_NPOS))
+            {
+                type->addImport(import);
+            }
+        }
+
+        ByteCode *byteCode = readByteCode(bytes);
+
+        if (byteCode)
+        {
+            type->setBCStaticInitializer(byteCode);
+        }
+
+        byteCode = readByteCode(bytes);
+
+        if (byteCode)
+        {
+            type->setBCInstanceInitializer(byteCode);
+        }
+
+        utArray<FunctionLiteral *> functions;
+        getClassFunctions(cls, functions);
+
+        for (UTsize j = 0; j < functions.size(); j++)
+        {
+            byteCode = readByteCode(bytes);
+
+            if (byteCode)
+            {
+                functions.at(j)->methodBase->setByteCode(byteCode);
+            }
+        }
+    }
+
+    return true;
+}
+
+
+void CompilerCache::store(CompilationUnit *cunit)
+{
+    utString *key = keys.get(cunit);
+
+    lmAssert(key, "no cache key for %s", cunit->filename.c_str());
+
+    utByteArray bytes;
+
+    for (UTsize i = 0; i < cunit->classDecls.size(); i++)
+    {
+        ClassDeclaration *cls  = cunit->classDecls.at(i);
+        Type             *type = cls->type;
+
+        utArray<Type *> imports;
+        type->getImports(imports);
+
+        bytes.writeInt((int)imports.size());
+
+        for (UTsize j = 0; j < imports.size(); j++)
+        {
+            bytes.writeString(imports.at(j)->getFullName().c_str());
+        }
+
+        writeByteCode(bytes, type->getBCStaticInitializer());
+        writeByteCode(bytes, type->getBCInstanceInitializer());
+
+        utArray<FunctionLiteral *> functions;
+        getClassFunctions(cls, functions);
+
+        for (UTsize j = 0; j < functions.size(); j++)
+        {
+            MethodBase *methodBase = functions.at(j)->methodBase;
+            writeByteCode(bytes, methodBase ? methodBase->getByteCode() : NULL);
+        }
+    }
+
+    Entry **existing = entries.get(utHashedString(cunit->filename));
+    Entry *entry     = existing ? *existing : new Entry;
+
+    if (!existing)
+    {
+        entries.insert(utHashedString(cunit->filename), entry);
+    }
+
+    entry->key = *key;
+    entry->data.resize(bytes.getSize());
+
+    if (bytes.getSize())
+    {
+        memcpy(entry->data.ptr(), bytes.getDataPtr(), bytes.getSize());
+    }
+}
+
+
+void CompilerCache::load()
+{
+    utArray<unsigned char> data;
+
+    if (!utFileStream::tryReadToArray(path, data, false))
+    {
+        return;
+    }
+
+    utByteArray bytes;
+    bytes.attach(data.ptr(), data.size());
+
+    if ((bytes.getSize() < sizeof(int) * 3) || (bytes.readInt() != LOOM_COMPILER_CACHE_MAGIC) ||
+        (bytes.readInt() != LOOM_COMPILER_CACHE_VERSION))
+    {
+        LSCompiler::logVerbose("Ignoring incompatible compiler cache %s", path.c_str());
+        return;
+    }
+
+#ifdef LOOM_ENABLE_JIT
+    bool jit = true;
+#else
+    bool jit = false;
+#endif
+
+    // the bytecode of the other backend can't be deserialized
+    if (bytes.readBoolean() != jit)
+    {
+        return;
+    }
+
+    int numEntries = bytes.readInt();
+
+    for (int i = 0; i < numEntries; i++)
+    {
+        Entry *entry = new Entry;
+
+        utString filename = bytes.readString();
+        entry->key = bytes.readString();
+
+        UTsize size = bytes.readUnsignedInt();
+
+        entry->data.resize(size);
+
+        if (size)
+        {
+            memcpy(entry->data.ptr(), (unsigned char *)bytes.getDataPtr() + bytes.getPosition(), size);
+            bytes.setPosition(bytes.getPosition() + size);
+        }
+
+        entries.insert(utHashedString(filename), entry);
+    }
+
+    LSCompiler::logVerbose("Loaded compiler cache %s with %i entries", path.c_str(), numEntries);
+}
+
+
+void CompilerCache::save()
+{
+    utByteArray bytes;
+
+    bytes.writeInt(LOOM_COMPILER_CACHE_MAGIC);
+    bytes.writeInt(LOOM_COMPILER_CACHE_VERSION);
+
+#ifdef LOOM_ENABLE_JIT
+    bytes.writeBoolean(true);
+#else
+    bytes.writeBoolean(false);
+#endif
+
+    // only entries of the source files still in the build are kept
+    utArray<utString> filenames;
+
+    for (UTsize i = 0; i < buildInfo->getNumModules(); i++)
+    {
+        ModuleBuildInfo *mbi = buildInfo->getModule(i);
+
+        for (UTsize j = 0; j < mbi->getNumSourceFiles(); j++)
+        {
+            if (entries.find(utHashedString(mbi->getSourceFilename(j))) != UT_NPOS)
+            {
+                filenames.push_back(mbi->getSourceFilename(j));
+            }
+        }
+    }
+
+    bytes.writeInt((int)filenames.size());
+
+    for (UTsize i = 0; i < filenames.size(); i++)
+    {
+        Entry *entry = *entries.get(utHashedString(filenames.at(i)));
+
+        bytes.writeString(filenames.at(i).c_str());
+        bytes.writeString(entry->key.c_str());
+        bytes.writeUnsignedInt(entry->data.size());
+
+        if (entry->data.size())
+        {
+            utByteArray data;
+            data.attach(entry->data.ptr(), entry->data.size());
+            bytes.writeBytes(&data);
+        }
+    }
+
+    if (platform_dirExists(LOOM_COMPILER_CACHE_DIR) != 0)
+    {
+        platform_makeDir(LOOM_COMPILER_CACHE_DIR);
+    }
+
+    utFileStream stream;
+    stream.open(path.c_str(), utStream::SM_WRITE);
+
+    if (!stream.isOpen())
+    {
+        LSCompiler::log("Unable to write compiler cache %s", path.c_str());
+        return;
+    }
+
+    stream.write(bytes.getDataPtr(), bytes.getSize());
+    stream.close();
+}
+}
@@ -0,0 +1,105 @@
+/*
+ * ===========================================================================
+ * Loom SDK
+ * Copyright 2011, 2012, 2013
+ * The Game Engine Company, LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ * ===========================================================================
+ */
+
+#ifndef _lscompilercache_h
+#define _lscompilercache_h
+
+#include "jansson.h"
+
+#include "loom/common/utils/utTypes.h"
+#include "loom/common/utils/utString.h"
+#include "loom/common/utils/utByteArray.h"
+
+#include "loom/script/runtime/lsLuaState.h"
+#include "loom/script/compiler/lsAST.h"
+#include "loom/script/compiler/lsBuildInfo.h"
+
+namespace LS {
+class OptimizationVisitor;
+
+/*
+ * Caches the bytecode generated for each source file of an assembly
+ * between compiler runs.
+ *
+ * An entry is keyed on the source file contents, the compiler flags and
+ * the signatures of every type the source file depends on, so it is
+ * reused only when neither the file nor anything its code generation
+ * depends on has changed.  Type checking still runs for every source file,
+ * only bytecode generation is skipped.
+ */
+class CompilerCache {
+private:
+
+    struct Entry
+    {
+        utString               key;
+        utArray<unsigned char> data;
+    };
+
+    LSLuaState *vm;
+
+    BuildInfo *buildInfo;
+
+    utString path;
+
+    // source filename -> entry, as loaded from disk and as stored this run
+    utHashTable<utHashedString, Entry *> entries;
+
+    // type full name -> signature hash of the types in the build
+    utHashTable<utHashedString, utString> signatures;
+
+    // compilation unit -> key computed for this run
+    utHashTable<utPointerHashKey, utString> keys;
+
+    OptimizationVisitor *optimizer;
+
+    void computeSignatures(json_t *typesJSON);
+
+    utString getSignature(Type *type);
+
+    void writeByteCode(utByteArray& bytes, ByteCode *byteCode);
+
+    ByteCode *readByteCode(utByteArray& bytes);
+
+public:
+
+    // optimizer is NULL when the OptimizationVisitor isn't run
+    CompilerCache(LSLuaState *vm, BuildInfo *buildInfo, json_t *typesJSON, OptimizationVisitor *optimizer);
+
+    ~CompilerCache();
+
+    void load();
+
+    void save();
+
+    // computes the key of a compilation unit, which must be fully typed
+    void computeKey(CompilationUnit *cunit, const utString& source);
+
+    // restores the bytecode of a compilation unit, returns false on a miss
+    bool restore(CompilationUnit *cunit);
+
+    // stores the bytecode of a freshly compiled compilation unit
+    void store(CompilationUnit *cunit);
+
+    // gathers the compiled functions of a class: constructor, methods and property accessors
+    static void getClassFunctions(ClassDeclaration *cls, utArray<FunctionLiteral *>& functions);
+};
+}
+#endif
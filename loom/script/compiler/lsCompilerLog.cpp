@@ -18,6 +18,7 @@
  * ===========================================================================
  */
 
+#include "loom/common/platform/platformThread.h"
 #include "loom/script/compiler/lsCompilerLog.h"
 
 #include <stdio.h>
@@ -26,6 +27,9 @@ namespace LS {
 utArray<LSCompilerLog::Message> LSCompilerLog::errors;
 utArray<LSCompilerLog::Message> LSCompilerLog::warnings;
 
+// source files are parsed in parallel, so logging must be guarded
+static MutexHandle logMutex = loom_mutex_create();
+
 void LSCompilerLog::logWarning(utString filename, int line, utString message,
                                utString subType)
 {
@@ -35,10 +39,12 @@ void LSCompilerLog::logWarning(utString filename, int line, utString message,
     msg.line     = line;
     msg.message  = message;
     msg.subType  = subType;
+    loom_mutex_lock(logMutex);
     if (warnings.find(msg) == UT_NPOS)
     {
         warnings.push_back(msg);
     }
+    loom_mutex_unlock(logMutex);
 }
 
 
@@ -51,10 +57,30 @@ void LSCompilerLog::logError(utString filename, int line, utString message,
     msg.line     = line;
     msg.message  = message;
     msg.subType  = subType;
+    loom_mutex_lock(logMutex);
     if (errors.find(msg) == UT_NPOS)
     {
         errors.push_back(msg);
     }
+    loom_mutex_unlock(logMutex);
+}
+
+
+int LSCompilerLog::getNumErrors(const utString& filename)
+{
+    int count = 0;
+
+    loom_mutex_lock(logMutex);
+    for (UTsize i = 0; i < errors.size(); i++)
+    {
+        if (errors[i].filename == filename)
+        {
+            count++;
+        }
+    }
+    loom_mutex_unlock(logMutex);
+
+    return count;
 }
 
 
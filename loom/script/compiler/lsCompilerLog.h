@@ -69,6 +69,9 @@ public:
         return errors.size();
     }
 
+    // number of errors logged against the given source file
+    static int getNumErrors(const utString& filename);
+
     static int getNumWarnings()
     {
         return warnings.size();
@@ -388,6 +388,8 @@ void JitTypeCompiler::generateMethod(FunctionLiteral *function,
 
     closeCodeState(&codeState);
 
+    function->numInstructions = (int)codeState.proto->sizebc;
+
 	bool debug = cunit->buildInfo->isDebugBuild();
 
     if (!method->getByteCode()) method->setByteCode(lmNew(NULL) ByteCode());
@@ -478,6 +480,7 @@ void JitTypeCompiler::generateConstructor(FunctionLiteral *function,
     // it at runtime which is a performance overhead.
     if(function->isConstructor
        && function->hasSuperCall == false
+       && function->implicitSuperCall == false
        && function->isNative == false
        && skipSuper == false
        && constructor->getDeclaringType()->isPrimitive() == false)
@@ -496,6 +499,8 @@ void JitTypeCompiler::generateConstructor(FunctionLiteral *function,
         if(function->statements == NULL)
             function->statements = new utArray<Statement*>();
         function->statements->push_front(stmt);
+
+        function->implicitSuperCall = true;
     }
 
     // Emit any actual constructor code!
@@ -503,6 +508,8 @@ void JitTypeCompiler::generateConstructor(FunctionLiteral *function,
 
     closeCodeState(&codeState);
 
+    function->numInstructions = (int)codeState.proto->sizebc;
+
 	bool debug = cunit->buildInfo->isDebugBuild();
 
     if (!constructor->getByteCode()) constructor->setByteCode(lmNew(NULL) ByteCode());
@@ -648,25 +655,30 @@ Statement *JitTypeCompiler::visit(ContinueStatement *statement)
 Statement *JitTypeCompiler::visit(DoStatement *statement)
 {
     FuncState *fs = cs->fs;
-
+    BCPos     loop;
     FuncScope bl;
 
-    int whileinit = BC::getLabel(fs);
+    loop = fs->lasttarget = fs->pc;
 
     enterBlock(fs, &bl, 1);
 
+    /* mark the loop for the trace compiler */
+    bcemit_AD(fs, BC_LOOP, fs->nactvar, 0);
+
     /* statements*/
     statement->statement->visitStatement(this);
 
-    lua_assert(bl.breaklist == NO_JMP);
+    /* continue evaluates the condition */
+    BC::jmpToHere(fs, bl.continuelist);
 
     int condexit = encodeCondition(statement->expression);
 
-    BC::jmpPatch(fs, BC::emitJmp(fs), whileinit);
+    BC::jmpPatch(fs, BC::emitJmp(fs), loop);
 
     leaveBlock(fs);
 
     BC::jmpToHere(fs, condexit); /* false conditions finish the loop */
+    BC::jmpPatchIns(fs, loop, fs->pc);
 
     return statement;
 }
@@ -713,6 +725,7 @@ Statement *JitTypeCompiler::visit(ForStatement *statement)
     FuncState *fs = cs->fs;
     int       whileinit;
     int       condexit;
+    BCPos     loop;
     FuncScope bl;
 
     /* initial */
@@ -744,13 +757,17 @@ Statement *JitTypeCompiler::visit(ForStatement *statement)
 
     enterBlock(fs, &bl, 1);
 
+    /* mark the loop for the trace compiler */
+    loop = bcemit_AD(fs, BC_LOOP, fs->nactvar, 0);
+
     /* statements*/
     statement->statement->visitStatement(this);
 
+    /* continue runs the increment, if any */
+    BC::jmpToHere(fs, bl.continuelist);
+
     if (es)
     {
-        BC::jmpToHere(fs, bl.continuelist);
-
         es->visitStatement(this);
 
         es->expression = NULL;
@@ -759,12 +776,11 @@ Statement *JitTypeCompiler::visit(ForStatement *statement)
         es = NULL;
     }
 
-    lua_assert(bl.breaklist == NO_JUMP);
-
     BC::jmpPatch(fs, BC::emitJmp(fs), whileinit);
     leaveBlock(fs);
 
     BC::jmpToHere(fs, condexit); /* false conditions finish the loop */
+    BC::jmpPatchIns(fs, loop, fs->pc);
 
     return statement;
 }
@@ -1363,7 +1379,7 @@ Expression *JitTypeCompiler::visit(AssignmentOperatorExpression *expression)
     if (eleft->memberInfo && eleft->memberInfo->isProperty())
     {
         eright->e = right;
-        generatePropertySet(&eleft->e, eright, false);
+        generatePropertyStore(eleft, &eleft->e, eright);
     }
     else
     {
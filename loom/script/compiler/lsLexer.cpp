@@ -28,9 +28,6 @@
 
 
 namespace LS {
-#define LEXER_MAX_TOKEN    65536
-static char ctoken[LEXER_MAX_TOKEN];
-
 Lexer::Lexer()
 {
     lineNumber  = 1;
@@ -27,6 +27,8 @@
 #include "loom/script/compiler/lsToken.h"
 
 namespace LS {
+#define LEXER_MAX_TOKEN    65536
+
 class Lexer {
     enum NumericBase
     {
@@ -67,6 +69,9 @@ class Lexer {
 
     Tokens *tokens;
 
+    // per lexer so that source files may be lexed in parallel
+    char ctoken[LEXER_MAX_TOKEN];
+
     bool isEOF();
     bool isLineTerminator();
     bool isWhitespace();
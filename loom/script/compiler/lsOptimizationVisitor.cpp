@@ -0,0 +1,1226 @@
+/*
+ * ===========================================================================
+ * Loom SDK
+ * Copyright 2011, 2012, 2013
+ * The Game Engine Company, LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ * ===========================================================================
+ */
+
+#include <math.h>
+#include <stdlib.h>
+
+#include "loom/script/compiler/lsOptimizationVisitor.h"
+#include "loom/script/compiler/lsBuildInfo.h"
+#include "loom/script/reflection/lsMethodInfo.h"
+
+namespace LS {
+/*
+ * Records assignments to const fields, const is not enforced by the
+ * type visitor so a const which is written to can't be propagated
+ */
+class ConstantWriteVisitor : public TraversalVisitor {
+    utHashTable<utPointerHashKey, FieldInfo *>& written;
+
+    void record(Expression *lvalue)
+    {
+        FieldInfo *field = OptimizationVisitor::getConstField(lvalue);
+
+        if (!field)
+        {
+            return;
+        }
+
+        warning("Assignment to const field %s::%s, it will not be propagated",
+                field->getDeclaringType()->getFullName().c_str(), field->getName());
+
+        written.insert(field, field);
+    }
+
+public:
+
+    ConstantWriteVisitor(CompilationUnit *cunit, utHashTable<utPointerHashKey, FieldInfo *>& written) :
+        TraversalVisitor(), written(written)
+    {
+        visitor     = this;
+        this->cunit = cunit;
+    }
+
+    Statement *visitStatement(Statement *statement)
+    {
+        if (statement != NULL)
+        {
+            lineNumber = statement->lineNumber;
+            statement  = TraversalVisitor::visitStatement(statement);
+        }
+
+        return statement;
+    }
+
+    Expression *visit(AssignmentExpression *expression)
+    {
+        record(expression->leftExpression);
+        return TraversalVisitor::visit(expression);
+    }
+
+    Expression *visit(AssignmentOperatorExpression *expression)
+    {
+        record(expression->leftExpression);
+        return TraversalVisitor::visit(expression);
+    }
+
+    Expression *visit(MultipleAssignmentExpression *expression)
+    {
+        for (UTsize i = 0; i < expression->left.size(); i++)
+        {
+            record(expression->left[i]);
+        }
+
+        return TraversalVisitor::visit(expression);
+    }
+
+    Expression *visit(IncrementExpression *expression)
+    {
+        record(expression->subExpression);
+        return TraversalVisitor::visit(expression);
+    }
+};
+
+/*
+ * Gathers what we need to know before removing a subtree: whether it
+ * contains a local function (which are indexed by the bytecode generators)
+ * and which locals it declares and references
+ */
+class DeadCodeScanVisitor : public TraversalVisitor {
+public:
+
+    bool hasFunction;
+
+    utArray<VariableDeclaration *> declarations;
+
+    utHashTable<utPointerHashKey, int> references;
+
+    DeadCodeScanVisitor() :
+        TraversalVisitor(), hasFunction(false)
+    {
+        visitor = this;
+    }
+
+    int getReferences(VariableDeclaration *declaration)
+    {
+        int *count = references.get(declaration);
+
+        return count ? *count : 0;
+    }
+
+    Expression *visit(FunctionLiteral *literal)
+    {
+        hasFunction = true;
+        return TraversalVisitor::visit(literal);
+    }
+
+    Expression *visit(VariableDeclaration *declaration)
+    {
+        declarations.push_back(declaration);
+        return TraversalVisitor::visit(declaration);
+    }
+
+    Expression *visit(Identifier *identifier)
+    {
+        if (identifier->localVarDecl)
+        {
+            references.set(identifier->localVarDecl, getReferences(identifier->localVarDecl) + 1);
+        }
+
+        return TraversalVisitor::visit(identifier);
+    }
+};
+
+
+static bool isTypeNamed(Type *type, const char *fullName)
+{
+    return type && type->getFullName() == fullName;
+}
+
+
+static Expression *createLiteral(Expression *value, Type *type, int lineNumber)
+{
+    Expression *literal = NULL;
+
+    switch (value->astType)
+    {
+    case AST_NUMBERLITERAL:
+        literal = new NumberLiteral(((NumberLiteral *)value)->value);
+        break;
+
+    case AST_STRINGLITERAL:
+        literal = new StringLiteral(((StringLiteral *)value)->string);
+        break;
+
+    case AST_BOOLEANLITERAL:
+        literal = new BooleanLiteral(((BooleanLiteral *)value)->value);
+        break;
+
+    default:
+        lmAssert(0, "Unexpected constant literal");
+    }
+
+    literal->type       = type;
+    literal->lineNumber = lineNumber;
+
+    return literal;
+}
+
+
+OptimizationVisitor::~OptimizationVisitor()
+{
+    for (UTsize i = 0; i < constants.size(); i++)
+    {
+        delete constants.at(i);
+    }
+}
+
+
+FieldInfo *OptimizationVisitor::getConstField(Expression *lvalue)
+{
+    MemberInfo *memberInfo = NULL;
+
+    if (lvalue->astType == AST_IDENTIFIER)
+    {
+        Identifier *identifier = (Identifier *)lvalue;
+
+        if (identifier->localVarDecl)
+        {
+            return NULL;
+        }
+
+        memberInfo = identifier->memberInfo;
+    }
+    else if (lvalue->astType == AST_PROPERTYEXPRESSION)
+    {
+        PropertyExpression *p = (PropertyExpression *)lvalue;
+
+        if (p->arrayAccess)
+        {
+            return NULL;
+        }
+
+        memberInfo = p->rightExpression->memberInfo ? p->rightExpression->memberInfo : p->memberInfo;
+    }
+
+    if (!memberInfo || !memberInfo->isField())
+    {
+        return NULL;
+    }
+
+    FieldInfo *field = (FieldInfo *)memberInfo;
+
+    return field->isConst() ? field : NULL;
+}
+
+
+bool OptimizationVisitor::isConstantLiteral(Expression *expression)
+{
+    if (!expression)
+    {
+        return false;
+    }
+
+    switch (expression->astType)
+    {
+    case AST_NUMBERLITERAL:
+        return isTypeNamed(expression->type, "system.Number");
+
+    case AST_STRINGLITERAL:
+        // string literals with member info are member names
+        return !expression->memberInfo && isTypeNamed(expression->type, "system.String");
+
+    case AST_BOOLEANLITERAL:
+        return isTypeNamed(expression->type, "system.Boolean");
+
+    default:
+        return false;
+    }
+}
+
+
+void OptimizationVisitor::collect(CompilationUnit *cunit)
+{
+    for (UTsize i = 0; i < cunit->classDecls.size(); i++)
+    {
+        ClassDeclaration *cls = cunit->classDecls.at(i);
+
+        for (UTsize j = 0; j < cls->varDecls.size(); j++)
+        {
+            VariableDeclaration *vd = cls->varDecls.at(j);
+
+            if (!vd->isStatic || !vd->isConst || vd->isNative || !vd->initializer || !vd->memberInfo)
+            {
+                continue;
+            }
+
+            ConstantField *constant = new ConstantField;
+            constant->varDecl = vd;
+            constant->cunit   = cunit;
+            constant->state   = CONSTANT_UNRESOLVED;
+            constant->value   = NULL;
+
+            constants.insert(vd->memberInfo, constant);
+        }
+    }
+
+    ConstantWriteVisitor cwv(cunit, writtenConstants);
+    cwv.TraversalVisitor::visit(cunit);
+}
+
+
+void OptimizationVisitor::resolveConstants(CompilationUnit *cunit)
+{
+    debugBuild = cunit->buildInfo->isDebugBuild();
+
+    for (UTsize i = 0; i < cunit->classDecls.size(); i++)
+    {
+        ClassDeclaration *cls = cunit->classDecls.at(i);
+
+        for (UTsize j = 0; j < cls->varDecls.size(); j++)
+        {
+            VariableDeclaration *vd = cls->varDecls.at(j);
+
+            if (!vd->memberInfo)
+            {
+                continue;
+            }
+
+            ConstantField **entry = constants.get(vd->memberInfo);
+
+            if (entry)
+            {
+                resolve(*entry);
+            }
+        }
+    }
+}
+
+
+Expression *OptimizationVisitor::getConstantValue(FieldInfo *field)
+{
+    if (writtenConstants.find(field) != UT_NPOS)
+    {
+        return NULL;
+    }
+
+    ConstantField **entry = constants.get(field);
+
+    if (!entry)
+    {
+        return NULL;
+    }
+
+    resolve(*entry);
+
+    return (*entry)->value;
+}
+
+
+void OptimizationVisitor::optimize(CompilationUnit *cunit)
+{
+    this->cunit = cunit;
+
+    debugBuild = cunit->buildInfo->isDebugBuild();
+
+    TraversalVisitor::visit(cunit);
+}
+
+
+Expression *OptimizationVisitor::getConstantFromMetaInfo(FieldInfo *field)
+{
+    MetaInfo *meta = field->getMetaInfo("ConstValue");
+
+    if (!meta)
+    {
+        return NULL;
+    }
+
+    const char *value;
+
+    if ((value = meta->getAttribute("Number")) != NULL)
+    {
+        return new NumberLiteral(strtod(value, NULL));
+    }
+
+    if ((value = meta->getAttribute("String")) != NULL)
+    {
+        return new StringLiteral(value);
+    }
+
+    if ((value = meta->getAttribute("Boolean")) != NULL)
+    {
+        return new BooleanLiteral(!strcmp(value, "true"));
+    }
+
+    return NULL;
+}
+
+
+void OptimizationVisitor::resolve(ConstantField *constant)
+{
+    if (constant->state != CONSTANT_UNRESOLVED)
+    {
+        return;
+    }
+
+    // reduce the initializer, which may reference other constants
+    constant->state = CONSTANT_RESOLVING;
+
+    CompilationUnit  *oldUnit   = cunit;
+    ClassDeclaration *oldClass  = curClass;
+    FunctionLiteral  *oldMethod = curMethod;
+    int              oldLine    = lineNumber;
+
+    VariableDeclaration *vd = constant->varDecl;
+
+    cunit      = constant->cunit;
+    curClass   = vd->classDecl;
+    curMethod  = NULL;
+    lineNumber = vd->lineNumber;
+
+    vd->initializer = visitExpression(vd->initializer);
+
+    cunit      = oldUnit;
+    curClass   = oldClass;
+    curMethod  = oldMethod;
+    lineNumber = oldLine;
+
+    // a const which is assigned to elsewhere isn't propagated
+    if (isConstantLiteral(vd->initializer) && (vd->initializer->type == vd->memberInfo->getType()) &&
+        (writtenConstants.find((FieldInfo *)vd->memberInfo) == UT_NPOS))
+    {
+        constant->value   = vd->initializer;
+        vd->constantValue = true;
+    }
+
+    constant->state = CONSTANT_RESOLVED;
+}
+
+
+Expression *OptimizationVisitor::resolveConstant(FieldInfo *field, Expression *site)
+{
+    if (!field->isStatic() || !field->isConst())
+    {
+        return NULL;
+    }
+
+    if (writtenConstants.find(field) != UT_NPOS)
+    {
+        return NULL;
+    }
+
+    ConstantField **entry = constants.get(field);
+
+    if (entry)
+    {
+        ConstantField *constant = *entry;
+
+        resolve(constant);
+
+        // a circular reference is left to be resolved at runtime
+        if ((constant->state != CONSTANT_RESOLVED) || !constant->value)
+        {
+            return NULL;
+        }
+
+        return createLiteral(constant->value, field->getType(), site->lineNumber);
+    }
+
+    // declared in an imported assembly
+    Expression *value = getConstantFromMetaInfo(field);
+
+    if (!value)
+    {
+        return NULL;
+    }
+
+    value->type       = field->getType();
+    value->lineNumber = site->lineNumber;
+
+    if (!isConstantLiteral(value))
+    {
+        delete value;
+        return NULL;
+    }
+
+    return value;
+}
+
+
+Expression *OptimizationVisitor::visitLValue(Expression *expression)
+{
+    if (expression->astType == AST_IDENTIFIER)
+    {
+        return expression;
+    }
+
+    if (expression->astType == AST_PROPERTYEXPRESSION)
+    {
+        PropertyExpression *p = (PropertyExpression *)expression;
+
+        p->leftExpression = visitExpression(p->leftExpression);
+
+        if (p->arrayAccess)
+        {
+            p->rightExpression = visitExpression(p->rightExpression);
+        }
+
+        return p;
+    }
+
+    return visitExpression(expression);
+}
+
+
+bool OptimizationVisitor::isRemovable(Statement *statement)
+{
+    if (!statement)
+    {
+        return true;
+    }
+
+    DeadCodeScanVisitor scan;
+    scan.visitStatement(statement);
+
+    return isRemovable(scan);
+}
+
+
+bool OptimizationVisitor::isRemovable(Expression *expression)
+{
+    DeadCodeScanVisitor scan;
+    scan.visitExpression(expression);
+
+    return isRemovable(scan);
+}
+
+
+bool OptimizationVisitor::isRemovable(DeadCodeScanVisitor& scan)
+{
+    if (scan.hasFunction)
+    {
+        return false;
+    }
+
+    if (!scan.declarations.size())
+    {
+        return true;
+    }
+
+    // locals are hoisted to function scope, so we may only remove the
+    // declaration if there are no references outside of the removed code
+    if (!curMethod)
+    {
+        return false;
+    }
+
+    DeadCodeScanVisitor method;
+    method.visitStatementArray(curMethod->functions);
+    method.visitStatementArray(curMethod->statements);
+
+    for (UTsize i = 0; i < scan.declarations.size(); i++)
+    {
+        VariableDeclaration *vd = scan.declarations.at(i);
+
+        if (scan.getReferences(vd) != method.getReferences(vd))
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+
+bool OptimizationVisitor::isDirectCall(CallExpression *call)
+{
+    // debug builds keep calls going through the bound method so that
+    // runtime errors report the method being called
+    if (debugBuild || !call->methodBase || !call->methodBase->isMethod())
+    {
+        return false;
+    }
+
+    MethodInfo *method   = (MethodInfo *)call->methodBase;
+    Type       *declType = method->getDeclaringType();
+
+    if (method->isNative() || declType->isNative() || declType->isInterface() ||
+        declType->isPrimitive() || declType->isDelegate())
+    {
+        return false;
+    }
+
+    // default arguments are inserted by the bound method, so
+    // every parameter must be supplied at the call site
+    int numArguments = call->arguments ? (int)call->arguments->size() : 0;
+    int numRequired  = method->getNumParameters();
+
+    if (method->getVarArgParameter())
+    {
+        // the receiver is passed as the first argument to instance methods
+        // which would offset the variable argument position
+        if (!method->isStatic())
+        {
+            return false;
+        }
+
+        numRequired--;
+    }
+
+    if (numArguments < numRequired)
+    {
+        return false;
+    }
+
+    if (call->function->astType == AST_IDENTIFIER)
+    {
+        Identifier *identifier = (Identifier *)call->function;
+
+        if (identifier->localVarDecl || identifier->superAccess || (identifier->memberInfo != method))
+        {
+            return false;
+        }
+
+        if (!method->isStatic() && !method->isFinal() && !(curClass && curClass->type->isFinal()))
+        {
+            return false;
+        }
+    }
+    else if (call->function->astType == AST_PROPERTYEXPRESSION)
+    {
+        PropertyExpression *p = (PropertyExpression *)call->function;
+
+        if (p->arrayAccess)
+        {
+            return false;
+        }
+
+        MemberInfo *memberInfo = p->rightExpression->memberInfo ? p->rightExpression->memberInfo : p->memberInfo;
+
+        if (memberInfo != method)
+        {
+            return false;
+        }
+
+        if (method->isStatic())
+        {
+            // the left hand side is dropped, so must be the type itself
+            Expression *left = p->leftExpression;
+
+            if (!p->staticAccess && !((left->astType == AST_IDENTIFIER) && ((Identifier *)left)->typeExpression))
+            {
+                return false;
+            }
+        }
+        else
+        {
+            Type *receiverType = p->leftExpression->type;
+
+            if (p->staticAccess || !receiverType || receiverType->isNative())
+            {
+                return false;
+            }
+
+            if (!method->isFinal() && !receiverType->isFinal())
+            {
+                return false;
+            }
+        }
+    }
+    else
+    {
+        return false;
+    }
+
+    return true;
+}
+
+
+Statement *OptimizationVisitor::visit(ClassDeclaration *cls)
+{
+    ClassDeclaration *oldClass = curClass;
+
+    curClass = cls;
+
+    Statement *statement = TraversalVisitor::visit(cls);
+
+    curClass = oldClass;
+
+    return statement;
+}
+
+
+Statement *OptimizationVisitor::visit(IfStatement *ifStatement)
+{
+    ifStatement = (IfStatement *)TraversalVisitor::visit(ifStatement);
+
+    if (ifStatement->expression->astType != AST_BOOLEANLITERAL)
+    {
+        return ifStatement;
+    }
+
+    bool      value = ((BooleanLiteral *)ifStatement->expression)->value;
+    Statement *live = value ? ifStatement->trueStatement : ifStatement->falseStatement;
+    Statement *dead = value ? ifStatement->falseStatement : ifStatement->trueStatement;
+
+    if (!isRemovable(dead))
+    {
+        return ifStatement;
+    }
+
+    if (!live)
+    {
+        live             = new EmptyStatement();
+        live->lineNumber = ifStatement->lineNumber;
+    }
+
+    return live;
+}
+
+
+Statement *OptimizationVisitor::visit(WhileStatement *whileStatement)
+{
+    whileStatement = (WhileStatement *)TraversalVisitor::visit(whileStatement);
+
+    if ((whileStatement->expression->astType != AST_BOOLEANLITERAL) ||
+        ((BooleanLiteral *)whileStatement->expression)->value)
+    {
+        return whileStatement;
+    }
+
+    if (!isRemovable(whileStatement->statement))
+    {
+        return whileStatement;
+    }
+
+    Statement *empty = new EmptyStatement();
+    empty->lineNumber = whileStatement->lineNumber;
+
+    return empty;
+}
+
+
+Statement *OptimizationVisitor::visit(ForInStatement *forInStatement)
+{
+    lastVisited = forInStatement;
+
+    // the variable is assigned to, so is not visited
+    forInStatement->expression = visitExpression(forInStatement->expression);
+    forInStatement->statement  = visitStatement(forInStatement->statement);
+
+    return forInStatement;
+}
+
+
+Expression *OptimizationVisitor::visit(FunctionLiteral *literal)
+{
+    FunctionLiteral *oldMethod = curMethod;
+
+    if (literal->classDecl)
+    {
+        curMethod = literal;
+    }
+
+    // default arguments are referenced from the parameter declarations
+    // and need to follow any rewrite of the initializer
+    utArray<Expression *> initializers;
+
+    if (literal->parameters)
+    {
+        for (UTsize i = 0; i < literal->parameters->size(); i++)
+        {
+            initializers.push_back(literal->parameters->at(i)->initializer);
+        }
+    }
+
+    literal = (FunctionLiteral *)TraversalVisitor::visit(literal);
+
+    if (literal->parameters)
+    {
+        for (UTsize i = 0; i < literal->parameters->size(); i++)
+        {
+            Expression *initializer = literal->parameters->at(i)->initializer;
+
+            if ((i < literal->defaultArguments.size()) && literal->defaultArguments[i] &&
+                (literal->defaultArguments[i] == initializers[i]))
+            {
+                literal->defaultArguments[i] = initializer;
+            }
+        }
+    }
+
+    // closures were visited above and are replaced before the function
+    // which encloses them
+    if (!debugBuild)
+    {
+        scalarReplacement.replace(cunit, literal);
+    }
+
+    curMethod = oldMethod;
+
+    return literal;
+}
+
+
+Expression *OptimizationVisitor::visit(VariableDeclaration *declaration)
+{
+    lastVisited = declaration;
+
+    // static consts are reduced on demand as they may be referenced
+    // before their declaration is visited
+    ConstantField **entry = declaration->memberInfo ? constants.get(declaration->memberInfo) : NULL;
+
+    if (entry)
+    {
+        resolve(*entry);
+        return declaration;
+    }
+
+    declaration->initializer = visitExpression(declaration->initializer);
+
+    return declaration;
+}
+
+
+Expression *OptimizationVisitor::visit(Identifier *identifier)
+{
+    lastVisited = identifier;
+
+    if (identifier->assignment || identifier->superAccess || identifier->typeExpression ||
+        identifier->localVarDecl || !identifier->memberInfo || !identifier->memberInfo->isField())
+    {
+        return identifier;
+    }
+
+    Expression *literal = resolveConstant((FieldInfo *)identifier->memberInfo, identifier);
+
+    return literal ? literal : identifier;
+}
+
+
+Expression *OptimizationVisitor::visit(PropertyExpression *expression)
+{
+    lastVisited = expression;
+
+    if (expression->arrayAccess)
+    {
+        return visitBinaryExpression(expression);
+    }
+
+    MemberInfo *memberInfo = expression->rightExpression->memberInfo ? expression->rightExpression->memberInfo : expression->memberInfo;
+
+    Expression *left = expression->leftExpression;
+
+    bool typeAccess = expression->staticAccess ||
+                      ((left->astType == AST_IDENTIFIER) && ((Identifier *)left)->typeExpression);
+
+    if (!expression->assignment && typeAccess && memberInfo && memberInfo->isField())
+    {
+        Expression *literal = resolveConstant((FieldInfo *)memberInfo, expression);
+
+        if (literal)
+        {
+            return literal;
+        }
+    }
+
+    // the right hand side names the member, so is never rewritten
+    expression->leftExpression = visitExpression(expression->leftExpression);
+
+    return expression;
+}
+
+
+Expression *OptimizationVisitor::visit(AssignmentExpression *expression)
+{
+    lastVisited = expression;
+
+    expression->leftExpression  = visitLValue(expression->leftExpression);
+    expression->rightExpression = visitExpression(expression->rightExpression);
+
+    return expression;
+}
+
+
+Expression *OptimizationVisitor::visit(AssignmentOperatorExpression *expression)
+{
+    lastVisited = expression;
+
+    expression->leftExpression  = visitLValue(expression->leftExpression);
+    expression->rightExpression = visitExpression(expression->rightExpression);
+
+    return expression;
+}
+
+
+Expression *OptimizationVisitor::visit(MultipleAssignmentExpression *expression)
+{
+    lastVisited = expression;
+
+    for (UTsize i = 0; i < expression->left.size(); i++)
+    {
+        expression->left[i] = visitLValue(expression->left[i]);
+    }
+
+    for (UTsize i = 0; i < expression->right.size(); i++)
+    {
+        expression->right[i] = visitExpression(expression->right[i]);
+    }
+
+    return expression;
+}
+
+
+Expression *OptimizationVisitor::visit(IncrementExpression *expression)
+{
+    lastVisited = expression;
+
+    expression->subExpression = visitLValue(expression->subExpression);
+
+    return expression;
+}
+
+
+Expression *OptimizationVisitor::visit(DeleteExpression *expression)
+{
+    lastVisited = expression;
+
+    expression->subExpression = visitLValue(expression->subExpression);
+
+    return expression;
+}
+
+
+Expression *OptimizationVisitor::foldBinaryOperator(BinaryOperatorExpression *expression)
+{
+    Tokens *tok = Tokens::getSingletonPtr();
+
+    Expression *left  = expression->leftExpression;
+    Expression *right = expression->rightExpression;
+
+    if (!isConstantLiteral(left) || !isConstantLiteral(right) || (left->astType != right->astType))
+    {
+        return NULL;
+    }
+
+    // operator overloads
+    const char *opmethod = tok->getOperatorMethodName(expression->op);
+
+    if (opmethod && left->type->findMember(opmethod))
+    {
+        return NULL;
+    }
+
+    Token  *op = expression->op;
+    double number;
+    bool   boolean;
+
+    if (left->astType == AST_NUMBERLITERAL)
+    {
+        double a = ((NumberLiteral *)left)->value;
+        double b = ((NumberLiteral *)right)->value;
+
+        if (isTypeNamed(expression->type, "system.Number"))
+        {
+            if (op == &tok->OPERATOR_PLUS)
+            {
+                number = a + b;
+            }
+            else if (op == &tok->OPERATOR_MINUS)
+            {
+                number = a - b;
+            }
+            else if (op == &tok->OPERATOR_MULTIPLY)
+            {
+                number = a * b;
+            }
+            else if ((op == &tok->OPERATOR_DIVIDE) && (b != 0))
+            {
+                number = a / b;
+            }
+            else if ((op == &tok->OPERATOR_MODULO) && (b != 0))
+            {
+                // matches the VM's modulo
+                number = a - floor(a / b) * b;
+            }
+            else
+            {
+                return NULL;
+            }
+
+            NumberLiteral *literal = new NumberLiteral(number);
+            literal->type       = expression->type;
+            literal->lineNumber = expression->lineNumber;
+            return literal;
+        }
+
+        if (!isTypeNamed(expression->type, "system.Boolean"))
+        {
+            return NULL;
+        }
+
+        if ((op == &tok->OPERATOR_EQUALEQUAL) || (op == &tok->OPERATOR_EQUALEQUALEQUAL))
+        {
+            boolean = a == b;
+        }
+        else if ((op == &tok->OPERATOR_NOTEQUAL) || (op == &tok->OPERATOR_NOTEQUALEQUAL))
+        {
+            boolean = a != b;
+        }
+        else if (op == &tok->OPERATOR_LESSTHAN)
+        {
+            boolean = a < b;
+        }
+        else if (op == &tok->OPERATOR_LESSTHANOREQUAL)
+        {
+            boolean = a <= b;
+        }
+        else if (op == &tok->OPERATOR_GREATERTHAN)
+        {
+            boolean = a > b;
+        }
+        else if (op == &tok->OPERATOR_GREATERTHANOREQUAL)
+        {
+            boolean = a >= b;
+        }
+        else
+        {
+            return NULL;
+        }
+    }
+    else if (left->astType == AST_STRINGLITERAL)
+    {
+        const utString& a = ((StringLiteral *)left)->string;
+        const utString& b = ((StringLiteral *)right)->string;
+
+        if ((op == &tok->OPERATOR_PLUS) && isTypeNamed(expression->type, "system.String"))
+        {
+            StringLiteral *literal = new StringLiteral(a + b);
+            literal->type       = expression->type;
+            literal->lineNumber = expression->lineNumber;
+            return literal;
+        }
+
+        if (!isTypeNamed(expression->type, "system.Boolean"))
+        {
+            return NULL;
+        }
+
+        if ((op == &tok->OPERATOR_EQUALEQUAL) || (op == &tok->OPERATOR_EQUALEQUALEQUAL))
+        {
+            boolean = a == b;
+        }
+        else if ((op == &tok->OPERATOR_NOTEQUAL) || (op == &tok->OPERATOR_NOTEQUALEQUAL))
+        {
+            boolean = a != b;
+        }
+        else
+        {
+            return NULL;
+        }
+    }
+    else
+    {
+        bool a = ((BooleanLiteral *)left)->value;
+        bool b = ((BooleanLiteral *)right)->value;
+
+        if (!isTypeNamed(expression->type, "system.Boolean"))
+        {
+            return NULL;
+        }
+
+        if ((op == &tok->OPERATOR_EQUALEQUAL) || (op == &tok->OPERATOR_EQUALEQUALEQUAL))
+        {
+            boolean = a == b;
+        }
+        else if ((op == &tok->OPERATOR_NOTEQUAL) || (op == &tok->OPERATOR_NOTEQUALEQUAL))
+        {
+            boolean = a != b;
+        }
+        else
+        {
+            return NULL;
+        }
+    }
+
+    BooleanLiteral *literal = new BooleanLiteral(boolean);
+    literal->type       = expression->type;
+    literal->lineNumber = expression->lineNumber;
+    return literal;
+}
+
+
+Expression *OptimizationVisitor::visit(BinaryOperatorExpression *expression)
+{
+    expression = (BinaryOperatorExpression *)TraversalVisitor::visit(expression);
+
+    Expression *folded = foldBinaryOperator(expression);
+
+    return folded ? folded : expression;
+}
+
+
+Expression *OptimizationVisitor::visit(UnaryOperatorExpression *expression)
+{
+    Tokens *tok = Tokens::getSingletonPtr();
+
+    expression = (UnaryOperatorExpression *)TraversalVisitor::visit(expression);
+
+    Expression *sub = expression->subExpression;
+
+    if (!isConstantLiteral(sub) || (sub->type != expression->type))
+    {
+        return expression;
+    }
+
+    if ((expression->op == &tok->OPERATOR_MINUS) && (sub->astType == AST_NUMBERLITERAL))
+    {
+        NumberLiteral *literal = (NumberLiteral *)sub;
+        literal->value = -literal->value;
+        return literal;
+    }
+
+    if ((expression->op == &tok->OPERATOR_LOGICALNOT) && (sub->astType == AST_BOOLEANLITERAL))
+    {
+        BooleanLiteral *literal = (BooleanLiteral *)sub;
+        literal->value = !literal->value;
+        return literal;
+    }
+
+    return expression;
+}
+
+
+Expression *OptimizationVisitor::visit(LogicalAndExpression *expression)
+{
+    expression = (LogicalAndExpression *)TraversalVisitor::visit(expression);
+
+    if ((expression->leftExpression->astType != AST_BOOLEANLITERAL) ||
+        (expression->leftExpression->type != expression->type))
+    {
+        return expression;
+    }
+
+    // true && b is b, false && b is false
+    if (((BooleanLiteral *)expression->leftExpression)->value)
+    {
+        if (expression->rightExpression->type == expression->type)
+        {
+            return expression->rightExpression;
+        }
+    }
+    else if (isRemovable(expression->rightExpression))
+    {
+        return expression->leftExpression;
+    }
+
+    return expression;
+}
+
+
+Expression *OptimizationVisitor::visit(LogicalOrExpression *expression)
+{
+    expression = (LogicalOrExpression *)TraversalVisitor::visit(expression);
+
+    if ((expression->leftExpression->astType != AST_BOOLEANLITERAL) ||
+        (expression->leftExpression->type != expression->type))
+    {
+        return expression;
+    }
+
+    // true || b is true, false || b is b
+    if (((BooleanLiteral *)expression->leftExpression)->value)
+    {
+        if (isRemovable(expression->rightExpression))
+        {
+            return expression->leftExpression;
+        }
+    }
+    else if (expression->rightExpression->type == expression->type)
+    {
+        return expression->rightExpression;
+    }
+
+    return expression;
+}
+
+
+Expression *OptimizationVisitor::visit(ConditionalExpression *expression)
+{
+    expression = (ConditionalExpression *)TraversalVisitor::visit(expression);
+
+    if (expression->expression->astType != AST_BOOLEANLITERAL)
+    {
+        return expression;
+    }
+
+    bool       value = ((BooleanLiteral *)expression->expression)->value;
+    Expression *live = value ? expression->trueExpression : expression->falseExpression;
+    Expression *dead = value ? expression->falseExpression : expression->trueExpression;
+
+    if ((live->type != expression->type) || !isRemovable(dead))
+    {
+        return expression;
+    }
+
+    return live;
+}
+
+
+Expression *OptimizationVisitor::visit(CallExpression *call)
+{
+    call = (CallExpression *)TraversalVisitor::visit(call);
+
+    if (!isDirectCall(call))
+    {
+        return call;
+    }
+
+    call->directCall = true;
+
+    // the direct call indexes the declaring class table by name, so make
+    // sure it is brought into the class environment
+    Type *declType = call->methodBase->getDeclaringType();
+
+    if (curClass && (declType != curClass->type))
+    {
+        utArray<Type *> imports;
+        curClass->type->getImports(imports);
+
+        if (imports.find(declType) == UT_NPOS)
+        {
+            curClass->type->addImport(declType);
+        }
+    }
+
+    return call;
+}
+
+
+Expression *OptimizationVisitor::visit(DictionaryLiteralPair *pair)
+{
+    pair->key   = visitExpression(pair->key);
+    pair->value = visitExpression(pair->value);
+
+    lastVisited = pair;
+
+    return pair;
+}
+}
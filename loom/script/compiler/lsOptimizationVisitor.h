@@ -0,0 +1,190 @@
+/*
+ * ===========================================================================
+ * Loom SDK
+ * Copyright 2011, 2012, 2013
+ * The Game Engine Company, LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ * ===========================================================================
+ */
+
+#ifndef _lsoptimizationvisitor_h
+#define _lsoptimizationvisitor_h
+
+#include "loom/common/utils/utTypes.h"
+#include "loom/common/utils/utString.h"
+
+#include "loom/script/compiler/lsToken.h"
+#include "loom/script/compiler/lsTraversalVisitor.h"
+#include "loom/script/compiler/lsScalarReplacementVisitor.h"
+
+#include "loom/script/runtime/lsLuaState.h"
+#include "loom/script/reflection/lsMemberInfo.h"
+#include "loom/script/reflection/lsFieldInfo.h"
+
+namespace LS {
+class DeadCodeScanVisitor;
+
+/*
+ * Visits the fully typed AST ahead of bytecode generation and:
+ *
+ * - propagates static const values to the sites that reference them,
+ *   across types in the build and across assemblies via ConstValue meta info
+ * - folds operators on literal operands
+ * - removes code guarded by constant conditions
+ * - marks calls to final and static methods as direct calls
+ * - replaces struct locals which don't escape with a local per field, in
+ *   release builds
+ *
+ * The collect pass must be run on every compilation unit of a module
+ * before any of them are optimized, so that propagation does not depend
+ * on source file order.
+ */
+class OptimizationVisitor : public TraversalVisitor {
+private:
+
+    enum ConstantState
+    {
+        CONSTANT_UNRESOLVED,
+        CONSTANT_RESOLVING,
+        CONSTANT_RESOLVED
+    };
+
+    struct ConstantField
+    {
+        VariableDeclaration *varDecl;
+        CompilationUnit     *cunit;
+        ConstantState       state;
+
+        // literal value, or NULL if the initializer didn't reduce to one
+        Expression *value;
+    };
+
+    LSLuaState *vm;
+
+    // static const fields declared in the build
+    utHashTable<utPointerHashKey, ConstantField *> constants;
+
+    // const fields which are assigned to somewhere in the build
+    utHashTable<utPointerHashKey, FieldInfo *> writtenConstants;
+
+    ClassDeclaration *curClass;
+
+    // the method (or property accessor) currently being visited, used to
+    // scope the local variable check when removing dead code
+    FunctionLiteral *curMethod;
+
+    bool debugBuild;
+
+    ScalarReplacementVisitor scalarReplacement;
+
+    void resolve(ConstantField *constant);
+
+    Expression *resolveConstant(FieldInfo *field, Expression *site);
+
+    Expression *getConstantFromMetaInfo(FieldInfo *field);
+
+    Expression *visitLValue(Expression *expression);
+
+    Expression *foldBinaryOperator(BinaryOperatorExpression *expression);
+
+    bool isRemovable(Statement *statement);
+
+    bool isRemovable(Expression *expression);
+
+    bool isRemovable(DeadCodeScanVisitor& scan);
+
+    bool isDirectCall(CallExpression *call);
+
+public:
+
+    OptimizationVisitor(LSLuaState *ls) :
+        TraversalVisitor(), vm(ls), curClass(NULL), curMethod(NULL), debugBuild(true),
+        scalarReplacement(ls)
+    {
+        visitor = this;
+    }
+
+    ~OptimizationVisitor();
+
+    // gather the static const fields and const writes of a compilation unit
+    void collect(CompilationUnit *cunit);
+
+    void optimize(CompilationUnit *cunit);
+
+    // reduce the static consts of a compilation unit without optimizing
+    // its methods, used for compilation units restored from the cache
+    void resolveConstants(CompilationUnit *cunit);
+
+    // the literal value of a static const declared in the build, or NULL
+    // if it can't be propagated
+    Expression *getConstantValue(FieldInfo *field);
+
+    // returns the field if the given assignment target is a const field
+    static FieldInfo *getConstField(Expression *lvalue);
+
+    static bool isConstantLiteral(Expression *expression);
+
+    Statement *visitStatement(Statement *statement)
+    {
+        if (statement != NULL)
+        {
+            lineNumber = statement->lineNumber;
+            statement  = TraversalVisitor::visitStatement(statement);
+        }
+
+        return statement;
+    }
+
+    Statement *visit(ClassDeclaration *cls);
+
+    Statement *visit(IfStatement *ifStatement);
+
+    Statement *visit(WhileStatement *whileStatement);
+
+    Statement *visit(ForInStatement *forInStatement);
+
+    Expression *visit(FunctionLiteral *literal);
+
+    Expression *visit(VariableDeclaration *declaration);
+
+    Expression *visit(Identifier *identifier);
+
+    Expression *visit(PropertyExpression *expression);
+
+    Expression *visit(AssignmentExpression *expression);
+
+    Expression *visit(AssignmentOperatorExpression *expression);
+
+    Expression *visit(MultipleAssignmentExpression *expression);
+
+    Expression *visit(IncrementExpression *expression);
+
+    Expression *visit(DeleteExpression *expression);
+
+    Expression *visit(BinaryOperatorExpression *expression);
+
+    Expression *visit(UnaryOperatorExpression *expression);
+
+    Expression *visit(LogicalAndExpression *expression);
+
+    Expression *visit(LogicalOrExpression *expression);
+
+    Expression *visit(ConditionalExpression *expression);
+
+    Expression *visit(CallExpression *call);
+
+    Expression *visit(DictionaryLiteralPair *pair);
+};
+}
+#endif
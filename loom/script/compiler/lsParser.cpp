@@ -190,6 +190,7 @@ FunctionLiteral *Parser::parseFunctionLiteral(bool nameFlag)
     lit->isStatic    = sawStatic;
     lit->isNative    = findMetaTag(lit->metaTags, "Native") != NULL;
     lit->isOperator  = sawOperator;
+    lit->isFinal     = sawFinal;
 
     if (nextToken == LSTOKEN(KEYWORD_GET))
     {
@@ -0,0 +1,1337 @@
+/*
+ * ===========================================================================
+ * Loom SDK
+ * Copyright 2011, 2012, 2013
+ * The Game Engine Company, LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ * ===========================================================================
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "loom/script/compiler/lsScalarForm.h"
+#include "loom/script/compiler/lsAST.h"
+#include "loom/script/compiler/lsToken.h"
+#include "loom/script/reflection/lsMemberInfo.h"
+#include "loom/script/serialize/lsMemberInfoWriter.h"
+
+namespace LS {
+static const char *kindNames[] = { "init", "mutate", "value", "number" };
+
+static bool isNumberType(const utString& typeString)
+{
+    return typeString == "Number" || typeString == "system.Number";
+}
+
+
+static int findName(utArray<utString>& names, const utString& name)
+{
+    for (UTsize i = 0; i < names.size(); i++)
+    {
+        if (names[i] == name)
+        {
+            return (int)i;
+        }
+    }
+
+    return -1;
+}
+
+
+// the arithmetic operator of a binary or assignment operator token, 0 if
+// it isn't one
+static char getArithmeticOperator(Token *token)
+{
+    Tokens *tok = Tokens::getSingletonPtr();
+
+    if ((token == &tok->OPERATOR_PLUS) || (token == &tok->OPERATOR_PLUSASSIGNMENT))
+    {
+        return '+';
+    }
+
+    if ((token == &tok->OPERATOR_MINUS) || (token == &tok->OPERATOR_MINUSASSIGNMENT))
+    {
+        return '-';
+    }
+
+    if ((token == &tok->OPERATOR_MULTIPLY) || (token == &tok->OPERATOR_MULTIPLYASSIGNMENT))
+    {
+        return '*';
+    }
+
+    if ((token == &tok->OPERATOR_DIVIDE) || (token == &tok->OPERATOR_DIVIDEASSIGNMENT))
+    {
+        return '/';
+    }
+
+    if ((token == &tok->OPERATOR_MODULO) || (token == &tok->OPERATOR_MODULOASSIGNMENT))
+    {
+        return '%';
+    }
+
+    return 0;
+}
+
+
+// a numeric literal, possibly negated, as used by field initializers and
+// default arguments
+static bool getConstant(Expression *expression, double& value)
+{
+    if (!expression)
+    {
+        return false;
+    }
+
+    if (expression->astType == AST_NUMBERLITERAL)
+    {
+        value = ((NumberLiteral *)expression)->value;
+        return true;
+    }
+
+    if (expression->astType == AST_UNARYOPERATOREXPRESSION)
+    {
+        UnaryOperatorExpression *unary = (UnaryOperatorExpression *)expression;
+
+        if ((unary->op == &Tokens::getSingletonPtr()->OPERATOR_MINUS) && getConstant(unary->subExpression, value))
+        {
+            value = -value;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+
+/*
+ * Walks the untyped AST of a struct method, collecting its steps. Names are
+ * resolved the way the type visitor would: locals, then parameters, then
+ * the fields of the struct.
+ */
+class ScalarFormAnalyzer {
+public:
+
+    FunctionLiteral  *function;
+    ClassDeclaration *cls;
+    ScalarForm       *form;
+
+    utArray<utString> fields;
+
+    // the parameters of the form, and whether each is of the struct type
+    utArray<utString> params;
+    utArray<bool>     structParams;
+
+    // the first parameter of the assignment operator stands in for the receiver
+    utString selfAlias;
+
+    // locals by index in order of declaration, and every local of the method
+    utArray<utString> locals;
+    utArray<utString> declared;
+
+    // the static field of the struct type a value form writes its result to
+    utString      result;
+    utArray<bool> resultWritten;
+
+    ScalarFormAnalyzer(FunctionLiteral *function) :
+        function(function), cls(function->classDecl), form(NULL)
+    {
+    }
+
+    ~ScalarFormAnalyzer()
+    {
+        delete form;
+    }
+
+    bool isStructType(const utString& typeString)
+    {
+        return typeString == cls->name->string || (cls->fullPath.size() && (typeString == cls->fullPath));
+    }
+
+    bool isResultField(const utString& name)
+    {
+        if (form->kind != ScalarForm::KIND_VALUE)
+        {
+            return false;
+        }
+
+        if (result.size())
+        {
+            return result == name;
+        }
+
+        for (UTsize i = 0; i < cls->varDecls.size(); i++)
+        {
+            VariableDeclaration *vd = cls->varDecls.at(i);
+
+            if (vd->isStatic && !vd->isNative && (vd->identifier->string == name) && isStructType(vd->typeString))
+            {
+                result = name;
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    // names which refer to a local or parameter rather than a field
+    bool isShadowed(const utString& name)
+    {
+        return findName(declared, name) >= 0 || findName(params, name) >= 0 || name == selfAlias;
+    }
+
+    void addStep(ScalarForm::Node *target, ScalarForm::Node *value)
+    {
+        ScalarForm::Step step;
+
+        step.target = target;
+        step.value  = value;
+        step.dead   = false;
+
+        form->steps.push_back(step);
+    }
+
+    int addLocal(const utString& name)
+    {
+        locals.push_back(name);
+        return form->numLocals++;
+    }
+
+    ScalarForm::Node *field(ScalarForm::NodeType type, const utString& name, int index = 0)
+    {
+        if (findName(fields, name) < 0)
+        {
+            return NULL;
+        }
+
+        ScalarForm::Node *node = new ScalarForm::Node(type);
+        node->field = name;
+        node->index = index;
+
+        return node;
+    }
+
+    ScalarForm::Node *readIdentifier(Identifier *identifier)
+    {
+        const utString& name = identifier->string;
+
+        for (int i = (int)locals.size() - 1; i >= 0; i--)
+        {
+            if (locals[i] == name)
+            {
+                ScalarForm::Node *node = new ScalarForm::Node(ScalarForm::NODE_LOCAL);
+                node->index = i;
+                return node;
+            }
+        }
+
+        // a local which hasn't been assigned yet
+        if (findName(declared, name) >= 0)
+        {
+            return NULL;
+        }
+
+        int param = findName(params, name);
+
+        if (param >= 0)
+        {
+            if (structParams[param])
+            {
+                return NULL;
+            }
+
+            ScalarForm::Node *node = new ScalarForm::Node(ScalarForm::NODE_PARAM);
+            node->index = param;
+            return node;
+        }
+
+        if (function->isStatic || (name == selfAlias))
+        {
+            return NULL;
+        }
+
+        return field(ScalarForm::NODE_SELF_FIELD, name);
+    }
+
+    ScalarForm::Node *readProperty(PropertyExpression *property, bool target)
+    {
+        if (property->arrayAccess || (property->rightExpression->astType != AST_STRINGLITERAL))
+        {
+            return NULL;
+        }
+
+        const utString& name = ((StringLiteral *)property->rightExpression)->string;
+
+        Expression *left = property->leftExpression;
+
+        if (left->astType == AST_THISLITERAL)
+        {
+            return function->isStatic ? NULL : field(ScalarForm::NODE_SELF_FIELD, name);
+        }
+
+        if (left->astType != AST_IDENTIFIER)
+        {
+            return NULL;
+        }
+
+        const utString& object = ((Identifier *)left)->string;
+
+        if (findName(declared, object) >= 0)
+        {
+            return NULL;
+        }
+
+        if (object == selfAlias)
+        {
+            return field(ScalarForm::NODE_SELF_FIELD, name);
+        }
+
+        int param = findName(params, object);
+
+        if (param >= 0)
+        {
+            // struct parameters are read only
+            return structParams[param] && !target ? field(ScalarForm::NODE_PARAM_FIELD, name, param) : NULL;
+        }
+
+        if (isResultField(object))
+        {
+            int fieldIndex = findName(fields, name);
+
+            // the static temporary holds whatever was last written to it
+            if ((fieldIndex < 0) || (!target && !resultWritten[fieldIndex]))
+            {
+                return NULL;
+            }
+
+            return field(ScalarForm::NODE_RESULT_FIELD, name);
+        }
+
+        return NULL;
+    }
+
+    ScalarForm::Node *expression(Expression *expression)
+    {
+        switch (expression->astType)
+        {
+        case AST_NUMBERLITERAL:
+           {
+               ScalarForm::Node *node = new ScalarForm::Node(ScalarForm::NODE_NUMBER);
+               node->number = ((NumberLiteral *)expression)->value;
+               return node;
+           }
+
+        case AST_UNARYOPERATOREXPRESSION:
+           {
+               UnaryOperatorExpression *unary = (UnaryOperatorExpression *)expression;
+
+               if (unary->op != &Tokens::getSingletonPtr()->OPERATOR_MINUS)
+               {
+                   return NULL;
+               }
+
+               ScalarForm::Node *operand = this->expression(unary->subExpression);
+
+               if (!operand)
+               {
+                   return NULL;
+               }
+
+               ScalarForm::Node *node = new ScalarForm::Node(ScalarForm::NODE_NEGATE);
+               node->left = operand;
+               return node;
+           }
+
+        case AST_BINARYOPERATOREXPRESSION:
+           {
+               BinaryOperatorExpression *binary = (BinaryOperatorExpression *)expression;
+
+               char op = getArithmeticOperator(binary->op);
+
+               if (!op)
+               {
+                   return NULL;
+               }
+
+               ScalarForm::Node *left = this->expression(binary->leftExpression);
+
+               if (!left)
+               {
+                   return NULL;
+               }
+
+               ScalarForm::Node *right = this->expression(binary->rightExpression);
+
+               if (!right)
+               {
+                   delete left;
+                   return NULL;
+               }
+
+               ScalarForm::Node *node = new ScalarForm::Node(ScalarForm::NODE_BINARY);
+               node->op    = op;
+               node->left  = left;
+               node->right = right;
+               return node;
+           }
+
+        case AST_IDENTIFIER:
+            return readIdentifier((Identifier *)expression);
+
+        case AST_PROPERTYEXPRESSION:
+            return readProperty((PropertyExpression *)expression, false);
+
+        default:
+            return NULL;
+        }
+    }
+
+    ScalarForm::Node *target(Expression *expression)
+    {
+        if (expression->astType == AST_PROPERTYEXPRESSION)
+        {
+            return readProperty((PropertyExpression *)expression, true);
+        }
+
+        if (expression->astType != AST_IDENTIFIER)
+        {
+            return NULL;
+        }
+
+        const utString& name = ((Identifier *)expression)->string;
+
+        for (int i = (int)locals.size() - 1; i >= 0; i--)
+        {
+            if (locals[i] == name)
+            {
+                ScalarForm::Node *node = new ScalarForm::Node(ScalarForm::NODE_LOCAL);
+                node->index = i;
+                return node;
+            }
+        }
+
+        // parameters are read only
+        if (function->isStatic || isShadowed(name))
+        {
+            return NULL;
+        }
+
+        return field(ScalarForm::NODE_SELF_FIELD, name);
+    }
+
+    // the value of the target before the assignment, for compound assignments
+    ScalarForm::Node *readTarget(ScalarForm::Node *target)
+    {
+        if (target->type == ScalarForm::NODE_RESULT_FIELD)
+        {
+            int fieldIndex = findName(fields, target->field);
+
+            if (!resultWritten[fieldIndex])
+            {
+                return NULL;
+            }
+        }
+
+        return ScalarForm::clone(target);
+    }
+
+    bool assign(ScalarForm::Node *target, ScalarForm::Node *value)
+    {
+        if (!target || !value)
+        {
+            delete target;
+            delete value;
+            return false;
+        }
+
+        if (target->type == ScalarForm::NODE_RESULT_FIELD)
+        {
+            resultWritten[findName(fields, target->field)] = true;
+        }
+
+        addStep(target, value);
+        return true;
+    }
+
+    bool expressionStatement(Expression *expression)
+    {
+        if (expression->astType == AST_ASSIGNMENTEXPRESSION)
+        {
+            AssignmentExpression *assignment = (AssignmentExpression *)expression;
+
+            ScalarForm::Node *value = this->expression(assignment->rightExpression);
+
+            return assign(target(assignment->leftExpression), value);
+        }
+
+        if ((expression->astType == AST_ASSIGNMENTOPERATOREXPRESSION) ||
+            (expression->astType == AST_INCREMENTEXPRESSION))
+        {
+            Expression       *lvalue;
+            ScalarForm::Node *operand;
+            char             op;
+
+            if (expression->astType == AST_ASSIGNMENTOPERATOREXPRESSION)
+            {
+                AssignmentOperatorExpression *assignment = (AssignmentOperatorExpression *)expression;
+
+                lvalue  = assignment->leftExpression;
+                op      = getArithmeticOperator(assignment->type);
+                operand = op ? this->expression(assignment->rightExpression) : NULL;
+            }
+            else
+            {
+                IncrementExpression *increment = (IncrementExpression *)expression;
+
+                lvalue  = increment->subExpression;
+                op      = '+';
+                operand = new ScalarForm::Node(ScalarForm::NODE_NUMBER);
+                operand->number = increment->value;
+            }
+
+            ScalarForm::Node *target = operand ? this->target(lvalue) : NULL;
+            ScalarForm::Node *left   = target ? readTarget(target) : NULL;
+
+            if (!left)
+            {
+                delete operand;
+                delete target;
+                return false;
+            }
+
+            ScalarForm::Node *value = new ScalarForm::Node(ScalarForm::NODE_BINARY);
+            value->op    = op;
+            value->left  = left;
+            value->right = operand;
+
+            return assign(target, value);
+        }
+
+        return false;
+    }
+
+    // expands the constructor of the struct into the steps of a value form
+    bool returnNew(NewExpression *expression)
+    {
+        if (result.size() || (expression->function->astType != AST_IDENTIFIER) ||
+            !isStructType(((Identifier *)expression->function)->string) || !cls->constructor)
+        {
+            return false;
+        }
+
+        ScalarForm *init = ScalarForm::analyze(cls->constructor);
+
+        if (!init)
+        {
+            return false;
+        }
+
+        int numArguments = expression->arguments ? (int)expression->arguments->size() : 0;
+        int numParams    = init->getNumParameters();
+
+        if (numArguments > numParams)
+        {
+            delete init;
+            return false;
+        }
+
+        // the arguments are evaluated before the constructor runs
+        int paramBase = form->numLocals;
+
+        for (int i = 0; i < numParams; i++)
+        {
+            ScalarForm::Node *value = NULL;
+
+            if (i < numArguments)
+            {
+                value = this->expression(expression->arguments->at(i));
+            }
+            else if (init->hasDefault[i])
+            {
+                value = new ScalarForm::Node(ScalarForm::NODE_NUMBER);
+                value->number = init->defaults[i];
+            }
+
+            ScalarForm::Node *target = new ScalarForm::Node(ScalarForm::NODE_LOCAL);
+            target->index = addLocal("");
+
+            if (!assign(target, value))
+            {
+                delete init;
+                return false;
+            }
+        }
+
+        int localBase = form->numLocals;
+
+        for (int i = 0; i < init->numLocals; i++)
+        {
+            addLocal("");
+        }
+
+        for (UTsize i = 0; i < init->steps.size(); i++)
+        {
+            addStep(rebase(init->steps[i].target, paramBase, localBase),
+                    rebase(init->steps[i].value, paramBase, localBase));
+        }
+
+        delete init;
+        return true;
+    }
+
+    // maps a constructor node onto the value form, the instance being
+    // constructed is the result and the parameters are locals
+    static ScalarForm::Node *rebase(ScalarForm::Node *node, int paramBase, int localBase)
+    {
+        ScalarForm::Node *copy = ScalarForm::clone(node);
+
+        rebaseNode(copy, paramBase, localBase);
+
+        return copy;
+    }
+
+    static void rebaseNode(ScalarForm::Node *node, int paramBase, int localBase)
+    {
+        if (!node)
+        {
+            return;
+        }
+
+        if (node->type == ScalarForm::NODE_SELF_FIELD)
+        {
+            node->type = ScalarForm::NODE_RESULT_FIELD;
+        }
+        else if (node->type == ScalarForm::NODE_PARAM)
+        {
+            node->type   = ScalarForm::NODE_LOCAL;
+            node->index += paramBase;
+        }
+        else if (node->type == ScalarForm::NODE_LOCAL)
+        {
+            node->index += localBase;
+        }
+
+        rebaseNode(node->left, paramBase, localBase);
+        rebaseNode(node->right, paramBase, localBase);
+    }
+
+    bool returnStatement(ReturnStatement *statement)
+    {
+        utArray<Expression *> *values = statement->result;
+
+        int numValues = values ? (int)values->size() : 0;
+
+        if (selfAlias.size())
+        {
+            return (numValues == 1) && (values->at(0)->astType == AST_IDENTIFIER) &&
+                   (((Identifier *)values->at(0))->string == selfAlias);
+        }
+
+        if ((form->kind == ScalarForm::KIND_INIT) || (form->kind == ScalarForm::KIND_MUTATE))
+        {
+            return numValues == 0;
+        }
+
+        if (numValues != 1)
+        {
+            return false;
+        }
+
+        Expression *value = values->at(0);
+
+        if (form->kind == ScalarForm::KIND_NUMBER)
+        {
+            return assign(new ScalarForm::Node(ScalarForm::NODE_RETURN), expression(value));
+        }
+
+        if (value->astType == AST_NEWEXPRESSION)
+        {
+            return returnNew((NewExpression *)value);
+        }
+
+        if ((value->astType != AST_IDENTIFIER) || !isResultField(((Identifier *)value)->string) ||
+            isShadowed(((Identifier *)value)->string))
+        {
+            return false;
+        }
+
+        for (UTsize i = 0; i < resultWritten.size(); i++)
+        {
+            if (!resultWritten[i])
+            {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    bool statements(utArray<Statement *> *statements)
+    {
+        bool returned = false;
+
+        for (UTsize i = 0; statements && (i < statements->size()); i++)
+        {
+            Statement *statement = statements->at(i);
+
+            if (returned)
+            {
+                return false;
+            }
+
+            if (statement->astType == AST_EMPTYSTATEMENT)
+            {
+                continue;
+            }
+
+            if (statement->astType == AST_RETURNSTATEMENT)
+            {
+                if (!returnStatement((ReturnStatement *)statement))
+                {
+                    return false;
+                }
+
+                returned = true;
+                continue;
+            }
+
+            if (statement->astType == AST_EXPRESSIONSTATEMENT)
+            {
+                if (!expressionStatement(((ExpressionStatement *)statement)->expression))
+                {
+                    return false;
+                }
+
+                continue;
+            }
+
+            if (statement->astType != AST_VARSTATEMENT)
+            {
+                return false;
+            }
+
+            utArray<VariableDeclaration *> *declarations = ((VariableStatement *)statement)->declarations;
+
+            for (UTsize j = 0; j < declarations->size(); j++)
+            {
+                VariableDeclaration *vd = declarations->at(j);
+
+                if ((!vd->assignType && !isNumberType(vd->typeString)) || !vd->initializer)
+                {
+                    return false;
+                }
+
+                ScalarForm::Node *value = expression(vd->initializer);
+
+                if (!value)
+                {
+                    return false;
+                }
+
+                ScalarForm::Node *target = new ScalarForm::Node(ScalarForm::NODE_LOCAL);
+                target->index = addLocal(vd->identifier->string);
+
+                assign(target, value);
+            }
+        }
+
+        // a method with a result must end in a return
+        return returned || ((form->kind != ScalarForm::KIND_VALUE) && (form->kind != ScalarForm::KIND_NUMBER) && !selfAlias.size());
+    }
+
+    void gatherDeclared(utArray<Statement *> *statements)
+    {
+        for (UTsize i = 0; statements && (i < statements->size()); i++)
+        {
+            Statement *statement = statements->at(i);
+
+            if (statement->astType != AST_VARSTATEMENT)
+            {
+                continue;
+            }
+
+            utArray<VariableDeclaration *> *declarations = ((VariableStatement *)statement)->declarations;
+
+            for (UTsize j = 0; j < declarations->size(); j++)
+            {
+                declared.push_back(declarations->at(j)->identifier->string);
+            }
+        }
+    }
+
+    ScalarForm *analyze()
+    {
+        if (!cls || !cls->isStruct || cls->isNative() || function->isNative ||
+            function->isCoroutine || function->numVarArgCalls || (!function->statements && !function->isConstructor))
+        {
+            return NULL;
+        }
+
+        form = new ScalarForm();
+
+        // the fields must all be Numbers initialized to constants
+        utArray<ScalarForm::Node *> initializers;
+
+        for (UTsize i = 0; i < cls->varDecls.size(); i++)
+        {
+            VariableDeclaration *vd = cls->varDecls.at(i);
+
+            if (vd->isStatic)
+            {
+                continue;
+            }
+
+            double value = 0;
+
+            if (vd->isNative || vd->assignType || !isNumberType(vd->typeString) || !getConstant(vd->initializer, value))
+            {
+                for (UTsize j = 0; j < initializers.size(); j++)
+                {
+                    delete initializers[j];
+                }
+
+                return NULL;
+            }
+
+            fields.push_back(vd->identifier->string);
+            resultWritten.push_back(false);
+
+            ScalarForm::Node *node = new ScalarForm::Node(ScalarForm::NODE_NUMBER);
+            node->number = value;
+            initializers.push_back(node);
+        }
+
+        bool assignment = ScalarForm::isAssignmentOperator(function->name->string.c_str());
+
+        utString returnType = function->retType ? function->retType->string : utString();
+
+        if (function->isConstructor)
+        {
+            form->kind = ScalarForm::KIND_INIT;
+        }
+        else if (assignment)
+        {
+            form->kind = ScalarForm::KIND_MUTATE;
+        }
+        else if (!returnType.size() || (returnType == "Void") || (returnType == "void"))
+        {
+            form->kind = ScalarForm::KIND_MUTATE;
+        }
+        else if (isNumberType(returnType))
+        {
+            form->kind = ScalarForm::KIND_NUMBER;
+        }
+        else if (isStructType(returnType))
+        {
+            form->kind = ScalarForm::KIND_VALUE;
+        }
+
+        bool valid = fields.size() && !function->isSetter && (form->kind != ScalarForm::KIND_INIT || !function->isStatic) &&
+                     (function->isConstructor || (form->kind != ScalarForm::KIND_INIT));
+
+        // a static method can only mutate its first parameter as the assignment operator
+        if ((form->kind == ScalarForm::KIND_MUTATE) && (assignment != function->isStatic))
+        {
+            valid = false;
+        }
+
+        int numParams = function->parameters ? (int)function->parameters->size() : 0;
+
+        if (assignment && ((numParams != 2) || !isStructType(returnType)))
+        {
+            valid = false;
+        }
+
+        for (int i = 0; valid && (i < numParams); i++)
+        {
+            VariableDeclaration *vd = function->parameters->at(i);
+
+            bool structParam = isStructType(vd->typeString);
+
+            if (vd->isVarArg || (!structParam && !isNumberType(vd->typeString)) ||
+                (structParam && (form->kind == ScalarForm::KIND_INIT)))
+            {
+                valid = false;
+                break;
+            }
+
+            if (assignment && (i == 0))
+            {
+                selfAlias = vd->identifier->string;
+                continue;
+            }
+
+            double value     = 0;
+            bool   hasDefault = false;
+
+            if ((i < (int)function->defaultArguments.size()) && function->defaultArguments[i])
+            {
+                if (structParam || !getConstant(function->defaultArguments[i], value))
+                {
+                    valid = false;
+                    break;
+                }
+
+                hasDefault = true;
+            }
+
+            params.push_back(vd->identifier->string);
+            structParams.push_back(structParam);
+            form->hasDefault.push_back(hasDefault);
+            form->defaults.push_back(value);
+        }
+
+        if (valid && (form->kind == ScalarForm::KIND_INIT))
+        {
+            for (UTsize i = 0; i < initializers.size(); i++)
+            {
+                addStep(field(ScalarForm::NODE_SELF_FIELD, fields[i]), initializers[i]);
+            }
+
+            initializers.clear();
+        }
+
+        for (UTsize i = 0; i < initializers.size(); i++)
+        {
+            delete initializers[i];
+        }
+
+        if (!valid)
+        {
+            return NULL;
+        }
+
+        gatherDeclared(function->statements);
+
+        if (!statements(function->statements))
+        {
+            return NULL;
+        }
+
+        form->findDeadSteps();
+
+        ScalarForm *analyzed = form;
+        form = NULL;
+
+        return analyzed;
+    }
+};
+
+ScalarForm::~ScalarForm()
+{
+    for (UTsize i = 0; i < steps.size(); i++)
+    {
+        delete steps[i].target;
+        delete steps[i].value;
+    }
+}
+
+
+ScalarForm *ScalarForm::analyze(FunctionLiteral *function)
+{
+    ScalarFormAnalyzer analyzer(function);
+
+    return analyzer.analyze();
+}
+
+
+bool ScalarForm::isAssignmentOperator(const char *name)
+{
+    return !strcmp(name, "__op_assignment");
+}
+
+
+bool ScalarForm::reads(Node *node, Node *target)
+{
+    if (!node)
+    {
+        return false;
+    }
+
+    if ((node->type == target->type) && (node->index == target->index) && (node->field == target->field))
+    {
+        return true;
+    }
+
+    return reads(node->left, target) || reads(node->right, target);
+}
+
+
+void ScalarForm::findDeadSteps()
+{
+    for (UTsize i = 0; i < steps.size(); i++)
+    {
+        Node *target = steps[i].target;
+
+        if ((target->type == NODE_RETURN) ||
+            ((target->type == NODE_SELF_FIELD) && (kind != KIND_INIT)))
+        {
+            continue;
+        }
+
+        for (UTsize j = i + 1; j < steps.size(); j++)
+        {
+            if (reads(steps[j].value, target))
+            {
+                break;
+            }
+
+            if ((steps[j].target->type == target->type) && (steps[j].target->index == target->index) &&
+                (steps[j].target->field == target->field))
+            {
+                steps[i].dead = true;
+                break;
+            }
+        }
+    }
+}
+
+
+ScalarForm::Node *ScalarForm::clone(Node *node)
+{
+    if (!node)
+    {
+        return NULL;
+    }
+
+    Node *copy = new Node(node->type);
+
+    copy->number     = node->number;
+    copy->index      = node->index;
+    copy->field      = node->field;
+    copy->fieldIndex = node->fieldIndex;
+    copy->op         = node->op;
+    copy->left       = clone(node->left);
+    copy->right      = clone(node->right);
+
+    return copy;
+}
+
+
+utString ScalarForm::encode(Node *node)
+{
+    char buffer[64];
+
+    switch (node->type)
+    {
+    case NODE_NUMBER:
+        snprintf(buffer, sizeof(buffer), "#%.17g", node->number);
+        return buffer;
+
+    case NODE_PARAM:
+        snprintf(buffer, sizeof(buffer), "$%d", node->index);
+        return buffer;
+
+    case NODE_PARAM_FIELD:
+        snprintf(buffer, sizeof(buffer), "$%d.", node->index);
+        return utString(buffer) + node->field;
+
+    case NODE_SELF_FIELD:
+        return utString(".") + node->field;
+
+    case NODE_RESULT_FIELD:
+        return utString(">") + node->field;
+
+    case NODE_LOCAL:
+        snprintf(buffer, sizeof(buffer), "@%d", node->index);
+        return buffer;
+
+    case NODE_RETURN:
+        return "^";
+
+    case NODE_NEGATE:
+        return utString("~ ") + encode(node->left);
+
+    case NODE_BINARY:
+        buffer[0] = node->op;
+        buffer[1] = ' ';
+        buffer[2] = 0;
+        return utString(buffer) + encode(node->left) + " " + encode(node->right);
+    }
+
+    return "";
+}
+
+
+ScalarForm::Node *ScalarForm::decode(utArray<utString>& tokens, UTsize& position)
+{
+    if (position >= tokens.size())
+    {
+        return NULL;
+    }
+
+    const char *token = tokens[position++].c_str();
+
+    Node *node = NULL;
+
+    switch (token[0])
+    {
+    case '#':
+        node         = new Node(NODE_NUMBER);
+        node->number = strtod(token + 1, NULL);
+        return node;
+
+    case '$':
+       {
+           const char *dot = strchr(token, '.');
+
+           node        = new Node(dot ? NODE_PARAM_FIELD : NODE_PARAM);
+           node->index = atoi(token + 1);
+
+           if (dot)
+           {
+               node->field = dot + 1;
+           }
+
+           return node;
+       }
+
+    case '.':
+        node        = new Node(NODE_SELF_FIELD);
+        node->field = token + 1;
+        return node;
+
+    case '>':
+        node        = new Node(NODE_RESULT_FIELD);
+        node->field = token + 1;
+        return node;
+
+    case '@':
+        node        = new Node(NODE_LOCAL);
+        node->index = atoi(token + 1);
+        return node;
+
+    case '^':
+        return new Node(NODE_RETURN);
+
+    case '~':
+        node       = new Node(NODE_NEGATE);
+        node->left = decode(tokens, position);
+
+        if (!node->left)
+        {
+            delete node;
+            return NULL;
+        }
+
+        return node;
+    }
+
+    if (!strchr("+-*/%", token[0]) || token[1])
+    {
+        return NULL;
+    }
+
+    node        = new Node(NODE_BINARY);
+    node->op    = token[0];
+    node->left  = decode(tokens, position);
+    node->right = node->left ? decode(tokens, position) : NULL;
+
+    if (!node->right)
+    {
+        delete node;
+        return NULL;
+    }
+
+    return node;
+}
+
+
+static void split(const utString& string, char separator, utArray<utString>& parts)
+{
+    const char *s = string.c_str();
+
+    while (*s)
+    {
+        const char *end = strchr(s, separator);
+
+        if (!end)
+        {
+            end = s + strlen(s);
+        }
+
+        if (end != s)
+        {
+            parts.push_back(string.substr((UTsize)(s - string.c_str()), (UTsize)(end - s)));
+        }
+
+        s = *end ? end + 1 : end;
+    }
+}
+
+
+static bool isValidNode(ScalarForm *form, ScalarForm::Node *node, bool target)
+{
+    switch (node->type)
+    {
+    case ScalarForm::NODE_PARAM:
+    case ScalarForm::NODE_PARAM_FIELD:
+        return !target && (node->index >= 0) && (node->index < form->getNumParameters());
+
+    case ScalarForm::NODE_LOCAL:
+        return (node->index >= 0) && (node->index < form->numLocals);
+
+    case ScalarForm::NODE_RESULT_FIELD:
+        return form->kind == ScalarForm::KIND_VALUE;
+
+    case ScalarForm::NODE_RETURN:
+        return target && (form->kind == ScalarForm::KIND_NUMBER);
+
+    case ScalarForm::NODE_SELF_FIELD:
+        return true;
+
+    case ScalarForm::NODE_NUMBER:
+        return !target;
+
+    case ScalarForm::NODE_NEGATE:
+    case ScalarForm::NODE_BINARY:
+        return !target && isValidNode(form, node->left, false) && (!node->right || isValidNode(form, node->right, false));
+    }
+
+    return false;
+}
+
+
+ScalarForm *ScalarForm::read(MetaInfo *meta)
+{
+    const char *kindName = meta ? meta->getAttribute("kind") : NULL;
+    const char *params   = meta ? meta->getAttribute("params") : NULL;
+    const char *locals   = meta ? meta->getAttribute("locals") : NULL;
+    const char *defaults = meta ? meta->getAttribute("defaults") : NULL;
+    const char *body     = meta ? meta->getAttribute("body") : NULL;
+
+    if (!kindName || !params || !locals || !defaults || !body)
+    {
+        return NULL;
+    }
+
+    ScalarForm *form = new ScalarForm();
+
+    bool valid = false;
+
+    for (int i = KIND_INIT; i <= KIND_NUMBER; i++)
+    {
+        if (!strcmp(kindName, kindNames[i]))
+        {
+            form->kind = (Kind)i;
+            valid      = true;
+        }
+    }
+
+    form->numLocals = atoi(locals);
+
+    utArray<utString> tokens;
+    split(defaults, ' ', tokens);
+
+    if (!valid || (tokens.size() != (UTsize)atoi(params)))
+    {
+        delete form;
+        return NULL;
+    }
+
+    for (UTsize i = 0; i < tokens.size(); i++)
+    {
+        bool hasDefault = tokens[i].c_str()[0] == '#';
+
+        form->hasDefault.push_back(hasDefault);
+        form->defaults.push_back(hasDefault ? strtod(tokens[i].c_str() + 1, NULL) : 0);
+    }
+
+    utArray<utString> steps;
+    split(body, ';', steps);
+
+    for (UTsize i = 0; i < steps.size(); i++)
+    {
+        tokens.clear();
+        split(steps[i], ' ', tokens);
+
+        UTsize position = 0;
+
+        Step step;
+        step.dead   = false;
+        step.target = decode(tokens, position);
+        step.value  = step.target ? decode(tokens, position) : NULL;
+
+        if (!step.value || (position != tokens.size()) || !isValidNode(form, step.target, true) ||
+            !isValidNode(form, step.value, false))
+        {
+            delete step.target;
+            delete step.value;
+            delete form;
+            return NULL;
+        }
+
+        form->steps.push_back(step);
+    }
+
+    form->findDeadSteps();
+
+    return form;
+}
+
+
+void ScalarForm::write(MemberInfoWriter *writer)
+{
+    utString body;
+
+    for (UTsize i = 0; i < steps.size(); i++)
+    {
+        if (i)
+        {
+            body += ";";
+        }
+
+        body += encode(steps[i].target);
+        body += " ";
+        body += encode(steps[i].value);
+    }
+
+    utString defaultValues;
+
+    for (UTsize i = 0; i < hasDefault.size(); i++)
+    {
+        char buffer[64];
+
+        if (hasDefault[i])
+        {
+            snprintf(buffer, sizeof(buffer), "#%.17g", defaults[i]);
+        }
+        else
+        {
+            snprintf(buffer, sizeof(buffer), "-");
+        }
+
+        if (i)
+        {
+            defaultValues += " ";
+        }
+
+        defaultValues += buffer;
+    }
+
+    char params[32];
+    snprintf(params, sizeof(params), "%d", getNumParameters());
+
+    char locals[32];
+    snprintf(locals, sizeof(locals), "%d", numLocals);
+
+    MetaInfo *meta = writer->addUniqueMetaInfo("ScalarForm", "kind", kindNames[kind]);
+
+    meta->keys.insert("params", params);
+    meta->keys.insert("locals", locals);
+    meta->keys.insert("defaults", defaultValues);
+    meta->keys.insert("body", body);
+}
+}
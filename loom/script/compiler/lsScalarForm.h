@@ -0,0 +1,178 @@
+/*
+ * ===========================================================================
+ * Loom SDK
+ * Copyright 2011, 2012, 2013
+ * The Game Engine Company, LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ * ===========================================================================
+ */
+
+#ifndef _lsscalarform_h
+#define _lsscalarform_h
+
+#include "loom/common/utils/utTypes.h"
+#include "loom/common/utils/utString.h"
+
+namespace LS {
+class FunctionLiteral;
+class MemberInfoWriter;
+class MetaInfo;
+
+/*
+ * The effect of a struct method written as Number arithmetic on the fields
+ * of the struct and the method's parameters, for structs whose fields are
+ * all Numbers.
+ *
+ * - init: a constructor, the field initializers followed by the body
+ * - mutate: an instance method which updates the fields of the receiver,
+ *   or the assignment operator, whose first parameter is the receiver
+ * - value: a method returning a new value of the struct, either through
+ *   a static temporary or by returning a new instance
+ * - number: a method or getter returning a Number
+ *
+ * Forms are taken from the method source by the type builder and are
+ * serialized as ScalarForm meta info, so they are available for structs
+ * declared in other assemblies. The optimizer uses them to expand struct
+ * methods inline on scalar replaced locals.
+ *
+ * The body is a list of steps separated by ';', each step is a target
+ * followed by an expression in prefix notation, the tokens separated by
+ * spaces:
+ *
+ *     .f    field f of the receiver
+ *     >f    field f of the result of a value form
+ *     @n    local n
+ *     ^     the result of a number form (target only)
+ *     $n    Number parameter n
+ *     $n.f  field f of struct parameter n
+ *     #v    the Number v
+ *     ~ a   negation
+ *     + a b (and - * / %) arithmetic
+ */
+class ScalarForm {
+public:
+
+    enum Kind
+    {
+        KIND_INIT,
+        KIND_MUTATE,
+        KIND_VALUE,
+        KIND_NUMBER
+    };
+
+    enum NodeType
+    {
+        NODE_NUMBER,
+        NODE_PARAM,
+        NODE_PARAM_FIELD,
+        NODE_SELF_FIELD,
+        NODE_RESULT_FIELD,
+        NODE_LOCAL,
+        NODE_RETURN,
+        NODE_NEGATE,
+        NODE_BINARY
+    };
+
+    struct Node
+    {
+        NodeType type;
+
+        double number;
+
+        // the parameter or local index
+        int index;
+
+        utString field;
+
+        // the field's position in the struct, resolved by the optimizer
+        int fieldIndex;
+
+        // arithmetic operator
+        char op;
+
+        Node *left;
+        Node *right;
+
+        Node(NodeType type) :
+            type(type), number(0), index(0), fieldIndex(-1), op(0), left(NULL), right(NULL)
+        {
+        }
+
+        ~Node()
+        {
+            delete left;
+            delete right;
+        }
+    };
+
+    struct Step
+    {
+        // a field, local or return node
+        Node *target;
+        Node *value;
+
+        // the target is written again before it is read
+        bool dead;
+    };
+
+    Kind kind;
+
+    utArray<Step> steps;
+
+    int numLocals;
+
+    // per parameter, whether it has a Number default argument and its value
+    utArray<bool>   hasDefault;
+    utArray<double> defaults;
+
+    ScalarForm() : kind(KIND_INIT), numLocals(0)
+    {
+    }
+
+    ~ScalarForm();
+
+    // the form of a method, or NULL if the method can't be expressed as one
+    static ScalarForm *analyze(FunctionLiteral *function);
+
+    // reads a form from ScalarForm meta info, NULL if it is malformed
+    static ScalarForm *read(MetaInfo *meta);
+
+    void write(MemberInfoWriter *writer);
+
+    // whether the method is the assignment operator, which takes the
+    // receiver as its first parameter
+    static bool isAssignmentOperator(const char *name);
+
+    // the number of the method's parameters which the form takes
+    int getNumParameters()
+    {
+        return (int)hasDefault.size();
+    }
+
+    // whether the expression reads the local or field the target writes
+    static bool reads(Node *node, Node *target);
+
+    // marks the steps whose target is written again before it is read, the
+    // fields of the receiver are only considered for constructors as the
+    // receiver of other methods may alias a struct parameter
+    void findDeadSteps();
+
+    static Node *clone(Node *node);
+
+    static utString encode(Node *node);
+
+    static Node *decode(utArray<utString>& tokens, UTsize& position);
+};
+}
+#endif
@@ -0,0 +1,1914 @@
+/*
+ * ===========================================================================
+ * Loom SDK
+ * Copyright 2011, 2012, 2013
+ * The Game Engine Company, LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ * ===========================================================================
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "loom/common/core/assert.h"
+#include "loom/script/compiler/lsScalarReplacementVisitor.h"
+#include "loom/script/compiler/lsToken.h"
+#include "loom/script/reflection/lsMethodInfo.h"
+#include "loom/script/reflection/lsPropertyInfo.h"
+
+namespace LS {
+// functions are limited to 200 locals, leave room for the ones the
+// bytecode generator declares
+#define SCALAR_REPLACEMENT_MAX_LOCALS    180
+
+// the largest expression a number form is inlined as
+#define SCALAR_REPLACEMENT_MAX_INLINE    48
+
+/*
+ * Finds references to a candidate, or to any candidate, in an expression
+ */
+class CandidateReferenceVisitor : public TraversalVisitor {
+    ScalarReplacementVisitor            *owner;
+    ScalarReplacementVisitor::Candidate *candidate;
+
+public:
+
+    bool found;
+
+    CandidateReferenceVisitor(ScalarReplacementVisitor *owner, ScalarReplacementVisitor::Candidate *candidate) :
+        TraversalVisitor(), owner(owner), candidate(candidate), found(false)
+    {
+        visitor = this;
+    }
+
+    Expression *visit(Identifier *identifier)
+    {
+        ScalarReplacementVisitor::Candidate *referenced = owner->getCandidate(identifier);
+
+        if (referenced && (!candidate || (referenced == candidate)))
+        {
+            found = true;
+        }
+
+        return identifier;
+    }
+};
+
+static bool resolveFields(ScalarForm::Node *node, utArray<FieldInfo *>& fields)
+{
+    if (!node)
+    {
+        return true;
+    }
+
+    if ((node->type == ScalarForm::NODE_SELF_FIELD) || (node->type == ScalarForm::NODE_PARAM_FIELD) ||
+        (node->type == ScalarForm::NODE_RESULT_FIELD))
+    {
+        node->fieldIndex = -1;
+
+        for (UTsize i = 0; i < fields.size(); i++)
+        {
+            if (!strcmp(fields[i]->getName(), node->field.c_str()))
+            {
+                node->fieldIndex = (int)i;
+                break;
+            }
+        }
+
+        if (node->fieldIndex < 0)
+        {
+            return false;
+        }
+    }
+
+    return resolveFields(node->left, fields) && resolveFields(node->right, fields);
+}
+
+
+static Token *getOperatorToken(char op)
+{
+    Tokens *tok = Tokens::getSingletonPtr();
+
+    switch (op)
+    {
+    case '+':
+        return &tok->OPERATOR_PLUS;
+
+    case '-':
+        return &tok->OPERATOR_MINUS;
+
+    case '*':
+        return &tok->OPERATOR_MULTIPLY;
+
+    case '/':
+        return &tok->OPERATOR_DIVIDE;
+
+    case '%':
+        return &tok->OPERATOR_MODULO;
+    }
+
+    lmAssert(0, "unknown ScalarForm operator %c", op);
+    return NULL;
+}
+
+
+ScalarReplacementVisitor::ScalarReplacementVisitor(LSLuaState *ls) :
+    TraversalVisitor(), vm(ls), numberType(NULL), objectType(NULL), function(NULL),
+    rewriting(false), escapeFound(false), nested(0), numTemps(0), numRefs(0), maxTemps(0), maxRefs(0)
+{
+    visitor = this;
+}
+
+
+ScalarReplacementVisitor::~ScalarReplacementVisitor()
+{
+    clear();
+
+    for (UTsize i = 0; i < forms.size(); i++)
+    {
+        Form *form = forms.at(i);
+
+        if (form)
+        {
+            delete form->form;
+            delete form;
+        }
+    }
+
+    for (UTsize i = 0; i < structs.size(); i++)
+    {
+        delete structs.at(i);
+    }
+}
+
+
+ScalarReplacementVisitor::StructInfo *ScalarReplacementVisitor::getStructInfo(Type *type)
+{
+    if (!type)
+    {
+        return NULL;
+    }
+
+    StructInfo **cached = structs.get(type);
+
+    if (cached)
+    {
+        return *cached;
+    }
+
+    if (!type->isStruct() || type->isNative())
+    {
+        structs.insert(type, NULL);
+        return NULL;
+    }
+
+    StructInfo *info = new StructInfo;
+
+    info->type           = type;
+    info->init           = NULL;
+    info->assign         = NULL;
+    info->copyAssignment = false;
+    info->valid          = false;
+
+    // the forms of the struct's methods are resolved against its fields
+    structs.insert(type, info);
+
+    for (int i = 0; i < type->getFieldInfoCount(); i++)
+    {
+        FieldInfo *field = type->getFieldInfo(i);
+
+        if (field->isStatic())
+        {
+            continue;
+        }
+
+        if (field->isNative() || (field->getType() != numberType))
+        {
+            info->fields.clear();
+            return info;
+        }
+
+        info->fields.push_back(field);
+    }
+
+    if (!info->fields.size())
+    {
+        return info;
+    }
+
+    MemberInfo *assignment = type->findMember("__op_assignment");
+
+    info->init   = getForm(type->getConstructor());
+    info->assign = assignment && assignment->isMethod() ? getForm((MethodBase *)assignment) : NULL;
+
+    if (!info->init || (info->init->form->kind != ScalarForm::KIND_INIT) ||
+        !info->assign || (info->assign->form->kind != ScalarForm::KIND_MUTATE) ||
+        (info->assign->structParams.size() != 1) || !info->assign->structParams[0])
+    {
+        return info;
+    }
+
+    // the constructor must set every field, as a replaced local has no
+    // instance to hold fields it leaves alone
+    utArray<bool> written;
+    utArray<bool> copied;
+
+    for (UTsize i = 0; i < info->fields.size(); i++)
+    {
+        written.push_back(false);
+        copied.push_back(false);
+    }
+
+    utArray<ScalarForm::Step>& init = info->init->form->steps;
+
+    for (UTsize i = 0; i < init.size(); i++)
+    {
+        if (init[i].target->type == ScalarForm::NODE_SELF_FIELD)
+        {
+            written[init[i].target->fieldIndex] = true;
+        }
+    }
+
+    for (UTsize i = 0; i < written.size(); i++)
+    {
+        if (!written[i])
+        {
+            return info;
+        }
+    }
+
+    // an assignment operator which only copies the fields lets a value be
+    // computed straight into the local it is assigned to
+    bool copy = true;
+
+    utArray<ScalarForm::Step>& assign = info->assign->form->steps;
+
+    for (UTsize i = 0; i < assign.size(); i++)
+    {
+        ScalarForm::Node *target = assign[i].target;
+        ScalarForm::Node *value  = assign[i].value;
+
+        if ((target->type != ScalarForm::NODE_SELF_FIELD) || (value->type != ScalarForm::NODE_PARAM_FIELD) ||
+            (value->index != 0) || (value->fieldIndex != target->fieldIndex) || copied[target->fieldIndex])
+        {
+            copy = false;
+            break;
+        }
+
+        copied[target->fieldIndex] = true;
+    }
+
+    for (UTsize i = 0; copy && i < copied.size(); i++)
+    {
+        copy = copied[i];
+    }
+
+    info->copyAssignment = copy;
+    info->valid          = true;
+
+    return info;
+}
+
+
+ScalarReplacementVisitor::Form *ScalarReplacementVisitor::getForm(MethodBase *method)
+{
+    if (!method)
+    {
+        return NULL;
+    }
+
+    Form **cached = forms.get(method);
+
+    if (cached)
+    {
+        return *cached;
+    }
+
+    MetaInfo   *meta = method->getMetaInfo("ScalarForm");
+    StructInfo *info = meta ? getStructInfo(method->getDeclaringType()) : NULL;
+    ScalarForm *form = info && info->fields.size() ? ScalarForm::read(meta) : NULL;
+
+    bool valid = form != NULL;
+
+    for (UTsize i = 0; valid && i < form->steps.size(); i++)
+    {
+        valid = resolveFields(form->steps[i].target, info->fields) &&
+                resolveFields(form->steps[i].value, info->fields);
+    }
+
+    // the form has to agree with the method's signature, as it may have been
+    // read from an assembly built against another version of the struct
+    bool assignment = ScalarForm::isAssignmentOperator(method->getName());
+    int  offset     = assignment ? 1 : 0;
+
+    utArray<bool> structParams;
+
+    if (valid)
+    {
+        valid = method->getNumParameters() == form->getNumParameters() + offset;
+    }
+
+    if (valid && assignment)
+    {
+        valid = method->getParameter(0)->getParameterType() == info->type;
+    }
+
+    for (int i = 0; valid && i < form->getNumParameters(); i++)
+    {
+        Type *type = method->getParameter(i + offset)->getParameterType();
+
+        valid = (type == info->type) || (type == numberType);
+        structParams.push_back(type == info->type);
+    }
+
+    if (valid)
+    {
+        switch (form->kind)
+        {
+        case ScalarForm::KIND_INIT:
+            valid = method->isConstructor();
+            break;
+
+        case ScalarForm::KIND_MUTATE:
+            valid = assignment == method->isStatic();
+            break;
+
+        case ScalarForm::KIND_VALUE:
+            valid = method->isMethod() && (((MethodInfo *)method)->getReturnType() == info->type);
+            break;
+
+        case ScalarForm::KIND_NUMBER:
+            valid = method->isMethod() && (((MethodInfo *)method)->getReturnType() == numberType);
+            break;
+        }
+    }
+
+    Form *result = NULL;
+
+    if (valid)
+    {
+        result = new Form;
+
+        result->form         = form;
+        result->method       = method;
+        result->info         = info;
+        result->structParams = structParams;
+    }
+    else
+    {
+        delete form;
+    }
+
+    forms.insert(method, result);
+
+    return result;
+}
+
+
+ScalarReplacementVisitor::Form *ScalarReplacementVisitor::getValidForm(MethodBase *method)
+{
+    Form *form = getForm(method);
+
+    return form && form->info->valid ? form : NULL;
+}
+
+
+ScalarReplacementVisitor::Form *ScalarReplacementVisitor::getOperatorForm(BinaryOperatorExpression *expression)
+{
+    const char *name = Tokens::getSingletonPtr()->getOperatorMethodName(expression->op);
+    Type       *type = expression->leftExpression->type;
+
+    if (!name || !type)
+    {
+        return NULL;
+    }
+
+    MemberInfo *member = type->findMember(name);
+
+    if (!member || !member->isMethod())
+    {
+        return NULL;
+    }
+
+    Form *form = getValidForm((MethodBase *)member);
+
+    if (!form || (form->form->kind != ScalarForm::KIND_VALUE) || !form->method->isStatic() ||
+        (form->form->getNumParameters() != 2))
+    {
+        return NULL;
+    }
+
+    return form;
+}
+
+
+bool ScalarReplacementVisitor::getCallReceiver(CallExpression *call, Form *form, Expression **receiver)
+{
+    Expression *function = call->function;
+
+    *receiver = NULL;
+
+    if (form->method->isStatic())
+    {
+        if (function->astType == AST_IDENTIFIER)
+        {
+            return function->memberInfo == form->method;
+        }
+
+        if (function->astType != AST_PROPERTYEXPRESSION)
+        {
+            return false;
+        }
+
+        PropertyExpression *p = (PropertyExpression *)function;
+
+        return !p->arrayAccess && p->staticAccess && (p->rightExpression->memberInfo == form->method);
+    }
+
+    if (function->astType != AST_PROPERTYEXPRESSION)
+    {
+        return false;
+    }
+
+    PropertyExpression *p = (PropertyExpression *)function;
+
+    if (p->arrayAccess || p->staticAccess || (p->rightExpression->memberInfo != form->method))
+    {
+        return false;
+    }
+
+    *receiver = p->leftExpression;
+
+    return true;
+}
+
+
+int ScalarReplacementVisitor::getFieldIndex(StructInfo *info, MemberInfo *memberInfo)
+{
+    for (UTsize i = 0; memberInfo && i < info->fields.size(); i++)
+    {
+        if (info->fields[i] == memberInfo)
+        {
+            return (int)i;
+        }
+    }
+
+    return -1;
+}
+
+
+bool ScalarReplacementVisitor::fits(Form *form, utArray<Expression *> *arguments)
+{
+    int numArguments = arguments ? (int)arguments->size() : 0;
+
+    if (numArguments > form->form->getNumParameters())
+    {
+        return false;
+    }
+
+    for (int i = numArguments; i < form->form->getNumParameters(); i++)
+    {
+        if (form->structParams[i] || !form->form->hasDefault[i])
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+
+ScalarReplacementVisitor::Candidate *ScalarReplacementVisitor::getCandidate(Expression *expression)
+{
+    if (!expression || (expression->astType != AST_IDENTIFIER))
+    {
+        return NULL;
+    }
+
+    Identifier *identifier = (Identifier *)expression;
+
+    if (identifier->memberInfo || identifier->typeExpression || identifier->superAccess)
+    {
+        return NULL;
+    }
+
+    Candidate **candidate = candidates.get(utHashedString(identifier->string));
+
+    return candidate && !(*candidate)->escaped ? *candidate : NULL;
+}
+
+
+bool ScalarReplacementVisitor::references(Expression *expression, Candidate *candidate)
+{
+    CandidateReferenceVisitor scan(this, candidate);
+
+    scan.visitExpression(expression);
+
+    return scan.found;
+}
+
+
+void ScalarReplacementVisitor::escape(Candidate *candidate)
+{
+    // the scan settles which locals escape before anything is rewritten, so
+    // this is a bug in the scan, which is reported rather than aborting lsc
+    if (rewriting)
+    {
+        error("Internal Error: struct local escaped while being replaced, compile without --optimize to work around it");
+        return;
+    }
+
+    candidate->escaped = true;
+    escapeFound        = true;
+}
+
+
+void ScalarReplacementVisitor::gatherCandidates()
+{
+    for (UTsize i = 0; i < function->localVariables.size(); i++)
+    {
+        VariableDeclaration *vd   = function->localVariables.at(i);
+        const utString&     name = vd->identifier->string;
+
+        bool parameter = vd->isParameter;
+
+        for (UTsize j = 0; !parameter && function->parameters && j < function->parameters->size(); j++)
+        {
+            parameter = function->parameters->at(j)->identifier->string == name;
+        }
+
+        StructInfo *info = parameter ? NULL : getStructInfo(vd->type);
+
+        if (info && !info->valid)
+        {
+            info = NULL;
+        }
+
+        // locals of the same name share a register
+        Candidate **existing = candidates.get(utHashedString(name));
+
+        if (existing)
+        {
+            if ((*existing)->info != info)
+            {
+                (*existing)->escaped = true;
+            }
+
+            continue;
+        }
+
+        Candidate *candidate = new Candidate;
+
+        candidate->info    = info;
+        candidate->escaped = info == NULL;
+
+        for (UTsize j = 0; info && j < info->fields.size(); j++)
+        {
+            candidate->scalars.push_back("__ls_sr_" + name + "_" + info->fields[j]->getName());
+        }
+
+        candidates.insert(utHashedString(name), candidate);
+    }
+}
+
+
+void ScalarReplacementVisitor::traverse()
+{
+    nested = 0;
+
+    visitStatementArray(function->functions);
+    visitStatementArray(function->statements);
+}
+
+
+void ScalarReplacementVisitor::replace(CompilationUnit *cunit, FunctionLiteral *literal)
+{
+    if (!literal->statements)
+    {
+        return;
+    }
+
+    this->cunit = cunit;
+    function    = literal;
+
+    numberType = vm->getType("system.Number");
+    objectType = vm->getType("system.Object");
+
+    gatherCandidates();
+
+    // an escape found late in the function may change how earlier
+    // statements use other candidates, so scan until nothing new escapes
+    rewriting = false;
+
+    do
+    {
+        escapeFound = false;
+        maxTemps    = 0;
+        maxRefs     = 0;
+
+        traverse();
+    } while (escapeFound);
+
+    int numScalars = 0;
+
+    for (UTsize i = 0; i < candidates.size(); i++)
+    {
+        Candidate *candidate = candidates.at(i);
+
+        if (!candidate->escaped)
+        {
+            numScalars += (int)candidate->scalars.size();
+        }
+    }
+
+    int numLocals = function->numVarArgCalls + 5 + (int)function->childFunctions.size() +
+                    (int)function->localVariables.size() + numScalars + maxTemps + maxRefs;
+
+    if (numScalars && (numLocals <= SCALAR_REPLACEMENT_MAX_LOCALS))
+    {
+        rewriting = true;
+
+        traverse();
+        finish();
+
+        rewriting = false;
+    }
+
+    clear();
+}
+
+
+void ScalarReplacementVisitor::finish()
+{
+    utArray<VariableDeclaration *> locals;
+
+    for (UTsize i = 0; i < function->localVariables.size(); i++)
+    {
+        VariableDeclaration *vd = function->localVariables.at(i);
+
+        Candidate **candidate = candidates.get(utHashedString(vd->identifier->string));
+
+        if (!candidate || (*candidate)->escaped)
+        {
+            locals.push_back(vd);
+        }
+    }
+
+    function->localVariables.clear();
+
+    for (UTsize i = 0; i < locals.size(); i++)
+    {
+        function->localVariables.push_back(locals[i]);
+    }
+
+    // struct locals are created on entry, so their fields start out as
+    // the constructor leaves them rather than 0
+    lineNumber = function->lineNumber;
+
+    beginStatement();
+
+    utArray<Statement *> entry;
+
+    for (UTsize i = 0; i < candidates.size(); i++)
+    {
+        Candidate *candidate = candidates.at(i);
+
+        if (!candidate->escaped)
+        {
+            initialize(candidate, NULL, entry);
+        }
+    }
+
+    bool zero = true;
+
+    for (UTsize i = 0; zero && i < entry.size(); i++)
+    {
+        Expression *value = ((AssignmentExpression *)((ExpressionStatement *)entry[i])->expression)->rightExpression;
+
+        zero = (value->astType == AST_NUMBERLITERAL) && (((NumberLiteral *)value)->value == 0);
+    }
+
+    if (!zero)
+    {
+        function->statements->push_front(rewritten(NULL, entry));
+    }
+
+    for (UTsize i = 0; i < candidates.size(); i++)
+    {
+        Candidate *candidate = candidates.at(i);
+
+        for (UTsize j = 0; !candidate->escaped && j < candidate->scalars.size(); j++)
+        {
+            declare(candidate->scalars[j], numberType);
+        }
+    }
+
+    char name[64];
+
+    for (int i = 0; i < maxTemps; i++)
+    {
+        snprintf(name, sizeof(name), "__ls_srt%d", i);
+        declare(name, numberType);
+    }
+
+    for (int i = 0; i < maxRefs; i++)
+    {
+        snprintf(name, sizeof(name), "__ls_srr%d", i);
+        declare(name, objectType);
+    }
+}
+
+
+void ScalarReplacementVisitor::declare(const utString& name, Type *type)
+{
+    VariableDeclaration *vd = new VariableDeclaration(local(name, type), NULL, false, false, false, false);
+
+    vd->type       = type;
+    vd->typeString = type->getFullName();
+    vd->function   = function;
+    vd->lineNumber = function->lineNumber;
+
+    function->localVariables.push_back(vd);
+}
+
+
+void ScalarReplacementVisitor::clear()
+{
+    beginStatement();
+
+    for (UTsize i = 0; i < candidates.size(); i++)
+    {
+        delete candidates.at(i);
+    }
+
+    candidates.clear();
+
+    function = NULL;
+}
+
+
+void ScalarReplacementVisitor::beginStatement()
+{
+    numTemps = 0;
+    numRefs  = 0;
+
+    for (UTsize i = 0; i < values.size(); i++)
+    {
+        delete values[i];
+    }
+
+    values.clear();
+}
+
+
+utString ScalarReplacementVisitor::newTemp()
+{
+    char name[64];
+
+    snprintf(name, sizeof(name), "__ls_srt%d", numTemps++);
+
+    if (numTemps > maxTemps)
+    {
+        maxTemps = numTemps;
+    }
+
+    return name;
+}
+
+
+utString ScalarReplacementVisitor::newRef()
+{
+    char name[64];
+
+    snprintf(name, sizeof(name), "__ls_srr%d", numRefs++);
+
+    if (numRefs > maxRefs)
+    {
+        maxRefs = numRefs;
+    }
+
+    return name;
+}
+
+
+ScalarReplacementVisitor::StructValue *ScalarReplacementVisitor::newValue()
+{
+    StructValue *value = new StructValue;
+
+    value->candidate = NULL;
+
+    values.push_back(value);
+
+    return value;
+}
+
+
+ScalarReplacementVisitor::StructValue *ScalarReplacementVisitor::candidateValue(Candidate *candidate)
+{
+    StructValue *value = newValue();
+
+    value->candidate = candidate;
+    value->names     = candidate->scalars;
+
+    return value;
+}
+
+
+ScalarReplacementVisitor::StructValue *ScalarReplacementVisitor::tempValue(StructInfo *info)
+{
+    StructValue *value = newValue();
+
+    for (UTsize i = 0; i < info->fields.size(); i++)
+    {
+        value->names.push_back(newTemp());
+    }
+
+    return value;
+}
+
+
+Identifier *ScalarReplacementVisitor::local(const utString& name, Type *type)
+{
+    Identifier *identifier = new Identifier(name);
+
+    identifier->type       = type;
+    identifier->lineNumber = lineNumber;
+
+    return identifier;
+}
+
+
+Expression *ScalarReplacementVisitor::field(StructInfo *info, StructValue *value, int index)
+{
+    if (value->names.size())
+    {
+        return local(value->names[index], numberType);
+    }
+
+    FieldInfo *fieldInfo = info->fields[index];
+
+    StringLiteral *name = new StringLiteral(fieldInfo->getName());
+
+    name->memberInfo = fieldInfo;
+    name->type       = numberType;
+    name->lineNumber = lineNumber;
+
+    PropertyExpression *p = new PropertyExpression(local(value->ref, objectType), name);
+
+    p->memberInfo = fieldInfo;
+    p->type       = numberType;
+    p->lineNumber = lineNumber;
+
+    return p;
+}
+
+
+Expression *ScalarReplacementVisitor::build(ScalarForm::Node *node, Form *form, Context& ctx)
+{
+    Expression *expression = NULL;
+
+    switch (node->type)
+    {
+    case ScalarForm::NODE_NUMBER:
+        expression = new NumberLiteral(node->number);
+        break;
+
+    case ScalarForm::NODE_PARAM:
+       {
+           NumberValue& value = ctx.numberArgs[node->index];
+
+           if (value.literal)
+           {
+               expression = new NumberLiteral(value.number);
+           }
+           else
+           {
+               return local(value.name, numberType);
+           }
+
+           break;
+       }
+
+    case ScalarForm::NODE_PARAM_FIELD:
+        return field(form->info, ctx.structArgs[node->index], node->fieldIndex);
+
+    case ScalarForm::NODE_SELF_FIELD:
+        return field(form->info, ctx.self, node->fieldIndex);
+
+    case ScalarForm::NODE_RESULT_FIELD:
+        return field(form->info, ctx.result, node->fieldIndex);
+
+    case ScalarForm::NODE_LOCAL:
+        return local(ctx.locals[node->index], numberType);
+
+    case ScalarForm::NODE_NEGATE:
+        expression = new UnaryOperatorExpression(build(node->left, form, ctx), &Tokens::getSingletonPtr()->OPERATOR_MINUS);
+        break;
+
+    case ScalarForm::NODE_BINARY:
+        expression = new BinaryOperatorExpression(build(node->left, form, ctx), build(node->right, form, ctx),
+                                                  getOperatorToken(node->op));
+        break;
+
+    default:
+        lmAssert(0, "unexpected ScalarForm node %d", node->type);
+    }
+
+    expression->type       = numberType;
+    expression->lineNumber = lineNumber;
+
+    return expression;
+}
+
+
+void ScalarReplacementVisitor::emit(utArray<Statement *>& out, Expression *target, Expression *value)
+{
+    AssignmentExpression *assignment = new AssignmentExpression(target, value);
+
+    assignment->type       = value->type;
+    assignment->lineNumber = lineNumber;
+
+    ExpressionStatement *statement = new ExpressionStatement(assignment);
+
+    statement->lineNumber = lineNumber;
+
+    out.push_back(statement);
+}
+
+
+void ScalarReplacementVisitor::expand(Form *form, Context& ctx, utArray<Statement *>& out)
+{
+    ScalarForm *scalarForm = form->form;
+
+    for (int i = 0; i < scalarForm->numLocals; i++)
+    {
+        ctx.locals.push_back(newTemp());
+    }
+
+    if (!rewriting)
+    {
+        return;
+    }
+
+    for (UTsize i = 0; i < scalarForm->steps.size(); i++)
+    {
+        ScalarForm::Step& step = scalarForm->steps[i];
+
+        if (step.dead)
+        {
+            continue;
+        }
+
+        Expression *target = NULL;
+
+        switch (step.target->type)
+        {
+        case ScalarForm::NODE_SELF_FIELD:
+            target = field(form->info, ctx.self, step.target->fieldIndex);
+            break;
+
+        case ScalarForm::NODE_RESULT_FIELD:
+            target = field(form->info, ctx.result, step.target->fieldIndex);
+            break;
+
+        case ScalarForm::NODE_LOCAL:
+            target = local(ctx.locals[step.target->index], numberType);
+            break;
+
+        default:
+            lmAssert(0, "unexpected ScalarForm target %d", step.target->type);
+        }
+
+        emit(out, target, build(step.value, form, ctx));
+    }
+}
+
+
+bool ScalarReplacementVisitor::readsWritten(ScalarForm::Node *node, Context& ctx, StructValue *dest, utArray<bool>& written)
+{
+    if (!node)
+    {
+        return false;
+    }
+
+    StructValue *value = NULL;
+
+    if (node->type == ScalarForm::NODE_PARAM_FIELD)
+    {
+        value = ctx.structArgs[node->index];
+    }
+    else if (node->type == ScalarForm::NODE_SELF_FIELD)
+    {
+        value = ctx.self;
+    }
+
+    if (value && (value->candidate == dest->candidate) && written[node->fieldIndex])
+    {
+        return true;
+    }
+
+    return readsWritten(node->left, ctx, dest, written) || readsWritten(node->right, ctx, dest, written);
+}
+
+
+bool ScalarReplacementVisitor::canWriteDirect(Form *form, Context& ctx, StructValue *dest)
+{
+    // writing the result into the local skips the assignment operator, and
+    // the operands must not see the local part way through being written
+    if (!form->info->copyAssignment || !dest->candidate)
+    {
+        return false;
+    }
+
+    utArray<bool> written;
+
+    for (UTsize i = 0; i < form->info->fields.size(); i++)
+    {
+        written.push_back(false);
+    }
+
+    utArray<ScalarForm::Step>& steps = form->form->steps;
+
+    for (UTsize i = 0; i < steps.size(); i++)
+    {
+        if (steps[i].dead)
+        {
+            continue;
+        }
+
+        if ((steps[i].target->type == ScalarForm::NODE_SELF_FIELD) || readsWritten(steps[i].value, ctx, dest, written))
+        {
+            return false;
+        }
+
+        if (steps[i].target->type == ScalarForm::NODE_RESULT_FIELD)
+        {
+            written[steps[i].target->fieldIndex] = true;
+        }
+    }
+
+    return true;
+}
+
+
+ScalarReplacementVisitor::NumberValue ScalarReplacementVisitor::evaluateNumber(Expression *expression, utArray<Statement *>& out)
+{
+    NumberValue value;
+
+    Expression *visited = visitExpression(expression);
+
+    if (visited->astType == AST_NUMBERLITERAL)
+    {
+        value.literal = true;
+        value.number  = ((NumberLiteral *)visited)->value;
+
+        return value;
+    }
+
+    value.name = newTemp();
+
+    if (rewriting)
+    {
+        emit(out, local(value.name, numberType), visited);
+    }
+
+    return value;
+}
+
+
+void ScalarReplacementVisitor::evaluateArguments(Form *form, utArray<Expression *> *arguments, Context& ctx, utArray<Statement *>& out)
+{
+    int numArguments = arguments ? (int)arguments->size() : 0;
+
+    for (int i = 0; i < form->form->getNumParameters(); i++)
+    {
+        if (form->structParams[i])
+        {
+            ctx.structArgs.push_back(evaluateStruct(arguments->at(i), form->info, out, NULL));
+            ctx.numberArgs.push_back(NumberValue());
+            continue;
+        }
+
+        ctx.structArgs.push_back(NULL);
+
+        if (i < numArguments)
+        {
+            ctx.numberArgs.push_back(evaluateNumber(arguments->at(i), out));
+        }
+        else
+        {
+            NumberValue value;
+
+            value.literal = true;
+            value.number  = form->form->defaults[i];
+
+            ctx.numberArgs.push_back(value);
+        }
+    }
+}
+
+
+ScalarReplacementVisitor::StructValue *ScalarReplacementVisitor::evaluateStruct(Expression *expression, StructInfo *info,
+                                                                                utArray<Statement *>& out, StructValue *dest)
+{
+    Candidate *candidate = getCandidate(expression);
+
+    if (candidate)
+    {
+        return candidateValue(candidate);
+    }
+
+    Form                  *form      = NULL;
+    Expression            *receiver  = NULL;
+    utArray<Expression *> *arguments = NULL;
+    utArray<Expression *> operands;
+
+    if (expression->type == info->type)
+    {
+        if (expression->astType == AST_NEWEXPRESSION)
+        {
+            arguments = ((NewExpression *)expression)->arguments;
+            form      = fits(info->init, arguments) ? info->init : NULL;
+        }
+        else if (expression->astType == AST_BINARYOPERATOREXPRESSION)
+        {
+            BinaryOperatorExpression *binary = (BinaryOperatorExpression *)expression;
+
+            form = getOperatorForm(binary);
+
+            if (form && (form->info == info))
+            {
+                operands.push_back(binary->leftExpression);
+                operands.push_back(binary->rightExpression);
+                arguments = &operands;
+            }
+            else
+            {
+                form = NULL;
+            }
+        }
+        else if (expression->astType == AST_CALLEXPRESSION)
+        {
+            CallExpression *call = (CallExpression *)expression;
+
+            form      = getValidForm(call->methodBase);
+            arguments = call->arguments;
+
+            if (!form || (form->form->kind != ScalarForm::KIND_VALUE) || (form->info != info) ||
+                !getCallReceiver(call, form, &receiver) || !fits(form, arguments))
+            {
+                form = NULL;
+            }
+        }
+    }
+
+    if (!form)
+    {
+        // any other struct expression is evaluated to its table
+        StructValue *value = newValue();
+
+        value->ref = newRef();
+
+        Expression *visited = visitExpression(expression);
+
+        if (rewriting)
+        {
+            emit(out, local(value->ref, objectType), visited);
+        }
+
+        return value;
+    }
+
+    Context ctx;
+
+    if (receiver)
+    {
+        ctx.self = evaluateStruct(receiver, info, out, NULL);
+    }
+
+    evaluateArguments(form, arguments, ctx, out);
+
+    // a new instance assigned to a local is constructed in place
+    if (form->form->kind == ScalarForm::KIND_INIT)
+    {
+        ctx.self = dest ? dest : tempValue(info);
+
+        expand(form, ctx, out);
+
+        return ctx.self;
+    }
+
+    ctx.result = dest && canWriteDirect(form, ctx, dest) ? dest : tempValue(info);
+
+    expand(form, ctx, out);
+
+    return ctx.result;
+}
+
+
+void ScalarReplacementVisitor::initialize(Candidate *candidate, utArray<Expression *> *arguments, utArray<Statement *>& out)
+{
+    Context ctx;
+
+    ctx.self = candidateValue(candidate);
+
+    evaluateArguments(candidate->info->init, arguments, ctx, out);
+    expand(candidate->info->init, ctx, out);
+}
+
+
+void ScalarReplacementVisitor::assign(StructInfo *info, StructValue *dest, StructValue *source, utArray<Statement *>& out)
+{
+    Context ctx;
+
+    ctx.self = dest;
+    ctx.structArgs.push_back(source);
+    ctx.numberArgs.push_back(NumberValue());
+
+    expand(info->assign, ctx, out);
+}
+
+
+void ScalarReplacementVisitor::assignCandidate(Candidate *candidate, Expression *expression, utArray<Statement *>& out)
+{
+    StructValue *dest = candidateValue(candidate);
+
+    Candidate *source = getCandidate(expression);
+
+    if (source)
+    {
+        if (source != candidate)
+        {
+            assign(candidate->info, dest, candidateValue(source), out);
+        }
+
+        return;
+    }
+
+    StructValue *value = evaluateStruct(expression, candidate->info, out, dest);
+
+    if (value != dest)
+    {
+        assign(candidate->info, dest, value, out);
+    }
+}
+
+
+bool ScalarReplacementVisitor::isOpaqueTarget(Expression *expression)
+{
+    if (expression->astType == AST_IDENTIFIER)
+    {
+        Identifier *identifier = (Identifier *)expression;
+
+        return !identifier->typeExpression && !identifier->superAccess &&
+               (!identifier->memberInfo || identifier->memberInfo->isField());
+    }
+
+    if (expression->astType == AST_PROPERTYEXPRESSION)
+    {
+        PropertyExpression *p = (PropertyExpression *)expression;
+
+        return !p->arrayAccess && p->rightExpression->memberInfo && p->rightExpression->memberInfo->isField();
+    }
+
+    return false;
+}
+
+
+void ScalarReplacementVisitor::assignOpaque(Expression *target, StructInfo *info, Expression *expression, utArray<Statement *>& out)
+{
+    // the target is evaluated first, as the first argument of the
+    // assignment operator
+    StructValue *dest = newValue();
+
+    dest->ref = newRef();
+
+    Expression *visited = visitExpression(target);
+
+    if (rewriting)
+    {
+        visited->assignment = false;
+        emit(out, local(dest->ref, objectType), visited);
+    }
+
+    assign(info, dest, evaluateStruct(expression, info, out, NULL), out);
+}
+
+
+void ScalarReplacementVisitor::mutate(Candidate *candidate, Form *form, utArray<Expression *> *arguments, utArray<Statement *>& out)
+{
+    Context ctx;
+
+    ctx.self = candidateValue(candidate);
+
+    evaluateArguments(form, arguments, ctx, out);
+    expand(form, ctx, out);
+}
+
+
+ScalarReplacementVisitor::StructInfo *ScalarReplacementVisitor::getStructDeclaration(VariableDeclaration *declaration)
+{
+    Expression *initializer = declaration->initializer;
+
+    if (declaration->isParameter || !initializer || declaration->defaultInitializer ||
+        (initializer->astType == AST_NEWEXPRESSION) || (initializer->type != declaration->type))
+    {
+        return NULL;
+    }
+
+    StructInfo *info = getStructInfo(declaration->type);
+
+    return info && info->valid && references(initializer, NULL) ? info : NULL;
+}
+
+
+bool ScalarReplacementVisitor::isStableNumber(Expression *expression)
+{
+    if (expression->astType == AST_NUMBERLITERAL)
+    {
+        return true;
+    }
+
+    if (expression->astType == AST_IDENTIFIER)
+    {
+        Identifier *identifier = (Identifier *)expression;
+
+        return !identifier->memberInfo && !identifier->typeExpression && !identifier->superAccess &&
+               (identifier->type == numberType);
+    }
+
+    if (expression->astType == AST_PROPERTYEXPRESSION)
+    {
+        PropertyExpression *p         = (PropertyExpression *)expression;
+        Candidate          *candidate = p->arrayAccess ? NULL : getCandidate(p->leftExpression);
+
+        return candidate && (getFieldIndex(candidate->info, p->rightExpression->memberInfo) >= 0);
+    }
+
+    return false;
+}
+
+
+ScalarReplacementVisitor::NumberValue ScalarReplacementVisitor::stableNumber(Expression *expression)
+{
+    NumberValue value;
+
+    if (expression->astType == AST_NUMBERLITERAL)
+    {
+        value.literal = true;
+        value.number  = ((NumberLiteral *)expression)->value;
+    }
+    else if (expression->astType == AST_IDENTIFIER)
+    {
+        value.name = ((Identifier *)expression)->string;
+    }
+    else
+    {
+        PropertyExpression *p         = (PropertyExpression *)expression;
+        Candidate          *candidate = getCandidate(p->leftExpression);
+
+        value.name = candidate->scalars[getFieldIndex(candidate->info, p->rightExpression->memberInfo)];
+    }
+
+    return value;
+}
+
+
+ScalarForm::Node *ScalarReplacementVisitor::substitute(ScalarForm::Node *node, utArray<ScalarForm::Node *>& locals)
+{
+    if (node->type == ScalarForm::NODE_LOCAL)
+    {
+        return locals[node->index] ? ScalarForm::clone(locals[node->index]) : NULL;
+    }
+
+    ScalarForm::Node *copy = new ScalarForm::Node(node->type);
+
+    copy->number     = node->number;
+    copy->index      = node->index;
+    copy->field      = node->field;
+    copy->fieldIndex = node->fieldIndex;
+    copy->op         = node->op;
+
+    if (node->left && !(copy->left = substitute(node->left, locals)))
+    {
+        delete copy;
+        return NULL;
+    }
+
+    if (node->right && !(copy->right = substitute(node->right, locals)))
+    {
+        delete copy;
+        return NULL;
+    }
+
+    return copy;
+}
+
+
+int ScalarReplacementVisitor::countNodes(ScalarForm::Node *node)
+{
+    return node ? 1 + countNodes(node->left) + countNodes(node->right) : 0;
+}
+
+
+Expression *ScalarReplacementVisitor::inlineNumber(Form *form, Expression *receiver, utArray<Expression *> *arguments,
+                                                   Expression *original)
+{
+    ScalarForm *scalarForm = form->form;
+
+    // only forms without side effects can stand in for the call
+    int numSteps = (int)scalarForm->steps.size();
+
+    if (!numSteps || (scalarForm->steps[numSteps - 1].target->type != ScalarForm::NODE_RETURN))
+    {
+        return NULL;
+    }
+
+    for (int i = 0; i < numSteps - 1; i++)
+    {
+        if (scalarForm->steps[i].target->type != ScalarForm::NODE_LOCAL)
+        {
+            return NULL;
+        }
+    }
+
+    // the struct operands must be replaced locals and the Number ones must
+    // read the same wherever they are substituted
+    Candidate *self = NULL;
+
+    if (!form->method->isStatic())
+    {
+        self = getCandidate(receiver);
+
+        if (!self || (self->info != form->info))
+        {
+            return NULL;
+        }
+    }
+
+    if (!fits(form, arguments))
+    {
+        return NULL;
+    }
+
+    bool replaced = self != NULL;
+
+    for (UTsize i = 0; arguments && i < arguments->size(); i++)
+    {
+        Expression *argument = arguments->at(i);
+
+        if (form->structParams[i])
+        {
+            Candidate *candidate = getCandidate(argument);
+
+            if (!candidate || (candidate->info != form->info))
+            {
+                return NULL;
+            }
+
+            replaced = true;
+        }
+        else if (!isStableNumber(argument))
+        {
+            return NULL;
+        }
+    }
+
+    if (!replaced)
+    {
+        return NULL;
+    }
+
+    utArray<ScalarForm::Node *> locals;
+
+    for (int i = 0; i < scalarForm->numLocals; i++)
+    {
+        locals.push_back(NULL);
+    }
+
+    ScalarForm::Node *result = NULL;
+
+    for (int i = 0; i < numSteps; i++)
+    {
+        ScalarForm::Step& step = scalarForm->steps[i];
+
+        if (step.dead)
+        {
+            continue;
+        }
+
+        ScalarForm::Node *value = substitute(step.value, locals);
+
+        if (!value)
+        {
+            break;
+        }
+
+        if (step.target->type == ScalarForm::NODE_LOCAL)
+        {
+            delete locals[step.target->index];
+            locals[step.target->index] = value;
+        }
+        else
+        {
+            result = value;
+        }
+    }
+
+    for (UTsize i = 0; i < locals.size(); i++)
+    {
+        delete locals[i];
+    }
+
+    if (!result || (countNodes(result) > SCALAR_REPLACEMENT_MAX_INLINE))
+    {
+        delete result;
+        return NULL;
+    }
+
+    if (!rewriting)
+    {
+        delete result;
+        return original;
+    }
+
+    Context ctx;
+
+    if (self)
+    {
+        ctx.self = candidateValue(self);
+    }
+
+    int numArguments = arguments ? (int)arguments->size() : 0;
+
+    for (int i = 0; i < scalarForm->getNumParameters(); i++)
+    {
+        if (form->structParams[i])
+        {
+            ctx.structArgs.push_back(candidateValue(getCandidate(arguments->at(i))));
+            ctx.numberArgs.push_back(NumberValue());
+            continue;
+        }
+
+        ctx.structArgs.push_back(NULL);
+
+        if (i < numArguments)
+        {
+            ctx.numberArgs.push_back(stableNumber(arguments->at(i)));
+        }
+        else
+        {
+            NumberValue value;
+
+            value.literal = true;
+            value.number  = scalarForm->defaults[i];
+
+            ctx.numberArgs.push_back(value);
+        }
+    }
+
+    Expression *inlined = build(result, form, ctx);
+
+    delete result;
+
+    return inlined;
+}
+
+
+Statement *ScalarReplacementVisitor::rewritten(Statement *original, utArray<Statement *>& out)
+{
+    if (!rewriting)
+    {
+        return original;
+    }
+
+    BlockStatement *block = new BlockStatement(new utArray<Statement *>(out));
+
+    block->astType    = AST_BLOCKSTATEMENT;
+    block->lineNumber = lineNumber;
+
+    return block;
+}
+
+
+Statement *ScalarReplacementVisitor::visit(ExpressionStatement *statement)
+{
+    if (nested)
+    {
+        return TraversalVisitor::visit(statement);
+    }
+
+    beginStatement();
+
+    utArray<Statement *> out;
+
+    Expression *expression = statement->expression;
+
+    if (expression->astType == AST_ASSIGNMENTEXPRESSION)
+    {
+        Expression *left  = ((AssignmentExpression *)expression)->leftExpression;
+        Expression *right = ((AssignmentExpression *)expression)->rightExpression;
+
+        Candidate *candidate = getCandidate(left);
+
+        if (candidate && (right->type == candidate->info->type))
+        {
+            assignCandidate(candidate, right, out);
+            return rewritten(statement, out);
+        }
+
+        // a struct value assigned to a variable or field is copied into it
+        // by the assignment operator, which can read replaced locals
+        StructInfo *info = candidate ? NULL : getStructInfo(left->type);
+
+        if (info && info->valid && (right->type == left->type) && (right->astType != AST_NEWEXPRESSION) &&
+            isOpaqueTarget(left) && references(right, NULL))
+        {
+            assignOpaque(left, info, right, out);
+            return rewritten(statement, out);
+        }
+    }
+    else if (expression->astType == AST_ASSIGNMENTOPERATOREXPRESSION)
+    {
+        AssignmentOperatorExpression *assignment = (AssignmentOperatorExpression *)expression;
+
+        Candidate  *candidate = getCandidate(assignment->leftExpression);
+        const char *name      = Tokens::getSingletonPtr()->getOperatorMethodName(assignment->type);
+        MemberInfo *member    = candidate && name ? candidate->info->type->findMember(name) : NULL;
+        Form       *form      = member && member->isMethod() ? getValidForm((MethodBase *)member) : NULL;
+
+        utArray<Expression *> arguments;
+        arguments.push_back(assignment->rightExpression);
+
+        if (form && (form->form->kind == ScalarForm::KIND_MUTATE) && !form->method->isStatic() &&
+            (form->info == candidate->info) && fits(form, &arguments))
+        {
+            mutate(candidate, form, &arguments, out);
+            return rewritten(statement, out);
+        }
+    }
+    else if (expression->astType == AST_CALLEXPRESSION)
+    {
+        CallExpression *call = (CallExpression *)expression;
+
+        Form       *form     = getValidForm(call->methodBase);
+        Expression *receiver = NULL;
+
+        if (form && (form->form->kind == ScalarForm::KIND_MUTATE) && !form->method->isStatic() &&
+            getCallReceiver(call, form, &receiver) && fits(form, call->arguments))
+        {
+            Candidate *candidate = getCandidate(receiver);
+
+            if (candidate && (form->info == candidate->info))
+            {
+                mutate(candidate, form, call->arguments, out);
+                return rewritten(statement, out);
+            }
+        }
+    }
+
+    return TraversalVisitor::visit(statement);
+}
+
+
+Statement *ScalarReplacementVisitor::visit(VariableStatement *statement)
+{
+    if (nested)
+    {
+        return TraversalVisitor::visit(statement);
+    }
+
+    utArray<VariableDeclaration *> *declarations = statement->declarations;
+
+    bool handled = false;
+
+    for (UTsize i = 0; i < declarations->size(); i++)
+    {
+        VariableDeclaration *declaration = declarations->at(i);
+
+        Candidate *candidate = getCandidate(declaration->identifier);
+
+        if (candidate && declaration->initializer && !declaration->defaultInitializer &&
+            (declaration->initializer->type != candidate->info->type))
+        {
+            escape(candidate);
+            continue;
+        }
+
+        if (candidate || getStructDeclaration(declaration))
+        {
+            handled = true;
+        }
+    }
+
+    if (!handled)
+    {
+        return TraversalVisitor::visit(statement);
+    }
+
+    beginStatement();
+
+    utArray<Statement *> out;
+
+    for (UTsize i = 0; i < declarations->size(); i++)
+    {
+        VariableDeclaration *declaration = declarations->at(i);
+        Expression          *initializer = declaration->initializer;
+
+        Candidate  *candidate = getCandidate(declaration->identifier);
+        StructInfo *info      = candidate ? NULL : getStructDeclaration(declaration);
+
+        if (candidate)
+        {
+            if (!initializer || declaration->defaultInitializer)
+            {
+                initialize(candidate, NULL, out);
+                continue;
+            }
+
+            // the local is created before its initializer is evaluated, and
+            // assigned through the assignment operator unless it is new
+            if ((initializer->astType != AST_NEWEXPRESSION) &&
+                (!candidate->info->copyAssignment || references(initializer, candidate)))
+            {
+                initialize(candidate, NULL, out);
+            }
+
+            assignCandidate(candidate, initializer, out);
+            continue;
+        }
+
+        utArray<VariableDeclaration *> *single = NULL;
+
+        if (rewriting)
+        {
+            single = new utArray<VariableDeclaration *>();
+        }
+
+        if (info)
+        {
+            // declared as a new instance, then assigned
+            StructValue *dest = newValue();
+
+            dest->ref = declaration->identifier->string;
+
+            if (rewriting)
+            {
+                declaration->defaultInitializer = true;
+
+                single->push_back(declaration);
+
+                VariableStatement *declare = new VariableStatement(single);
+                declare->lineNumber = statement->lineNumber;
+                out.push_back(declare);
+            }
+
+            assign(info, dest, evaluateStruct(initializer, info, out, NULL), out);
+            continue;
+        }
+
+        declaration = (VariableDeclaration *)visitExpression(declaration);
+
+        if (rewriting)
+        {
+            single->push_back(declaration);
+
+            VariableStatement *declare = new VariableStatement(single);
+            declare->lineNumber = statement->lineNumber;
+            out.push_back(declare);
+        }
+    }
+
+    return rewritten(statement, out);
+}
+
+
+Expression *ScalarReplacementVisitor::visit(FunctionLiteral *literal)
+{
+    // closures have been replaced on their own, and any use of the
+    // function's candidates within them is an escape
+    if (rewriting)
+    {
+        return literal;
+    }
+
+    nested++;
+    TraversalVisitor::visit(literal);
+    nested--;
+
+    return literal;
+}
+
+
+Expression *ScalarReplacementVisitor::visit(Identifier *identifier)
+{
+    Candidate *candidate = getCandidate(identifier);
+
+    if (candidate)
+    {
+        escape(candidate);
+    }
+
+    return identifier;
+}
+
+
+Expression *ScalarReplacementVisitor::visit(PropertyExpression *expression)
+{
+    Candidate *candidate = nested || expression->arrayAccess ? NULL : getCandidate(expression->leftExpression);
+
+    if (candidate)
+    {
+        MemberInfo *member = expression->rightExpression->memberInfo;
+
+        int index = getFieldIndex(candidate->info, member);
+
+        if (index >= 0)
+        {
+            if (!rewriting)
+            {
+                return expression;
+            }
+
+            Identifier *scalar = local(candidate->scalars[index], numberType);
+
+            scalar->assignment = expression->assignment;
+
+            return scalar;
+        }
+
+        if (member && member->isProperty() && !expression->assignment)
+        {
+            Form *form = getValidForm(((PropertyInfo *)member)->getGetMethod());
+
+            if (form && (form->form->kind == ScalarForm::KIND_NUMBER) && !form->method->isStatic())
+            {
+                Expression *inlined = inlineNumber(form, expression->leftExpression, NULL, expression);
+
+                if (inlined)
+                {
+                    return inlined;
+                }
+            }
+        }
+    }
+
+    return TraversalVisitor::visit(expression);
+}
+
+
+Expression *ScalarReplacementVisitor::visit(CallExpression *call)
+{
+    Form *form = nested ? NULL : getValidForm(call->methodBase);
+
+    Expression *receiver = NULL;
+
+    if (form && (form->form->kind == ScalarForm::KIND_NUMBER) && getCallReceiver(call, form, &receiver))
+    {
+        Expression *inlined = inlineNumber(form, receiver, call->arguments, call);
+
+        if (inlined)
+        {
+            return inlined;
+        }
+    }
+
+    return TraversalVisitor::visit(call);
+}
+
+
+Expression *ScalarReplacementVisitor::visit(MultipleAssignmentExpression *expression)
+{
+    for (UTsize i = 0; i < expression->left.size(); i++)
+    {
+        expression->left[i] = visitExpression(expression->left[i]);
+    }
+
+    for (UTsize i = 0; i < expression->right.size(); i++)
+    {
+        expression->right[i] = visitExpression(expression->right[i]);
+    }
+
+    return expression;
+}
+
+
+Expression *ScalarReplacementVisitor::visit(DictionaryLiteralPair *pair)
+{
+    pair->key   = visitExpression(pair->key);
+    pair->value = visitExpression(pair->value);
+
+    return pair;
+}
+}
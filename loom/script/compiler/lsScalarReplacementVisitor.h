@@ -0,0 +1,291 @@
+/*
+ * ===========================================================================
+ * Loom SDK
+ * Copyright 2011, 2012, 2013
+ * The Game Engine Company, LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ * ===========================================================================
+ */
+
+#ifndef _lsscalarreplacementvisitor_h
+#define _lsscalarreplacementvisitor_h
+
+#include "loom/common/utils/utTypes.h"
+#include "loom/common/utils/utString.h"
+
+#include "loom/script/compiler/lsTraversalVisitor.h"
+#include "loom/script/compiler/lsScalarForm.h"
+
+#include "loom/script/runtime/lsLuaState.h"
+#include "loom/script/reflection/lsFieldInfo.h"
+
+namespace LS {
+class CandidateReferenceVisitor;
+
+/*
+ * Replaces struct locals which don't escape their function with a Number
+ * local per field.
+ *
+ * A struct local is a candidate when its struct only has Number fields and
+ * its constructor and assignment operator have a ScalarForm. It escapes when
+ * it is used other than by:
+ *
+ * - reading or writing its fields
+ * - declaring it, assigning a struct value to it or assigning it to another
+ *   struct variable or field
+ * - as an operand, receiver or argument of a struct method with a ScalarForm
+ *
+ * Methods with a form are expanded inline on the fields, the value of any
+ * other struct expression they take is evaluated to a table held in a
+ * temporary local. Locals which escape anywhere, including in a closure,
+ * stay tables.
+ *
+ * Struct values are computed into temporaries rather than the static
+ * temporary of the struct, so expressions which use more than one result of
+ * a value method see each of them rather than the last one.
+ */
+class ScalarReplacementVisitor : public TraversalVisitor {
+    friend class CandidateReferenceVisitor;
+
+private:
+
+    struct StructInfo;
+
+    struct Form
+    {
+        ScalarForm *form;
+        MethodBase *method;
+        StructInfo *info;
+
+        // per parameter of the form, whether it takes the struct
+        utArray<bool> structParams;
+    };
+
+    struct StructInfo
+    {
+        Type *type;
+
+        utArray<FieldInfo *> fields;
+
+        Form *init;
+        Form *assign;
+
+        // the assignment operator copies every field and nothing else
+        bool copyAssignment;
+
+        // the struct's locals can be replaced
+        bool valid;
+    };
+
+    struct Candidate
+    {
+        StructInfo *info;
+
+        bool escaped;
+
+        // the local holding each field
+        utArray<utString> scalars;
+    };
+
+    // where the fields of a struct value are, either in locals or in the
+    // table referenced by a local
+    struct StructValue
+    {
+        Candidate         *candidate;
+        utArray<utString> names;
+        utString          ref;
+    };
+
+    // a Number argument, a literal or a local
+    struct NumberValue
+    {
+        bool     literal;
+        double   number;
+        utString name;
+
+        NumberValue() : literal(false), number(0)
+        {
+        }
+    };
+
+    struct Context
+    {
+        StructValue            *self;
+        StructValue            *result;
+        utArray<StructValue *> structArgs;
+        utArray<NumberValue>   numberArgs;
+        utArray<utString>      locals;
+
+        Context() : self(NULL), result(NULL)
+        {
+        }
+    };
+
+    LSLuaState *vm;
+
+    Type *numberType;
+    Type *objectType;
+
+    utHashTable<utPointerHashKey, StructInfo *> structs;
+    utHashTable<utPointerHashKey, Form *>       forms;
+
+    FunctionLiteral *function;
+
+    utHashTable<utHashedString, Candidate *> candidates;
+
+    // struct values of the current statement
+    utArray<StructValue *> values;
+
+    // scanning for escapes, or rewriting once no more are found
+    bool rewriting;
+    bool escapeFound;
+
+    // depth of closures within the function
+    int nested;
+
+    // temporaries of the current statement and the most any statement needs
+    int numTemps;
+    int numRefs;
+    int maxTemps;
+    int maxRefs;
+
+    StructInfo *getStructInfo(Type *type);
+
+    Form *getForm(MethodBase *method);
+
+    // the form of a method of a struct whose locals can be replaced
+    Form *getValidForm(MethodBase *method);
+
+    Form *getOperatorForm(BinaryOperatorExpression *expression);
+
+    bool getCallReceiver(CallExpression *call, Form *form, Expression **receiver);
+
+    static int getFieldIndex(StructInfo *info, MemberInfo *memberInfo);
+
+    static bool fits(Form *form, utArray<Expression *> *arguments);
+
+    Candidate *getCandidate(Expression *expression);
+
+    bool references(Expression *expression, Candidate *candidate);
+
+    void escape(Candidate *candidate);
+
+    void gatherCandidates();
+
+    void traverse();
+
+    void finish();
+
+    void declare(const utString& name, Type *type);
+
+    void clear();
+
+    void beginStatement();
+
+    utString newTemp();
+
+    utString newRef();
+
+    StructValue *newValue();
+
+    StructValue *candidateValue(Candidate *candidate);
+
+    StructValue *tempValue(StructInfo *info);
+
+    Identifier *local(const utString& name, Type *type);
+
+    Expression *field(StructInfo *info, StructValue *value, int index);
+
+    Expression *build(ScalarForm::Node *node, Form *form, Context& ctx);
+
+    void emit(utArray<Statement *>& out, Expression *target, Expression *value);
+
+    void expand(Form *form, Context& ctx, utArray<Statement *>& out);
+
+    // whether the expression reads a field of the destination already written
+    bool readsWritten(ScalarForm::Node *node, Context& ctx, StructValue *dest, utArray<bool>& written);
+
+    bool canWriteDirect(Form *form, Context& ctx, StructValue *dest);
+
+    NumberValue evaluateNumber(Expression *expression, utArray<Statement *>& out);
+
+    void evaluateArguments(Form *form, utArray<Expression *> *arguments, Context& ctx, utArray<Statement *>& out);
+
+    StructValue *evaluateStruct(Expression *expression, StructInfo *info, utArray<Statement *>& out, StructValue *dest);
+
+    void initialize(Candidate *candidate, utArray<Expression *> *arguments, utArray<Statement *>& out);
+
+    void assign(StructInfo *info, StructValue *dest, StructValue *source, utArray<Statement *>& out);
+
+    void assignCandidate(Candidate *candidate, Expression *expression, utArray<Statement *>& out);
+
+    bool isOpaqueTarget(Expression *expression);
+
+    void assignOpaque(Expression *target, StructInfo *info, Expression *expression, utArray<Statement *>& out);
+
+    void mutate(Candidate *candidate, Form *form, utArray<Expression *> *arguments, utArray<Statement *>& out);
+
+    // the struct of a declaration whose initializer reads a replaced local
+    StructInfo *getStructDeclaration(VariableDeclaration *declaration);
+
+    bool isStableNumber(Expression *expression);
+
+    NumberValue stableNumber(Expression *expression);
+
+    ScalarForm::Node *substitute(ScalarForm::Node *node, utArray<ScalarForm::Node *>& locals);
+
+    static int countNodes(ScalarForm::Node *node);
+
+    Expression *inlineNumber(Form *form, Expression *receiver, utArray<Expression *> *arguments, Expression *original);
+
+    Statement *rewritten(Statement *original, utArray<Statement *>& out);
+
+public:
+
+    ScalarReplacementVisitor(LSLuaState *ls);
+
+    ~ScalarReplacementVisitor();
+
+    // replaces the struct locals of an optimized function which don't escape
+    void replace(CompilationUnit *cunit, FunctionLiteral *literal);
+
+    Statement *visitStatement(Statement *statement)
+    {
+        if (statement != NULL)
+        {
+            lineNumber = statement->lineNumber;
+            statement  = TraversalVisitor::visitStatement(statement);
+        }
+
+        return statement;
+    }
+
+    Statement *visit(ExpressionStatement *statement);
+
+    Statement *visit(VariableStatement *statement);
+
+    Expression *visit(FunctionLiteral *literal);
+
+    Expression *visit(Identifier *identifier);
+
+    Expression *visit(PropertyExpression *expression);
+
+    Expression *visit(CallExpression *call);
+
+    Expression *visit(MultipleAssignmentExpression *expression);
+
+    Expression *visit(DictionaryLiteralPair *pair);
+};
+}
+#endif
@@ -80,7 +80,8 @@ Token *Token::getKeyword(const char *t)
 {
     utHashedString svalue(t);
 
-    Token **tt = sKeywords.get(svalue.hash());
+    // source files are lexed in parallel, leave the lookup cache alone
+    Token *const *tt = sKeywords.getUncached(svalue.hash());
 
     if (tt)
     {
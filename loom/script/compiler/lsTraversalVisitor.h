@@ -172,7 +172,7 @@ public:
         return _expressions;
     }
 
-    Expression *visitExpression(Expression *expression)
+    virtual Expression *visitExpression(Expression *expression)
     {
         if (expression != NULL)
         {
@@ -366,6 +366,8 @@ void TypeCompiler::generateMethod(FunctionLiteral *function,
 
     closeCodeState(&codeState);
 
+    function->numInstructions = (int)funcState.f->sizecode;
+
 	bool debug = cunit->buildInfo->isDebugBuild();
 
     method->setByteCode(generateByteCode(funcState.f, debug));
@@ -454,6 +456,7 @@ void TypeCompiler::generateConstructor(FunctionLiteral *function,
     // it at runtime which is a performance overhead.
     if(function->isConstructor
        && function->hasSuperCall == false
+       && function->implicitSuperCall == false
        && function->isNative == false
        && skipSuper == false
        && constructor->getDeclaringType()->isPrimitive() == false)
@@ -472,6 +475,8 @@ void TypeCompiler::generateConstructor(FunctionLiteral *function,
         if(function->statements == NULL)
             function->statements = new utArray<Statement*>();
         function->statements->push_front(stmt);
+
+        function->implicitSuperCall = true;
     }
 
     // Emit any actual constructor code!
@@ -479,6 +484,8 @@ void TypeCompiler::generateConstructor(FunctionLiteral *function,
 
     closeCodeState(&codeState);
 
+    function->numInstructions = (int)funcState.f->sizecode;
+
 	bool debug = cunit->buildInfo->isDebugBuild();
     constructor->setByteCode(generateByteCode(funcState.f, debug));
 
@@ -614,7 +621,8 @@ Statement *TypeCompiler::visit(DoStatement *statement)
     /* statements*/
     statement->statement->visitStatement(this);
 
-    lua_assert(bl.breaklist == NO_JUMP);
+    /* continue evaluates the condition */
+    BC::patchToHere(fs, bl.continuelist);
 
     statement->expression->visitExpression(this);
     ExpDesc c        = statement->expression->e;
@@ -703,10 +711,11 @@ Statement *TypeCompiler::visit(ForStatement *statement)
     /* statements*/
     statement->statement->visitStatement(this);
 
+    /* continue runs the increment, if any */
+    BC::patchToHere(fs, bl.continuelist);
+
     if (es)
     {
-        BC::patchToHere(fs, bl.continuelist);
-
         es->visitStatement(this);
 
         es->expression = NULL;
@@ -1279,7 +1288,7 @@ Expression *TypeCompiler::visit(AssignmentOperatorExpression *expression)
     if (eleft->memberInfo && eleft->memberInfo->isProperty())
     {
         eright->e = right;
-        generatePropertySet(&eleft->e, eright, false);
+        generatePropertyStore(eleft, &eleft->e, eright);
     }
     else
     {
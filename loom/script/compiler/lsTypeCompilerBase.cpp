@@ -343,6 +343,12 @@ Expression *TypeCompilerBase::visit(CallExpression *call)
 {
     MethodBase *methodBase = call->methodBase;
 
+    if (call->directCall)
+    {
+        generateDirectCall(call);
+        return call;
+    }
+
     call->function->visitExpression(this);
 
     // check whether we're calling a methodbase
@@ -392,6 +398,66 @@ Expression *TypeCompilerBase::visit(CallExpression *call)
 }
 
 
+void TypeCompilerBase::generateDirectCall(CallExpression *call)
+{
+    FuncState *fs = cs->fs;
+
+    MethodInfo *method = (MethodInfo *)call->methodBase;
+
+    lmAssert(method && method->isMethod(), "Direct call to non-method");
+
+    ExpDesc efunction;
+    BC::singleVar(cs, &efunction, method->getDeclaringType()->getFullName().c_str());
+
+    // static methods are replaced with their bound method at class
+    // initialization, so the raw function is stashed under a separate name
+    utString name = method->getName();
+    if (method->isStatic())
+    {
+        name += "__direct";
+    }
+
+    ExpDesc fname;
+    BC::expString(cs, &fname, name.c_str());
+
+    BC::expToNextReg(fs, &efunction);
+    BC::expToNextReg(fs, &fname);
+    BC::expToVal(fs, &fname);
+    BC::indexed(fs, &efunction, &fname);
+
+    if (method->isStatic())
+    {
+        generateCall(&efunction, call->arguments, method);
+    }
+    else
+    {
+        // pass the receiver in arg 1
+        utArray<Expression *> args;
+
+        if (call->function->astType == AST_PROPERTYEXPRESSION)
+        {
+            args.push_back(((PropertyExpression *)call->function)->leftExpression);
+        }
+        else
+        {
+            args.push_back(new ThisLiteral());
+        }
+
+        if (call->arguments)
+        {
+            for (UTsize i = 0; i < call->arguments->size(); i++)
+            {
+                args.push_back(call->arguments->at(i));
+            }
+        }
+
+        generateCall(&efunction, &args, NULL);
+    }
+
+    call->e = efunction;
+}
+
+
 void TypeCompilerBase::createVarArg(ExpDesc *varg, utArray<Expression *> *arguments,
                                    int startIdx)
 {
@@ -886,7 +952,34 @@ Expression *TypeCompilerBase::visit(PropertyExpression *expression)
 
         bool primitive = eright->memberInfo->getDeclaringType()->isPrimitive() && expression->staticAccess == false;
 
+        FieldInfo *inlinedField = NULL;
         if (!primitive)
+        {
+            inlinedField = getInlinedAccessorField(expression, expression->assignment);
+        }
+
+        if (inlinedField)
+        {
+            // trivial accessor, index the backing field directly
+            if (inlinedField->isStatic())
+            {
+                BC::singleVar(cs, &left, inlinedField->getDeclaringType()->getFullName().c_str());
+            }
+            else
+            {
+                eleft->visitExpression(this);
+                left = eleft->e;
+            }
+
+            generateInlinedAccessor(&left, inlinedField);
+
+            expression->e = left;
+            eleft->e      = left;
+            eright->e     = left;
+
+            return expression;
+        }
+        else if (!primitive)
         {
             // non-primitive property path
 
@@ -1073,6 +1166,134 @@ Expression *TypeCompilerBase::visit(PropertyExpression *expression)
 }
 
 
+FieldInfo *TypeCompilerBase::getInlinedAccessorField(Expression *property, bool setter)
+{
+    if (!LSCompiler::getInlineAccessors())
+    {
+        return NULL;
+    }
+
+    MemberInfo *memberInfo = property->memberInfo;
+    bool       staticAccess = false;
+
+    if (property->astType == AST_IDENTIFIER)
+    {
+        Identifier *identifier = (Identifier *)property;
+
+        if (identifier->superAccess || identifier->typeExpression)
+        {
+            return NULL;
+        }
+
+        staticAccess = true;
+    }
+    else if (property->astType == AST_PROPERTYEXPRESSION)
+    {
+        PropertyExpression *p = (PropertyExpression *)property;
+
+        if (p->arrayAccess)
+        {
+            return NULL;
+        }
+
+        memberInfo   = p->rightExpression->memberInfo;
+        staticAccess = p->staticAccess;
+    }
+    else
+    {
+        return NULL;
+    }
+
+    if (!memberInfo || !memberInfo->isProperty())
+    {
+        return NULL;
+    }
+
+    PropertyInfo *pinfo        = (PropertyInfo *)memberInfo;
+    Type         *declaringType = pinfo->getDeclaringType();
+
+    if (declaringType->isInterface() || declaringType->isPrimitive() || declaringType->isNative())
+    {
+        return NULL;
+    }
+
+    MethodInfo *accessor = setter ? pinfo->getSetMethod() : pinfo->getGetMethod();
+
+    if (!accessor)
+    {
+        return NULL;
+    }
+
+    MetaInfo   *meta      = accessor->getMetaInfo("InlineAccessor");
+    const char *fieldName = meta ? meta->getAttribute("field") : NULL;
+
+    if (!fieldName)
+    {
+        return NULL;
+    }
+
+    // we can only bypass the accessor when we know it won't be overridden,
+    // static accessors are always dispatched on their declaring type, so we
+    // need a static access to know which type that is
+    if (accessor->isStatic())
+    {
+        if (!staticAccess)
+        {
+            return NULL;
+        }
+    }
+    else if (!accessor->isFinal() && !accessor->getDeclaringType()->isFinal() &&
+             !accessor->getDeclaringType()->isStruct())
+    {
+        return NULL;
+    }
+
+    MemberInfo *field = accessor->getDeclaringType()->findMember(fieldName, false);
+
+    if (!field || !field->isField() || field->isNative() ||
+        (field->isStatic() != accessor->isStatic()) || !field->getOrdinal())
+    {
+        return NULL;
+    }
+
+    return (FieldInfo *)field;
+}
+
+
+void TypeCompilerBase::generateInlinedAccessor(ExpDesc *expr, FieldInfo *field)
+{
+    FuncState *fs = cs->fs;
+
+    ExpDesc fieldOrdinal;
+
+    BC::initExpDesc(&fieldOrdinal, VKNUM, 0);
+
+#ifdef LOOM_ENABLE_JIT
+    setnumV(&fieldOrdinal.u.nval, field->getOrdinal());
+#else
+    fieldOrdinal.u.nval = field->getOrdinal();
+#endif
+
+    BC::expToNextReg(fs, expr);
+    BC::expToNextReg(fs, &fieldOrdinal);
+    BC::expToVal(fs, &fieldOrdinal);
+    BC::indexed(fs, expr, &fieldOrdinal);
+}
+
+
+void TypeCompilerBase::generatePropertyStore(Expression *property, ExpDesc *call, Expression *value)
+{
+    if (getInlinedAccessorField(property, true))
+    {
+        // the call is the indexed backing field, so this is a plain store
+        BC::storeVar(cs->fs, call, &value->e);
+        return;
+    }
+
+    generatePropertySet(call, value, false);
+}
+
+
 void TypeCompilerBase::insertYield(ExpDesc *yield, utArray<Expression *> *arguments)
 {
     BC::singleVar(cs, yield, "yield");
@@ -1244,7 +1465,7 @@ Expression *TypeCompilerBase::visit(IncrementExpression *expression)
         // setup the property setter call
         ExpDesc set = sub->e;
         sub->e = e;
-        generatePropertySet(&set, sub, false);
+        generatePropertyStore(sub, &set, sub);
 
         // back to the original expression (with associated register)
         e = erestore;
@@ -1494,7 +1715,7 @@ Expression *TypeCompilerBase::visit(AssignmentExpression *expression)
             // generated a super.property call for it
             if (!set)
             {
-                generatePropertySet(&left, eright, false);
+                generatePropertyStore(eleft, &left, eright);
             }
 
             expression->e = e;
@@ -1639,6 +1860,20 @@ Expression *TypeCompilerBase::visit(Identifier *identifier)
     {
         BC::singleVar(cs, &identifier->e, istring.c_str());
     }
+    else if (FieldInfo *inlinedField = getInlinedAccessorField(identifier, identifier->assignment))
+    {
+        // trivial accessor, index the backing field directly
+        if (inlinedField->isStatic())
+        {
+            BC::singleVar(cs, &identifier->e, inlinedField->getDeclaringType()->getFullName().c_str());
+        }
+        else
+        {
+            BC::singleVar(cs, &identifier->e, "this");
+        }
+
+        generateInlinedAccessor(&identifier->e, inlinedField);
+    }
     else
     {
         MemberInfo *memberInfo = identifier->memberInfo;
@@ -109,6 +109,24 @@ protected:
 
     Expression *visit(PropertyExpression *expression);
 
+    // When accessor inlining is enabled, returns the backing field of the
+    // property getter/setter referenced by the given Identifier or
+    // PropertyExpression, if it is a trivial accessor which can't be
+    // overridden, otherwise NULL
+    FieldInfo *getInlinedAccessorField(Expression *property, bool setter);
+
+    // generate the store for a property assignment, this is either a
+    // setter call or a direct store to the backing field of an inlined setter
+    void generatePropertyStore(Expression *property, ExpDesc *call, Expression *value);
+
+    // index the backing field of an inlined accessor into expr
+    void generateInlinedAccessor(ExpDesc *expr, FieldInfo *field);
+
+    // generate a call marked direct by the OptimizationVisitor, the raw
+    // function is indexed off of the declaring class table, bypassing
+    // the bound method
+    void generateDirectCall(CallExpression *call);
+
     void insertYield(ExpDesc *yield, utArray<Expression *> *arguments = NULL);
 
     Expression *visit(YieldExpression *expression);
@@ -356,6 +356,23 @@ public:
         }
     }
 
+    // validate that a property accessor declared on type doesn't
+    // override a final accessor on the base type
+    void validateFinalAccessor(Type *type, MethodInfo *accessor, MethodInfo *baseAccessor)
+    {
+        if (!accessor || !baseAccessor || (accessor == baseAccessor))
+        {
+            return;
+        }
+
+        if ((accessor->getDeclaringType() == type) && baseAccessor->isFinal())
+        {
+            error(accessor, "Property Override Error: %s:%s overrides final accessor on base type %s:%s",
+                  type->getFullName().c_str(), accessor->getName(),
+                  baseAccessor->getDeclaringType()->getFullName().c_str(), baseAccessor->getName());
+        }
+    }
+
     void validateInheritance(Type *type)
     {
         Type *baseType = type->getBaseType();
@@ -448,6 +465,9 @@ public:
                       type->getFullName().c_str(), mi->getName(), p1->getType()->getFullName().c_str(),
                       bmi->getDeclaringType()->getFullName().c_str(), bmi->getName(), p2->getType()->getFullName().c_str());
             }
+
+            validateFinalAccessor(type, p1->getGetMethod(), p2->getGetMethod());
+            validateFinalAccessor(type, p1->getSetMethod(), p2->getSetMethod());
         }
 
 
@@ -485,6 +505,13 @@ public:
                           bmi->getDeclaringType()->getFullName().c_str(), bmi->getName());
                 }
 
+                if (bmi->isMethod() && ((MethodInfo *)bmi)->isFinal())
+                {
+                    error(mi, "Method Override Error: %s:%s overrides final method on base type %s:%s",
+                          type->getFullName().c_str(), mi->getName(),
+                          bmi->getDeclaringType()->getFullName().c_str(), bmi->getName());
+                }
+
                 // static methods may have different signatures
                 // TODO: Look at how this affects super calls
                 // https://theengineco.atlassian.net/browse/LOOM-591
@@ -25,18 +25,166 @@ using namespace LS;
 class Coroutine {
 public:
 
-    static int resume(lua_State *L)
+    static Type *typeCoroutine;
+
+    // member ordinals of system.Coroutine
+    static int threadOrdinal;
+    static int aliveOrdinal;
+    static int thisOrdinal;
+    static int initMethodOrdinal;
+
+    static void initialize(lua_State *L)
+    {
+        typeCoroutine = LSLuaState::getLuaState(L)->getType("system.Coroutine");
+        lmAssert(typeCoroutine, "unable to get system.Coroutine type");
+
+        threadOrdinal     = typeCoroutine->getMemberOrdinal("thread");
+        aliveOrdinal      = typeCoroutine->getMemberOrdinal("alive");
+        thisOrdinal       = typeCoroutine->getMemberOrdinal("_this");
+        initMethodOrdinal = typeCoroutine->getMemberOrdinal("_initMethod");
+    }
+
+    // Resumes co with the nargs values on top of L. On return the arguments
+    // are replaced with the last value the coroutine yielded or returned, or
+    // its error message. Returns false if the coroutine is dead afterwards.
+    static bool resumeThread(lua_State *L, lua_State *co, int nargs)
     {
-        // get the coroutine resume function
-        lua_getglobal(L, "coroutine");
-        lua_getfield(L, -1, "resume");
+        int status = lua_status(co);
+
+        // a thread with frames that has not yielded is running or resuming
+        // another coroutine, one with no frames left and nothing on its
+        // stack has finished
+        lua_Debug ar;
+        bool running  = (status == 0) && (lua_getstack(co, 0, &ar) > 0);
+        bool finished = (status != LUA_YIELD) && ((status != 0) || !lua_gettop(co));
+
+        if (running || finished)
+        {
+            lua_pop(L, nargs);
+            lua_pushstring(L, running ? "cannot resume running coroutine" : "cannot resume dead coroutine");
+            return running;
+        }
+
+        if (!lua_checkstack(co, nargs))
+        {
+            luaL_error(L, "too many arguments to resume");
+        }
+
+        lua_xmove(L, co, nargs);
+
+        status = lua_resume(co, nargs);
 
-        // push the thread on the stack
-        lua_pushvalue(L, 1);
+        if ((status != 0) && (status != LUA_YIELD))
+        {
+            // the error message is left on the thread's stack
+            lua_xmove(co, L, 1);
+            return false;
+        }
+
+        int nresults = lua_gettop(co);
+
+        if (!nresults)
+        {
+            // as coroutine.resume would, a bare yield or return gives true
+            lua_pushboolean(L, 1);
+            return status == LUA_YIELD;
+        }
+
+        luaL_checkstack(L, nresults, "too many results to resume");
+        lua_xmove(co, L, nresults);
 
+        // only the last value is handed back to script
+        if (nresults > 1)
+        {
+            lua_replace(L, -nresults);
+            lua_pop(L, nresults - 2);
+        }
+
+        return status == LUA_YIELD;
+    }
+
+    // Resumes the Coroutine instance at cidx with the nargs values on top of
+    // the stack, priming method coroutines with their this and arguments on
+    // their first resume. Leaves the coroutine's result on the stack and
+    // returns false once the coroutine is dead.
+    static bool resumeInstance(lua_State *L, int cidx, int nargs)
+    {
+        if (!threadOrdinal)
+        {
+            initialize(L);
+        }
+
+        lua_rawgeti(L, cidx, threadOrdinal);
+        lua_State *co = lua_tothread(L, -1);
+        lua_pop(L, 1);
+
+        if (!co)
+        {
+            lua_pop(L, nargs);
+            lua_pushnil(L);
+            return false;
+        }
+
+        bool alive = true;
+
+        lua_rawgeti(L, cidx, initMethodOrdinal);
+        bool initMethod = lua_toboolean(L, -1) != 0;
+        lua_pop(L, 1);
+
+        if (initMethod)
+        {
+            lua_pushboolean(L, 0);
+            lua_rawseti(L, cidx, initMethodOrdinal);
+
+            // methods start suspended, the first resume hands them their
+            // this and arguments, the second one runs the body
+            int firstArg = lua_gettop(L) - nargs + 1;
+
+            lua_rawgeti(L, cidx, thisOrdinal);
+            if (lua_isnil(L, -1))
+            {
+                lua_pop(L, 1);
+            }
+            else
+            {
+                lua_insert(L, firstArg);
+                nargs++;
+            }
+
+            alive = resumeThread(L, co, nargs);
+            nargs = 0;
+
+            if (alive)
+            {
+                lua_pop(L, 1);
+            }
+        }
+
+        if (alive)
+        {
+            alive = resumeThread(L, co, nargs);
+        }
+
+        if (!alive)
+        {
+            lua_pushboolean(L, 0);
+            lua_rawseti(L, cidx, aliveOrdinal);
+            lua_pushnil(L);
+            lua_rawseti(L, cidx, thisOrdinal);
+            lua_pushnil(L);
+            lua_rawseti(L, cidx, threadOrdinal);
+        }
+
+        return alive;
+    }
+
+    static int resume(lua_State *L)
+    {
         // unwind our var args
         int length = lsr_vector_get_length(L, 2);
 
+        luaL_checkstack(L, length, "too many arguments to resume");
+
         lua_rawgeti(L, 2, LSINDEXVECTOR);
         int vidx = lua_gettop(L);
 
@@ -48,25 +196,7 @@ public:
         // get rid of the vector table
         lua_remove(L, vidx);
 
-        // call resume on the thread
-        lua_call(L, length + 1, LUA_MULTRET);
-
-        int top = lua_gettop(L);
-
-        // get the coroutine status
-        // and flag coroutine instance as dead
-        // if necessary
-        lua_getglobal(L, "coroutine");
-        lua_getfield(L, -1, "status");
-        lua_pushvalue(L, 1);
-        lua_call(L, 1, 1);
-        if (!strcmp(lua_tostring(L, -1), "dead"))
-        {
-            lua_pushboolean(L, 0);
-            lualoom_setmember(L, 3, "alive");
-        }
-
-        lua_settop(L, top);
+        resumeInstance(L, 1, length);
 
         // return the value of the yield(x) if any
         return 1;
@@ -74,12 +204,27 @@ public:
 
     static int create(lua_State *L)
     {
+        MethodBase *method = NULL;
+
         if (lua_iscfunction(L, 1))
         {
             // get the method
             lua_getupvalue(L, 1, 1);
-            MethodBase *method = (MethodBase *)lua_topointer(L, -1);
+            method = (MethodBase *)lua_topointer(L, -1);
             lua_pop(L, 1);
+        }
+        else if (lua_isfunction(L, 1))
+        {
+            // methods bound without lsr_method, see lsr_isbindablemethod
+            lua_rawgeti(L, LUA_GLOBALSINDEX, LSINDEXMETHODLOOKUP);
+            lua_pushvalue(L, 1);
+            lua_rawget(L, -2);
+            method = (MethodBase *)lua_topointer(L, -1);
+            lua_pop(L, 2);
+        }
+
+        if (method)
+        {
 
             // set the _initMethod on the coroutine
             // instance, as methods require a setup resume
@@ -97,15 +242,30 @@ public:
             // if we're not static, we also need to store off the instance
             if (!method->isStatic())
             {
-                lua_getupvalue(L, 1, 2);
+                if (lua_iscfunction(L, 1))
+                {
+                    lua_getupvalue(L, 1, 2);
+                }
+                else
+                {
+                    lsr_getbinderupvalue(L, 1, "this");
+                }
+
                 lualoom_setmember(L, 2, "_this");
             }
 
-            int methodIdx = method->isStatic() ? 2 : 3;
-
             lua_getglobal(L, "coroutine");
             lua_getfield(L, -1, "create");
-            lua_getupvalue(L, 1, methodIdx);
+
+            if (lua_iscfunction(L, 1))
+            {
+                lua_getupvalue(L, 1, method->isStatic() ? 2 : 3);
+            }
+            else
+            {
+                lsr_getbinderupvalue(L, 1, "f");
+            }
+
             lua_call(L, 1, LUA_MULTRET);
 
             return 1;
@@ -128,6 +288,361 @@ public:
     }
 };
 
+Type *Coroutine::typeCoroutine;
+int  Coroutine::threadOrdinal;
+int  Coroutine::aliveOrdinal;
+int  Coroutine::thisOrdinal;
+int  Coroutine::initMethodOrdinal;
+
+/**
+ * Native side of system.CoroutineScheduler. Waiting coroutines are kept in
+ * two min-heaps, one keyed by the frame and one by the time they are due,
+ * so a tick only touches the coroutines it resumes. The coroutines
+ * themselves are held by a table in the script instance, mapping each one
+ * to its slot and each slot back to its coroutine.
+ */
+class CoroutineScheduler
+{
+protected:
+
+    struct Wait
+    {
+        double due;
+        int    slot;
+        int    serial;
+    };
+
+    static Type *typeCoroutineScheduler;
+    static int  coroutinesOrdinal;
+
+    utArray<Wait> frameWaits;
+    utArray<Wait> timeWaits;
+
+    // bumped whenever a slot is rescheduled, cancelled or freed, heap
+    // entries carrying an older serial are stale and skipped
+    utArray<int> serials;
+    utArray<int> freeSlots;
+
+    // waits collected by tick before any of them is resumed
+    utArray<Wait> ready;
+
+    int    frame;
+    double time;
+    int    count;
+
+    static void pushWait(utArray<Wait>& heap, const Wait& wait)
+    {
+        UTsize i = heap.size();
+        heap.push_back(wait);
+
+        while (i > 0)
+        {
+            UTsize parent = (i - 1) / 2;
+            if (heap[parent].due <= wait.due)
+            {
+                break;
+            }
+
+            heap[i] = heap[parent];
+            i       = parent;
+        }
+
+        heap[i] = wait;
+    }
+
+    static Wait popWait(utArray<Wait>& heap)
+    {
+        Wait top  = heap[0];
+        Wait last = heap[heap.size() - 1];
+
+        heap.pop_back();
+
+        UTsize n = heap.size();
+        UTsize i = 0;
+
+        while (n)
+        {
+            UTsize child = i * 2 + 1;
+            if (child >= n)
+            {
+                break;
+            }
+
+            if ((child + 1 < n) && (heap[child + 1].due < heap[child].due))
+            {
+                child++;
+            }
+
+            if (last.due <= heap[child].due)
+            {
+                break;
+            }
+
+            heap[i] = heap[child];
+            i       = child;
+        }
+
+        if (n)
+        {
+            heap[i] = last;
+        }
+
+        return top;
+    }
+
+    // pushes the slot table of the script instance at index 1, creating it
+    // on first use
+    static void pushCoroutines(lua_State *L)
+    {
+        if (!coroutinesOrdinal)
+        {
+            typeCoroutineScheduler = LSLuaState::getLuaState(L)->getType("system.CoroutineScheduler");
+            lmAssert(typeCoroutineScheduler, "unable to get system.CoroutineScheduler type");
+            coroutinesOrdinal = typeCoroutineScheduler->getMemberOrdinal("_coroutines");
+        }
+
+        lua_rawgeti(L, 1, coroutinesOrdinal);
+
+        if (lua_isnil(L, -1))
+        {
+            lua_pop(L, 1);
+            lua_newtable(L);
+            lua_pushvalue(L, -1);
+            lua_rawseti(L, 1, coroutinesOrdinal);
+        }
+    }
+
+    // slot of the coroutine at cidx, allocating one if create is set;
+    // returns -1 if the coroutine is not scheduled
+    int getSlot(lua_State *L, int cidx, bool create)
+    {
+        pushCoroutines(L);
+
+        lua_pushvalue(L, cidx);
+        lua_rawget(L, -2);
+
+        int slot = lua_isnil(L, -1) ? -1 : (int)lua_tonumber(L, -1);
+        lua_pop(L, 1);
+
+        if ((slot == -1) && create)
+        {
+            if (freeSlots.size())
+            {
+                slot = freeSlots.back();
+                freeSlots.pop_back();
+            }
+            else
+            {
+                slot = (int)serials.size();
+                serials.push_back(0);
+            }
+
+            lua_pushvalue(L, cidx);
+            lua_pushnumber(L, slot);
+            lua_rawset(L, -3);
+
+            lua_pushvalue(L, cidx);
+            lua_rawseti(L, -2, slot);
+
+            count++;
+        }
+
+        lua_pop(L, 1);
+        return slot;
+    }
+
+    void releaseSlot(lua_State *L, int slot)
+    {
+        pushCoroutines(L);
+
+        lua_rawgeti(L, -1, slot);
+        lua_pushnil(L);
+        lua_rawset(L, -3);
+
+        lua_pushnil(L);
+        lua_rawseti(L, -2, slot);
+
+        lua_pop(L, 1);
+
+        serials[slot]++;
+        freeSlots.push_back(slot);
+        count--;
+    }
+
+    void schedule(int slot, utArray<Wait>& heap, double due)
+    {
+        Wait wait;
+
+        wait.due    = due;
+        wait.slot   = slot;
+        wait.serial = ++serials[slot];
+
+        pushWait(heap, wait);
+    }
+
+    static void collectDue(utArray<Wait>& heap, double now, utArray<Wait>& out)
+    {
+        while (heap.size() && (heap[0].due <= now))
+        {
+            out.push_back(popWait(heap));
+        }
+    }
+
+public:
+
+    CoroutineScheduler() : frame(0), time(0), count(0)
+    {
+    }
+
+    int getFrame() const
+    {
+        return frame;
+    }
+
+    double getTime() const
+    {
+        return time;
+    }
+
+    int getCount() const
+    {
+        return count;
+    }
+
+    int waitForFrames(lua_State *L)
+    {
+        int frames = (int)lua_tonumber(L, 3);
+
+        schedule(getSlot(L, 2, true), frameWaits, frame + (frames > 1 ? frames : 1));
+        return 0;
+    }
+
+    int waitForTime(lua_State *L)
+    {
+        double delay = lua_tonumber(L, 3);
+
+        schedule(getSlot(L, 2, true), timeWaits, time + (delay > 0 ? delay : 0));
+        return 0;
+    }
+
+    int cancel(lua_State *L)
+    {
+        int slot = getSlot(L, 2, false);
+
+        if (slot != -1)
+        {
+            releaseSlot(L, slot);
+        }
+
+        return 0;
+    }
+
+    int clear(lua_State *L)
+    {
+        if (coroutinesOrdinal)
+        {
+            lua_pushnil(L);
+            lua_rawseti(L, 1, coroutinesOrdinal);
+        }
+
+        for (UTsize i = 0; i < serials.size(); i++)
+        {
+            serials[i]++;
+        }
+
+        frameWaits.clear();
+        timeWaits.clear();
+
+        freeSlots.clear();
+        for (int i = (int)serials.size() - 1; i >= 0; i--)
+        {
+            freeSlots.push_back(i);
+        }
+
+        count = 0;
+        return 0;
+    }
+
+    int tick(lua_State *L)
+    {
+        frame++;
+        time += lua_tonumber(L, 2);
+
+        // take everything that is due before resuming anything, so a
+        // coroutine waiting again from inside the tick runs no earlier
+        // than the next one
+        ready.clear();
+        collectDue(frameWaits, frame, ready);
+        collectDue(timeWaits, time, ready);
+
+        int resumed = 0;
+
+        pushCoroutines(L);
+        int coroutinesIdx = lua_gettop(L);
+
+        for (UTsize i = 0; i < ready.size(); i++)
+        {
+            Wait wait = ready[i];
+
+            if (serials[wait.slot] != wait.serial)
+            {
+                continue;
+            }
+
+            lua_rawgeti(L, coroutinesIdx, wait.slot);
+            int cidx = lua_gettop(L);
+
+            bool alive = Coroutine::resumeInstance(L, cidx, 0);
+            resumed++;
+
+            // the coroutine waited again or was cancelled while it ran
+            if (serials[wait.slot] != wait.serial)
+            {
+                lua_settop(L, coroutinesIdx);
+                continue;
+            }
+
+            if (!alive)
+            {
+                releaseSlot(L, wait.slot);
+            }
+            else if (lua_type(L, -1) == LUA_TNUMBER)
+            {
+                // yielding a number waits that many milliseconds
+                double delay = lua_tonumber(L, -1);
+                schedule(wait.slot, timeWaits, time + (delay > 0 ? delay : 0));
+            }
+            else
+            {
+                schedule(wait.slot, frameWaits, frame + 1);
+            }
+
+            lua_settop(L, coroutinesIdx);
+        }
+
+        ready.clear();
+
+        lua_pushnumber(L, resumed);
+        return 1;
+    }
+
+    // The script methods forward to these with this as the first argument,
+    // so that index 1 is the script instance holding _coroutines.
+    static CoroutineScheduler *getScheduler(lua_State *L)
+    {
+        return (CoroutineScheduler *)lualoom_getnativepointer(L, 1);
+    }
+
+    static int _waitForFrames(lua_State *L) { return getScheduler(L)->waitForFrames(L); }
+    static int _waitForTime(lua_State *L) { return getScheduler(L)->waitForTime(L); }
+    static int _cancel(lua_State *L) { return getScheduler(L)->cancel(L); }
+    static int _clear(lua_State *L) { return getScheduler(L)->clear(L); }
+    static int _tick(lua_State *L) { return getScheduler(L)->tick(L); }
+};
+
+Type *CoroutineScheduler::typeCoroutineScheduler;
+int  CoroutineScheduler::coroutinesOrdinal;
+
 static int registerSystemCoroutine(lua_State *L)
 {
     beginPackage(L, "system")
@@ -138,6 +653,20 @@ static int registerSystemCoroutine(lua_State *L)
        .addStaticLuaFunction("_create", &Coroutine::create)
 
 
+       .endClass()
+
+       .beginClass<CoroutineScheduler> ("CoroutineScheduler")
+
+       .addConstructor<void (*)(void)>()
+       .addProperty("frame", &CoroutineScheduler::getFrame)
+       .addProperty("time", &CoroutineScheduler::getTime)
+       .addProperty("count", &CoroutineScheduler::getCount)
+       .addStaticLuaFunction("_waitForFrames", &CoroutineScheduler::_waitForFrames)
+       .addStaticLuaFunction("_waitForTime", &CoroutineScheduler::_waitForTime)
+       .addStaticLuaFunction("_cancel", &CoroutineScheduler::_cancel)
+       .addStaticLuaFunction("_clear", &CoroutineScheduler::_clear)
+       .addStaticLuaFunction("_tick", &CoroutineScheduler::_tick)
+
        .endClass()
 
        .endPackage();
@@ -149,4 +678,5 @@ static int registerSystemCoroutine(lua_State *L)
 void installSystemCoroutine()
 {
     NativeInterface::registerNativeType<Coroutine>(registerSystemCoroutine);
+    NativeInterface::registerManagedNativeType<CoroutineScheduler>(registerSystemCoroutine);
 }
@@ -69,6 +69,17 @@ public:
     // Fast lookup of source file breakpoints
     static utHashTable<utFastStringHash, utArray<Breakpoint *> > sourceBreakpoints;
 
+    // per Lua function prototype, whether a breakpoint falls within its
+    // lines, so call and return events only need a pointer lookup
+    static utHashTable<utPointerHashKey, bool> prototypeBreakpoints;
+
+    // true if the function running at the last call or return event
+    // contains a breakpoint, and so needs line events
+    static bool breakpointFunction;
+
+    // the Lua state the debug hook is installed on
+    static lua_State *hookState;
+
     // cached to avoid duplicate line events for same line
     static char lastSourceEvent[2048];
     static int  lastLineEvent;
@@ -161,6 +172,11 @@ public:
         int            nstack = 0;
         _CallStackInfo cstack[MAX_CALLSTACK];
 
+        // local functions aren't methods, their frames are reported as
+        // running in the method further down the stack
+        int            npending = 0;
+        _CallStackInfo pending[MAX_CALLSTACK];
+
         // look for method infos
         for (int i = 0; i < MAX_CALLSTACK; i++)
         {
@@ -176,9 +192,9 @@ public:
                 continue;
             }
 
-            // if we're a cfunction we're not interested in debugging it
-            // as we're a LoomScript debugger!
-            if (lua_iscfunction(L, -1))
+            // if we're a cfunction or a method binder we're not interested
+            // in debugging it as we're a LoomScript debugger!
+            if (lua_iscfunction(L, -1) || !strcmp(ar.source, LSMETHODBINDERSCHUNK))
             {
                 lua_pop(L, 1);
 
@@ -199,16 +215,20 @@ public:
             lua_pushvalue(L, -2);
             lua_rawget(L, -2);
 
-            // if we aren't found in the global functions
+            // if we aren't found in the global functions we're a local
+            // function, whose calls and returns the debugger doesn't follow
             if (lua_isnil(L, -1))
             {
-                // we are at the top of the stack, so this is an invalid stack
-                if (!i)
+                if (!i && ((eventType == CALL_EVENT) || (eventType == RETURN_EVENT)))
                 {
                     break;
                 }
 
-                lua_pop(L, 2);
+                pending[npending].source = ar.source;
+                pending[npending].line   = ar.currentline;
+                npending++;
+
+                lua_pop(L, 3);
                 continue;
             }
 
@@ -227,6 +247,16 @@ public:
                 break;
             }
 
+            bool topOfStack = !nstack;
+
+            for (int j = 0; j < npending; j++)
+            {
+                cstack[nstack]          = pending[j];
+                cstack[nstack++].method = methodBase;
+            }
+
+            npending = 0;
+
             // store out the stack info to our stack array
             _CallStackInfo *cs = &cstack[nstack++];
 
@@ -248,10 +278,10 @@ public:
             if (eventType == LINE_EVENT)
             {
                 // check breakpoints
-                if (!i && !stepping)
+                if (topOfStack && !stepping)
                 {
                     // we only stop on a breakpoint
-                    if (!hasBreakpoint(cs->source, cs->line) && !debugBreak)
+                    if (!hasBreakpoint(cstack[0].source, cstack[0].line) && !debugBreak)
                     {
                         lastSourceEvent[0] = 0;
                         lua_pushnil(L);
@@ -368,11 +398,250 @@ public:
         return 1;
     }
 
+    // retrieves the prototype of the Lua function at the given stack index
+    // along with its source and line range, NULL for C functions
+    static const void *getPrototype(lua_State *L, int index, const char **source, int *firstLine, int *lastLine)
+    {
+        if (!lua_isfunction(L, index) || lua_iscfunction(L, index))
+        {
+            return NULL;
+        }
+
+#ifdef LOOM_ENABLE_JIT
+        GCfunc *fn = (GCfunc *)lua_topointer(L, index);
+
+        if (!isluafunc(fn))
+        {
+            return NULL;
+        }
+
+        GCproto *pt = funcproto(fn);
+
+        *source    = proto_chunknamestr(pt);
+        *firstLine = (int)pt->firstline;
+        *lastLine  = (int)(pt->firstline + pt->numline);
+
+        return pt;
+#else
+        Closure *cl = (Closure *)lua_topointer(L, index);
+
+        Proto *p = cl->l.p;
+
+        // methods are compiled as main chunks, which don't record their
+        // lines, so take the range from the instructions' line info
+        *source    = getstr(p->source);
+        *firstLine = p->sizelineinfo ? p->lineinfo[0] : 0;
+        *lastLine  = *firstLine - 1;
+
+        for (int i = 0; i < p->sizelineinfo; i++)
+        {
+            if (p->lineinfo[i] < *firstLine)
+            {
+                *firstLine = p->lineinfo[i];
+            }
+
+            if (p->lineinfo[i] > *lastLine)
+            {
+                *lastLine = p->lineinfo[i];
+            }
+        }
+
+        return p;
+#endif
+    }
+
+    // tests whether the Lua function at the given stack index contains a
+    // breakpoint, the result is cached per prototype until the breakpoints change
+    static bool resolvePrototype(lua_State *L, int index)
+    {
+        const char *source    = NULL;
+        int        firstLine  = 0;
+        int        lastLine   = 0;
+        const void *prototype = getPrototype(L, index, &source, &firstLine, &lastLine);
+
+        if (!prototype)
+        {
+            return false;
+        }
+
+        utPointerHashKey key((void *)prototype);
+
+        bool *cached = prototypeBreakpoints.get(key);
+
+        if (cached)
+        {
+            return *cached;
+        }
+
+        utString path(source);
+        path.replace('\\', '/');
+        utArray<Breakpoint *> *bps = sourceBreakpoints.get(utFastStringHash(path));
+
+        bool found = false;
+
+        for (UTsize i = 0; bps && !found && i < bps->size(); i++)
+        {
+            int line = bps->at(i)->line;
+
+            found = (line >= firstLine) && (line <= lastLine);
+        }
+
+        prototypeBreakpoints.insert(key, found);
+
+        return found;
+    }
+
+    // resolves the breakpoints against every loaded method up front, local
+    // functions and methods loaded later are resolved on their first call
+    static void resolveBreakpoints(lua_State *L)
+    {
+        prototypeBreakpoints.clear();
+
+        // until the next call or return event we can't tell which function
+        // is running, so take line events
+        breakpointFunction = true;
+
+        if (!breakpoints.size())
+        {
+            updateHook();
+            return;
+        }
+
+        int top = lua_gettop(L);
+
+        lua_rawgeti(L, LUA_GLOBALSINDEX, LSINDEXMETHODLOOKUP);
+        lua_pushnil(L);
+
+        while (lua_next(L, -2))
+        {
+            lua_pop(L, 1);
+
+            resolvePrototype(L, -1);
+        }
+
+        lua_settop(L, top);
+
+        updateHook();
+    }
+
+    // prototypes are cached by address, which a newly loaded assembly may
+    // reuse, and its methods need resolving against the breakpoints
+    static void assemblyLoaded(lua_State *L)
+    {
+        prototypeBreakpoints.clear();
+
+        if (debuggerRunning && breakpoints.size())
+        {
+            resolveBreakpoints(L);
+        }
+    }
+
+    // the events the hook needs given the debugger state
+    static int getHookMask()
+    {
+        // stepping, finishing a method and Debug.debug() break on
+        // whichever line runs next
+        if (stepping || finishMethod || debugBreak)
+        {
+            return LUA_MASKCALL | LUA_MASKRET | LUA_MASKLINE;
+        }
+
+        // call and return events track whether the running function has a
+        // breakpoint, only then are line events taken
+        if (breakpoints.size())
+        {
+            return LUA_MASKCALL | LUA_MASKRET | (breakpointFunction ? LUA_MASKLINE : 0);
+        }
+
+#ifdef LOOM_ENABLE_JIT
+        // nothing to break on, so leave the VM unhooked and JIT enabled
+        return 0;
+#else
+        // hooks are per coroutine and are copied to new ones, call events
+        // let each coroutine pick up a later change on its next call
+        return LUA_MASKCALL;
+#endif
+    }
+
+    // installs the hook with the events the debugger currently needs
+    static void updateHook(lua_State *L = NULL)
+    {
+        if (!debuggerRunning)
+        {
+            return;
+        }
+
+        if (!L)
+        {
+            L = hookState;
+        }
+
+        int mask = getHookMask();
+
+        // the next line event after line events are off is never a repeat
+        // of the last one, even when it is on the same line
+        if (!(mask & LUA_MASKLINE))
+        {
+            lastSourceEvent[0] = 0;
+            lastLineEvent      = -1;
+        }
+
+        lua_sethook(L, debugHook, mask, 0);
+    }
+
+    // called on call and return events to track whether the function which
+    // is running once the event completes contains a breakpoint, level is
+    // its stack level. C functions have no lines, so calling one from a
+    // function with a breakpoint doesn't rehook the VM on the way in and out
+    static void trackBreakpointFunction(lua_State *L, int level)
+    {
+        bool      found = false;
+        lua_Debug frame;
+
+        if (lua_getstack(L, level, &frame) && lua_getinfo(L, "f", &frame))
+        {
+            if (lua_iscfunction(L, -1))
+            {
+                lua_pop(L, 1);
+                return;
+            }
+
+            found = resolvePrototype(L, -1);
+            lua_pop(L, 1);
+        }
+
+        breakpointFunction = found;
+    }
+
     // Main lua VM debug hook
     static void debugHook(lua_State *L, lua_Debug *ar)
     {
+        // a coroutine can still carry the hook after the debugger detached
+        if (!debuggerRunning)
+        {
+            lua_sethook(L, NULL, 0, 0);
+            return;
+        }
+
         int top = lua_gettop(L);
 
+        // a coroutine resumed part way through a function picks up line
+        // events on its next call or return
+        if (ar->event != LUA_HOOKLINE)
+        {
+            if (breakpoints.size())
+            {
+                trackBreakpointFunction(L, ar->event == LUA_HOOKCALL ? 0 : 1);
+            }
+
+            // hooks are per coroutine, this one may still have the events
+            // from before the last change
+            if (lua_gethookmask(L) != getHookMask())
+            {
+                updateHook(L);
+            }
+        }
+
         // line event
         if ((ar->event == LUA_HOOKLINE) && lineEventDelegate.getCount() && !assertion)
         {
@@ -459,17 +728,73 @@ public:
     }
 
     // initializes the Lua VM debug hook at this point
-    // we are now running under the debugger
+    // we are now running under the debugger, the hook only takes the
+    // events needed for the current breakpoints and stepping state
     static int setDebugHook(lua_State *L)
     {
-        lua_sethook(L, debugHook, LUA_MASKRET | LUA_MASKLINE | LUA_MASKCALL, 1);
         debuggerRunning    = true;
+        hookState          = L;
         lastSourceEvent[0] = 0;
         lastLineEvent      = -1;
 
+        resolveBreakpoints(L);
+
         return 0;
     }
 
+    // removes the debug hook, we are no longer running under the debugger
+    static int clearDebugHook(lua_State *L)
+    {
+        debuggerRunning = false;
+        hookState       = NULL;
+
+        lua_sethook(L, NULL, 0, 0);
+
+        return 0;
+    }
+
+    // the events the debug hook of the calling coroutine currently takes
+    static int getInstalledHookMask(lua_State *L)
+    {
+        lua_pushnumber(L, lua_gethookmask(L));
+
+        return 1;
+    }
+
+    // stepping state accessors, which rehook the VM as the state changes
+    static bool getStepping()
+    {
+        return stepping;
+    }
+
+    static void setStepping(bool value)
+    {
+        stepping = value;
+        updateHook();
+    }
+
+    static bool getDebugBreak()
+    {
+        return debugBreak;
+    }
+
+    static void setDebugBreak(bool value)
+    {
+        debugBreak = value;
+        updateHook();
+    }
+
+    static MethodBase *getFinishMethod()
+    {
+        return finishMethod;
+    }
+
+    static void setFinishMethod(MethodBase *value)
+    {
+        finishMethod = value;
+        updateHook();
+    }
+
     // When running under the debugger, this will freeze the execution state
     // allowing us to inspect it.  Otherwise we get a fatal error and exit
     static int loomAssert(lua_State *L)
@@ -588,9 +913,11 @@ public:
             return 1;
         }
 
-        // Now, build up current stack information
+        // Now, build up current stack information, with local functions
+        // running in the method below them as getCallStack reports them
         utArray<MethodBase *> curmethods;
         utArray<int>          curstack;
+        utArray<int>          pending;
 
         for (int i = 0; i < MAX_CALLSTACK; i++)
         {
@@ -608,8 +935,8 @@ public:
                 continue;
             }
 
-            // we are no interested in c functions
-            if (lua_iscfunction(L, -1))
+            // we are no interested in c functions or method binders
+            if (lua_iscfunction(L, -1) || !strcmp(ar.source, LSMETHODBINDERSCHUNK))
             {
                 lua_pop(L, 1);
                 continue;
@@ -620,10 +947,11 @@ public:
             lua_pushvalue(L, -2);
             lua_rawget(L, -2);
 
-            // if it doesn't exist, continue
+            // if it doesn't exist it's a local function
             if (lua_isnil(L, -1))
             {
-                lua_pop(L, 2);
+                pending.push_back(i);
+                lua_pop(L, 3);
                 continue;
             }
 
@@ -632,10 +960,19 @@ public:
             // skip it if we should filter it
             if (filterMethodBase(method))
             {
+                pending.clear();
                 continue;
             }
 
             // we got one
+            for (UTsize j = 0; j < pending.size(); j++)
+            {
+                curstack.push_back(pending[j]);
+                curmethods.push_back(method);
+            }
+
+            pending.clear();
+
             curstack.push_back(i);
             curmethods.push_back(method);
         }
@@ -838,7 +1175,7 @@ public:
         return false;
     }
 
-    static void regenerateSourceBreakpoints()
+    static void regenerateSourceBreakpoints(lua_State *L)
     {
         sourceBreakpoints.clear();
 
@@ -856,6 +1193,11 @@ public:
 
             sourceBreakpoints.get(fhash)->push_back(bp);
         }
+
+        if (debuggerRunning)
+        {
+            resolveBreakpoints(L);
+        }
     }
 
     // add's a breakpoint at the given source and line, checks for duplicates
@@ -904,7 +1246,7 @@ public:
 
                 breakpoints.push_back(bp);
 
-                regenerateSourceBreakpoints();
+                regenerateSourceBreakpoints(L);
 
                 lua_pushstring(L, typeSource.c_str());
                 return 1;
@@ -934,7 +1276,7 @@ public:
                 breakpoints.erase(bp);
                 strncpy(result, bp->source.c_str(), 1024);
                 delete bp;
-                regenerateSourceBreakpoints();
+                regenerateSourceBreakpoints(L);
                 lua_pushstring(L, result);
                 return 1;
             }
@@ -948,7 +1290,7 @@ public:
                 breakpoints.erase(bp);
                 strncpy(result, bp->source.c_str(), 1024);
                 delete bp;
-                regenerateSourceBreakpoints();
+                regenerateSourceBreakpoints(L);
                 lua_pushstring(L, result);
                 return 1;
             }
@@ -968,7 +1310,10 @@ public:
 
         breakpoints.clear();
 
-        regenerateSourceBreakpoints();
+        sourceBreakpoints.clear();
+        prototypeBreakpoints.clear();
+
+        updateHook();
     }
 
     // removes the breakpoint at the given index
@@ -992,7 +1337,7 @@ public:
 
         delete bp;
 
-        regenerateSourceBreakpoints();
+        regenerateSourceBreakpoints(L);
 
         lua_pushboolean(L, true);
         return 1;
@@ -1008,6 +1353,10 @@ char Debug::lastSourceEvent[2048];
 int  Debug::lastLineEvent = -1;
 utList<Debug::Breakpoint *> Debug::breakpoints;
 utHashTable<utFastStringHash, utArray<Debug::Breakpoint *> > Debug::sourceBreakpoints;
+utHashTable<utPointerHashKey, bool> Debug::prototypeBreakpoints;
+
+bool      Debug::breakpointFunction = false;
+lua_State *Debug::hookState         = NULL;
 
 bool Debug::assertion  = false;
 bool Debug::blocking   = false;
@@ -1027,14 +1376,16 @@ int registerSystemDebug(lua_State *L)
 
        .addStaticVar("assertion", &Debug::assertion)
        .addStaticVar("blocking", &Debug::blocking)
-       .addStaticVar("stepping", &Debug::stepping)
+       .addStaticProperty("stepping", &Debug::getStepping, &Debug::setStepping)
        .addStaticVar("stepOver", &Debug::stepOver)
-       .addStaticVar("debugBreak", &Debug::debugBreak)
-       .addStaticVar("finishMethod", &Debug::finishMethod)
+       .addStaticProperty("debugBreak", &Debug::getDebugBreak, &Debug::setDebugBreak)
+       .addStaticProperty("finishMethod", &Debug::getFinishMethod, &Debug::setFinishMethod)
 
        .addStaticLuaFunction("assert", &Debug::loomAssert)
        .addStaticLuaFunction("dump", &Debug::loomDump)
        .addStaticLuaFunction("setDebugHook", &Debug::setDebugHook)
+       .addStaticLuaFunction("clearDebugHook", &Debug::clearDebugHook)
+       .addStaticLuaFunction("getHookMask", &Debug::getInstalledHookMask)
        .addStaticLuaFunction("getLocals", &Debug::getLocals)
        .addStaticLuaFunction("getCallStack", &Debug::getCallStackInfo)
 
@@ -1063,3 +1414,9 @@ void installSystemDebug()
 {
     NativeInterface::registerNativeType<Debug>(registerSystemDebug);
 }
+
+
+void debugAssemblyLoaded(lua_State *L)
+{
+    Debug::assemblyLoaded(L);
+}
@@ -28,34 +28,7 @@ public:
 
     static int _length(lua_State *L)
     {
-        lmAssert(lua_isfunction(L, 1) || lua_iscfunction(L, 1), "Non-function in Function._length");
-
-        // first look in the global method lookup to see if we have a method base to go off
-        lua_rawgeti(L, LUA_GLOBALSINDEX, LSINDEXMETHODLOOKUP);
-        lua_pushvalue(L, 1);
-        lua_rawget(L, -2);
-
-        if (!lua_isnil(L, -1))
-        {
-            MethodBase *methodBase = (MethodBase *)lua_topointer(L, -1);
-            lua_pushnumber(L, methodBase->getNumParameters());
-            return 1;
-        }
-
-        // we don't, so we better be a local function with an upvalue at index 1 describing the number of parameters
-        const char *upvalue = lua_getupvalue(L, 1, 1);
-
-        lmAssert(upvalue, "Internal Error: funcinfo not at upvalue 1");
-
-#ifdef LOOM_DEBUG
-        lmAssert(!strncmp(upvalue, "__ls_funcinfo_arginfo", 21), "Internal Error: funcinfo not __ls_funcinfo_arginfo");
-#endif
-
-        lmAssert(lua_isnumber(L, -1), "Internal Error: __ls_funcinfo_arginfo not a number");
-
-        // number of args stored in upper 16 bits, so shift and return
-        lua_pushnumber(L, ((unsigned int) lua_tonumber(L, -1)) >> 16);
-
+        lua_pushnumber(L, lsr_function_get_numparameters(L, 1));
         return 1;
     }
 
@@ -88,7 +61,8 @@ public:
             lmAssert(upvalue, "Internal Error: funcinfo not at upvalue 1");
 
     #ifdef LOOM_DEBUG
-            lmAssert(!strncmp(upvalue, "__ls_funcinfo_arginfo", 21), "Internal Error: funcinfo not __ls_funcinfo_arginfo");
+            // release builds strip the upvalue names
+            lmAssert(!*upvalue || !strncmp(upvalue, "__ls_funcinfo_arginfo", 21), "Internal Error: funcinfo not __ls_funcinfo_arginfo");
     #endif
 
             lmAssert(lua_isnumber(L, -1), "Internal Error: __ls_funcinfo_arginfo not a number");
@@ -224,6 +198,49 @@ static int registerSystemFunction(lua_State *L)
 }
 
 
+namespace LS {
+
+int lsr_function_get_numparameters(lua_State *L, int index)
+{
+    index = lua_absindex(L, index);
+
+    lmAssert(lua_isfunction(L, index) || lua_iscfunction(L, index), "Non-function in Function._length");
+
+    int top = lua_gettop(L);
+
+    // first look in the global method lookup to see if we have a method base to go off
+    lua_rawgeti(L, LUA_GLOBALSINDEX, LSINDEXMETHODLOOKUP);
+    lua_pushvalue(L, index);
+    lua_rawget(L, -2);
+
+    if (!lua_isnil(L, -1))
+    {
+        MethodBase *methodBase = (MethodBase *)lua_topointer(L, -1);
+        lua_settop(L, top);
+        return methodBase->getNumParameters();
+    }
+
+    // we don't, so we better be a local function with an upvalue at index 1 describing the number of parameters
+    const char *upvalue = lua_getupvalue(L, index, 1);
+
+    lmAssert(upvalue, "Internal Error: funcinfo not at upvalue 1");
+
+#ifdef LOOM_DEBUG
+    // release builds strip the upvalue names
+    lmAssert(!*upvalue || !strncmp(upvalue, "__ls_funcinfo_arginfo", 21), "Internal Error: funcinfo not __ls_funcinfo_arginfo");
+#endif
+
+    lmAssert(lua_isnumber(L, -1), "Internal Error: __ls_funcinfo_arginfo not a number");
+
+    // number of args stored in upper 16 bits
+    int numParameters = (int)(((unsigned int) lua_tonumber(L, -1)) >> 16);
+
+    lua_settop(L, top);
+
+    return numParameters;
+}
+}
+
 void installSystemFunction()
 {
     NativeInterface::registerNativeType<LSFunction>(registerSystemFunction);
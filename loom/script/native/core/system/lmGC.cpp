@@ -65,6 +65,13 @@ public:
         return 0;
     }
 
+    static int fullCollect(lua_State *L)
+    {
+        lua_gc(L, LUA_GCCOLLECT, 0);
+
+        return 0;
+    }
+
     static int getAllocatedMemory(lua_State *L)
     {        
         lua_pushnumber(L, ((double)lua_gc(L, LUA_GCCOUNT, 0) + (double)lua_gc(L, LUA_GCCOUNTB, 0) / 1024) / 1024);
@@ -373,6 +380,7 @@ int registerSystemGC(lua_State *L)
        .beginClass<GC> ("GC")
 
        .addStaticLuaFunction("collect", &GC::collect)
+       .addStaticLuaFunction("fullCollect", &GC::fullCollect)
        .addStaticLuaFunction("getAllocatedMemory", &GC::getAllocatedMemory)
        .addStaticLuaFunction("update", &GC::update)
        .addStaticLuaFunction("setMemoryWarningLevel", &GC::setMemoryWarningLevel)
@@ -18,8 +18,318 @@
  * ===========================================================================
  */
 
+#include "loom/common/core/log.h"
 #include "loom/common/utils/json.h"
+#include "loom/common/utils/jsonReader.h"
 #include "loom/script/loomscript.h"
+#include "loom/script/reflection/lsPropertyInfo.h"
+#include "loom/script/runtime/lsRuntime.h"
+
+using namespace LS;
+
+lmDefineLogGroup(gJSONLogGroup, "json", 1, LoomLogInfo);
+
+/*
+ * Builds script values straight from JSONReader tokens: objects become
+ * Dictionaries, arrays Vectors, or, when a Type is given, instances of that
+ * Type with matching fields and properties set. Member types and their
+ * Vector/Dictionary template types steer the decoding of nested values.
+ */
+class JSONDecoder
+{
+    lua_State  *L;
+    JSONReader reader;
+
+    Type *objectType;
+    Type *numberType;
+    Type *stringType;
+    Type *booleanType;
+    Type *vectorType;
+    Type *dictionaryType;
+
+    JSONDecoder(lua_State *L) : L(L)
+    {
+        LSLuaState *ls = LSLuaState::getLuaState(L);
+
+        objectType     = ls->objectType;
+        numberType     = ls->numberType;
+        stringType     = ls->stringType;
+        booleanType    = ls->booleanType;
+        vectorType     = ls->vectorType;
+        dictionaryType = ls->getType("system.Dictionary");
+    }
+
+    // true for types that decode from a JSON object by member
+    bool isClassType(Type *type)
+    {
+        return type && (type != objectType) && (type != vectorType) && (type != dictionaryType) && !type->isPrimitive();
+    }
+
+    // whether a value decoded as valueType may be stored in a member of memberType
+    bool fits(Type *memberType, Type *valueType)
+    {
+        if (!memberType || (memberType == objectType))
+        {
+            return true;
+        }
+
+        if (!valueType)
+        {
+            // null leaves Number and Boolean members at their defaults
+            return (memberType != numberType) && (memberType != booleanType);
+        }
+
+        return valueType == memberType || valueType->isDerivedFrom(memberType);
+    }
+
+    // pushes the value starting at token, valueType is set to the decoded
+    // type or NULL for null
+    bool decodeValue(int token, Type *type, TemplateInfo *templateInfo, Type **valueType)
+    {
+        switch (token)
+        {
+        case JSON_TOKEN_STRING:
+            lua_pushlstring(L, reader.getString(), reader.getStringLength());
+            *valueType = stringType;
+            return true;
+
+        case JSON_TOKEN_NUMBER:
+            lua_pushnumber(L, reader.getNumber());
+            *valueType = numberType;
+            return true;
+
+        case JSON_TOKEN_BOOLEAN:
+            lua_pushboolean(L, reader.getBoolean());
+            *valueType = booleanType;
+            return true;
+
+        case JSON_TOKEN_NULL:
+            lua_pushnil(L);
+            *valueType = NULL;
+            return true;
+
+        case JSON_TOKEN_BEGIN_ARRAY:
+            *valueType = vectorType;
+
+            if (templateInfo && templateInfo->isTemplate())
+            {
+                TemplateInfo *element = templateInfo->getIndexedTemplateInfo();
+                return decodeVector(element->type, element);
+            }
+
+            // a bare class type decodes an array of its instances
+            return decodeVector(isClassType(type) ? type : NULL, NULL);
+
+        case JSON_TOKEN_BEGIN_OBJECT:
+            if (isClassType(type))
+            {
+                *valueType = type;
+                return decodeInstance(type);
+            }
+
+            *valueType = dictionaryType;
+
+            if (templateInfo && templateInfo->isTemplate())
+            {
+                TemplateInfo *element = templateInfo->getIndexedTemplateInfo();
+                return decodeDictionary(element->type, element);
+            }
+
+            return decodeDictionary(NULL, NULL);
+        }
+
+        return false;
+    }
+
+    bool decodeVector(Type *elementType, TemplateInfo *elementTemplate)
+    {
+        if (!lua_checkstack(L, 4))
+        {
+            return false;
+        }
+
+        lsr_createinstance(L, vectorType);
+        int vectorIdx = lua_gettop(L);
+
+        lua_rawgeti(L, vectorIdx, LSINDEXVECTOR);
+        int tableIdx = lua_gettop(L);
+
+        int  count = 0;
+        Type *valueType;
+
+        for (int token = reader.next(); token != JSON_TOKEN_END_ARRAY; token = reader.next())
+        {
+            if (!decodeValue(token, elementType, elementTemplate, &valueType))
+            {
+                return false;
+            }
+
+            lua_rawseti(L, tableIdx, count++);
+        }
+
+        lua_pop(L, 1);
+        lsr_vector_set_length(L, vectorIdx, count);
+
+        return true;
+    }
+
+    bool decodeDictionary(Type *valueType, TemplateInfo *valueTemplate)
+    {
+        if (!lua_checkstack(L, 5))
+        {
+            return false;
+        }
+
+        lsr_createinstance(L, dictionaryType);
+        lua_rawgeti(L, -1, LSINDEXDICTPAIRS);
+        int pairsIdx = lua_gettop(L);
+
+        Type *decodedType;
+
+        for (int token = reader.next(); token != JSON_TOKEN_END_OBJECT; token = reader.next())
+        {
+            if (token != JSON_TOKEN_KEY)
+            {
+                return false;
+            }
+
+            lua_pushlstring(L, reader.getString(), reader.getStringLength());
+
+            if (!decodeValue(reader.next(), valueType, valueTemplate, &decodedType))
+            {
+                return false;
+            }
+
+            lua_rawset(L, pairsIdx);
+        }
+
+        lua_pop(L, 1);
+
+        return true;
+    }
+
+    bool decodeInstance(Type *type)
+    {
+        if (!lua_checkstack(L, 5))
+        {
+            return false;
+        }
+
+        lsr_createinstance(L, type);
+        int instanceIdx = lua_gettop(L);
+
+        Type *valueType;
+
+        for (int token = reader.next(); token != JSON_TOKEN_END_OBJECT; token = reader.next())
+        {
+            if (token != JSON_TOKEN_KEY)
+            {
+                return false;
+            }
+
+            MemberInfo *member = type->findMember(reader.getString());
+            MethodInfo *setter = NULL;
+
+            if (member && member->isProperty())
+            {
+                setter = ((PropertyInfo *)member)->getSetMethod();
+            }
+
+            if (!member || member->isStatic() || (!member->isField() && !setter))
+            {
+                reader.skip();
+
+                if (reader.getToken() == JSON_TOKEN_ERROR)
+                {
+                    return false;
+                }
+
+                continue;
+            }
+
+            if (!decodeValue(reader.next(), member->getType(), member->getTemplateInfo(), &valueType))
+            {
+                return false;
+            }
+
+            if (!fits(member->getType(), valueType))
+            {
+                lua_pop(L, 1);
+                continue;
+            }
+
+            if (setter)
+            {
+                // instance methods are fetched bound, see MethodInfo::_invokeSingle
+                lua_pushnumber(L, setter->getOrdinal());
+                lua_gettable(L, instanceIdx);
+                lua_insert(L, -2);
+                lua_call(L, 1, 0);
+            }
+            else
+            {
+                lua_pushnumber(L, member->getOrdinal());
+                lua_insert(L, -2);
+                lua_settable(L, instanceIdx);
+            }
+        }
+
+        return true;
+    }
+
+    // decodes the loaded document leaving the result, or null on error, on the stack
+    void run(Type *type, const char *source)
+    {
+        int  top = lua_gettop(L);
+        Type *valueType;
+
+        if (!decodeValue(reader.next(), type, NULL, &valueType) || (reader.next() != JSON_TOKEN_END))
+        {
+            const char *error = reader.getToken() == JSON_TOKEN_ERROR ? reader.getError() : "unexpected token";
+            lmLogError(gJSONLogGroup, "Unable to decode JSON %s: %s", source, error);
+
+            lua_settop(L, top);
+            lua_pushnil(L);
+        }
+    }
+
+public:
+
+    static int decode(lua_State *L)
+    {
+        size_t     length;
+        const char *json = lua_tolstring(L, 1, &length);
+        Type       *type = lua_isnil(L, 2) ? NULL : (Type *)lualoom_getnativepointer(L, 2);
+
+        JSONDecoder decoder(L);
+
+        // the string stays at index 1 while the reader borrows it
+        decoder.reader.loadBuffer(json, json ? (int)length : 0);
+        decoder.run(type, "string");
+
+        return 1;
+    }
+
+    static int decodeFile(lua_State *L)
+    {
+        const char *path = lua_tostring(L, 1);
+        Type       *type = lua_isnil(L, 2) ? NULL : (Type *)lualoom_getnativepointer(L, 2);
+
+        JSONDecoder decoder(L);
+
+        if (!decoder.reader.loadFile(path))
+        {
+            lmLogError(gJSONLogGroup, "Unable to open JSON file '%s'", path ? path : "");
+            lua_pushnil(L);
+            return 1;
+        }
+
+        decoder.run(type, path);
+
+        return 1;
+    }
+};
+
 
 static int registerSystemJSON(lua_State *L)
 {
@@ -81,7 +391,32 @@ static int registerSystemJSON(lua_State *L)
        .addMethod("getArrayArray", &JSON::getArrayArrayNew)
        .addMethod("setArrayArray", &JSON::setArrayArray)
 
+       .addStaticLuaFunction("decode", &JSONDecoder::decode)
+       .addStaticLuaFunction("decodeFile", &JSONDecoder::decodeFile)
+
+       .endClass()
+       .endPackage();
+
+    return 0;
+}
 
+
+static int registerSystemJSONReader(lua_State *L)
+{
+    beginPackage(L, "system")
+
+       .beginClass<JSONReader> ("JSONReader")
+       .addConstructor<void (*)(void)>()
+       .addMethod("loadString", &JSONReader::loadString)
+       .addMethod("loadFile", &JSONReader::loadFile)
+       .addMethod("next", &JSONReader::next)
+       .addMethod("skip", &JSONReader::skip)
+       .addMethod("getError", &JSONReader::getError)
+       .addProperty("token", &JSONReader::getToken)
+       .addProperty("depth", &JSONReader::getDepth)
+       .addProperty("stringValue", &JSONReader::getString)
+       .addProperty("numberValue", &JSONReader::getNumber)
+       .addProperty("booleanValue", &JSONReader::getBoolean)
        .endClass()
        .endPackage();
 
@@ -92,4 +427,5 @@ static int registerSystemJSON(lua_State *L)
 void installSystemJSON()
 {
     NativeInterface::registerManagedNativeType<JSON>(registerSystemJSON);
+    NativeInterface::registerNativeType<JSONReader>(registerSystemJSONReader);
 }
@@ -37,6 +37,7 @@ void installSystemDate();
 void installSystemRandom();
 void installSystemObject();
 void installSystemString();
+void installSystemStringBuilder();
 void installSystemNumber();
 void installSystemVector();
 void installSystemVM();
@@ -81,6 +82,7 @@ void installPackageSystem()
 
     installSystemBaseDelegate();
     installSystemByteArray();
+    installSystemStringBuilder();
     installSystemNativeDelegate();
     installSystemBootstrap();
     installSystemConsole();
@@ -0,0 +1,201 @@
+/*
+ * ===========================================================================
+ * Loom SDK
+ * Copyright 2011, 2012, 2013
+ * The Game Engine Company, LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ * ===========================================================================
+ */
+
+#include <string.h>
+
+#include "loom/common/core/allocator.h"
+#include "loom/script/loomscript.h"
+#include "loom/script/runtime/lsRuntime.h"
+
+/**
+ * Native side of system.StringBuilder. Appends go into a single buffer
+ * that doubles as it fills, so building a string of n characters is O(n)
+ * and only the final toString() creates a Lua string.
+ */
+class StringBuilder
+{
+protected:
+
+    char *buffer;
+    int  size;
+    int  capacity;
+
+    void ensureCapacity(int required)
+    {
+        if (required <= capacity)
+        {
+            return;
+        }
+
+        int newCapacity = capacity ? capacity : 64;
+        while (newCapacity < required)
+        {
+            newCapacity *= 2;
+        }
+
+        buffer   = (char *)lmRealloc(NULL, buffer, newCapacity);
+        capacity = newCapacity;
+    }
+
+    // Make room for count bytes at offset, moving the tail up.
+    char *open(int offset, int count)
+    {
+        ensureCapacity(size + count);
+
+        if (offset < size)
+        {
+            memmove(buffer + offset + count, buffer + offset, size - offset);
+        }
+
+        size += count;
+
+        return buffer + offset;
+    }
+
+    // Converts the value at index the way string concatenation in script
+    // would, numbers use Lua's formatting and objects their toString.
+    static const char *toChars(lua_State *L, int index, size_t *length)
+    {
+        switch (lua_type(L, index))
+        {
+        case LUA_TSTRING:
+        case LUA_TNUMBER:
+            return lua_tolstring(L, index, length);
+
+        case LUA_TNIL:
+            *length = 4;
+            return "null";
+
+        case LUA_TBOOLEAN:
+            *length = lua_toboolean(L, index) ? 4 : 5;
+            return lua_toboolean(L, index) ? "true" : "false";
+        }
+
+        const char *value = lsr_objecttostring(L, index);
+        *length = value ? strlen(value) : 0;
+        return value;
+    }
+
+    void insertValue(lua_State *L, int offset, int index)
+    {
+        size_t     length;
+        const char *value = toChars(L, index, &length);
+
+        if (length)
+        {
+            memcpy(open(offset, (int)length), value, length);
+        }
+    }
+
+public:
+
+    StringBuilder() : buffer(NULL), size(0), capacity(0)
+    {
+    }
+
+    ~StringBuilder()
+    {
+        lmFree(NULL, buffer);
+    }
+
+    int getLength() const
+    {
+        return size;
+    }
+
+    void reserve(int bytes)
+    {
+        ensureCapacity(bytes);
+    }
+
+    void clear()
+    {
+        size = 0;
+    }
+
+    int append(lua_State *L)
+    {
+        insertValue(L, size, 2);
+
+        lua_settop(L, 1);
+        return 1;
+    }
+
+    int appendChar(lua_State *L)
+    {
+        *open(size, 1) = (char)lua_tonumber(L, 2);
+
+        lua_settop(L, 1);
+        return 1;
+    }
+
+    int insert(lua_State *L)
+    {
+        int offset = (int)lua_tonumber(L, 2);
+
+        if (offset < 0)
+        {
+            offset = 0;
+        }
+        else if (offset > size)
+        {
+            offset = size;
+        }
+
+        insertValue(L, offset, 3);
+
+        lua_settop(L, 1);
+        return 1;
+    }
+
+    int toString(lua_State *L)
+    {
+        lua_pushlstring(L, buffer ? buffer : "", size);
+        return 1;
+    }
+};
+
+static int registerSystemStringBuilder(lua_State *L)
+{
+    beginPackage(L, "system")
+
+       .beginClass<StringBuilder> ("StringBuilder")
+
+       .addConstructor<void (*)(void)>()
+       .addProperty("length", &StringBuilder::getLength)
+       .addMethod("reserve", &StringBuilder::reserve)
+       .addMethod("clear", &StringBuilder::clear)
+       .addLuaFunction("append", &StringBuilder::append)
+       .addLuaFunction("appendChar", &StringBuilder::appendChar)
+       .addLuaFunction("insert", &StringBuilder::insert)
+       .addLuaFunction("toString", &StringBuilder::toString)
+
+       .endClass()
+
+       .endPackage();
+
+    return 0;
+}
+
+
+void installSystemStringBuilder()
+{
+    NativeInterface::registerNativeType<StringBuilder>(registerSystemStringBuilder);
+}
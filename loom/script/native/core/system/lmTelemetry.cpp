@@ -32,6 +32,9 @@ int registerSystemTelemetry(lua_State *L)
            .addStaticMethod("enable", &Telemetry::enable)
            .addStaticMethod("disable", &Telemetry::disable)
            .addStaticMethod("isEnabled", &Telemetry::isEnabled)
+           .addStaticMethod("startTrace", &Telemetry::startTrace)
+           .addStaticMethod("stopTrace", &Telemetry::stopTrace)
+           .addStaticMethod("isTracing", &Telemetry::isTracing)
        .endClass()
     .endPackage();
 
@@ -40,6 +40,13 @@ static int registerSystemVM(lua_State *L)
        .addMethod("getStackSize", &LSLuaState::getStackSize)
 
        .addStaticMethod("isJIT", &LSLuaState::isJIT)
+       .addStaticMethod("getJITEnabled", &LSLuaState::getJITEnabled)
+
+       .addMethod("getJITTracesStarted", &LSLuaState::getJITTracesStarted)
+       .addMethod("getJITTracesCompiled", &LSLuaState::getJITTracesCompiled)
+       .addMethod("getJITTracesAborted", &LSLuaState::getJITTracesAborted)
+       .addMethod("getJITFlushes", &LSLuaState::getJITFlushes)
+       .addMethod("resetJITStats", &LSLuaState::resetJITStats)
 
        .addStaticMethod("getExecutingVM", &LSLuaState::getExecutingVM)
 
@@ -21,6 +21,20 @@
 #include "loom/script/loomscript.h"
 #include "loom/script/runtime/lsRuntime.h"
 
+#ifdef LOOM_ENABLE_JIT
+extern "C" {
+#include "lj_tab.h"
+}
+
+// LuaJIT keeps a table's array part (including slot 0) as one contiguous
+// TValue array and, unless built in dual number mode, stores Numbers in it
+// unboxed. A dense Vector.<Number> is therefore already a lua_Number array
+// which native code can borrow directly.
+#if !LJ_DUALNUM
+#define LSVECTOR_CONTIGUOUS_NUMBERS    1
+#endif
+#endif
+
 using namespace LS;
 
 /**
@@ -112,10 +126,23 @@ static int lsr_vectorinternal_newindex(lua_State *L)
     return 0;
 }
 
-// creates the internal vector used by a Vector.<T> instance
-static void lsr_create_internal_vector(lua_State *L)
+#ifdef LOOM_ENABLE_JIT
+// gets the internal vector table of the Vector at (absolute) index, it stays
+// referenced by the Vector so there is no need to keep it on the stack
+static GCtab *lsr_get_internal_vector(lua_State *L, int index)
 {
-    lua_newtable(L);
+    lua_rawgeti(L, index, LSINDEXVECTOR);
+    GCtab *t = (GCtab *)lua_topointer(L, -1);
+    lua_pop(L, 1);
+    return t;
+}
+#endif
+
+// creates the internal vector used by a Vector.<T> instance, with room
+// for narray elements in the table's array part
+static void lsr_create_internal_vector(lua_State *L, int narray = 0)
+{
+    lua_createtable(L, narray > 0 ? narray : 0, 1);
 
     luaL_getmetatable(L, LSVECTORINTERNAL);
     lua_setmetatable(L, -2);
@@ -151,7 +178,7 @@ public:
 
     static int initialize(lua_State *L)
     {
-        lsr_create_internal_vector(L);
+        lsr_create_internal_vector(L, (int) lua_tonumber(L, 2));
         lua_rawseti(L, 1, LSINDEXVECTOR);        
         lua_pushboolean(L, 0);
         lua_rawseti(L, 1, LSINDEXVECTORFIXED);
@@ -221,7 +248,7 @@ public:
         lua_pushnumber(L, 0);
         lua_gettable(L, -2);
 
-        lsr_create_internal_vector(L);
+        lsr_create_internal_vector(L, length - 1);
 
         int nidx = lua_gettop(L);
 
@@ -401,6 +428,15 @@ public:
 
         int fromLength = lsr_vector_get_length(L, fromIdx);
 
+        // Number vectors are copied in bulk
+        const lua_Number *numbers = lsr_vector_borrow_numbers(L, fromIdx, NULL);
+        if (numbers)
+        {
+            lsr_vector_write_numbers(L, toIdx, toLength, numbers, fromLength);
+            lua_settop(L, top);
+            return;
+        }
+
         lua_rawgeti(L, toIdx, LSINDEXVECTOR);
         int toTableIdx = lua_gettop(L);
         lua_rawgeti(L, fromIdx, LSINDEXVECTOR);
@@ -684,6 +720,17 @@ public:
             endIndex = srcVectorLength;
         }
 
+        // Number vectors are copied in bulk
+        const lua_Number *numbers = lsr_vector_borrow_numbers(L, 1, NULL);
+        if (numbers)
+        {
+            lsr_vector_write_numbers(L, newVectorIdx, 0, numbers + startIndex, endIndex - startIndex);
+
+            lmAssert(lua_gettop(L) == top + 1, "lua stack unaligned after Vector slice");
+
+            return 1;
+        }
+
         // bring in the source Vector's table
         lua_rawgeti(L, 1, LSINDEXVECTOR);
         int srcTableIdx = lua_gettop(L);
@@ -714,230 +761,479 @@ public:
         return 1;
     }
 
-    // static state variables for access in qsort
-
-    // the lua_State we're sorting in
-    static lua_State *_sortState;
-    // the vector table we're sorting
-    static int _sortVectorIdx;
-    // the length of the vector table
-    static int _sortVectorLength;
-    // current sort flags (for default sort only)
-    static int _sortFlags;
-    // whether we're aborting sort on UNIQUESORT flag
-    static bool _sortUniqueAbort;
-    // if we're using a sort Function instead of numeric/string sort
-    static bool _sortFunction;
-
-    // internal (qsort) function
-    static int internalsort(const void *pidx1, const void *pidx2)
+    // Sort keys extracted once from the elements of a vector, so sorting
+    // never has to go back to the Lua table
+    struct SortKeys
     {
-        static char sbuffer1[1024];
-        static char sbuffer2[1024];
+        bool                 numeric;
+        utArray<double>      numbers;
+        utArray<const char*> strings;
 
-        int idx1 = *((int *)pidx1);
-        int idx2 = *((int *)pidx2);
+        // holds numbers formatted for string sorts
+        utArray<char>        pool;
+    };
 
-        lua_State *L = _sortState;
+    // Gets the sort key of each element, either the element itself or the
+    // named member of it. Values are read the same way the old comparator
+    // did: numbers (and numeric strings) format with %f for string sorts,
+    // other types sort as 0 or the empty string.
+    static void extractSortKeys(lua_State *L, int tableIdx, int length, int flags, const char *field, SortKeys& keys)
+    {
+        keys.numeric = (flags & NUMERIC) != 0;
 
-        if (_sortFunction)
+        if (keys.numeric)
+        {
+            keys.numbers.resize(length);
+        }
+        else
         {
-            // we're using a sort function, so we need to
-            // setup args and call the sort function
+            keys.strings.resize(length);
+        }
 
-            lua_pushvalue(L, 2);
-            lua_rawgeti(L, _sortVectorIdx, idx1);
-            lua_rawgeti(L, _sortVectorIdx, idx2);
-            lua_call(L, 2, 1);
+        // member values may be computed by getters, keep them referenced
+        // while we hold pointers to their strings
+        int fieldValuesIdx = 0;
+        if (field)
+        {
+            lua_createtable(L, length, 0);
+            fieldValuesIdx = lua_gettop(L);
+        }
 
-            if (!lua_isnumber(L, -1))
+        utArray<int> poolOffsets;
+        char         buffer[1024];
+
+        for (int i = 0; i < length; i++)
+        {
+            lua_rawgeti(L, tableIdx, i);
+
+            if (field)
             {
-                lua_pushstring(L, "Vector.sort compare function did not return a number");
-                lua_error(L);
+                if (lua_istable(L, -1))
+                {
+                    lualoom_getmember(L, -1, field);
+                    lua_remove(L, -2);
+                }
+                else
+                {
+                    lua_pop(L, 1);
+                    lua_pushnil(L);
+                }
+
+                lua_pushvalue(L, -1);
+                lua_rawseti(L, fieldValuesIdx, i + 1);
+            }
+
+            // please note, we MUST check number first as lua automatically converts numbers to strings :/
+            if (lua_isnumber(L, -1))
+            {
+                double d = lua_tonumber(L, -1);
+
+                if (keys.numeric)
+                {
+                    keys.numbers[i] = d;
+                }
+                else
+                {
+                    int n = snprintf(buffer, sizeof(buffer), "%f", d);
+                    if ((n < 0) || (n >= (int)sizeof(buffer)))
+                    {
+                        n = (int)sizeof(buffer) - 1;
+                    }
+
+                    poolOffsets.push_back(i);
+                    poolOffsets.push_back((int)keys.pool.size());
+
+                    for (int c = 0; c < n; c++)
+                    {
+                        keys.pool.push_back(buffer[c]);
+                    }
+
+                    keys.pool.push_back(0);
+                    keys.strings[i] = NULL;
+                }
+            }
+            else if (keys.numeric)
+            {
+                keys.numbers[i] = 0;
+            }
+            else
+            {
+                keys.strings[i] = lua_isstring(L, -1) ? lua_tostring(L, -1) : "";
             }
 
-            int rval = (int)lua_tonumber(L, -1);
             lua_pop(L, 1);
-            return rval;
         }
 
-        // convert to string/number generic objects are undefined and should use a script sorting function
+        // the pool is complete, so its storage won't move any more
+        for (UTsize i = 0; i < poolOffsets.size(); i += 2)
+        {
+            keys.strings[poolOffsets[i]] = keys.pool.ptr() + poolOffsets[i + 1];
+        }
 
-        const char *s1 = "";
-        const char *s2 = "";
+        // fieldValuesIdx stays on the stack until the caller is done with the keys
+    }
 
-        double d1 = 0;
-        double d2 = 0;
+    // Stable LSD radix sort of element indices by Number key, a byte per
+    // pass, skipping passes where every key has the same byte.
+    static void radixSortNumbers(const double *numbers, int length, bool descending, int *indices)
+    {
+        utArray<unsigned long long> keys;
+        keys.resize(length);
 
-        lua_rawgeti(L, _sortVectorIdx, idx1);
+        UTsize counts[8][256];
+        memset(counts, 0, sizeof(counts));
 
-        // please note, we MUST check string first as lua automatically converts numbers to strings :/
-        if (lua_isnumber(L, -1))
+        for (int i = 0; i < length; i++)
         {
-            d1 = lua_tonumber(L, -1);
-            if (!(_sortFlags & NUMERIC))
+            // map the double onto an unsigned integer with the same ordering
+            unsigned long long u;
+            memcpy(&u, &numbers[i], sizeof(u));
+            u = (u & 0x8000000000000000ULL) ? ~u : (u | 0x8000000000000000ULL);
+
+            if (descending)
             {
-                snprintf(sbuffer1, 1024, "%f", d1);
-                s1 = sbuffer1;
+                u = ~u;
             }
+
+            keys[i] = u;
+
+            for (int b = 0; b < 8; b++)
+            {
+                counts[b][(u >> (b * 8)) & 0xFF]++;
+            }
+
+            indices[i] = i;
         }
-        else if (lua_isstring(L, -1))
+
+        if (length < 2)
         {
-            s1 = lua_tostring(L, -1);
+            return;
         }
 
-        lua_pop(L, 1);
+        utArray<int> scratch;
+        scratch.resize(length);
 
-        lua_rawgeti(L, _sortVectorIdx, idx2);
+        int *src = indices;
+        int *dst = scratch.ptr();
 
-        if (lua_isnumber(L, -1))
+        for (int b = 0; b < 8; b++)
         {
-            d2 = lua_tonumber(L, -1);
-            if (!(_sortFlags & NUMERIC))
+            int shift = b * 8;
+
+            if (counts[b][(keys[0] >> shift) & 0xFF] == (UTsize)length)
             {
-                snprintf(sbuffer2, 1024, "%f", d2);
-                s2 = sbuffer2;
+                continue;
             }
+
+            UTsize offsets[256];
+            UTsize total = 0;
+            for (int j = 0; j < 256; j++)
+            {
+                offsets[j] = total;
+                total     += counts[b][j];
+            }
+
+            for (int i = 0; i < length; i++)
+            {
+                int idx = src[i];
+                dst[offsets[(keys[idx] >> shift) & 0xFF]++] = idx;
+            }
+
+            int *tmp = src;
+            src = dst;
+            dst = tmp;
         }
-        else if (lua_isstring(L, -1))
+
+        if (src != indices)
         {
-            s2 = lua_tostring(L, -1);
+            memcpy(indices, src, sizeof(int) * length);
         }
+    }
 
-        lua_pop(L, 1);
+    // compares extracted string keys
+    struct StringCompare
+    {
+        const char **strings;
+        bool       caseInsensitive;
+        bool       descending;
+
+        int operator()(int idx1, int idx2) const
+        {
+            int val = caseInsensitive ? strcasecmp(strings[idx1], strings[idx2]) : strcmp(strings[idx1], strings[idx2]);
+            return descending ? -val : val;
+        }
+    };
 
-        bool descending = _sortFlags & DESCENDING ? true : false;
+    // compares elements with a script sort Function
+    struct FunctionCompare
+    {
+        lua_State *L;
+        int       functionIdx;
+        int       tableIdx;
 
-        if (_sortFlags & NUMERIC)
+        int operator()(int idx1, int idx2) const
         {
-            if (d1 < d2)
-            {
-                return descending ? 1 : -1;
-            }
+            lua_pushvalue(L, functionIdx);
+            lua_rawgeti(L, tableIdx, idx1);
+            lua_rawgeti(L, tableIdx, idx2);
+            lua_call(L, 2, 1);
 
-            if (d1 > d2)
+            if (!lua_isnumber(L, -1))
             {
-                return descending ? -1 : 1;
+                lua_pushstring(L, "Vector.sort compare function did not return a number");
+                lua_error(L);
             }
 
+            int rval = (int)lua_tonumber(L, -1);
+            lua_pop(L, 1);
+            return rval;
+        }
+    };
 
-            if (_sortFlags & UNIQUESORT)
-            {
-                _sortUniqueAbort = true;
-            }
+    // Stable bottom up merge sort of element indices.
+    template<typename Compare>
+    static void mergeSort(int *indices, int length, const Compare& compare)
+    {
+        for (int i = 0; i < length; i++)
+        {
+            indices[i] = i;
+        }
 
-            return 0;
+        if (length < 2)
+        {
+            return;
         }
 
-        int val = 0;
+        utArray<int> scratch;
+        scratch.resize(length);
 
-        if (_sortFlags & CASEINSENSITIVE)
+        int *src = indices;
+        int *dst = scratch.ptr();
+
+        for (int width = 1; width < length; width *= 2)
         {
-            val = descending ? -strcasecmp(s1, s2) : strcasecmp(s1, s2);
+            for (int lo = 0; lo < length; lo += 2 * width)
+            {
+                int mid = lo + width < length ? lo + width : length;
+                int hi  = lo + 2 * width < length ? lo + 2 * width : length;
+
+                int a = lo, b = mid, out = lo;
+
+                while (a < mid && b < hi)
+                {
+                    // only take from the right run when strictly smaller
+                    if (compare(src[b], src[a]) < 0)
+                    {
+                        dst[out++] = src[b++];
+                    }
+                    else
+                    {
+                        dst[out++] = src[a++];
+                    }
+                }
+
+                while (a < mid)
+                {
+                    dst[out++] = src[a++];
+                }
+
+                while (b < hi)
+                {
+                    dst[out++] = src[b++];
+                }
+            }
+
+            int *tmp = src;
+            src = dst;
+            dst = tmp;
         }
-        else
+
+        if (src != indices)
         {
-            val = descending ? -strcmp(s1, s2) : strcmp(s1, s2);
+            memcpy(indices, src, sizeof(int) * length);
         }
+    }
 
-        if (!val && (_sortFlags & UNIQUESORT))
+    // true if any two neighbouring elements in sorted order have equal keys
+    static bool hasDuplicateKeys(const SortKeys& keys, int flags, const int *indices, int length)
+    {
+        for (int i = 1; i < length; i++)
         {
-            _sortUniqueAbort = true;
+            int idx1 = indices[i - 1];
+            int idx2 = indices[i];
+
+            if (keys.numeric)
+            {
+                if (keys.numbers[idx1] == keys.numbers[idx2])
+                {
+                    return true;
+                }
+            }
+            else
+            {
+                const char *s1 = keys.strings[idx1];
+                const char *s2 = keys.strings[idx2];
+
+                if (!((flags & CASEINSENSITIVE) ? strcasecmp(s1, s2) : strcmp(s1, s2)))
+                {
+                    return true;
+                }
+            }
         }
 
-        return val;
+        return false;
     }
 
-    static int sort(lua_State *L)
+    // Sorts the vector at index 1 with either the sort flags at flagsIdx or
+    // a sort Function, keying elements on field when not NULL.
+    static int sortInternal(lua_State *L, int flagsIdx, const char *field)
     {
-        _sortState = L;
-
-        _sortVectorLength = lsr_vector_get_length(L, 1);
+        int length = lsr_vector_get_length(L, 1);
 
         lua_rawgeti(L, 1, LSINDEXVECTOR);
-        _sortVectorIdx = lua_absindex(L, -1);
+        int tableIdx = lua_gettop(L);
 
-        _sortFlags    = 0;
-        _sortFunction = false;
-        if (lua_isnumber(L, 2))
+        int  flags       = 0;
+        bool useFunction = false;
+        if (lua_isnumber(L, flagsIdx))
         {
-            _sortFlags = (int)lua_tonumber(L, 2);
+            flags = (int)lua_tonumber(L, flagsIdx);
         }
-        else if (lua_isfunction(L, 2) || lua_iscfunction(L, 2))
+        else if (!field && (lua_isfunction(L, flagsIdx) || lua_iscfunction(L, flagsIdx)))
         {
-            _sortFunction = true;
+            useFunction = true;
         }
-        else
+        else if (!field || !lua_isnil(L, flagsIdx))
         {
             lmAssert(0, "INTERNAL ERROR: unknown parameter type to Vector.sort");
         }
 
-        _sortUniqueAbort = false;
-
-        int *indices = new int[_sortVectorLength];
+        utArray<int> indices;
+        indices.resize(length);
 
-        for (int i = 0; i < _sortVectorLength; i++)
+        if (useFunction)
         {
-            indices[i] = i;
+            FunctionCompare compare;
+            compare.L           = L;
+            compare.functionIdx = flagsIdx;
+            compare.tableIdx    = tableIdx;
+            mergeSort(indices.ptr(), length, compare);
         }
+        else
+        {
+            SortKeys keys;
 
-        qsort(indices, _sortVectorLength, sizeof(int), internalsort);
+            // Number vectors already hold their keys contiguously
+            const lua_Number *numbers = NULL;
+            if (!field && (flags & NUMERIC))
+            {
+                numbers = lsr_vector_borrow_numbers(L, 1, NULL);
+            }
 
-        if (_sortUniqueAbort)
-        {
-            lua_pushnumber(L, 0);
-            delete [] indices;
-            return 1;
-        }
+            if (numbers)
+            {
+                keys.numeric = true;
+                keys.numbers.resize(length);
+                memcpy(keys.numbers.ptr(), numbers, sizeof(double) * length);
+            }
+            else
+            {
+                extractSortKeys(L, tableIdx, length, flags, field, keys);
+            }
 
-        // create new table to hold the result
-        lsr_create_internal_vector(L);
+            if (keys.numeric)
+            {
+                radixSortNumbers(keys.numbers.ptr(), length, (flags & DESCENDING) != 0, indices.ptr());
+            }
+            else
+            {
+                StringCompare compare;
+                compare.strings         = keys.strings.ptr();
+                compare.caseInsensitive = (flags & CASEINSENSITIVE) != 0;
+                compare.descending      = (flags & DESCENDING) != 0;
+                mergeSort(indices.ptr(), length, compare);
+            }
+
+            if ((flags & UNIQUESORT) && hasDuplicateKeys(keys, flags, indices.ptr(), length))
+            {
+                lua_pushnumber(L, 0);
+                return 1;
+            }
+        }
 
-        if (_sortFlags & RETURNINDEXEDARRAY)
+        if (flags & RETURNINDEXEDARRAY)
         {
             // populate index vector
-            for (int i = 0; i < _sortVectorLength; i++)
+            lsr_create_internal_vector(L, length);
+            for (int i = 0; i < length; i++)
             {
                 lua_pushnumber(L, indices[i]);
                 lua_rawseti(L, -2, i);
             }
 
-            Type *vectorType = LSLuaState::getLuaState(L)->getType("system.Vector");            
+            Type *vectorType = LSLuaState::getLuaState(L)->getType("system.Vector");
             lsr_createinstance(L, vectorType);
 
             lua_pushvalue(L, -2); // return the new vector table
             lua_rawseti(L, -2, LSINDEXVECTOR);
 
-            lsr_vector_set_length(L, -1, _sortVectorLength);
+            lsr_vector_set_length(L, -1, length);
 
-            delete [] indices;
+            return 1;
+        }
+
+        // Number vectors are permuted in place
+        const lua_Number *numbers = lsr_vector_borrow_numbers(L, 1, NULL);
+        if (numbers)
+        {
+            utArray<lua_Number> sorted;
+            sorted.resize(length);
+            for (int i = 0; i < length; i++)
+            {
+                sorted[i] = numbers[indices[i]];
+            }
+
+            lsr_vector_write_numbers(L, 1, 0, sorted.ptr(), length);
+
+            lua_pushvalue(L, 1);
             return 1;
         }
 
         // populate replacement vector
-        for (int i = 0; i < _sortVectorLength; i++)
+        lsr_create_internal_vector(L, length);
+        for (int i = 0; i < length; i++)
         {
-            lua_rawgeti(L, _sortVectorIdx, indices[i]);
+            lua_rawgeti(L, tableIdx, indices[i]);
             lua_rawseti(L, -2, i);
         }
 
         // replace vector table
         lua_rawseti(L, 1, LSINDEXVECTOR);
-        lsr_vector_set_length(L, 1, _sortVectorLength);
+        lsr_vector_set_length(L, 1, length);
 
         lua_pushvalue(L, 1); // return the existing vector table
-        delete [] indices;
 
         return 1;
     }
-};
 
-lua_State *LSVector::_sortState       = NULL;
-int       LSVector::_sortVectorIdx    = -1;
-int       LSVector::_sortVectorLength = -2;
-int       LSVector::_sortFlags        = 0;
-bool      LSVector::_sortUniqueAbort  = false;
-bool      LSVector::_sortFunction     = false;
+    static int sort(lua_State *L)
+    {
+        return sortInternal(L, 2, NULL);
+    }
+
+    static int sortOn(lua_State *L)
+    {
+        const char *field = lua_tostring(L, 2);
+
+        if (!field)
+        {
+            lua_pushstring(L, "Vector.sortOn requires a field name");
+            lua_error(L);
+        }
+
+        return sortInternal(L, 3, field);
+    }
+};
 
 namespace LS {
 
@@ -975,6 +1271,18 @@ void lsr_vector_set_length(lua_State *L, int index, int nlength)
             lua_pop(L, 1);
         }
 
+#ifdef LOOM_ENABLE_JIT
+        // make room in the array part up front so growing doesn't rehash
+        if (nlength > clength)
+        {
+            GCtab *t = lsr_get_internal_vector(L, index);
+            if (t->asize < (MSize)nlength)
+            {
+                lj_tab_reasize(L, t, nlength);
+            }
+        }
+#endif
+
         // set the new length
         lua_rawgeti(L, index, LSINDEXVECTOR);
         lua_pushnumber(L, nlength);
@@ -982,6 +1290,128 @@ void lsr_vector_set_length(lua_State *L, int index, int nlength)
         lua_pop(L, 1);    
 }
 
+lua_Number *lsr_vector_borrow_numbers(lua_State *L, int index, int *length)
+{
+    index = lua_absindex(L, index);
+
+    int vlength = lsr_vector_get_length(L, index);
+
+    if (length)
+    {
+        *length = vlength;
+    }
+
+#ifdef LSVECTOR_CONTIGUOUS_NUMBERS
+    GCtab *t = lsr_get_internal_vector(L, index);
+
+    // pull any elements living in the hash part into the array part
+    if (t->asize <= (MSize)vlength)
+    {
+        lj_tab_reasize(L, t, vlength);
+    }
+
+    TValue *array = tvref(t->array);
+
+    for (int i = 0; i < vlength; i++)
+    {
+        if (!tvisnum(&array[i]))
+        {
+            return NULL;
+        }
+    }
+
+    return (lua_Number *)array;
+#else
+    return NULL;
+#endif
+}
+
+void lsr_vector_write_numbers(lua_State *L, int index, int offset, const lua_Number *src, int count)
+{
+    index = lua_absindex(L, index);
+
+    if (count <= 0)
+    {
+        return;
+    }
+
+    if (offset + count > lsr_vector_get_length(L, index))
+    {
+        lsr_vector_set_length(L, index, offset + count);
+    }
+
+#ifdef LSVECTOR_CONTIGUOUS_NUMBERS
+    // lsr_vector_set_length has reserved the array part
+    GCtab *t = lsr_get_internal_vector(L, index);
+
+    if (t->asize < (MSize)(offset + count))
+    {
+        lj_tab_reasize(L, t, offset + count);
+    }
+
+    TValue *array = tvref(t->array) + offset;
+
+    for (int i = 0; i < count; i++)
+    {
+        // the VM expects NaNs in canonical form
+        if (src[i] != src[i])
+        {
+            setnanV(&array[i]);
+        }
+        else
+        {
+            setnumV(&array[i], src[i]);
+        }
+    }
+#else
+    lua_rawgeti(L, index, LSINDEXVECTOR);
+
+    for (int i = 0; i < count; i++)
+    {
+        lua_pushnumber(L, src[i]);
+        lua_rawseti(L, -2, offset + i);
+    }
+
+    lua_pop(L, 1);
+#endif
+}
+
+int lsr_vector_read_floats(lua_State *L, int index, float *dst, int count)
+{
+    index = lua_absindex(L, index);
+
+    int length;
+    const lua_Number *numbers = lsr_vector_borrow_numbers(L, index, &length);
+
+    if (count > length)
+    {
+        count = length;
+    }
+
+    if (numbers)
+    {
+        for (int i = 0; i < count; i++)
+        {
+            dst[i] = (float)numbers[i];
+        }
+
+        return count;
+    }
+
+    lua_rawgeti(L, index, LSINDEXVECTOR);
+
+    for (int i = 0; i < count; i++)
+    {
+        lua_rawgeti(L, -1, i);
+        dst[i] = (float)lua_tonumber(L, -1);
+        lua_pop(L, 1);
+    }
+
+    lua_pop(L, 1);
+
+    return count;
+}
+
 }
 
 
@@ -1016,6 +1446,7 @@ static int registerSystemVector(lua_State *L)
        .addStaticLuaFunction("slice", &LSVector::slice)
        .addStaticLuaFunction("indexOf", &LSVector::indexOf)
        .addStaticLuaFunction("sort", &LSVector::sort)
+       .addStaticLuaFunction("sortOn", &LSVector::sortOn)
 
        .endClass()
 
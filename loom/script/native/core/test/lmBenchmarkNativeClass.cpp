@@ -43,6 +43,12 @@ public:
         return _rotation;
     }
 
+    // returns this, so script measures the cost of pushing a managed native
+    BenchmarkNativeClass *getSelf()
+    {
+        return this;
+    }
+
     float _x;
     float _y;
     float _rotation;
@@ -62,6 +68,8 @@ static int registerBenchmarkNativeClass(lua_State *L)
        .addProperty("y", &BenchmarkNativeClass::getPositionY, &BenchmarkNativeClass::setPositionY)
        .addProperty("rotation", &BenchmarkNativeClass::getRotation, &BenchmarkNativeClass::setRotation)
 
+       .addMethod("getSelf", &BenchmarkNativeClass::getSelf)
+
        .endClass()
 
        .endPackage();
@@ -46,6 +46,14 @@ public:
         return child;
     }
 
+    // returns the script instance the bridge passes as self, which it looks
+    // up for the native rather than taking it from the caller
+    int getScriptSelf(lua_State *L)
+    {
+        lua_pushvalue(L, 1);
+        return 1;
+    }
+
     static void addInstance(MyManagedNativeClass *instance)
     {
         nativeInstances.push_back(instance);
@@ -83,6 +91,17 @@ public:
         lmDelete(NULL, instance);
     }
 
+    // destroys instance and constructs a new one in the same memory, so
+    // script is handed a new managed native at an address it has seen
+    static MyManagedNativeClass *recycleNativeInstance(MyManagedNativeClass *instance)
+    {
+        instance->~MyManagedNativeClass();
+
+        instance = new (instance) MyManagedNativeClass();
+        instance->stringField = "recycled";
+        return instance;
+    }
+
     const char *getDescString(int number)
     {
         static char text[1024];
@@ -180,12 +199,14 @@ static int registerNative(lua_State *L)
        .addMethod("getDescString", (const char * (MyManagedNativeClass::*)(int)) & MyManagedNativeClass::getDescString)
        .addMethod("getDescStringBool", (const char * (MyManagedNativeClass::*)(bool)) & MyManagedNativeClass::getDescString)
        .addMethod("getChild", &MyManagedNativeClass::getChild)
+       .addLuaFunction("getScriptSelf", &MyManagedNativeClass::getScriptSelf)
        .addStaticMethod("addInstance", &MyManagedNativeClass::addInstance)
        .addStaticMethod("getInstance", &MyManagedNativeClass::getInstance)
        .addStaticMethod("getNumInstances", &MyManagedNativeClass::getNumInstances)
        .addStaticMethod("deleteRandomInstance", &MyManagedNativeClass::deleteRandomInstance)
        .addStaticMethod("createdNativeInstance", &MyManagedNativeClass::createdNativeInstance)
        .addStaticMethod("deleteNativeInstance", &MyManagedNativeClass::deleteNativeInstance)
+       .addStaticMethod("recycleNativeInstance", &MyManagedNativeClass::recycleNativeInstance)
 
        .endClass()
 
@@ -38,6 +38,8 @@ utHashTable<utPointerHashKey, NativeTypeBase *> NativeInterface::scriptToNative;
 
 utHashTable<utPointerHashKey, lua_State *> NativeInterface::handleEntryToLuaState;
 
+utHashTable<utPointerHashKey, NativeInterface::ManagedScriptRef> NativeInterface::handleEntryToScriptRef;
+
 // Checks that the native managed type being deleted isn't still in use
 // by script. See `lualoom_managedpointerreleased` for more info.
 //
@@ -181,6 +183,21 @@ void NativeInterface::shutdownLuaState(lua_State *L)
         handleEntryToLuaState.remove(entries.at(i));
     }
 
+    // the registry goes away with the VM, so just drop the references
+    entries.clear();
+    for (UTsize i = 0; i < handleEntryToScriptRef.size(); i++)
+    {
+        if (handleEntryToScriptRef.at(i).vm == L)
+        {
+            entries.push_back(handleEntryToScriptRef.keyAt(i));
+        }
+    }
+
+    for (UTsize i = 0; i < entries.size(); i++)
+    {
+        handleEntryToScriptRef.remove(entries.at(i));
+    }
+
     //TODO: LOOM-708, improve vm shutdown
     scriptTypes.clear();
     scriptToNative.clear();
@@ -294,6 +311,47 @@ void NativeInterface::dumpManagedNatives(lua_State *L)
     }
 }
 
+void NativeInterface::cacheManagedScriptRef(lua_State *L, void *ptr, int instanceIdx)
+{
+    lua_State *vm = LSLuaState::getLuaState(L)->VM();
+
+    // release any stale reference from a previous wrap of this entry
+    ManagedScriptRef *scriptRef = handleEntryToScriptRef.get(ptr);
+    if (scriptRef)
+    {
+        if (scriptRef->vm == vm)
+        {
+            luaL_unref(L, LUA_REGISTRYINDEX, scriptRef->ref);
+        }
+
+        handleEntryToScriptRef.remove(ptr);
+    }
+
+    ManagedScriptRef newRef;
+    newRef.vm = vm;
+
+    lua_pushvalue(L, instanceIdx);
+    newRef.ref = luaL_ref(L, LUA_REGISTRYINDEX);
+
+    handleEntryToScriptRef.insert(ptr, newRef);
+}
+
+
+bool NativeInterface::pushCachedManagedScriptRef(lua_State *L, void *ptr)
+{
+    ManagedScriptRef *scriptRef = handleEntryToScriptRef.get(ptr);
+
+    if (!scriptRef || (scriptRef->vm != LSLuaState::getLuaState(L)->VM()))
+    {
+        return false;
+    }
+
+    lua_rawgeti(L, LUA_REGISTRYINDEX, scriptRef->ref);
+
+    return true;
+}
+
+
 void NativeInterface::managedPointerReleased(void* entry, int version)
 {
     lua_State **statePtr = handleEntryToLuaState.get(entry);
@@ -302,6 +360,15 @@ void NativeInterface::managedPointerReleased(void* entry, int version)
 
     lua_State *L = *statePtr;
 
+    // drop the cached script instance so a new object at this address is
+    // wrapped afresh
+    ManagedScriptRef *scriptRef = handleEntryToScriptRef.get(entry);
+    if (scriptRef)
+    {
+        luaL_unref(L, LUA_REGISTRYINDEX, scriptRef->ref);
+        handleEntryToScriptRef.remove(entry);
+    }
+
     lua_rawgeti(L, LUA_GLOBALSINDEX, LSINDEXMANAGEDVERSION);
 
     lua_pushlightuserdata(L, entry);
@@ -303,6 +303,29 @@ public:
     // void* -> LSLuaState
     static utHashTable<utPointerHashKey, lua_State *> handleEntryToLuaState;
 
+    // Registry reference to the script instance wrapping a managed native,
+    // vm is the main thread of the owning VM
+    struct ManagedScriptRef
+    {
+        lua_State *vm;
+        int       ref;
+    };
+
+    // void* -> ManagedScriptRef
+    static utHashTable<utPointerHashKey, ManagedScriptRef> handleEntryToScriptRef;
+
+    /*
+     * Store a registry reference to the script instance at instanceIdx so
+     * later pushes of ptr are a single lua_rawgeti
+     */
+    static void cacheManagedScriptRef(lua_State *L, void *ptr, int instanceIdx);
+
+    /*
+     * Push the cached script instance for ptr, returns false if ptr has no
+     * cached instance in L's VM
+     */
+    static bool pushCachedManagedScriptRef(lua_State *L, void *ptr);
+
     /*
      * Store the managed native user data on the top of the stack
      * to the entry->version and entry->userdata global lookup table
@@ -359,6 +382,8 @@ public:
         lua_pushvalue(L, instanceIdx);
         lua_settable(L, -3);
 
+        cacheManagedScriptRef(L, ptr, instanceIdx);
+
         // If we're in a constructor we are being explicitly initialized in script with a new
         // the object initializer chain will be automatically called in this case
         // otherwise, we're handing back a C++ created instance to script and need to
@@ -576,6 +601,12 @@ public:
     {
         lmAssert(nativeType->isManaged(), "pushManagedNativeInternal - pushing unmanaged native type %s", nativeType->getFullName().c_str());
 
+        // fast path, we've already wrapped this entry
+        if (pushCachedManagedScriptRef(L, ptr))
+        {
+            return;
+        }
+
         // look in the managed table for our entry
         lua_rawgeti(L, LUA_GLOBALSINDEX, LSINDEXMANAGEDVERSION);
         lua_pushlightuserdata(L, ptr);
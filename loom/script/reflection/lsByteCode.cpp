@@ -53,7 +53,7 @@ ByteCode *ByteCode::decode64(const char *code64)
 {
     ByteCode *byteCode = lmNew(NULL) ByteCode();
 
-    byteCode->base64 = utBase64::decode64(code64);
+    byteCode->setBase64(code64);
     return byteCode;
 }
 
@@ -62,7 +62,8 @@ ByteCode *ByteCode::encode64(const utArray<unsigned char>& bc)
 {
     ByteCode *byteCode = lmNew(NULL) ByteCode();
 
-    byteCode->base64 = utBase64::encode64(bc);
+    byteCode->bytes       = bc;
+    byteCode->base64Dirty = true;
     return byteCode;
 }
 
@@ -180,14 +181,17 @@ void ByteCode::serialize(utByteArray *bytes)
     bytes->writeUnsignedByte(LOOM_CLASSIC_BYTECODE_MAGIC);
     bytes->writeUnsignedByte(LOOM_CLASSIC_BYTECODE_VERSION);
 
-    utArray<unsigned char> data = base64.getData();
-    bytes->writeUnsignedInt(data.size());
-    utByteArray wrapper;
-    wrapper.attach(data.ptr(), data.size());
-    if (data.size() > 0) bytes->writeBytes(&wrapper);
+    bytes->writeUnsignedInt(this->bytes.size());
+
+    if (this->bytes.size() > 0)
+    {
+        utByteArray wrapper;
+        wrapper.attach(this->bytes.ptr(), this->bytes.size());
+        bytes->writeBytes(&wrapper);
+    }
 }
 
-void ByteCode::deserialize(utByteArray *bytes)
+void ByteCode::deserialize(utByteArray *bytes, bool inPlace)
 {
     unsigned char magic = bytes->readUnsignedByte();
     lmAssert(magic == LOOM_CLASSIC_BYTECODE_MAGIC, "Loom JIT ByteCode magic mismatch: %x", magic);
@@ -196,20 +200,32 @@ void ByteCode::deserialize(utByteArray *bytes)
 
     UTsize size = bytes->readUnsignedInt();
 
-    base64.clear();
+    clear();
     if (size == 0) return;
 
-    utByteArray data;
+    lmAssert(bytes->getPosition() + size <= bytes->getSize(), "ByteCode out of data on read of size %u", size);
+
+    unsigned char *data = (unsigned char *)bytes->getDataPtr() + bytes->getPosition();
+
+    if (inPlace)
+    {
+        this->bytes.attach(data, size);
+    }
+    else
+    {
+        this->bytes.resize(size);
+        memcpy(this->bytes.ptr(), data, size);
+    }
 
-    bytes->readBytes(&data, 0, size);
+    bytes->setPosition(bytes->getPosition() + size);
 
-    base64 = utBase64::encode64(*data.getInternalArray());
+    base64Dirty = true;
 }
 
 
 bool ByteCode::load(LSLuaState *ls, bool execute)
 {
-    const utArray<unsigned char>& bc = base64.getData();
+    const utArray<unsigned char>& bc = bytes;
 
     if (!bc.size())
     {
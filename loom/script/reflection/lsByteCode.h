@@ -33,29 +33,49 @@ namespace LS {
 class LSLuaState;
 
 class ByteCode {
-    utBase64 base64;
+    // raw bytecode
+    utArray<unsigned char> bytes;
+
+    // bytecode encoded as base64, generated on demand as it is
+    // only needed when writing JSON assemblies
+    utString base64;
+    bool     base64Dirty;
 
 public:
     utString error;
 
-    utString getBase64()
+    ByteCode() : base64Dirty(false)
+    {
+    }
+
+    const utString& getBase64()
     {
-        return base64.getBase64();
+        if (base64Dirty)
+        {
+            base64      = utBase64::encode64(bytes).getBase64();
+            base64Dirty = false;
+        }
+
+        return base64;
     }
 
     void setBase64(utString bc64)
     {
-        base64 = utBase64::decode64(bc64);
+        bytes       = utBase64::decode64(bc64).getData();
+        base64      = bc64;
+        base64Dirty = false;
     }
 
     const utArray<unsigned char>& getByteCode()
     {
-        return base64.getData();
+        return bytes;
     }
 
     void clear()
     {
-        base64.clear();
+        bytes.clear();
+        base64      = "";
+        base64Dirty = false;
     }
 
     bool load(LSLuaState *ls, bool execute = false);
@@ -65,7 +85,11 @@ public:
     static ByteCode *encode64(const utArray<unsigned char>& bc);
 
     void serialize(utByteArray *bytes);
-    void deserialize(utByteArray *bytes);
+
+    // when inPlace is set the bytecode references the data within the
+    // byte array rather than copying it, so the byte array must outlive
+    // the ByteCode
+    void deserialize(utByteArray *bytes, bool inPlace = false);
 };
 }
 #endif
@@ -236,10 +236,22 @@ void ByteCodeVariant::serialize(utByteArray *stream) {
     stream->writeBytes(ba);
 }
 
-void ByteCodeVariant::deserialize(utByteArray *stream) {
+void ByteCodeVariant::deserialize(utByteArray *stream, bool inPlace) {
     UTsize size = static_cast<UTsize>(stream->readUnsignedInt());
     bytes.clear();
-    if (size > 0) stream->readBytes(&bytes, 0, size);
+    if (size > 0)
+    {
+        if (inPlace)
+        {
+            lmAssert(stream->getPosition() + size <= stream->getSize(), "ByteCode out of data on read of size %u", size);
+            bytes.attach((unsigned char *)stream->getDataPtr() + stream->getPosition(), size);
+            stream->setPosition(stream->getPosition() + size);
+        }
+        else
+        {
+            stream->readBytes(&bytes, 0, size);
+        }
+    }
     base64.clear(); flags |= BASE64_DIRTY;
 }
 
@@ -333,15 +345,15 @@ void ByteCode::serialize(utByteArray *bytes)
     fr2.serialize(bytes);
 }
 
-void ByteCode::deserialize(utByteArray *bytes)
+void ByteCode::deserialize(utByteArray *bytes, bool inPlace)
 {
     unsigned char magic = bytes->readUnsignedByte();
     lmAssert(magic == LOOM_JIT_BYTECODE_MAGIC, "Loom JIT ByteCode magic mismatch: %x", magic);
     unsigned char ver = bytes->readUnsignedByte();
     lmAssert(ver == LOOM_JIT_BYTECODE_VERSION, "Loom JIT ByteCode version mismatch: %d", ver);
 
-    std.deserialize(bytes);
-    fr2.deserialize(bytes);
+    std.deserialize(bytes, inPlace);
+    fr2.deserialize(bytes, inPlace);
 }
 
 bool ByteCode::load(LSLuaState *ls, bool execute)
@@ -62,7 +62,10 @@ public:
     void setByteCode(utByteArray bc);
 
     void serialize(utByteArray *stream);
-    void deserialize(utByteArray *stream);
+
+    // when inPlace is set the bytecode references the data within the
+    // stream rather than copying it, so the stream must outlive the variant
+    void deserialize(utByteArray *stream, bool inPlace = false);
 };
 
 class ByteCode {
@@ -92,7 +95,7 @@ public:
     void clear();
 
     void serialize(utByteArray *bytes);
-    void deserialize(utByteArray *bytes);
+    void deserialize(utByteArray *bytes, bool inPlace = false);
 
 };
 }
@@ -35,11 +35,15 @@ struct MethodAttributes : BaseAttributes
     bool isOperator;
     bool hasSuperCall;
 
+    // method may not be overridden by subtypes
+    bool isFinal;
+
     MethodAttributes()
     {
         isVirtual    = false;
         isOperator   = false;
         hasSuperCall = false;
+        isFinal      = false;
     }
 };
 
@@ -186,6 +190,11 @@ public:
         return attr.hasSuperCall;
     }
 
+    inline bool isFinal()
+    {
+        return attr.isFinal;
+    }
+
     bool isVirtual();
 
     inline PropertyInfo *getPropertyInfo()
@@ -353,6 +353,10 @@ static int lsr_classcreateinstance(lua_State *L)
             lua_pushvalue(L, instanceIdx);
             lua_settable(L, -3);
             lua_pop(L, 1);
+
+            // the native constructor wrapped the new native in an instance
+            // of its own, later pushes of it must find this one instead
+            NativeInterface::cacheManagedScriptRef(L, lualoom_getnativepointer(L, instanceIdx), instanceIdx);
         }
         else
         {
@@ -467,6 +471,8 @@ static int lsr_classcreateinstance(lua_State *L)
 }
 
 
+static void lsr_classimportsymbols(lua_State *L, Type *type, int index);
+
 static int lsr_classindex(lua_State *L)
 {
     Type *type = (Type *)lua_topointer(L, lua_upvalueindex(1));
@@ -519,6 +525,29 @@ static int lsr_classindex(lua_State *L)
         return 1;
     }
 
+    // the imports are brought into the class environment on its first
+    // miss, most classes loaded at startup never look one up
+    lua_rawgeti(L, 1, LSINDEXIMPORTS);
+    bool imported = lua_toboolean(L, -1) != 0;
+    lua_pop(L, 1);
+
+    if (!imported)
+    {
+        lua_pushboolean(L, 1);
+        lua_rawseti(L, 1, LSINDEXIMPORTS);
+
+        lsr_classimportsymbols(L, type, 1);
+
+        lua_pushvalue(L, 2);
+        lua_rawget(L, 1);
+        if (!lua_isnil(L, -1))
+        {
+            return 1;
+        }
+
+        lua_pop(L, 1);
+    }
+
     Type *baseType = type->getBaseType();
 
     if (baseType)
@@ -777,25 +806,42 @@ static void lsr_classimportsymbols(lua_State *L, Type *type, int index)
         }
     }
 
-    // bring the type's imports into the class environment
-    for (UTsize i = 0; i < imports.size(); i++)
+    // bring the type's imports into the class environment, this runs after
+    // the methods and static fields are set so it only fills empty names,
+    // walking backwards so a later import still wins over an earlier one
+    for (UTsize i = imports.size(); i > 0; i--)
     {
-        Type *import = imports.at(i);
+        Type *import = imports.at(i - 1);
         if (import->getMissing()) continue;
 
         int t = lua_gettop(L);
 
         lsr_getclasstable(L, import);
+        int importIdx = lua_gettop(L);
 
         // import class name
         lua_pushstring(L, import->getName());
-        lsr_getclasstable(L, import);
-        lua_rawset(L, index);
+        lua_pushvalue(L, -1);
+        lua_rawget(L, index);
+        if (lua_isnil(L, -1))
+        {
+            lua_pop(L, 1);
+            lua_pushvalue(L, importIdx);
+            lua_rawset(L, index);
+        }
+
+        lua_settop(L, importIdx);
 
         // import full class path
         lua_pushstring(L, import->getFullName().c_str());
-        lsr_getclasstable(L, import);
-        lua_rawset(L, index);
+        lua_pushvalue(L, -1);
+        lua_rawget(L, index);
+        if (lua_isnil(L, -1))
+        {
+            lua_pop(L, 1);
+            lua_pushvalue(L, importIdx);
+            lua_rawset(L, index);
+        }
 
         lua_settop(L, t);
     }
@@ -857,6 +903,15 @@ static void lsr_classinitializemethod(lua_State *L, MethodBase *methodBase, int
     {
         int functionIdx = lua_gettop(L);
 
+#ifdef LOOM_ENABLE_JIT
+        // escape hatch for methods the trace compiler mishandles, this
+        // includes any closures declared in the method
+        if (LSLuaState::isJITDisabled(methodBase->getDeclaringType(), methodBase))
+        {
+            luaJIT_setmode(L, functionIdx, LUAJIT_MODE_ALLFUNC | LUAJIT_MODE_OFF);
+        }
+#endif
+
         // create the function environment
         lua_newtable(L);
 
@@ -878,6 +933,16 @@ static void lsr_classinitializemethod(lua_State *L, MethodBase *methodBase, int
         lua_setmetatable(L, functionEnv);
 
         lua_settop(L, functionIdx);
+
+        // static methods are replaced with their bound method in
+        // lsr_classinitializestaticmethods, keep the raw function
+        // for calls which the compiler has resolved as direct
+        if (methodBase->isStatic() && methodBase->isMethod())
+        {
+            lua_pushstring(L, (name + "__direct").c_str());
+            lua_pushvalue(L, functionIdx);
+            lua_rawset(L, index);
+        }
     }
 
     // store to method lookup
@@ -1028,6 +1093,29 @@ static void lsr_classinitializestaticmethods(lua_State *L, Type *type, int index
             continue;
         }
 
+        if (lsr_isbindablemethod(method))
+        {
+            int ttop = lua_gettop(L);
+
+            lua_getfield(L, index, method->getName());
+            lsr_bindmethod(L, method, 0);
+
+            lua_pushstring(L, method->getName());
+            lua_pushvalue(L, -2);
+            lua_rawset(L, index);
+
+            lua_rawgeti(L, LUA_GLOBALSINDEX, LSINDEXMETHODLOOKUP);
+            lua_pushvalue(L, -2);
+            lua_pushlightuserdata(L, method);
+            lua_rawset(L, -3);
+            lua_pop(L, 1);
+
+            lua_rawseti(L, index, method->getOrdinal());
+
+            lua_settop(L, ttop);
+            continue;
+        }
+
         if (true /*method->getFirstDefaultParm() != -1*/)
         {
             int ttop = lua_gettop(L);
@@ -1149,9 +1237,9 @@ void lsr_classinitializestatic(lua_State *L, Type *type)
 
 
 /*
- * Initializes a class including its import table, initializes methods,
- * loads instance and static byte code, also initializes any native information
- * including fields.
+ * Initializes a class, initializes methods, loads instance and static byte
+ * code, also initializes any native information including fields. The import
+ * table is filled on the first lookup that misses the class table.
  */
 void lsr_classinitialize(lua_State *L, Type *type)
 {
@@ -1163,8 +1251,16 @@ void lsr_classinitialize(lua_State *L, Type *type)
 
     lsr_classimportluasymbols(L, clsIdx);
     lua_settop(L, clsIdx);
-    lsr_classimportsymbols(L, type, clsIdx);
-    lua_settop(L, clsIdx);
+
+    // the rest of the imports are left to lsr_classindex, but the class
+    // names itself in its static initializer and always wins over them
+    lua_pushstring(L, type->getName());
+    lua_pushvalue(L, clsIdx);
+    lua_rawset(L, clsIdx);
+    lua_pushstring(L, type->getFullName().c_str());
+    lua_pushvalue(L, clsIdx);
+    lua_rawset(L, clsIdx);
+
     lsr_classinitializemethods(L, type, clsIdx);
     lua_settop(L, clsIdx);
 
@@ -1191,6 +1287,13 @@ void lsr_classinitialize(lua_State *L, Type *type)
             continue;
         }
 
+#ifdef LOOM_ENABLE_JIT
+        if (LSLuaState::isJITDisabled(type))
+        {
+            luaJIT_setmode(L, -1, LUAJIT_MODE_ALLFUNC | LUAJIT_MODE_OFF);
+        }
+#endif
+
         // set initializer env to class table
         lua_pushvalue(L, clsIdx);
         lua_setfenv(L, -2);
@@ -166,6 +166,186 @@ void *lsr_getmethodcfunctionaddress()
 }
 
 
+// the maximum number of parameters a method bound without lsr_method may have
+#define LSMAXBINDERPARAMETERS    8
+
+/*
+ * The trace compiler can't record through a C closure, so every call through
+ * lsr_method aborts the trace it is in.  Under the JIT, script methods which need
+ * neither default arguments nor var args are instead bound with a Lua closure,
+ * which does what lsr_method would for them: it asserts on too few arguments and
+ * calls the method in an xpcall with the same traceback, reporting errors against
+ * the method.  Both are recorded by the trace compiler.
+ */
+bool lsr_isbindablemethod(MethodBase *method)
+{
+#ifdef LOOM_ENABLE_JIT
+    return !method->isNative() &&
+           !method->isFastCall() &&
+           method->getFirstDefaultParm() == -1 &&
+           method->getVarArgIndex() == -1 &&
+           method->getNumParameters() <= LSMAXBINDERPARAMETERS;
+
+#else
+    return false;
+#endif
+}
+
+
+#ifdef LOOM_ENABLE_JIT
+static int lsr_bindertoofewarguments(lua_State *L)
+{
+    MethodBase *method = (MethodBase *)lua_topointer(L, 1);
+
+    lmAssert(0, "Method '%s::%s' called with too few arguments.", method->getDeclaringType()->getFullName().c_str(), method->getStringSignature().c_str());
+
+    return 0;
+}
+
+
+static int lsr_bindererror(lua_State *L)
+{
+    MethodBase *method = (MethodBase *)lua_topointer(L, 1);
+
+    LSLuaState::getLuaState(L)->triggerRuntimeError("Runtime error calling %s:%s", method->getDeclaringType()->getFullName().c_str(), method->getName());
+
+    return 0;
+}
+
+
+/*
+ * binders[1][n] = function(f, method) binds a static method of arity n,
+ * binders[2][n] = function(f, this, method) an instance one.
+ *
+ * Script methods are vararg functions, and the trace compiler can't return
+ * from one into a pcall frame, so the method is called from a fixed arity
+ * "call" closure rather than directly by the xpcall.
+ */
+static void lsr_registermethodbinders(lua_State *L)
+{
+    utString source =
+        "local select, xpcall = select, xpcall\n"
+        "local tooFewArguments, failed = ...\n"
+        "local function finish(method, ok, ...)\n"
+        "    if not ok then failed(method) return end\n"
+        "    return ...\n"
+        "end\n"
+        "local binders = { {}, {} }\n";
+
+    for (int i = 0; i <= LSMAXBINDERPARAMETERS; i++)
+    {
+        utString args;
+        char     arg[16];
+
+        for (int j = 1; j <= i; j++)
+        {
+            snprintf(arg, 16, j == 1 ? "a%i" : ", a%i", j);
+            args += arg;
+        }
+
+        snprintf(arg, 16, "%i", i);
+
+        for (int instance = 0; instance <= 1; instance++)
+        {
+            source += instance ? "binders[2][" : "binders[1][";
+            source += arg;
+            source += instance ? "] = function(f, this, method)\n" : "] = function(f, method)\n";
+            source += "    local function call(";
+            source += args;
+            source += ") return (f(";
+            source += instance ? (i ? "this, " : "this") : "";
+            source += args;
+            source += ")) end\n";
+            source += "    return function(...)\n";
+            source += "        if select('#', ...) < ";
+            source += arg;
+            source += " then tooFewArguments(method) end\n";
+            source += "        return finish(method, xpcall(call, __ls_traceback, ...))\n";
+            source += "    end\n";
+            source += "end\n";
+        }
+    }
+
+    source += "return binders\n";
+
+    int error = luaL_loadbuffer(L, source.c_str(), source.length(), LSMETHODBINDERSCHUNK);
+
+    lmAssert(!error, "Unable to load method binders: %s", lua_tostring(L, -1));
+
+    lua_pushcfunction(L, lsr_bindertoofewarguments);
+    lua_pushcfunction(L, lsr_bindererror);
+    lua_call(L, 2, 1);
+    lua_rawseti(L, LUA_GLOBALSINDEX, LSINDEXMETHODBINDERS);
+}
+#endif
+
+
+void lsr_bindmethod(lua_State *L, MethodBase *method, int thisIdx)
+{
+    int top = lua_gettop(L);
+
+    if (thisIdx)
+    {
+        thisIdx = lua_absindex(L, thisIdx);
+    }
+
+    lua_rawgeti(L, LUA_GLOBALSINDEX, LSINDEXMETHODBINDERS);
+    lua_rawgeti(L, -1, thisIdx ? 2 : 1);
+    lua_rawgeti(L, -1, method->getNumParameters());
+    lua_pushvalue(L, top); // the method's function
+
+    if (thisIdx)
+    {
+        lua_pushvalue(L, thisIdx);
+    }
+
+    lua_pushlightuserdata(L, method);
+    lua_call(L, thisIdx ? 3 : 2, 1);
+
+    // replace the method's function with the bound method
+    lua_replace(L, top);
+    lua_settop(L, top);
+}
+
+
+// pushes the named upvalue of the function at index, or nil
+static void lsr_getnamedupvalue(lua_State *L, int index, const char *name)
+{
+    for (int i = 1; ; i++)
+    {
+        const char *upvalue = lua_getupvalue(L, index, i);
+
+        if (!upvalue)
+        {
+            lua_pushnil(L);
+            return;
+        }
+
+        if (!strcmp(upvalue, name))
+        {
+            return;
+        }
+
+        lua_pop(L, 1);
+    }
+}
+
+
+void lsr_getbinderupvalue(lua_State *L, int index, const char *name)
+{
+    // "f" and "this" are upvalues of the binder's call closure
+    lsr_getnamedupvalue(L, index, "call");
+
+    if (lua_isnil(L, -1))
+    {
+        return;
+    }
+
+    lsr_getnamedupvalue(L, -1, name);
+    lua_remove(L, -2);
+}
+
+
 // only called when table index does not exist
 static int lsr_instancenewindex(lua_State *L)
 {
@@ -311,7 +491,17 @@ static int lsr_instanceindex(lua_State *L)
                 }
 
                 // check for fast path
-                if (method->isFastCall())
+                if (lsr_isbindablemethod(method))
+                {
+                    // bind with a Lua closure the trace compiler can record through,
+                    // there are no default args so the method's function is on top
+                    lsr_bindmethod(L, method, 1);
+
+                    // replace the upvalues with the bound method
+                    lua_replace(L, -nup);
+                    lua_pop(L, nup - 2);
+                }
+                else if (method->isFastCall())
                 {
                     if (method->getNumParameters())
                     {
@@ -564,6 +754,10 @@ static int lsr_gctracker(lua_State *L)
 
 void lsr_instanceregister(lua_State *L)
 {
+#ifdef LOOM_ENABLE_JIT
+    lsr_registermethodbinders(L);
+#endif
+
     // Standard metatable for instances
     luaL_newmetatable(L, LSINSTANCE);
 
@@ -37,12 +37,15 @@
 #include "loom/script/common/lsError.h"
 #include "loom/script/common/lsFile.h"
 #include "loom/script/serialize/lsBinReader.h"
+#include "loom/script/serialize/lsAssemblyReader.h"
 
 extern "C" {
     int luaopen_socket_core(lua_State *L);
     void luaL_openlibs(lua_State *L);
 }
 
+void debugAssemblyLoaded(lua_State *L);
+
 
 namespace LS {
 void lsr_classinitializestatic(lua_State *L, Type *type);
@@ -56,6 +59,8 @@ lua_State         *LSLuaState::lastState     = NULL;
 LSLuaState        *LSLuaState::lastLSState   = NULL;
 double            LSLuaState::constructorKey = 0;
 utArray<utString> LSLuaState::buildCache;
+bool              LSLuaState::jitEnabled = true;
+utArray<utString> LSLuaState::jitDisabledAssemblies;
 
 lmDefineLogGroup(gLuaStateLogGroup, "luastate", true, LoomLogInfo);
 
@@ -112,18 +117,31 @@ void LSLuaState::open()
 
     toLuaState.insert(L, this);
 
-#ifdef LUAJIT_MODE_MASK
-    // TODO: turn this back on when it doesn't fail on the testWhile unit test
-    // update luajit and test again
-    luaJIT_setmode(L, 0, LUAJIT_MODE_ENGINE | LUAJIT_MODE_OFF);
-#endif
-
     // Stop the GC initially
     lua_gc(L, LUA_GCSTOP, 0);
 
     // open all the standard libraries
     luaL_openlibs(L);
 
+#ifdef LOOM_ENABLE_JIT
+    // opening the jit library initializes the engine mode, so this must follow it
+    if (!jitEnabled)
+    {
+        luaJIT_setmode(L, 0, LUAJIT_MODE_ENGINE | LUAJIT_MODE_OFF);
+    }
+
+    // count trace events for the JIT stats, jit.attach(handler, "trace")
+    resetJITStats();
+
+    lua_getglobal(L, "jit");
+    lua_getfield(L, -1, "attach");
+    lua_pushlightuserdata(L, this);
+    lua_pushcclosure(L, jitTraceEvent, 1);
+    lua_pushstring(L, "trace");
+    lua_call(L, 2, 0);
+    lua_pop(L, 1);
+#endif
+
     // open socket library
     luaopen_socket_core(L);
 
@@ -178,6 +196,58 @@ void LSLuaState::open()
 }
 
 
+int LSLuaState::jitTraceEvent(lua_State *L)
+{
+    LSLuaState *ls   = (LSLuaState *)lua_touserdata(L, lua_upvalueindex(1));
+    const char *what = lua_tostring(L, 1);
+
+    if (!what)
+    {
+        return 0;
+    }
+
+    if (!strcmp(what, "start"))
+    {
+        ls->jitTracesStarted++;
+    }
+    else if (!strcmp(what, "stop"))
+    {
+        ls->jitTracesCompiled++;
+    }
+    else if (!strcmp(what, "abort"))
+    {
+        ls->jitTracesAborted++;
+    }
+    else if (!strcmp(what, "flush"))
+    {
+        ls->jitFlushes++;
+    }
+
+    return 0;
+}
+
+
+bool LSLuaState::isJITDisabled(Type *type, MethodBase *method)
+{
+    if (method && method->getMetaInfo("NoJIT"))
+    {
+        return true;
+    }
+
+    if (type->getMetaInfo("NoJIT"))
+    {
+        return true;
+    }
+
+    if (jitDisabledAssemblies.size() && type->getAssembly())
+    {
+        return jitDisabledAssemblies.find(type->getAssembly()->getName()) != UT_NPOS;
+    }
+
+    return false;
+}
+
+
 void LSLuaState::close()
 {
     assert(L);
@@ -206,11 +276,11 @@ void LSLuaState::close()
 }
 
 
-Assembly *LSLuaState::loadTypeAssembly(const utString& assemblyString)
+Assembly *LSLuaState::loadTypeAssembly(json_t *assemblyJSON)
 {
     beginAssemblyLoad();
 
-    Assembly *assembly = Assembly::loadFromString(this, assemblyString);
+    Assembly *assembly = AssemblyReader::deserialize(this, assemblyJSON);
 
     utArray<Type *> types;
     assembly->getTypes(types);
@@ -504,6 +574,9 @@ void LSLuaState::finalizeAssemblyLoad(Assembly *assembly, utArray<Type *>& types
     }
 #endif
 
+    // before the static initializers run any of the new methods
+    debugAssemblyLoaded(L);
+
     assembly->bootstrap();
 }
 
@@ -607,20 +680,39 @@ utByteArray *LSLuaState::openExecutableAssemblyBinary(const char *buffer, long b
 
     utByteArray headerBytes;
 
-    headerBytes.allocateAndCopy((void *)buffer, sizeof(unsigned int) * 4);
+    lmCheck(bufferSize >= (long)LOOM_BINARY_HEADER_SIZE, "executable assembly is truncated");
+
+    headerBytes.attach((void *)buffer, LOOM_BINARY_HEADER_SIZE);
 
-    // we need to decompress
     lmCheck(headerBytes.readUnsignedInt() == LOOM_BINARY_ID, "binary id mismatch");
     lmCheck(headerBytes.readUnsignedInt() == LOOM_BINARY_VERSION_MAJOR, "major version mismatch");
     lmCheck(headerBytes.readUnsignedInt() == LOOM_BINARY_VERSION_MINOR, "minor version mismatch");
-    unsigned int sz = headerBytes.readUnsignedInt();
+    unsigned int sz           = headerBytes.readUnsignedInt();
+    unsigned int compressedSz = headerBytes.readUnsignedInt();
+
+    const unsigned char *body = (const unsigned char *)buffer + LOOM_BINARY_HEADER_SIZE;
 
     utByteArray *bytes = lmNew(NULL) utByteArray();
+
+    if (compressedSz == 0)
+    {
+        lmCheck(sz <= bufferSize - LOOM_BINARY_HEADER_SIZE, "executable assembly is truncated");
+
+        // the body is read in place, bytecode references it until the
+        // assembly's bytecode is freed so the buffer must outlive the load
+        bytes->attach((void *)body, sz);
+
+        return bytes;
+    }
+
+    lmCheck(compressedSz <= bufferSize - LOOM_BINARY_HEADER_SIZE, "executable assembly is truncated");
+
+    // we need to decompress
     bytes->resize(sz);
 
     uLongf readSZ = sz;
 
-    int ok = uncompress((Bytef *)bytes->getDataPtr(), (uLongf *)&readSZ, (const Bytef *)((unsigned char *)buffer + sizeof(unsigned int) * 4), (uLong)sz);
+    int ok = uncompress((Bytef *)bytes->getDataPtr(), (uLongf *)&readSZ, (const Bytef *)body, (uLong)compressedSz);
 
     lmCheck(ok == Z_OK, "problem uncompressing executable assembly");
     lmCheck(readSZ == sz, "Read size mismatch");
@@ -892,8 +984,8 @@ static void _getCurrentStack(lua_State *L, utStack<stackinfo>& stack)
 
         lua_settop(L, top);
 
-        // we only want the root call, not the pcall wrapper
-        if (cfunc && (lastMethod == methodBase))
+        // we only want the root call, not the pcall wrapper or binder
+        if ((cfunc || !strcmp(lstack.source, LSMETHODBINDERSCHUNK)) && (lastMethod == methodBase))
         {
             continue;
         }
@@ -21,6 +21,8 @@
 #ifndef _lsluastate_h
 #define _lsluastate_h
 
+#include "jansson.h"
+
 #include "loom/common/core/assert.h"
 #include "loom/script/reflection/lsAssembly.h"
 #include "loom/script/native/lsNativeDelegate.h"
@@ -67,6 +69,20 @@ class LSLuaState {
     // lua_State* -> LSLuaState
     static utHashTable<utPointerHashKey, LSLuaState *> toLuaState;
 
+    // whether the trace compiler is enabled for VM's opened from here on
+    static bool jitEnabled;
+
+    // assemblies whose methods are always interpreted
+    static utArray<utString> jitDisabledAssemblies;
+
+    // trace compiler events since the VM was opened or the stats were reset
+    int jitTracesStarted;
+    int jitTracesCompiled;
+    int jitTracesAborted;
+    int jitFlushes;
+
+    static int jitTraceEvent(lua_State *L);
+
     void declareLuaTypes(const utArray<Type *>& types);
     void initializeLuaTypes(const utArray<Type *>& types);
 
@@ -106,7 +122,8 @@ public:
     static size_t allocatedBytes;
 
     LSLuaState() :
-        compiling(false), loadingAssembly(0), L(NULL)
+        compiling(false), loadingAssembly(0), L(NULL),
+        jitTracesStarted(0), jitTracesCompiled(0), jitTracesAborted(0), jitFlushes(0)
     {
 
 #ifdef LOOM_DEBUG
@@ -173,7 +190,7 @@ public:
     /*
      * Loads a Type assembly into the VM, Type assemblies are purely used during compilation
      */
-    Assembly *loadTypeAssembly(const utString& assemblyString);
+    Assembly *loadTypeAssembly(json_t *assemblyJSON);
 
     /*
      * Loads a JSON assembly into the VM, JSON assemblies are used during compilation for loomlibs
@@ -320,6 +337,59 @@ public:
 #endif
     }
 
+    static void setJITEnabled(bool enabled)
+    {
+        jitEnabled = enabled;
+    }
+
+    static bool getJITEnabled()
+    {
+        return isJIT() && jitEnabled;
+    }
+
+    // always interpret the methods of the given assembly, must be
+    // called before the assembly is loaded
+    static void disableJITForAssembly(const utString& assemblyName)
+    {
+        if (jitDisabledAssemblies.find(assemblyName) == UT_NPOS)
+        {
+            jitDisabledAssemblies.push_back(assemblyName);
+        }
+    }
+
+    // true if a method is to be interpreted, either because of [NoJIT]
+    // meta info on it or its declaring type, or because the JIT is disabled
+    // for its assembly
+    static bool isJITDisabled(Type *type, MethodBase *method = NULL);
+
+    int getJITTracesStarted()
+    {
+        return jitTracesStarted;
+    }
+
+    int getJITTracesCompiled()
+    {
+        return jitTracesCompiled;
+    }
+
+    int getJITTracesAborted()
+    {
+        return jitTracesAborted;
+    }
+
+    int getJITFlushes()
+    {
+        return jitFlushes;
+    }
+
+    void resetJITStats()
+    {
+        jitTracesStarted  = 0;
+        jitTracesCompiled = 0;
+        jitTracesAborted  = 0;
+        jitFlushes        = 0;
+    }
+
     LOOM_DELEGATE(OnReload);
 };
 }
@@ -118,7 +118,16 @@ namespace LS {
 // index for fast checking on whether a managed native instance has been deleted (from C/C++ or LoomScript)
 #define LSINDEXDELETEDMANAGED             -1000025
 
-#define LSINDEXMAX                        -1000025
+// tables of arity -> Lua function binding a static (1) or instance (2) method, JIT only
+#define LSINDEXMETHODBINDERS              -1000026
+
+// Class tables hold true at this index once their imports have been brought into the class environment
+#define LSINDEXIMPORTS                    -1000027
+
+#define LSINDEXMAX                        -1000027
+
+// the chunk name of the method binders, so their frames can be told apart
+#define LSMETHODBINDERSCHUNK              "__ls_methodbinders"
 
 void lsr_getclasstable(lua_State *L, Type *type);
 void lsr_classinitialize(lua_State *L, Type *type);
@@ -138,6 +147,16 @@ const char *lsr_objecttostring(lua_State *L, int index);
 int lsr_method(lua_State *L);
 void *lsr_getmethodcfunctionaddress();
 
+// true if the method can be called without going through lsr_method
+bool lsr_isbindablemethod(MethodBase *method);
+
+// replaces the method's function on top of the stack with a bound method
+// calling it, with the this at thisIdx or for a static method when 0
+void lsr_bindmethod(lua_State *L, MethodBase *method, int thisIdx);
+
+// pushes the "f" (the method's function) or "this" of a bound method
+void lsr_getbinderupvalue(lua_State *L, int index, const char *name);
+
 inline void lsr_getclasstable(lua_State *L, Type *type)
 {
     // check cache first
@@ -365,6 +384,14 @@ inline void lsr_pushmethodbase(lua_State *L, MethodBase *base)
     lua_settop(L, top);
 }
 
+// Function Operations
+
+/**
+ *  Gets the number of declared parameters of the function at the specified
+ *  index, as Function.length
+ */
+int lsr_function_get_numparameters(lua_State *L, int index);
+
 // Vector Operations
 
 /** 
@@ -377,6 +404,27 @@ int lsr_vector_get_length(lua_State *L, int index);
  */
  void lsr_vector_set_length(lua_State *L, int index, int nlength);
 
+/**
+ *  Borrows the elements of the Number vector at the specified index as a
+ *  contiguous array, optionally returning its length. Returns NULL when an
+ *  element isn't a Number or the VM doesn't store Numbers unboxed (the
+ *  classic VM and dual number builds), callers then fall back to
+ *  lua_rawgeti. The array is only valid until the vector is next modified.
+ */
+lua_Number *lsr_vector_borrow_numbers(lua_State *L, int index, int *length);
+
+/**
+ *  Writes count Numbers from src to the vector at the specified index,
+ *  starting at offset and growing the vector as needed
+ */
+void lsr_vector_write_numbers(lua_State *L, int index, int offset, const lua_Number *src, int count);
+
+/**
+ *  Copies up to count elements of the vector at the specified index to dst,
+ *  returns the number of elements copied
+ */
+int lsr_vector_read_floats(lua_State *L, int index, float *dst, int count);
+
 
 // avoid oodles of static buffers compiler into template code
 #define TYPENAME_BUFFER_SIZE    1024
@@ -93,6 +93,12 @@ Assembly *AssemblyReader::deserialize(LSLuaState *vm, const utString& sjson)
 
     lmAssert(json, "Error loading Assembly json: %s\n %s %i\n", jerror.source, jerror.text, jerror.line);
 
+    return deserialize(vm, json);
+}
+
+
+Assembly *AssemblyReader::deserialize(LSLuaState *vm, json_t *json)
+{
     utString type       = json_string_value(json_object_get(json, "type"));
     utString name       = json_string_value(json_object_get(json, "name"));
     utString version    = json_string_value(json_object_get(json, "version"));
@@ -43,6 +43,8 @@ public:
 
     static Assembly *deserialize(LSLuaState *vm, const utString& sjson);
 
+    static Assembly *deserialize(LSLuaState *vm, json_t *json);
+
     static void addLibraryAssemblyPath(const utString& path)
     {
         libraryAssemblyPath.push_back(path);
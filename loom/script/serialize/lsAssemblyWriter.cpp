@@ -28,7 +28,7 @@
 #include "loom/common/utils/utBase64.h"
 
 namespace LS {
-void AssemblyWriter::writeToString(utString& out)
+json_t *AssemblyWriter::write()
 {
     json_t *json = json_object();
 
@@ -75,7 +75,17 @@ void AssemblyWriter::writeToString(utString& out)
         json_array_append(moduleArray, mjson);
     }
 
+    return json;
+}
+
+
+void AssemblyWriter::writeToString(utString& out)
+{
+    json_t *json = write();
+
     out = json_dumps(json, JSON_INDENT(3) | JSON_SORT_KEYS | JSON_PRESERVE_ORDER | JSON_COMPACT);
+
+    json_decref(json);
 }
 
 
@@ -81,6 +81,9 @@ public:
         loomConfig = _loomConfig;
     }
 
+    // the assembly as a JSON object, owned by the caller
+    json_t *write();
+
     void writeToString(utString& out);
 
     void writeToFile(const utString& filename);
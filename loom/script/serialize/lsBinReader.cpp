@@ -25,6 +25,7 @@
 
 namespace LS {
 utByteArray           *BinReader::sBytes = NULL;
+int                   BinReader::byteCodePosition = 0;
 utArray<const char *> BinReader::stringPool;
 const char            *BinReader::stringBuffer = NULL;
 LSLuaState            *BinReader::vm           = NULL;
@@ -141,6 +142,22 @@ TemplateInfo *BinReader::readTemplateTypes()
 }
 
 
+ByteCode *BinReader::readByteCode()
+{
+    int offset   = bytes->readInt();
+    int position = bytes->getPosition();
+
+    bytes->setPosition(byteCodePosition + offset);
+
+    ByteCode *byteCode = lmNew(NULL) ByteCode();
+    byteCode->deserialize(bytes, true);
+
+    bytes->setPosition(position);
+
+    return byteCode;
+}
+
+
 void BinReader::readMethodBase(MethodBase *mbase)
 {
     readMemberInfo(mbase);
@@ -183,6 +200,10 @@ void BinReader::readMethodBase(MethodBase *mbase)
         {
             mbase->attr.isOperator = true;
         }
+        else if (!strcmp(methodAttr, "final"))
+        {
+            mbase->attr.isFinal = true;
+        }
     }
 
     if (bytes->readBoolean())
@@ -239,8 +260,7 @@ void BinReader::readMethodBase(MethodBase *mbase)
     if (mbase->isNative())
     {
         // empty bytecode
-        ByteCode byteCode;
-        byteCode.deserialize(bytes);
+        bytes->readInt();
 
         lua_CFunction function = NULL;
         lua_State     *L       = vm->VM();
@@ -296,9 +316,7 @@ void BinReader::readMethodBase(MethodBase *mbase)
     }
     else
     {
-        ByteCode *byteCode = lmNew(NULL) ByteCode();
-        byteCode->deserialize(bytes);
-        mbase->setByteCode(byteCode);
+        mbase->setByteCode(readByteCode());
     }
 }
 
@@ -594,15 +612,8 @@ void BinReader::readClass(Type *type)
         type->addMember(methodInfo);
     }
 
-    ByteCode *byteCode;
-
-    byteCode = lmNew(NULL) ByteCode();
-    byteCode->deserialize(bytes);
-    type->setBCStaticInitializer(byteCode);
-
-    byteCode = lmNew(NULL) ByteCode();
-    byteCode->deserialize(bytes);
-    type->setBCInstanceInitializer(byteCode);
+    type->setBCStaticInitializer(readByteCode());
+    type->setBCInstanceInitializer(readByteCode());
 }
 
 
@@ -844,6 +855,8 @@ void BinReader::loadExecutableHeader(LSLuaState *_vm, utByteArray *byteArray)
     // write out the number of references
     int numRefs = sBytes->readInt();
 
+    byteCodePosition = sBytes->readInt();
+
     for (int i = 0; i < numRefs; i++)
     {
         const char* name = readPoolString();
@@ -83,6 +83,9 @@ class BinReader {
     static utArray<const char *> stringPool;
     // The byte array of the entire binary
     static utByteArray *sBytes;
+
+    // The position of the bytecode section within the binary
+    static int byteCodePosition;
     // initialized the string pool from the binary file
     static void readStringPool();
 
@@ -161,6 +164,12 @@ class BinReader {
      */
     PropertyInfo *readProperty(Type *type);
 
+    /*
+     * Reads a bytecode offset and returns the ByteCode it refers to, which
+     * references the binary in place and so must be freed before the binary is
+     */
+    ByteCode *readByteCode();
+
     /*
      * Reads a MethodBase which are shared by MethodInfos and ConstructorInfos
      */
@@ -35,6 +35,7 @@
 namespace LS {
 utHashTable<utHashedString, int>         BinWriter::stringPool;
 utHashTable<utHashedString, BinWriter *> BinWriter::binWriters;
+utByteArray BinWriter::byteCodeSection;
 
 loom_allocator_t *gBinWriterAllocator = NULL;
 
@@ -328,14 +329,21 @@ void BinWriter::writeMethodBase(json_t *jmbase)
         }
     }
 
+    writeByteCode(jmbase, "bytecode", "bytecode_fr2");
+}
+
+
+void BinWriter::writeByteCode(json_t *json, const char *key, const char *keyFR2)
+{
     ByteCode byteCode;
 
-    byteCode.setBase64(utString(json_string_value(json_object_get(jmbase, "bytecode"))));
+    byteCode.setBase64(utString(json_string_value(json_object_get(json, key))));
 #if LOOM_ENABLE_JIT
-    byteCode.setBase64FR2(utString(json_string_value(json_object_get(jmbase, "bytecode_fr2"))));
+    byteCode.setBase64FR2(utString(json_string_value(json_object_get(json, keyFR2))));
 #endif
-    byteCode.serialize(&bytes);
 
+    bytes.writeInt((int)byteCodeSection.getPosition());
+    byteCode.serialize(&byteCodeSection);
 }
 
 
@@ -478,23 +486,9 @@ void BinWriter::writeClass(json_t *jclass)
         writeMethodInfo(jmethod);
     }
 
-    // static initializer byte code
-    ByteCode byteCode;
-
-
-    byteCode.setBase64   (utString(json_string_value(json_object_get(jclass, "bytecode_staticinitializer"))));
-#if LOOM_ENABLE_JIT
-    byteCode.setBase64FR2(utString(json_string_value(json_object_get(jclass, "bytecode_staticinitializer_fr2"))));
-#endif
-    byteCode.serialize(&bytes);
-
-
-    byteCode.setBase64   (utString(json_string_value(json_object_get(jclass, "bytecode_instanceinitializer"))));
-#if LOOM_ENABLE_JIT
-    byteCode.setBase64FR2(utString(json_string_value(json_object_get(jclass, "bytecode_instanceinitializer_fr2"))));
-#endif
-    byteCode.serialize(&bytes);
-
+    // static and instance initializer byte code
+    writeByteCode(jclass, "bytecode_staticinitializer", "bytecode_staticinitializer_fr2");
+    writeByteCode(jclass, "bytecode_instanceinitializer", "bytecode_instanceinitializer_fr2");
 }
 
 
@@ -678,21 +672,22 @@ void BinWriter::writeAssembly(json_t *json)
 }
 
 
-void BinWriter::writeExecutable(const char *path, const char *sjson, int jsonSize)
+void BinWriter::writeExecutable(const char *path, const char *sjson, int jsonSize, bool compress)
 {
     json_error_t jerror;
     json_t       *json = json_loadb(sjson, jsonSize, 0, &jerror);
 
     lmAssert(json, "Error loading Assembly json: %s\n %s %i\n", jerror.source, jerror.text, jerror.line);
 
-    writeExecutable(path, json);
+    writeExecutable(path, json, compress);
 }
 
 
-void BinWriter::writeExecutable(const char *path, json_t *sjson)
+void BinWriter::writeExecutable(const char *path, json_t *sjson, bool compress)
 {
     stringPool.clear();
     binWriters.clear();
+    byteCodeSection.clear();
 
     utByteArray bytes;
     // reserve 32 megs
@@ -751,6 +746,15 @@ void BinWriter::writeExecutable(const char *path, json_t *sjson)
     // write out the number of references
     bytes.writeInt((int)binWriters.size());
 
+    // the bytecode section follows the reference data
+    int byteCodePosition = bytes.getPosition() + sizeof(int) + (binWriters.size() * (sizeof(int) * 4));
+    for (UTsize i = 0; i < binWriters.size(); i++)
+    {
+        byteCodePosition += binWriters.at(i)->bytes.getPosition();
+    }
+
+    bytes.writeInt(byteCodePosition);
+
     // write out reference table (which will allow random access if we want/need it)
     int position = bytes.getPosition() + (binWriters.size() * (sizeof(int) * 4));
 
@@ -778,28 +782,52 @@ void BinWriter::writeExecutable(const char *path, json_t *sjson)
         bytes.writeBytes(&bref->bytes);
     }
 
-    int dataLength = bytes.getPosition();
+    lmAssert((int)bytes.getPosition() == byteCodePosition, "bytecode section position mismatch");
+
+    if (byteCodeSection.getPosition() > 0)
+    {
+        bytes.writeBytes(&byteCodeSection, 0, byteCodeSection.getPosition());
+    }
 
-    Bytef *compressed = (Bytef *) lmAlloc(gBinWriterAllocator, dataLength);
-    uLongf length = (uLongf) dataLength;
-    int ok = compress(compressed, &length, (Bytef *) bytes.getDataPtr(), (uLong) dataLength);
-    lmAssert(ok == Z_OK, "problem compressing executable assemby");
+    byteCodeSection.clear();
 
-    bytes.clear();
-    bytes.writeUnsignedInt(LOOM_BINARY_ID);
-    bytes.writeUnsignedInt(LOOM_BINARY_VERSION_MAJOR);
-    bytes.writeUnsignedInt(LOOM_BINARY_VERSION_MINOR);
-    bytes.writeUnsignedInt((unsigned int)dataLength);
+    unsigned int dataLength = bytes.getPosition();
+
+    Bytef  *compressed = NULL;
+    uLongf length      = 0;
+
+    if (compress)
+    {
+        length     = compressBound((uLong)dataLength);
+        compressed = (Bytef *)lmAlloc(gBinWriterAllocator, length);
+        int ok = ::compress(compressed, &length, (Bytef *)bytes.getDataPtr(), (uLong)dataLength);
+        lmAssert(ok == Z_OK, "problem compressing executable assemby");
+    }
+
+    utByteArray header;
+    header.writeUnsignedInt(LOOM_BINARY_ID);
+    header.writeUnsignedInt(LOOM_BINARY_VERSION_MAJOR);
+    header.writeUnsignedInt(LOOM_BINARY_VERSION_MINOR);
+    header.writeUnsignedInt(dataLength);
+    header.writeUnsignedInt((unsigned int)length);
 
     utFileStream binStream;
     binStream.open(path, utStream::SM_WRITE);
     // write header
-    binStream.write(bytes.getDataPtr(), sizeof(unsigned int) * 4);
-    // write compressed data
-    binStream.write(compressed, length);
+    binStream.write(header.getDataPtr(), LOOM_BINARY_HEADER_SIZE);
 
-    binStream.close();
+    if (compressed)
+    {
+        // write compressed data
+        binStream.write(compressed, length);
+        lmFree(gBinWriterAllocator, compressed);
+    }
+    else
+    {
+        // write the body, uncompressed so it may be read in place
+        binStream.write(bytes.getDataPtr(), dataLength);
+    }
 
-    lmFree(gBinWriterAllocator, compressed);
+    binStream.close();
 }
 }
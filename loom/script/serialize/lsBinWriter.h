@@ -38,12 +38,20 @@ namespace LS {
      | ((unsigned int)(unsigned char)('O') << 16) \
      | ((unsigned int)(unsigned char)('L') << 24))
 
-#define LOOM_BINARY_VERSION_MAJOR    1
+#define LOOM_BINARY_VERSION_MAJOR    2
 #define LOOM_BINARY_VERSION_MINOR    1
 
+// id, major, minor, body length and compressed body length
+#define LOOM_BINARY_HEADER_SIZE      (sizeof(unsigned int) * 5)
+
 /*
  * BinWriter recursively writes an executable binary assembly given a JSON source assembly
- * The binary assembly will include all dependencies linked in and uses zlib compression
+ * The binary assembly will include all dependencies linked in
+ *
+ * The raw bytecode of every method and initializer is gathered into a single section at
+ * the end of the body which the type records index into.  The body uses zlib compression
+ * unless written uncompressed, in which case it is read in place from a mapped file.  The
+ * compressed length in the header is 0 for an uncompressed body
  */
 class BinWriter {
     /*
@@ -67,6 +75,9 @@ class BinWriter {
     // Assembly reference name to BinWriter lookup, for recursive writing of assembly data
     static utHashTable<utHashedString, BinWriter *> binWriters;
 
+    // The bytecode of all assemblies, written at the end of the executable
+    static utByteArray byteCodeSection;
+
     // the bytes of the binary assembly
     utByteArray bytes;
 
@@ -99,6 +110,12 @@ class BinWriter {
      */
     void writeField(json_t *jfield);
 
+    /*
+     * Writes the bytecode of the given JSON keys to the bytecode section
+     * and its offset within the section to the byte array
+     */
+    void writeByteCode(json_t *json, const char *key, const char *keyFR2);
+
     /*
      * Writes a MethodBase to the byte array
      */
@@ -179,14 +196,14 @@ public:
      * generates an executable assembly with all dependencies linked
      * in
      */
-    static void writeExecutable(const char *path, const char *sjson, int jsonSize);
+    static void writeExecutable(const char *path, const char *sjson, int jsonSize, bool compress = true);
 
     /*
      * Given a path, source JSON, and the size of the JSON
      * generates an executable assembly with all dependencies linked
      * in
      */
-    static void writeExecutable(const char *path, json_t *sjson);
+    static void writeExecutable(const char *path, json_t *sjson, bool compress = true);
 };
 }
 #endif
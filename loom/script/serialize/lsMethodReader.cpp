@@ -68,6 +68,10 @@ void MethodReader::deserializeMethodBase(MethodBase *base, json_t *json)
         {
             base->attr.isOperator = true;
         }
+        else if (modifier == "final")
+        {
+            base->attr.isFinal = true;
+        }
     }
 
     // template types on return
@@ -89,6 +89,10 @@ void MethodBaseWriter::write(json_t *json)
     {
         json_array_append(mattr, json_string("supercall"));
     }
+    if (attr.isFinal)
+    {
+        json_array_append(mattr, json_string("final"));
+    }
 
     json_t *params = json_array();
 
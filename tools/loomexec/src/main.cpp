@@ -117,6 +117,7 @@ static void initialize(int argc, const char **argv)
 
     if (argSwitches.find("--verbose") != UT_NPOS) LSLogSetLevel(LSLogDebug);
     if (argSwitches.find("--ignore-missing-types") != UT_NPOS) Type::ignoreMissingTypes = true;
+    if (argSwitches.find("--no-jit") != UT_NPOS) LSLuaState::setJITEnabled(false);
 
     // look for passing a .loom file
     for (int i = argStart; i < argc; i++ )
@@ -24,6 +24,7 @@
 #include "loom/common/platform/platform.h"
 #include "loom/common/platform/platformTime.h"
 #include "loom/common/platform/platformFile.h"
+#include "loom/common/platform/platformIO.h"
 #include "loom/script/compiler/lsCompiler.h"
 #include "loom/script/runtime/lsLuaState.h"
 #include "loom/script/native/lsNativeDelegate.h"
@@ -173,6 +174,37 @@ void RunBenchmarks()
     benchVM->close();
 }
 
+void RunStartupBenchmark(const char *executable, int iterations)
+{
+    LSCompiler::log("Startup benchmark of %s, %i iterations", executable, iterations);
+
+    long long total = 0;
+    long long best  = -1;
+    long long worst = 0;
+
+    for (int i = 0; i < iterations; i++)
+    {
+        LSLuaState *benchVM = new LSLuaState();
+
+        benchVM->open();
+
+        loom_precision_timer_t timer = loom_startTimer();
+        benchVM->loadExecutableAssembly(executable);
+        long long elapsed = loom_readTimerNano(timer);
+        loom_destroyTimer(timer);
+
+        benchVM->close();
+        delete benchVM;
+
+        total += elapsed;
+        if (best < 0 || elapsed < best) best = elapsed;
+        if (elapsed > worst) worst = elapsed;
+    }
+
+    LSCompiler::log("Startup: min %.2fms avg %.2fms max %.2fms",
+                    best / 1000000.0, total / (iterations * 1000000.0), worst / 1000000.0);
+}
+
 void printHeader()
 {
     const char *buildTarget;
@@ -212,9 +244,15 @@ int main(int argc, const char **argv)
     bool runbenchmarks = false;
     bool symbols       = false;
 
+    const char *startupExecutable = NULL;
+    int        startupIterations  = 10;
+
     const char *rootBuildFile = NULL;
     const char *sdkRoot = NULL;
 
+    const char *packRoot    = NULL;
+    const char *packArchive = NULL;
+
     for (int i = 1; i < argc; i++)
     {
         if (!strcmp(argv[i], "--log-type"))
@@ -259,6 +297,32 @@ int main(int argc, const char **argv)
         {
             LSCompiler::setDebugBuild(false);
         }
+        else if (!strcmp(argv[i], "--inline-accessors"))
+        {
+            LSCompiler::setInlineAccessors(true);
+        }
+        else if (!strcmp(argv[i], "--optimize"))
+        {
+            LSCompiler::setOptimize(true);
+        }
+        else if (!strcmp(argv[i], "--incremental"))
+        {
+            LSCompiler::setIncremental(true);
+        }
+        else if (!strcmp(argv[i], "--uncompressed"))
+        {
+            LSCompiler::setCompressExecutable(false);
+        }
+        else if (!strcmp(argv[i], "--jobs"))
+        {
+            i++;
+            if (i >= argc)
+            {
+                LSError("--jobs option requires the number of threads to be specified");
+            }
+
+            LSCompiler::setJobs(atoi(argv[i]));
+        }
         else if (!strcmp(argv[i], "--verbose"))
         {
             loom_log_setGlobalLevel(LoomLogDebug);
@@ -271,10 +335,35 @@ int main(int argc, const char **argv)
         {
             runbenchmarks = true;
         }
+        else if (!strcmp(argv[i], "--startup-benchmark"))
+        {
+            i++;
+            if (i >= argc)
+            {
+                LSError("--startup-benchmark option requires the executable assembly to be specified");
+            }
+
+            startupExecutable = argv[i];
+
+            if (i + 1 < argc && atoi(argv[i + 1]) > 0)
+            {
+                startupIterations = atoi(argv[++i]);
+            }
+        }
         else if (!strcmp(argv[i], "--symbols"))
         {
             symbols = true;
         }
+        else if (!strcmp(argv[i], "--pack-assets"))
+        {
+            if (i + 2 >= argc)
+            {
+                LSError("--pack-assets option requires the asset folder and the archive to be specified");
+            }
+
+            packRoot    = argv[++i];
+            packArchive = argv[++i];
+        }
         else if (!strcmp(argv[i], "--xmlfile"))
         {
             i++;      // skip the filename
@@ -327,10 +416,17 @@ int main(int argc, const char **argv)
             printf("-Dkey=value : override key in loom.config with value, use dots to set nested values\n");
             printf("--release : build in release mode\n");
             printf("--verbose : enable verbose compilation\n");
+            printf("--inline-accessors : compile trivial final/static property accessors to direct field access\n");
+            printf("--optimize : propagate static consts, remove constant guarded code and call final/static methods directly\n");
+            printf("--incremental : reuse the bytecode of unchanged source files from the previous build\n");
+            printf("--jobs N : parse source files on N threads, defaults to one per core\n");
+            printf("--uncompressed : store the executable uncompressed, so it is read in place instead of inflated\n");
             printf("--unittest [--xmlfile filename.xml]: run unit tests with optional xml file output\n");
+            printf("--startup-benchmark file.loom [N] : time loading an executable assembly N times (default 10)\n");
             printf("--root: set the SDK root\n");
             printf("--project: set the project folder\n");
             printf("--symbols : dump symbols for binary executable\n");
+            printf("--pack-assets folder archive : pack the files under folder into an indexed archive\n");
             printf("--config : set a custom configuration override\n");
             printf("--help: display this help\n");
         }
@@ -346,6 +442,12 @@ int main(int argc, const char **argv)
         }
     }
 
+    if (packArchive)
+    {
+        LSCompiler::log("Packing %s into %s", packRoot, packArchive);
+        return platform_writeArchive(packArchive, packRoot) ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+
     if (!rootBuildFile)
     {
         LSLog(LSLogDebug, "Building Main.loom with default settings");
@@ -372,6 +474,12 @@ int main(int argc, const char **argv)
         return EXIT_SUCCESS;
     }
 
+    if (startupExecutable)
+    {
+        RunStartupBenchmark(startupExecutable, startupIterations);
+        return EXIT_SUCCESS;
+    }
+
     LSCompiler::setDumpSymbols(symbols);
 
     // todo, better sdk detection